@@ -50,6 +50,13 @@
 #include <time.h>
 #include <stdint.h>
 
+/* Storage class for variables that need one instance per thread */
+#if defined _MSC_VER
+	#define THREAD_LOCAL __declspec(thread)
+#else
+	#define THREAD_LOCAL __thread
+#endif
+
 #define EPSILON					 0.000000001 /* Near zero comparative define*/
 
 #define MAX_Kantu_Systems         20      /* The maximum number of kantu rules for each instance. */
@@ -61,7 +61,10 @@ int asirikuyLoggerInit(const char* pLogFilePath, int severityLevel);
 
 /**
  * Log a message with the specified severity level
- * Only logs if severity <= configured severity level
+ * Only logs if severity <= configured severity level, checked before any other work
+ * 
+ * The line is formatted by the calling thread into a buffer of its own and written to
+ * the log files by a background thread, in the order each thread logged its lines.
  * 
  * @param severity Severity level (0-7)
  * @param format printf-style format string
@@ -69,15 +72,42 @@ int asirikuyLoggerInit(const char* pLogFilePath, int severityLevel);
  */
 void asirikuyLogMessage(int severity, const char* format, ...);
 
+/**
+ * Write the messages logged so far to the log files
+ * Called at exit, and before a process ends without running the exit handlers
+ */
+void asirikuyLoggerFlush();
+
+// Highest severity compiled into the build. Calls above it are removed along with their
+// arguments, e.g. -DASIRIKUY_LOG_COMPILED_LEVEL=LOG_INFO drops every logDebug call.
+#ifndef ASIRIKUY_LOG_COMPILED_LEVEL
+  #define ASIRIKUY_LOG_COMPILED_LEVEL LOG_DEBUG
+#endif
+
+// Configured severity level, set by asirikuyLoggerInit
+extern int asirikuyLogSeverityLevel;
+
+#if defined _MSC_VER
+  #define asirikuyLogLevel() (*(volatile int*)&asirikuyLogSeverityLevel)
+#else
+  #define asirikuyLogLevel() __atomic_load_n(&asirikuyLogSeverityLevel, __ATOMIC_RELAXED)
+#endif
+
+// TRUE if messages of this severity are logged, for work done only to build a message
+#define asirikuyLogEnabled(severity) ((severity) <= ASIRIKUY_LOG_COMPILED_LEVEL && (severity) <= asirikuyLogLevel())
+
+// The arguments are only evaluated when the severity is logged
+#define asirikuyLog(severity, ...) (asirikuyLogEnabled(severity) ? asirikuyLogMessage((severity), __VA_ARGS__) : (void)0)
+
 // Convenience macros for different log levels
-#define logEmergency(...) asirikuyLogMessage(LOG_EMERGENCY, __VA_ARGS__)
-#define logAlert(...)     asirikuyLogMessage(LOG_ALERT, __VA_ARGS__)
-#define logCritical(...)  asirikuyLogMessage(LOG_CRITICAL, __VA_ARGS__)
-#define logError(...)     asirikuyLogMessage(LOG_ERROR, __VA_ARGS__)
-#define logWarning(...)   asirikuyLogMessage(LOG_WARNING, __VA_ARGS__)
-#define logNotice(...)    asirikuyLogMessage(LOG_NOTICE, __VA_ARGS__)
-#define logInfo(...)      asirikuyLogMessage(LOG_INFO, __VA_ARGS__)
-#define logDebug(...)     asirikuyLogMessage(LOG_DEBUG, __VA_ARGS__)
+#define logEmergency(...) asirikuyLog(LOG_EMERGENCY, __VA_ARGS__)
+#define logAlert(...)     asirikuyLog(LOG_ALERT, __VA_ARGS__)
+#define logCritical(...)  asirikuyLog(LOG_CRITICAL, __VA_ARGS__)
+#define logError(...)     asirikuyLog(LOG_ERROR, __VA_ARGS__)
+#define logWarning(...)   asirikuyLog(LOG_WARNING, __VA_ARGS__)
+#define logNotice(...)    asirikuyLog(LOG_NOTICE, __VA_ARGS__)
+#define logInfo(...)      asirikuyLog(LOG_INFO, __VA_ARGS__)
+#define logDebug(...)     asirikuyLog(LOG_DEBUG, __VA_ARGS__)
 
 #ifdef __cplusplus
 } /* extern "C" */
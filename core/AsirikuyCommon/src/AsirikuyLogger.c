@@ -10,24 +10,90 @@
 #include <stdlib.h>
 #include "AsirikuyLogger.h"
 #include "AsirikuyDefines.h"
-#include "CriticalSection.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
 #include <time.h>
-#include <sys/time.h>
-#include <unistd.h>
 #include <errno.h>
 
+#if defined _WIN32 || defined _WIN64
+  #include <windows.h>
+  #include <process.h>
+#elif defined __linux__ || defined __APPLE__
+  #include <sys/time.h>
+  #include <unistd.h>
+  #include <pthread.h>
+#else
+  #error "Unsupported operating system"
+#endif
+
 // Maximum number of log files (support multiple loggers)
 #define MAX_LOG_FILES 4
 
+// Messages are formatted by the logging thread into its own ring of lines and written
+// to the files by a background writer thread
+#define LOG_LINE_CHARS  1124
+#define LOG_RING_LINES  64
+
+// Statically initialized, so the logger works before anything else is set up
+#if defined _WIN32 || defined _WIN64
+  static SRWLOCK            gLoggerLock     = SRWLOCK_INIT;
+  static CONDITION_VARIABLE gLogLinesQueued = CONDITION_VARIABLE_INIT;
+  static INIT_ONCE          gLoggerOnce     = INIT_ONCE_STATIC_INIT;
+  static DWORD              gRingKey        = FLS_OUT_OF_INDEXES;
+  #define lockLogger()                 AcquireSRWLockExclusive(&gLoggerLock)
+  #define unlockLogger()               ReleaseSRWLockExclusive(&gLoggerLock)
+  #define waitForLogLines()            SleepConditionVariableSRW(&gLogLinesQueued, &gLoggerLock, INFINITE, 0)
+  #define signalLogLines()             WakeConditionVariable(&gLogLinesQueued)
+  #define loadAcquire(pValue)          InterlockedCompareExchange((LONG volatile*)(pValue), 0, 0)
+  #define storeRelease(pValue, value)  InterlockedExchange((LONG volatile*)(pValue), (LONG)(value))
+  #define fullBarrier()                MemoryBarrier()
+  #define callLoggerOnce(function)     InitOnceExecuteOnce(&gLoggerOnce, function, NULL, NULL)
+  #define getOwnLogRing()              ((LogRing*)FlsGetValue(gRingKey))
+  #define setOwnLogRing(pRing)         (FlsSetValue(gRingKey, (pRing)) != 0)
+#elif defined __linux__ || defined __APPLE__
+  static pthread_mutex_t gLoggerLock     = PTHREAD_MUTEX_INITIALIZER;
+  static pthread_cond_t  gLogLinesQueued = PTHREAD_COND_INITIALIZER;
+  static pthread_once_t  gLoggerOnce     = PTHREAD_ONCE_INIT;
+  static pthread_key_t   gRingKey;
+  #define lockLogger()                 pthread_mutex_lock(&gLoggerLock)
+  #define unlockLogger()               pthread_mutex_unlock(&gLoggerLock)
+  #define waitForLogLines()            pthread_cond_wait(&gLogLinesQueued, &gLoggerLock)
+  #define signalLogLines()             pthread_cond_signal(&gLogLinesQueued)
+  #define loadAcquire(pValue)          __atomic_load_n((pValue), __ATOMIC_ACQUIRE)
+  #define storeRelease(pValue, value)  __atomic_store_n((pValue), (value), __ATOMIC_RELEASE)
+  #define fullBarrier()                __atomic_thread_fence(__ATOMIC_SEQ_CST)
+  #define callLoggerOnce(function)     pthread_once(&gLoggerOnce, function)
+  #define getOwnLogRing()              ((LogRing*)pthread_getspecific(gRingKey))
+  #define setOwnLogRing(pRing)         (pthread_setspecific(gRingKey, (pRing)) == 0)
+#endif
+
+// Single producer (the owning thread), single consumer (whoever drains under the logger lock).
+// One line is left free, so head == tail means empty.
+typedef struct log_ring_t
+{
+  int                head;      // Next line to write out, advanced by the consumer
+  int                tail;      // Next free line, advanced by the owning thread
+  int                isClosed;  // The owning thread ended, the ring is freed once drained
+  time_t             timestampSecond;
+  char               timestamp[32];
+  struct log_ring_t* pNext;
+  int                severities[LOG_RING_LINES];
+  char               lines[LOG_RING_LINES][LOG_LINE_CHARS];
+} LogRing;
+
 // Logger state
 static FILE* gLogFiles[MAX_LOG_FILES] = {NULL, NULL, NULL, NULL};
 static char gLogFilePaths[MAX_LOG_FILES][MAX_FILE_PATH_CHARS] = {{0}}; // Track file paths to prevent duplicates
-static int gSeverityLevel = LOG_INFO; // Default to Info level
+int asirikuyLogSeverityLevel = LOG_INFO; // Default to Info level, read without the lock
 static BOOL gInitialized = FALSE;
 
+// Protected by the logger lock, with the files
+static LogRing* gRings = NULL;
+static BOOL     gWriterRunning = FALSE;
+// Set by the writer before it waits for lines, read by the logging threads without the lock
+static int      gWriterWaiting = FALSE;
+
 // Get severity level label
 static const char* getSeverityLabel(int severity)
 {
@@ -97,6 +163,287 @@ static void ensureDirectoryExists(const char* filePath)
   }
 }
 
+// Writes one formatted line, the caller holds the logger lock
+static void writeLogLine(int severity, const char* logLine)
+{
+  int i;
+
+  // Write to stderr (always, for critical messages)
+  if(severity <= LOG_ERROR)
+  {
+    fprintf(stderr, "%s", logLine);
+  }
+
+  for(i = 0; i < MAX_LOG_FILES; i++)
+  {
+    if(gLogFiles[i] != NULL && gLogFiles[i] != stderr)
+    {
+      fprintf(gLogFiles[i], "%s", logLine);
+    }
+  }
+}
+
+// Writes the lines queued so far, the caller holds the logger lock
+static int drainLogRings()
+{
+  LogRing** ppRing = &gRings;
+  LogRing*  pRing;
+  int head, tail;
+  int i, isClosed, numLines = 0;
+
+  while((pRing = *ppRing) != NULL)
+  {
+    // Read before the tail: once the thread ended its last line is in the ring
+    isClosed = loadAcquire(&pRing->isClosed);
+    head = pRing->head;
+    tail = loadAcquire(&pRing->tail);
+
+    for(; head != tail; head = (head + 1) % LOG_RING_LINES)
+    {
+      writeLogLine(pRing->severities[head], pRing->lines[head]);
+      numLines++;
+    }
+    storeRelease(&pRing->head, head);
+
+    if(isClosed)
+    {
+      *ppRing = pRing->pNext;
+      free(pRing);
+      continue;
+    }
+    ppRing = &pRing->pNext;
+  }
+
+  // The writer is off the logging threads' path, so each batch reaches the files right away
+  if(numLines > 0)
+  {
+    for(i = 0; i < MAX_LOG_FILES; i++)
+    {
+      if(gLogFiles[i] != NULL)
+      {
+        fflush(gLogFiles[i]);
+      }
+    }
+  }
+
+  return numLines;
+}
+
+// TRUE if a thread queued lines that are not written yet, the caller holds the logger lock
+static BOOL hasQueuedLogLines()
+{
+  LogRing* pRing;
+
+  for(pRing = gRings; pRing != NULL; pRing = pRing->pNext)
+  {
+    if(pRing->head != loadAcquire(&pRing->tail))
+    {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+// Sleeps until a logging thread queues a line
+static void writeLogLines()
+{
+  lockLogger();
+  for(;;)
+  {
+    if(drainLogRings() > 0)
+    {
+      // Let asirikuyLoggerInit and asirikuyLoggerFlush in between two batches
+      unlockLogger();
+      lockLogger();
+      continue;
+    }
+
+    // A logging thread reads gWriterWaiting after queueing its line, so either it wakes the writer or the check below sees the line
+    storeRelease(&gWriterWaiting, TRUE);
+    fullBarrier();
+    if(!hasQueuedLogLines())
+    {
+      waitForLogLines();
+    }
+    storeRelease(&gWriterWaiting, FALSE);
+  }
+}
+
+#if defined _WIN32 || defined _WIN64
+static unsigned __stdcall logWriterThread(void* pUnused)
+{
+  writeLogLines();
+  return 0;
+}
+
+static BOOL startLogWriter()
+{
+  HANDLE writer = (HANDLE)_beginthreadex(NULL, 0, logWriterThread, NULL, 0, NULL);
+
+  if(writer == 0)
+  {
+    return FALSE;
+  }
+  CloseHandle(writer);
+  return TRUE;
+}
+#else
+static void* logWriterThread(void* pUnused)
+{
+  writeLogLines();
+  return NULL;
+}
+
+static BOOL startLogWriter()
+{
+  pthread_t writer;
+  pthread_attr_t attributes;
+  BOOL isStarted;
+
+  pthread_attr_init(&attributes);
+  pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+  isStarted = pthread_create(&writer, &attributes, logWriterThread, NULL) == 0;
+  pthread_attr_destroy(&attributes);
+  return isStarted;
+}
+#endif
+
+// Lines queued without a writer thread (it could not be started) are written by the logging thread
+static void ensureLogWriter()
+{
+  if(loadAcquire(&gWriterRunning))
+  {
+    return;
+  }
+
+  lockLogger();
+  if(!gWriterRunning)
+  {
+    storeRelease(&gWriterRunning, startLogWriter());
+  }
+  if(!gWriterRunning)
+  {
+    drainLogRings();
+  }
+  unlockLogger();
+}
+
+#if defined _WIN32 || defined _WIN64
+static VOID NTAPI closeLogRing(PVOID pRing)
+{
+  if(pRing != NULL)
+  {
+    storeRelease(&((LogRing*)pRing)->isClosed, TRUE);
+  }
+}
+
+static BOOL CALLBACK initLoggerOnce(PINIT_ONCE pOnce, PVOID pParameter, PVOID* ppContext)
+{
+  gRingKey = FlsAlloc(closeLogRing);
+  atexit(asirikuyLoggerFlush);
+  return TRUE;
+}
+#else
+static void closeLogRing(void* pRing)
+{
+  storeRelease(&((LogRing*)pRing)->isClosed, TRUE);
+}
+
+// Lines queued before a fork are written once, by the parent
+static void prepareLoggerFork()
+{
+  lockLogger();
+  drainLogRings();
+}
+
+static void resumeLoggerParent()
+{
+  unlockLogger();
+}
+
+// Only the forking thread exists in the child, the other rings are dropped and the writer is started again when needed
+static void resumeLoggerChild()
+{
+  LogRing* pOwnRing = getOwnLogRing();
+  LogRing* pRing;
+
+  for(pRing = gRings; pRing != NULL; pRing = pRing->pNext)
+  {
+    pRing->head = pRing->tail;
+    if(pRing != pOwnRing)
+    {
+      pRing->isClosed = TRUE;
+    }
+  }
+
+  // The parent's writer may have been waiting on the condition, it does not exist here
+  pthread_cond_init(&gLogLinesQueued, NULL);
+  gWriterWaiting = FALSE;
+  gWriterRunning = FALSE;
+  unlockLogger();
+}
+
+static void initLoggerOnce()
+{
+  pthread_key_create(&gRingKey, closeLogRing);
+  pthread_atfork(prepareLoggerFork, resumeLoggerParent, resumeLoggerChild);
+  atexit(asirikuyLoggerFlush);
+}
+#endif
+
+// The calling thread's ring, NULL if it could not be allocated
+static LogRing* getLogRing()
+{
+  LogRing* pRing;
+
+  callLoggerOnce(initLoggerOnce);
+  pRing = getOwnLogRing();
+  if(pRing != NULL)
+  {
+    return pRing;
+  }
+
+  pRing = (LogRing*)calloc(1, sizeof(LogRing));
+  if(pRing == NULL || !setOwnLogRing(pRing))
+  {
+    free(pRing);
+    return NULL;
+  }
+
+  lockLogger();
+  pRing->pNext = gRings;
+  gRings = pRing;
+  unlockLogger();
+
+  return pRing;
+}
+
+static void formatLogLine(char* logLine, size_t logLineSize, int severity, const char* timestamp, const char* format, va_list args)
+{
+  char messageBuffer[1024] = "";
+  size_t len;
+
+  // Format the message
+  vsnprintf(messageBuffer, sizeof(messageBuffer) - 1, format, args);
+  messageBuffer[sizeof(messageBuffer) - 1] = '\0';
+
+  // Format the full log line with timestamp and severity
+  snprintf(logLine, logLineSize, "[%s] [%s] %s",
+           timestamp, getSeverityLabel(severity), messageBuffer);
+
+  // Ensure newline
+  len = strlen(logLine);
+  if(len > 0 && logLine[len - 1] != '\n')
+  {
+    if(len < logLineSize - 1)
+    {
+      logLine[len] = '\n';
+      logLine[len + 1] = '\0';
+    }
+  }
+}
+
 int asirikuyLoggerInit(const char* pLogFilePath, int severityLevel)
 {
   // Create test file to verify this function is called
@@ -114,14 +461,14 @@ int asirikuyLoggerInit(const char* pLogFilePath, int severityLevel)
   fflush(stderr);
   
   // Thread-safe access to shared logger state
-  enterCriticalSection();
+  lockLogger();
   
   // Update severity level (use lowest/most restrictive severity if multiple loggers)
   // Lower numbers = more restrictive (only critical errors), higher numbers = less restrictive (everything)
   // If this is the first initialization or the new severity is more restrictive, use it
-  if(!gInitialized || severityLevel < gSeverityLevel)
+  if(!gInitialized || severityLevel < asirikuyLogSeverityLevel)
   {
-    gSeverityLevel = severityLevel;
+    storeRelease(&asirikuyLogSeverityLevel, severityLevel);
   }
 
   // Open log file if path provided
@@ -152,7 +499,7 @@ int asirikuyLoggerInit(const char* pLogFilePath, int severityLevel)
     if(existingSlot >= 0)
     {
       // File already open, no need to open again - just update severity if needed
-      leaveCriticalSection();
+      unlockLogger();
       return 0;
     }
     
@@ -221,69 +568,77 @@ int asirikuyLoggerInit(const char* pLogFilePath, int severityLevel)
 
   gInitialized = TRUE;
   
-  leaveCriticalSection();
+  unlockLogger();
   return 0;
 }
 
 void asirikuyLogMessage(int severity, const char* format, ...)
 {
-  // Thread-safe access to shared logger state
-  enterCriticalSection();
-  
-  // Check if this severity level should be logged
-  if(severity > gSeverityLevel)
-  {
-    leaveCriticalSection();
-    return; // Skip logging for levels above the threshold
-  }
-  
   va_list args;
+  LogRing* pRing;
+  time_t now;
+  int tail;
+  char logLine[LOG_LINE_CHARS] = "";
   char timestamp[32] = "";
-  char messageBuffer[1024] = "";
-  char logLine[1124] = "";
-  
-  // Get timestamp (thread-safe)
-  getTimestamp(timestamp, sizeof(timestamp));
-  
-  // Format the message
-  va_start(args, format);
-  vsnprintf(messageBuffer, sizeof(messageBuffer) - 1, format, args);
-  messageBuffer[sizeof(messageBuffer) - 1] = '\0';
-  va_end(args);
-  
-  // Format the full log line with timestamp and severity
-  snprintf(logLine, sizeof(logLine), "[%s] [%s] %s", 
-           timestamp, getSeverityLabel(severity), messageBuffer);
-  
-  // Ensure newline
-  size_t len = strlen(logLine);
-  if(len > 0 && logLine[len - 1] != '\n')
+
+  // Check if this severity level should be logged, before any other work
+  if(severity > loadAcquire(&asirikuyLogSeverityLevel))
   {
-    if(len < sizeof(logLine) - 1)
-    {
-      logLine[len] = '\n';
-      logLine[len + 1] = '\0';
-    }
+    return;
   }
-  
-  // Write to stderr (always, for critical messages)
-  if(severity <= LOG_ERROR)
+
+  pRing = getLogRing();
+  if(pRing == NULL)
   {
-    fprintf(stderr, "%s", logLine);
+    getTimestamp(timestamp, sizeof(timestamp));
+    va_start(args, format);
+    formatLogLine(logLine, sizeof(logLine), severity, timestamp, format, args);
+    va_end(args);
+
+    lockLogger();
+    writeLogLine(severity, logLine);
+    unlockLogger();
+    return;
   }
-  
-  // Write to all open log files (protected by critical section)
-  // Use OS default buffering - no explicit flushes, let OS handle it
-  int i;
-  for(i = 0; i < MAX_LOG_FILES; i++)
+
+  // A full ring is written out by its own thread, no line is dropped
+  tail = pRing->tail;
+  if((tail + 1) % LOG_RING_LINES == loadAcquire(&pRing->head))
   {
-    if(gLogFiles[i] != NULL && gLogFiles[i] != stderr)
-    {
-      fprintf(gLogFiles[i], "%s", logLine);
-      // No explicit flush - rely on OS buffering for best performance
-    }
+    lockLogger();
+    drainLogRings();
+    unlockLogger();
+  }
+
+  // The timestamp only changes once a second
+  time(&now);
+  if(now != pRing->timestampSecond || pRing->timestamp[0] == '\0')
+  {
+    getTimestamp(pRing->timestamp, sizeof(pRing->timestamp));
+    pRing->timestampSecond = now;
+  }
+
+  va_start(args, format);
+  formatLogLine(pRing->lines[tail], LOG_LINE_CHARS, severity, pRing->timestamp, format, args);
+  va_end(args);
+  pRing->severities[tail] = severity;
+  storeRelease(&pRing->tail, (tail + 1) % LOG_RING_LINES);
+
+  ensureLogWriter();
+
+  // Only an idle writer needs waking, a busy one finds the line on its next batch
+  fullBarrier();
+  if(loadAcquire(&gWriterWaiting))
+  {
+    lockLogger();
+    signalLogLines();
+    unlockLogger();
   }
-  
-  leaveCriticalSection();
 }
 
+void asirikuyLoggerFlush()
+{
+  lockLogger();
+  drainLogRings();
+  unlockLogger();
+}
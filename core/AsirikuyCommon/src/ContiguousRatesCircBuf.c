@@ -3,12 +3,15 @@
  * @brief     Contains buffers for storing normalized rates data for all strategy instances.
  * @details   By storing rates data instead of copying it on every tick the framework runs much faster.
  * @details   This is different from a regular circular buffer because it needs to store arrays
- * @details   in a contiguous way to be compatible with TALib. The buffers look like this after each new bar:
- * @details   [0000111100] 1 = actual data, 0 = unused
- * @details   [0000011110] increment buffer pointer and add the new bar (no need to copy anything).
- * @details   [0000001111] reached end of buffer
- * @details   [1111000000] loop to start of buffer (must copy all data to the front of the buffer)
- * @details   [0111100000] increment buffer pointer and add the new bar as normal.
+ * @details   in a contiguous way to be compatible with TALib. Each array is a ring whose memory is mapped
+ * @details   twice in a row, so a window that runs past the end of the ring continues in the second mapping.
+ * @details   The buffers look like this after each new bar (| = start of the second mapping):
+ * @details   [0000111100|0000111100] 1 = actual data, 0 = unused
+ * @details   [0000011110|0000011110] increment buffer pointer and add the new bar (no need to copy anything).
+ * @details   [1000000111|1000000111] the window continues into the second mapping (still nothing to copy).
+ * @details   [1100000011|1100000011] once the pointer passes the first mapping it moves back by the ring size.
+ * @details   Where memory cannot be mapped twice the arrays are extended by the rates buffer extension
+ * @details   and the data is copied to the front of the buffer each time the extension is used up.
  * 
  * @author    Morgan Doel (Initial implementation)
  * @author    Daniel Fernandez (Assisted with design and code styling)
@@ -44,14 +47,34 @@
  * @copyright In no event shall Asirikuy or any contributors to the Asirikuy Framework be liable for any damages (including, without limitation, lost profits, business interruption, or lost information) rising out of 'Authorized Users' use of or inability to use the Asirikuy Framework, even if Asirikuy has been advised of the possibility of such damages. In no event will Asirikuy or any contributors to the Asirikuy Framework be liable for loss of data or for indirect, special, incidental, consequential (including lost profit), or other damages based in contract, tort or otherwise. Asirikuy and contributors to the Asirikuy Framework shall have no liability with respect to the content of the Asirikuy Framework or any part thereof, including but not limited to errors or omissions contained therein, libel, infringements of rights of publicity, privacy, trademark rights, business interruption, personal injury, loss of privacy, moral rights or the disclosure of confidential information.
  */
 
+
+#if defined __linux__ && !defined _GNU_SOURCE
+  #define _GNU_SOURCE /* memfd_create */
+#endif
+
 #include "Precompiled.h"
 #include "ContiguousRatesCircBuf.h"
 #include "TimeZoneOffsets.h"
 #include "CriticalSection.h"
 #include "AsirikuyLogger.h"
 
+#if defined __APPLE__ || defined __linux__
+  #include <sys/mman.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <pthread.h>
+#endif
+
+/* Open addressing table of rates buffers keyed by instance ID. Must be a power of 2. */
+#define RATES_BUFFER_SLOTS     512
+#define UNUSED_INSTANCE_ID     -1
+#define RELEASED_INSTANCE_ID   -2 /* Lookups probe past a released slot, allocations reuse it. */
+#define MIRROR_MAP_ATTEMPTS    8
+
 static int gExtendedBufferSize = DEFAULT_RATES_BUF_EXT;
-static RatesBuffers gRatesBuffers[MAX_INSTANCES];
+static RatesBuffers gRatesBuffers[RATES_BUFFER_SLOTS];
+/* Elements in the ring of each mirrored rates buffer, or 0 for heap arrays with an extension. */
+static int gRingSizes[RATES_BUFFER_SLOTS][MAX_RATES_BUFFERS];
 
 void setExtendedBufferSize(int size)
 {
@@ -63,17 +86,243 @@ void setExtendedBufferSize(int size)
   }
 }
 
-static void initRatesBuffer(int instanceIndex, int ratesIndex)
+#if defined _WIN32 || defined _WIN64
+
+static size_t mirrorGranularity()
+{
+  SYSTEM_INFO systemInfo;
+  GetSystemInfo(&systemInfo);
+  return systemInfo.dwAllocationGranularity;
+}
+
+static void* mapMirroredRing(size_t ringBytes)
+{
+  HANDLE mapping = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((unsigned long long)ringBytes >> 32), (DWORD)(ringBytes & 0xFFFFFFFF), NULL);
+  int    attempt;
+
+  if(mapping == NULL)
+  {
+    return NULL;
+  }
+
+  for(attempt = 0; attempt < MIRROR_MAP_ATTEMPTS; attempt++)
+  {
+    char* pAddress = (char*)VirtualAlloc(NULL, 2 * ringBytes, MEM_RESERVE, PAGE_NOACCESS);
+    char* pRing;
+
+    if(pAddress == NULL)
+    {
+      break;
+    }
+
+    /* Another thread can take the range between releasing and mapping it, so this is retried */
+    VirtualFree(pAddress, 0, MEM_RELEASE);
+    pRing = (char*)MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, ringBytes, pAddress);
+    if(pRing == NULL)
+    {
+      continue;
+    }
+    if(MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, ringBytes, pRing + ringBytes) != NULL)
+    {
+      /* The views keep the mapping alive */
+      CloseHandle(mapping);
+      return pRing;
+    }
+    UnmapViewOfFile(pRing);
+  }
+
+  CloseHandle(mapping);
+  return NULL;
+}
+
+static void unmapMirroredRing(void* pRing, size_t ringBytes)
+{
+  UnmapViewOfFile(pRing);
+  UnmapViewOfFile((char*)pRing + ringBytes);
+}
+
+#elif defined __APPLE__ || defined __linux__
+
+static size_t mirrorGranularity()
+{
+  return (size_t)sysconf(_SC_PAGESIZE);
+}
+
+static int createRingFile(size_t ringBytes)
+{
+  int fd;
+
+#if defined __linux__
+  fd = memfd_create("asirikuy_rates", MFD_CLOEXEC);
+#else
+  char name[64];
+
+  sprintf(name, "/asirikuy_rates_%d_%p", (int)getpid(), (void*)&name);
+  fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  if(fd >= 0)
+  {
+    shm_unlink(name);
+  }
+#endif
+
+  if(fd >= 0 && ftruncate(fd, (off_t)ringBytes) != 0)
+  {
+    close(fd);
+    fd = -1;
+  }
+  return fd;
+}
+
+/* Maps the ring file over both halves of the reserved range starting at pRing */
+static BOOL mapRingFile(char* pRing, int fd, size_t ringBytes)
+{
+  return mmap(pRing, ringBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED
+      && mmap(pRing + ringBytes, ringBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+}
+
+static void* mapMirroredRing(size_t ringBytes)
+{
+  int   fd = createRingFile(ringBytes);
+  char* pRing;
+
+  if(fd < 0)
+  {
+    return NULL;
+  }
+
+  pRing = (char*)mmap(NULL, 2 * ringBytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if(pRing != (char*)MAP_FAILED && !mapRingFile(pRing, fd, ringBytes))
+  {
+    munmap(pRing, 2 * ringBytes);
+    pRing = (char*)MAP_FAILED;
+  }
+  close(fd);
+
+  return pRing == (char*)MAP_FAILED ? NULL : pRing;
+}
+
+static void unmapMirroredRing(void* pRing, size_t ringBytes)
+{
+  munmap(pRing, 2 * ringBytes);
+}
+
+static void remapRingInChild(char* pRing, size_t ringBytes)
+{
+  int fd = createRingFile(ringBytes);
+
+  if(fd < 0 || pwrite(fd, pRing, ringBytes, 0) != (ssize_t)ringBytes || !mapRingFile(pRing, fd, ringBytes))
+  {
+    logCritical("remapRingInChild() failed. The rates buffer at %p stays shared with the parent process.", (void*)pRing);
+  }
+  if(fd >= 0)
+  {
+    close(fd);
+  }
+}
+
+/* The ring pages are shared mappings, a forked child copies them so it cannot write into the parent's rates. */
+static void remapRingsInChild()
+{
+  int instanceIndex, ratesIndex;
+
+  for(instanceIndex = 0; instanceIndex < RATES_BUFFER_SLOTS; instanceIndex++)
+  {
+    for(ratesIndex = 0; ratesIndex < MAX_RATES_BUFFERS; ratesIndex++)
+    {
+      Rates* pRates   = &gRatesBuffers[instanceIndex].rates[ratesIndex];
+      int    ringSize = gRingSizes[instanceIndex][ratesIndex];
+      int    offset   = gRatesBuffers[instanceIndex].bufferOffsets[ratesIndex];
+
+      if(ringSize == 0)
+      {
+        continue;
+      }
+
+      remapRingInChild((char*)(pRates->time - offset), ringSize * sizeof(time_t));
+      remapRingInChild((char*)(pRates->open - offset), ringSize * sizeof(double));
+      remapRingInChild((char*)(pRates->high - offset), ringSize * sizeof(double));
+      remapRingInChild((char*)(pRates->low - offset), ringSize * sizeof(double));
+      remapRingInChild((char*)(pRates->close - offset), ringSize * sizeof(double));
+      remapRingInChild((char*)(pRates->volume - offset), ringSize * sizeof(double));
+    }
+  }
+}
+
+#else
+  #error "Unsupported operating system"
+#endif
+
+/* The smallest ring that holds the window and whose arrays are all whole mapping granules */
+static int ringSizeFor(int arraySize)
+{
+  size_t smallestElement = sizeof(time_t) < sizeof(double) ? sizeof(time_t) : sizeof(double);
+  int    granuleElements = (int)(mirrorGranularity() / smallestElement);
+
+  return ((arraySize + granuleElements - 1) / granuleElements) * granuleElements;
+}
+
+static void unmapRates(Rates* pRates, int ringSize, int offset)
+{
+  unmapMirroredRing(pRates->time - offset, ringSize * sizeof(time_t));
+  unmapMirroredRing(pRates->open - offset, ringSize * sizeof(double));
+  unmapMirroredRing(pRates->high - offset, ringSize * sizeof(double));
+  unmapMirroredRing(pRates->low - offset, ringSize * sizeof(double));
+  unmapMirroredRing(pRates->close - offset, ringSize * sizeof(double));
+  unmapMirroredRing(pRates->volume - offset, ringSize * sizeof(double));
+}
+
+/* Maps every array of the rates as a mirrored ring. Returns the ring size, or 0 if the pages cannot be mapped twice. */
+static int mapRates(Rates* pRates)
+{
+  int ringSize = ringSizeFor(pRates->info.arraySize);
+
+#if defined __APPLE__ || defined __linux__
+  static BOOL isForkHandlerRegistered = FALSE;
+
+  /* Called inside the critical section */
+  if(!isForkHandlerRegistered)
+  {
+    isForkHandlerRegistered = (pthread_atfork(NULL, NULL, remapRingsInChild) == 0);
+    if(!isForkHandlerRegistered)
+    {
+      return 0;
+    }
+  }
+#endif
+
+  pRates->time   = (time_t*)mapMirroredRing(ringSize * sizeof(time_t));
+  pRates->open   = (double*)mapMirroredRing(ringSize * sizeof(double));
+  pRates->high   = (double*)mapMirroredRing(ringSize * sizeof(double));
+  pRates->low    = (double*)mapMirroredRing(ringSize * sizeof(double));
+  pRates->close  = (double*)mapMirroredRing(ringSize * sizeof(double));
+  pRates->volume = (double*)mapMirroredRing(ringSize * sizeof(double));
+
+  if(pRates->time && pRates->open && pRates->high && pRates->low && pRates->close && pRates->volume)
+  {
+    return ringSize;
+  }
+
+  if(pRates->time)   unmapMirroredRing(pRates->time, ringSize * sizeof(time_t));
+  if(pRates->open)   unmapMirroredRing(pRates->open, ringSize * sizeof(double));
+  if(pRates->high)   unmapMirroredRing(pRates->high, ringSize * sizeof(double));
+  if(pRates->low)    unmapMirroredRing(pRates->low, ringSize * sizeof(double));
+  if(pRates->close)  unmapMirroredRing(pRates->close, ringSize * sizeof(double));
+  if(pRates->volume) unmapMirroredRing(pRates->volume, ringSize * sizeof(double));
+  return 0;
+}
+
+static void initRatesBuffer(int instanceIndex, int instanceId)
 {
   int i;
 
-  gRatesBuffers[instanceIndex].instanceId = -1;
+  gRatesBuffers[instanceIndex].instanceId = instanceId;
 
   for(i = 0; i < MAX_RATES_BUFFERS; i++)
   {
     Rates* rates = &gRatesBuffers[instanceIndex].rates[i];
 
     gRatesBuffers[instanceIndex].bufferOffsets[i] = 0;
+    gRingSizes[instanceIndex][i] = 0;
     rates->info.isEnabled     = FALSE;
     rates->info.isBufferFull  = FALSE;
     rates->info.timeframe     = 0;
@@ -88,6 +337,54 @@ static void initRatesBuffer(int instanceIndex, int ratesIndex)
   }
 }
 
+static unsigned int firstRatesSlot(int instanceId)
+{
+  /* Fibonacci hashing spreads consecutive instance IDs over the table */
+  return ((unsigned int)instanceId * 2654435761u) & (RATES_BUFFER_SLOTS - 1);
+}
+
+static unsigned int nextRatesSlot(unsigned int slot)
+{
+  return (slot + 1) & (RATES_BUFFER_SLOTS - 1);
+}
+
+static int findInstanceIndex(int instanceId)
+{
+  unsigned int slot = firstRatesSlot(instanceId);
+  int          probes;
+
+  for(probes = 0; probes < RATES_BUFFER_SLOTS; probes++, slot = nextRatesSlot(slot))
+  {
+    if(gRatesBuffers[slot].instanceId == instanceId)
+    {
+      return (int)slot;
+    }
+    if(gRatesBuffers[slot].instanceId == UNUSED_INSTANCE_ID)
+    {
+      break;
+    }
+  }
+
+  return -1;
+}
+
+/* Returns the slot an instance that is not in the table yet should take, or -1 if the table is full. */
+static int findFreeInstanceIndex(int instanceId)
+{
+  unsigned int slot = firstRatesSlot(instanceId);
+  int          probes;
+
+  for(probes = 0; probes < RATES_BUFFER_SLOTS; probes++, slot = nextRatesSlot(slot))
+  {
+    if(gRatesBuffers[slot].instanceId == UNUSED_INSTANCE_ID || gRatesBuffers[slot].instanceId == RELEASED_INSTANCE_ID)
+    {
+      return (int)slot;
+    }
+  }
+
+  return -1;
+}
+
 static void resetRatesOffset(int instanceIndex, int ratesIndex)
 {
   Rates* pRates = &gRatesBuffers[instanceIndex].rates[ratesIndex];
@@ -158,29 +455,27 @@ AsirikuyReturnCode allocateRates(RatesBuffers** ppRatesBuffer, int instanceId, R
 {
   int instanceIndex, ratesIndex, ratesValueIndex;
 
-  for(instanceIndex = 0; instanceIndex < MAX_INSTANCES; instanceIndex++)
+  instanceIndex = findInstanceIndex(instanceId);
+  if(instanceIndex >= 0)
   {
-    if(gRatesBuffers[instanceIndex].instanceId == instanceId)
-    {
-      /* Rates are already allocated for this instance */
-      *ppRatesBuffer = &gRatesBuffers[instanceIndex];
-      return SUCCESS;
-    }
+    /* Rates are already allocated for this instance */
+    *ppRatesBuffer = &gRatesBuffers[instanceIndex];
+    return SUCCESS;
   }
 
   enterCriticalSection();
   {
-    /* Find the first unused index */
-    for(instanceIndex = 0; instanceIndex < MAX_INSTANCES; instanceIndex++)
+    /* Another thread may have allocated them since the lookup above */
+    instanceIndex = findInstanceIndex(instanceId);
+    if(instanceIndex >= 0)
     {
-      if(gRatesBuffers[instanceIndex].instanceId == -1)
-      {
-        gRatesBuffers[instanceIndex].instanceId = instanceId;
-        break;
-      }
+      *ppRatesBuffer = &gRatesBuffers[instanceIndex];
+      leaveCriticalSection();
+      return SUCCESS;
     }
 
-    if(instanceIndex >= MAX_INSTANCES)
+    instanceIndex = findFreeInstanceIndex(instanceId);
+    if(instanceIndex < 0)
     {
       leaveCriticalSection();
       return TOO_MANY_INSTANCES;
@@ -202,12 +497,17 @@ AsirikuyReturnCode allocateRates(RatesBuffers** ppRatesBuffer, int instanceId, R
       pRates->info.point        = pRatesInfo[ratesIndex].point;
 	  pRates->info.digits       = pRatesInfo[ratesIndex].digits;
 
-      pRates->time   = (time_t*)malloc((pRates->info.arraySize + gExtendedBufferSize) * sizeof(time_t));
-      pRates->open   = (double*)malloc((pRates->info.arraySize + gExtendedBufferSize) * sizeof(double));
-      pRates->high   = (double*)malloc((pRates->info.arraySize + gExtendedBufferSize) * sizeof(double));
-      pRates->low    = (double*)malloc((pRates->info.arraySize + gExtendedBufferSize) * sizeof(double));
-      pRates->close  = (double*)malloc((pRates->info.arraySize + gExtendedBufferSize) * sizeof(double));
-      pRates->volume = (double*)malloc((pRates->info.arraySize + gExtendedBufferSize) * sizeof(double));
+      gRingSizes[instanceIndex][ratesIndex] = mapRates(pRates);
+      if(gRingSizes[instanceIndex][ratesIndex] == 0)
+      {
+        logWarning("allocateRates() Unable to map a mirrored rates buffer for instance ID %d. Using an extended buffer instead.", instanceId);
+        pRates->time   = (time_t*)malloc((pRates->info.arraySize + gExtendedBufferSize) * sizeof(time_t));
+        pRates->open   = (double*)malloc((pRates->info.arraySize + gExtendedBufferSize) * sizeof(double));
+        pRates->high   = (double*)malloc((pRates->info.arraySize + gExtendedBufferSize) * sizeof(double));
+        pRates->low    = (double*)malloc((pRates->info.arraySize + gExtendedBufferSize) * sizeof(double));
+        pRates->close  = (double*)malloc((pRates->info.arraySize + gExtendedBufferSize) * sizeof(double));
+        pRates->volume = (double*)malloc((pRates->info.arraySize + gExtendedBufferSize) * sizeof(double));
+      }
 
       for(ratesValueIndex = 0; ratesValueIndex < pRates->info.arraySize; ratesValueIndex++)
       {
@@ -220,6 +520,8 @@ AsirikuyReturnCode allocateRates(RatesBuffers** ppRatesBuffer, int instanceId, R
       }
     }
 
+    /* Published last, lookups outside the critical section only find fully allocated buffers */
+    gRatesBuffers[instanceIndex].instanceId = instanceId;
     *ppRatesBuffer = &gRatesBuffers[instanceIndex];
   }
   leaveCriticalSection();
@@ -231,6 +533,12 @@ static void resetRatesBuffer(int instanceIndex, int ratesIndex)
 {
   Rates* pRates = &gRatesBuffers[instanceIndex].rates[ratesIndex];
 
+  if(gRingSizes[instanceIndex][ratesIndex] > 0)
+  {
+    unmapRates(pRates, gRingSizes[instanceIndex][ratesIndex], gRatesBuffers[instanceIndex].bufferOffsets[ratesIndex]);
+    return;
+  }
+
   resetRatesOffset(instanceIndex, ratesIndex);
 
   if(pRates->time)
@@ -257,56 +565,59 @@ static void resetRatesBuffer(int instanceIndex, int ratesIndex)
   {
     free(pRates->volume);
   }
-
-  /* re-initialize rates buffer - sets all pointers to NULL */
-  initRatesBuffer(instanceIndex, ratesIndex);
   return;
 }
 
+/* Frees every rates buffer of the instance before re-initializing it. initRatesBuffer()
+   clears the pointers of all buffers and the instance ID, so it must come last. */
+static void resetInstanceIndex(int instanceIndex, int freedInstanceId)
+{
+  int j;
+  for(j = 0; j < MAX_RATES_BUFFERS; j++)
+  {
+    resetRatesBuffer(instanceIndex, j);
+  }
+
+  /* re-initialize rates buffers - sets all pointers to NULL and frees the slot */
+  initRatesBuffer(instanceIndex, freedInstanceId);
+}
+
 void resetInstanceBuffer(int instanceId)
 {
-  int i, j;
-  for(i = 0; i < MAX_INSTANCES; i++)
+  int instanceIndex;
+
+  enterCriticalSection();
+  instanceIndex = findInstanceIndex(instanceId);
+  if(instanceIndex >= 0)
   {
-    for(j = 0; j < MAX_RATES_BUFFERS; j++)
+    resetInstanceIndex(instanceIndex, RELEASED_INSTANCE_ID);
+
+    /* No lookup probes past a released slot that is followed by an unused one, so it is unused too */
+    while(gRatesBuffers[instanceIndex].instanceId == RELEASED_INSTANCE_ID
+      && gRatesBuffers[nextRatesSlot(instanceIndex)].instanceId == UNUSED_INSTANCE_ID)
     {
-      if(gRatesBuffers[i].instanceId == instanceId)
-      {
-        resetRatesBuffer(i, j);
-        gRatesBuffers[i].instanceId = -1;
-      }
+      gRatesBuffers[instanceIndex].instanceId = UNUSED_INSTANCE_ID;
+      instanceIndex = (instanceIndex + RATES_BUFFER_SLOTS - 1) & (RATES_BUFFER_SLOTS - 1);
     }
   }
+  leaveCriticalSection();
 }
 
 void resetAllRatesBuffers()
 {
-  int i, j;
-  for(i = 0; i < MAX_INSTANCES; i++)
+  int i;
+  for(i = 0; i < RATES_BUFFER_SLOTS; i++)
   {
-    for(j = 0; j < MAX_RATES_BUFFERS; j++)
-    {
-      resetRatesBuffer(i, j);
-      gRatesBuffers[i].instanceId = -1;
-    }
+    resetInstanceIndex(i, UNUSED_INSTANCE_ID);
   }
 }
 
-
-
 AsirikuyReturnCode incrementRatesOffset(int instanceId, int ratesIndex)
 {
-  int instanceIndex;
+  int instanceIndex = findInstanceIndex(instanceId);
+  int ringSize;
 
-  for(instanceIndex = 0; instanceIndex < MAX_INSTANCES; instanceIndex++)
-  {
-    if(gRatesBuffers[instanceIndex].instanceId == instanceId)
-    {
-      break;
-    }
-  }
-
-  if(instanceIndex >= MAX_INSTANCES)
+  if(instanceIndex < 0)
   {
     logCritical("incrementRatesOffset() failed. instanceId: %d does not have a rates buffer allocated", instanceId);
     return UNKNOWN_INSTANCE_ID;
@@ -320,7 +631,22 @@ AsirikuyReturnCode incrementRatesOffset(int instanceId, int ratesIndex)
   gRatesBuffers[instanceIndex].rates[ratesIndex].close++;
   gRatesBuffers[instanceIndex].rates[ratesIndex].volume++;
 
-  if(gRatesBuffers[instanceIndex].bufferOffsets[ratesIndex] >= gExtendedBufferSize)
+  ringSize = gRingSizes[instanceIndex][ratesIndex];
+  if(ringSize > 0)
+  {
+    /* The window now starts in the second mapping, which is the same memory as the first */
+    if(gRatesBuffers[instanceIndex].bufferOffsets[ratesIndex] >= ringSize)
+    {
+      gRatesBuffers[instanceIndex].bufferOffsets[ratesIndex] -= ringSize;
+      gRatesBuffers[instanceIndex].rates[ratesIndex].time   -= ringSize;
+      gRatesBuffers[instanceIndex].rates[ratesIndex].open   -= ringSize;
+      gRatesBuffers[instanceIndex].rates[ratesIndex].high   -= ringSize;
+      gRatesBuffers[instanceIndex].rates[ratesIndex].low    -= ringSize;
+      gRatesBuffers[instanceIndex].rates[ratesIndex].close  -= ringSize;
+      gRatesBuffers[instanceIndex].rates[ratesIndex].volume -= ringSize;
+    }
+  }
+  else if(gRatesBuffers[instanceIndex].bufferOffsets[ratesIndex] >= gExtendedBufferSize)
   {
     resetRatesOffset(instanceIndex, ratesIndex);
   }
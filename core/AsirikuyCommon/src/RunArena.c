@@ -0,0 +1,147 @@
+/**
+ * @file
+ * @brief     Run-scoped bump allocator for per-bar scratch buffers.
+ * @details   Buffers are carved from one block and released all at once by resetRunArena().
+ * @details   If a bar needs more than the block holds the extra requests are served from the
+ * @details   heap and the block is grown to the high-water mark on the next reset, so a run
+ * @details   reaches a steady state without any heap calls per bar.
+ * 
+ * @version   F4.x.x
+ * @date      2026
+ *
+ * @copyright END-USER LICENSE AGREEMENT FOR ASIRIKUY SOFTWARE. IMPORTANT PLEASE READ THE TERMS AND CONDITIONS OF THIS LICENSE AGREEMENT CAREFULLY BEFORE USING THIS SOFTWARE: 
+ * @copyright Asirikuy's End-User License Agreement ("EULA") is a legal agreement between you (either an individual or a single entity) and Asirikuy for the use of the Asirikuy Framework in both source and binary forms. By installing, copying, or otherwise using the Asirikuy Framework, you agree to be bound by the terms of this EULA. This license agreement represents the entire agreement concerning the program between you and Asirikuy, (referred to as "licenser"), and it supersedes any prior proposal, representation, or understanding between the parties. If you do not agree to the terms of this EULA, do not install or use the Asirikuy Framework.
+ * @copyright The Asirikuy Framework is protected by copyright laws and international copyright treaties, as well as other intellectual property laws and treaties. The Asirikuy Framework is licensed, not sold.
+ * @copyright 1. GRANT OF LICENSE.
+ * @copyright The Asirikuy Framework is licensed as follows:
+ * @copyright (a) Installation and Use.
+ * @copyright Asirikuy grants you the right to install and use copies of the Asirikuy Framework in both source and binary forms for personal and business use. You may also make modifications to the source code.
+ * @copyright (b) Backup Copies.
+ * @copyright You may make copies of the Asirikuy Framework as may be necessary for backup and archival purposes.
+ * @copyright 2. DESCRIPTION OF OTHER RIGHTS AND LIMITATIONS.
+ * @copyright (a) Maintenance of Copyright Notices.
+ * @copyright You must not remove or alter any copyright notices on any and all copies of the Asirikuy Framework.
+ * @copyright (b) Distribution.
+ * @copyright You may not distribute copies of the Asirikuy Framework in binary or source forms to third parties outside of the Asirikuy community.
+ * @copyright (c) Rental.
+ * @copyright You may not rent, lease, or lend the Asirikuy Framework.
+ * @copyright (d) Compliance with Applicable Laws.
+ * @copyright You must comply with all applicable laws regarding use of the Asirikuy Framework.
+ * @copyright 3. TERMINATION
+ * @copyright Without prejudice to any other rights, Asirikuy may terminate this EULA if you fail to comply with the terms and conditions of this EULA. In such event, you must destroy all copies of the Asirikuy Framework in your possession.
+ * @copyright 4. COPYRIGHT
+ * @copyright All title, including but not limited to copyrights, in and to the Asirikuy Framework and any copies thereof are owned by Asirikuy or its suppliers. All title and intellectual property rights in and to the content which may be accessed through use of the Asirikuy Framework is the property of the respective content owner and may be protected by applicable copyright or other intellectual property laws and treaties. This EULA grants you no rights to use such content. All rights not expressly granted are reserved by Asirikuy.
+ * @copyright 5. NO WARRANTIES
+ * @copyright Asirikuy expressly disclaims any warranty for the Asirikuy Framework. The Asirikuy Framework is provided 'As Is' without any express or implied warranty of any kind, including but not limited to any warranties of merchantability, noninfringement, or fitness of a particular purpose. Asirikuy does not warrant or assume responsibility for the accuracy or completeness of any information, text, graphics, links or other items contained within the Asirikuy Framework. Asirikuy makes no warranties respecting any harm that may be caused by the transmission of a computer virus, worm, time bomb, logic bomb, or other such computer program. Asirikuy further expressly disclaims any warranty or representation to Authorized Users or to any third party.
+ * @copyright 6. LIMITATION OF LIABILITY
+ * @copyright In no event shall Asirikuy or any contributors to the Asirikuy Framework be liable for any damages (including, without limitation, lost profits, business interruption, or lost information) rising out of 'Authorized Users' use of or inability to use the Asirikuy Framework, even if Asirikuy has been advised of the possibility of such damages. In no event will Asirikuy or any contributors to the Asirikuy Framework be liable for loss of data or for indirect, special, incidental, consequential (including lost profit), or other damages based in contract, tort or otherwise. Asirikuy and contributors to the Asirikuy Framework shall have no liability with respect to the content of the Asirikuy Framework or any part thereof, including but not limited to errors or omissions contained therein, libel, infringements of rights of publicity, privacy, trademark rights, business interruption, personal injury, loss of privacy, moral rights or the disclosure of confidential information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "RunArena.h"
+
+#define RUN_ARENA_ALIGNMENT     16
+#define RUN_ARENA_ALIGN(size)   (((size) + RUN_ARENA_ALIGNMENT - 1) & ~(size_t)(RUN_ARENA_ALIGNMENT - 1))
+#define OVERFLOW_HEADER_SIZE    RUN_ARENA_ALIGN(sizeof(void*))
+
+int initRunArena(RunArena* pArena, size_t capacity)
+{
+  memset(pArena, 0, sizeof(RunArena));
+
+  if(capacity == 0)
+  {
+    return 1;
+  }
+
+  pArena->base = (char*)malloc(RUN_ARENA_ALIGN(capacity));
+  pArena->heapCalls++;
+  if(pArena->base == NULL)
+  {
+    return 0;
+  }
+
+  pArena->capacity = RUN_ARENA_ALIGN(capacity);
+  return 1;
+}
+
+void* runArenaAlloc(RunArena* pArena, size_t size)
+{
+  void** pBlock;
+
+  size = RUN_ARENA_ALIGN(size);
+  pArena->requested += size;
+  if(pArena->requested > pArena->highWater)
+  {
+    pArena->highWater = pArena->requested;
+  }
+
+  if(pArena->used + size <= pArena->capacity)
+  {
+    void* pMemory = pArena->base + pArena->used;
+    pArena->used += size;
+    return pMemory;
+  }
+
+  /* Out of room: serve this bar from the heap, the main block grows on the next reset */
+  pBlock = (void**)malloc(OVERFLOW_HEADER_SIZE + size);
+  pArena->heapCalls++;
+  if(pBlock == NULL)
+  {
+    return NULL;
+  }
+
+  *pBlock = pArena->overflow;
+  pArena->overflow = pBlock;
+  return (char*)pBlock + OVERFLOW_HEADER_SIZE;
+}
+
+void* runArenaCalloc(RunArena* pArena, size_t count, size_t size)
+{
+  void* pMemory = runArenaAlloc(pArena, count * size);
+
+  if(pMemory != NULL)
+  {
+    memset(pMemory, 0, count * size);
+  }
+
+  return pMemory;
+}
+
+static void freeOverflowBlocks(RunArena* pArena)
+{
+  while(pArena->overflow != NULL)
+  {
+    void** pBlock = (void**)pArena->overflow;
+    pArena->overflow = *pBlock;
+    free(pBlock);
+    pArena->heapCalls++;
+  }
+}
+
+void resetRunArena(RunArena* pArena)
+{
+  if(pArena->overflow != NULL)
+  {
+    freeOverflowBlocks(pArena);
+
+    free(pArena->base);
+    pArena->base = (char*)malloc(pArena->highWater);
+    pArena->heapCalls += 2;
+    pArena->capacity = (pArena->base != NULL) ? pArena->highWater : 0;
+  }
+
+  pArena->used      = 0;
+  pArena->requested = 0;
+}
+
+void freeRunArena(RunArena* pArena)
+{
+  freeOverflowBlocks(pArena);
+  free(pArena->base);
+  pArena->base      = NULL;
+  pArena->capacity  = 0;
+  pArena->used      = 0;
+  pArena->requested = 0;
+}
@@ -84,7 +84,7 @@ static AsirikuyReturnCode checkTZValidity(time_t brokerTime, time_t referenceTim
     logError("checkTZValidity() adjusted broker time = %s", safe_timeString(timeString, adjustedBrokerTime));
     return BROKER_TZ_MISMATCH;
   }
-  else if(1)  // Always log debug messages (replaced Pantheios check)
+  else if(asirikuyLogEnabled(LOG_DEBUG))
   {
     logDebug("checkTZValidity() Local time(UTC)      = %s", safe_timeString(timeString, localTimeUTC));
     logDebug("checkTZValidity() broker time          = %s", safe_timeString(timeString, brokerTime));
@@ -249,7 +249,7 @@ time_t getAdjustedBrokerTime(time_t brokerTime, TZOffsets* pTZOffsets)
     return brokerTime;
   }
 
-  if(1)  // Always log debug messages (replaced Pantheios check)
+  if(asirikuyLogEnabled(LOG_DEBUG))
   {
     char sourceTime[MAX_TIME_STRING_SIZE] = "";
     char destTime[MAX_TIME_STRING_SIZE] = "";
@@ -296,7 +296,7 @@ time_t getAdjustedLocalTime(time_t localTimeUTC, TZOffsets* pTZOffsets)
     return localTimeUTC;
   }
 
-  if(1)  // Always log debug messages (replaced Pantheios check)
+  if(asirikuyLogEnabled(LOG_DEBUG))
   {
     char sourceTime[MAX_TIME_STRING_SIZE] = "";
     char destTime[MAX_TIME_STRING_SIZE] = "";
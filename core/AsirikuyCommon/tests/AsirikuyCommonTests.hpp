@@ -34,7 +34,72 @@
  * @copyright In no event shall Asirikuy or any contributors to the Asirikuy Framework be liable for any damages (including, without limitation, lost profits, business interruption, or lost information) rising out of 'Authorized Users' use of or inability to use the Asirikuy Framework, even if Asirikuy has been advised of the possibility of such damages. In no event will Asirikuy or any contributors to the Asirikuy Framework be liable for loss of data or for indirect, special, incidental, consequential (including lost profit), or other damages based in contract, tort or otherwise. Asirikuy and contributors to the Asirikuy Framework shall have no liability with respect to the content of the Asirikuy Framework or any part thereof, including but not limited to errors or omissions contained therein, libel, infringements of rights of publicity, privacy, trademark rights, business interruption, personal injury, loss of privacy, moral rights or the disclosure of confidential information.
  */
 
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
 #include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "AsirikuyDefines.h"
+#include "AsirikuyLogger.h"
+#include "RunArena.h"
+#include "CriticalSection.h"
+#include "ContiguousRatesCircBuf.h"
+
+namespace
+{
+  /* Mimics one tester run: per bar the tester's strategy results and the framework's order info */
+  int heapCallsForBars(int numBars)
+  {
+    RunArena barArena;
+    RunArena orderInfoArena;
+    int heapCalls;
+
+    initRunArena(&barArena, 10 * sizeof(StrategyResults));
+    initRunArena(&orderInfoArena, 0);
+
+    for(int bar = 0; bar < numBars; bar++)
+    {
+      resetRunArena(&barArena);
+      StrategyResults* pResults = (StrategyResults*)runArenaCalloc(&barArena, 10, sizeof(StrategyResults));
+      pResults[9].lots = bar;
+
+      resetRunArena(&orderInfoArena);
+      OrderInfo* pOrders = (OrderInfo*)runArenaAlloc(&orderInfoArena, 200 * sizeof(OrderInfo));
+      pOrders[199].ticket = bar;
+    }
+
+    heapCalls = barArena.heapCalls + orderInfoArena.heapCalls;
+    freeRunArena(&barArena);
+    freeRunArena(&orderInfoArena);
+    return heapCalls;
+  }
+
+  const int LOGGER_TEST_LINES = 500;
+
+  /* More lines than a thread's ring holds, half of them below the logger's level */
+  void logTestLines(int thread)
+  {
+    for(int line = 0; line < LOGGER_TEST_LINES; line++)
+    {
+      logNotice("logger test thread %d line %d", thread, line);
+      logDebug("logger test thread %d debug line %d", thread, line);
+    }
+  }
+
+  const int RATES_TEST_INSTANCE_ID = 800000;
+
+  void enableRatesBuffer(RatesInfo* pRatesInfo, int arraySize)
+  {
+    memset(pRatesInfo, 0, MAX_RATES_BUFFERS * sizeof(RatesInfo));
+    pRatesInfo[0].isEnabled = TRUE;
+    pRatesInfo[0].timeframe = 60;
+    pRatesInfo[0].arraySize = arraySize;
+    pRatesInfo[0].point     = 0.00001;
+    pRatesInfo[0].digits    = 5;
+  }
+}
 
 BOOST_AUTO_TEST_SUITE(Asirikuy_Common)
 
@@ -43,4 +108,144 @@ BOOST_AUTO_TEST_CASE(placeholder)
   BOOST_CHECK(true);
 }
 
+BOOST_AUTO_TEST_CASE(runArena_heap_calls_do_not_grow_with_bars)
+{
+  int shortRun = heapCallsForBars(100);
+
+  BOOST_CHECK_EQUAL(heapCallsForBars(10000), shortRun);
+  BOOST_CHECK_EQUAL(heapCallsForBars(100000), shortRun);
+}
+
+BOOST_AUTO_TEST_CASE(runArena_grows_to_high_water_mark)
+{
+  RunArena arena;
+
+  BOOST_REQUIRE(initRunArena(&arena, 64));
+
+  char* pFirst  = (char*)runArenaAlloc(&arena, 40);
+  char* pSecond = (char*)runArenaAlloc(&arena, 40);
+  BOOST_CHECK(((size_t)pFirst % 16) == 0);
+  BOOST_CHECK(((size_t)pSecond % 16) == 0);
+  BOOST_CHECK(arena.overflow != NULL);
+  memset(pSecond, 1, 40);
+
+  resetRunArena(&arena);
+  BOOST_CHECK(arena.overflow == NULL);
+  BOOST_CHECK_EQUAL(arena.capacity, 96u);
+
+  int heapCalls = arena.heapCalls;
+  double* pZeroed = (double*)runArenaCalloc(&arena, 5, sizeof(double));
+  runArenaAlloc(&arena, 40);
+  for(int k = 0; k < 5; k++)
+  {
+    BOOST_CHECK_EQUAL(pZeroed[k], 0);
+  }
+  BOOST_CHECK_EQUAL(arena.heapCalls, heapCalls);
+
+  freeRunArena(&arena);
+}
+
+BOOST_AUTO_TEST_CASE(logger_writes_the_lines_of_every_thread_in_order)
+{
+  const char* pLogFile = "AsirikuyCommonLoggerTest.log";
+  const int numThreads = 4;
+  std::vector<int> nextLine(numThreads, 0);
+  boost::thread_group threads;
+  char text[1200];
+  FILE* pFile;
+
+  remove(pLogFile);
+  BOOST_REQUIRE_EQUAL(asirikuyLoggerInit(pLogFile, LOG_INFO), 0);
+
+  for(int thread = 0; thread < numThreads; thread++)
+  {
+    threads.add_thread(new boost::thread(logTestLines, thread));
+  }
+  threads.join_all();
+  asirikuyLoggerFlush();
+
+  pFile = fopen(pLogFile, "r");
+  BOOST_REQUIRE(pFile != NULL);
+  while(fgets(text, sizeof(text), pFile) != NULL)
+  {
+    int year, month, day, hour, minute, second, thread, line;
+
+    BOOST_CHECK(strstr(text, "debug line") == NULL);
+    if(sscanf(text, "[%d-%d-%d %d:%d:%d] [NOTICE] logger test thread %d line %d", &year, &month, &day, &hour, &minute, &second, &thread, &line) == 8)
+    {
+      BOOST_REQUIRE(thread >= 0 && thread < numThreads);
+      BOOST_CHECK_EQUAL(line, nextLine[thread]);
+      nextLine[thread] = line + 1;
+    }
+  }
+  fclose(pFile);
+  remove(pLogFile);
+
+  for(int thread = 0; thread < numThreads; thread++)
+  {
+    BOOST_CHECK_EQUAL(nextLine[thread], LOGGER_TEST_LINES);
+  }
+}
+
+
+BOOST_AUTO_TEST_CASE(rates_buffer_windows_stay_contiguous_across_many_bars)
+{
+  const int windowSize = 700;
+  const int numBars    = 5000;
+  RatesInfo ratesInfo[MAX_RATES_BUFFERS];
+  RatesBuffers* pBuffers = NULL;
+
+  initCriticalSection();
+  resetAllRatesBuffers();
+  enableRatesBuffer(ratesInfo, windowSize);
+  BOOST_REQUIRE_EQUAL(allocateRates(&pBuffers, RATES_TEST_INSTANCE_ID, ratesInfo), SUCCESS);
+
+  for(int bar = 0; bar < numBars; bar++)
+  {
+    Rates* pRates = &pBuffers->rates[0];
+
+    BOOST_REQUIRE_EQUAL(incrementRatesOffset(RATES_TEST_INSTANCE_ID, 0), SUCCESS);
+    pRates->time[windowSize - 1]  = bar;
+    pRates->close[windowSize - 1] = 1.0 + bar;
+
+    if(bar >= windowSize && bar % 97 == 0)
+    {
+      for(int k = 0; k < windowSize; k++)
+      {
+        BOOST_REQUIRE_EQUAL(pRates->time[k], bar - windowSize + 1 + k);
+        BOOST_REQUIRE_EQUAL(pRates->close[k], 1.0 + bar - windowSize + 1 + k);
+      }
+    }
+  }
+
+  resetInstanceBuffer(RATES_TEST_INSTANCE_ID);
+}
+
+BOOST_AUTO_TEST_CASE(rates_buffers_are_reused_after_release)
+{
+  RatesInfo ratesInfo[MAX_RATES_BUFFERS];
+
+  initCriticalSection();
+  resetAllRatesBuffers();
+  enableRatesBuffer(ratesInfo, 50);
+
+  for(int i = 0; i < 20 * MAX_INSTANCES; i++)
+  {
+    const int instanceId = RATES_TEST_INSTANCE_ID + i % (3 * MAX_INSTANCES);
+    RatesBuffers* pBuffers = NULL;
+
+    BOOST_REQUIRE_EQUAL(allocateRates(&pBuffers, instanceId, ratesInfo), SUCCESS);
+    BOOST_REQUIRE_EQUAL(pBuffers->instanceId, instanceId);
+    BOOST_REQUIRE_EQUAL(incrementRatesOffset(instanceId, 0), SUCCESS);
+    if(i % 2 == 0)
+    {
+      resetInstanceBuffer(instanceId);
+    }
+  }
+
+  BOOST_CHECK_EQUAL(incrementRatesOffset(RATES_TEST_INSTANCE_ID, 0), UNKNOWN_INSTANCE_ID);
+  BOOST_CHECK_EQUAL(incrementRatesOffset(RATES_TEST_INSTANCE_ID + 1, 0), SUCCESS);
+  resetAllRatesBuffers();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -694,6 +694,64 @@ AsirikuyReturnCode openSingleSellLimitEasy(double entryPrice, double takeProfit,
   */
   double iAtr(int ratesArrayIndex, int period, int shift);
 
+  /**
+  * Returns how often the indicator calls of the running instance were answered from the
+  * indicator cache (iAtr, iMA, iMACD, iMACDAll, iBBands, iBBandStop, iStdev and iCCI results
+  * are reused until the open bar of their rates array changes) and how often they were computed.
+  *
+  * @param long long* pHits
+  *   receives the number of calls answered from the cache
+  *
+  * @param long long* pMisses
+  *   receives the number of calls that were computed
+  * 
+  */
+  void getIndicatorCacheCounters(long long* pHits, long long* pMisses);
+
+  /**
+  * Logs the hits and misses of the indicator caches of the instances run by the calling
+  * thread and frees them. Called at the end of a test, on the thread that ran it.
+  * 
+  */
+  static void releaseIndicatorCaches();
+
+  /**
+  * Frees the Bollinger Band stop states and EMA histories kept for an instance. Called when the instance
+  * will not run again, e.g. when an optimizer worker is done with its instance ID.
+  * 
+  * @param int instanceId
+  *   the instance whose states are freed
+  * 
+  */
+  static void releaseIndicatorStates(int instanceId);
+
+  /**
+  * Frees the indicator states of the instances run by the calling thread, see
+  * releaseIndicatorStates(). Called at the end of a test, on the thread that ran it.
+  * 
+  */
+  static void releaseThreadIndicatorStates();
+
+  /**
+  * Counts the Bollinger Band stop states kept for an instance, one per rates array,
+  * period and deviation it used.
+  * 
+  * @param int instanceId
+  *   the instance whose states are counted
+  * 
+  */
+  static int countBBandStopStates(int instanceId);
+
+  /**
+  * Counts the EMA histories kept for an instance, one per rates array, indicator (iMA, iMACD)
+  * and parameters it used.
+  * 
+  * @param int instanceId
+  *   the instance whose histories are counted
+  * 
+  */
+  static int countEmaHistories(int instanceId);
+
   /**
   * This is a wrapper for the TA-lib RSI indicator that simplifies its use
   * making it similar to the MQL4 function
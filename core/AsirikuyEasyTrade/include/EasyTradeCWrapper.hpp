@@ -1111,6 +1111,30 @@ double caculateStrategyWeeklyPNLEasy(time_t currentTime);
 
 double iASIEasy(int ratesArrayIndex, int mode, int length, int smooth, double * outBull, double *outBear);
 
+void getIndicatorCacheCountersEasy(long long *pHits, long long *pMisses);
+
+/**
+* Logs the hits and misses of the indicator caches of the instances run by the calling
+* thread and frees them. Needs no initEasyTradeLibrary call.
+*/
+void releaseIndicatorCachesEasy();
+
+/**
+* Frees the indicator states (Bollinger Band stops and EMA histories) kept for an instance.
+* Needs no initEasyTradeLibrary call.
+*/
+void releaseIndicatorStatesEasy(int instanceId);
+
+/**
+* Frees the indicator states of the instances run by the calling thread.
+* Needs no initEasyTradeLibrary call.
+*/
+void releaseThreadIndicatorStatesEasy();
+
+int countBBandStopStatesEasy(int instanceId);
+
+int countEmaHistoriesEasy(int instanceId);
+
 int getOldestOpenOrderIndexEasy(int rateIndex);
 
 int getLastestOrderIndexExceptLimitAndStopOrdersEasy(int rateIndex, BOOL isClosedOnly);
@@ -40,8 +40,15 @@
 #include "Precompiled.h"
 
 #include <float.h>
+#include <limits.h>
 #include <math.h>
 #include <ta_libc.h>
+#include <map>
+#include <set>
+#include <vector>
+#include <algorithm>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
 
 #include "AsirikuyTime.h"
 #include "EasyTrade.hpp"
@@ -62,6 +69,355 @@
 #define INDICATOR_CALCULATION_ERROR -1
 #define SELECT_ALL_TRADES			      -1
 #define DAILY_RATES                 1 // TODO: iterate to find the daily rates index instead of assuming its on index 1.
+#define EMA_UNSTABLE_PERIOD         0 // TA-Lib's default, iMA and iSMI follow it
+#define MACD_EMA_UNSTABLE_PERIOD    35
+
+
+namespace
+{
+  // One incremental Bollinger Band stop per instance, rates array, period and deviation
+  struct BBandStopKey
+  {
+    int    instanceId;
+    int    ratesArrayIndex;
+    int    period;
+    double deviation;
+
+    bool operator<(const BBandStopKey& other) const
+    {
+      if(instanceId != other.instanceId) return instanceId < other.instanceId;
+      if(ratesArrayIndex != other.ratesArrayIndex) return ratesArrayIndex < other.ratesArrayIndex;
+      if(period != other.period) return period < other.period;
+      return deviation < other.deviation;
+    }
+  };
+
+  boost::mutex                           bbandStopMutex;
+  std::map<BBandStopKey, BBandStopState> bbandStopStates;
+
+  // The instances that created indicator states on a thread, released with the thread's scratch
+  boost::thread_specific_ptr<std::set<int> > stateInstances;
+
+  void addStateInstance(int instanceId)
+  {
+    if(stateInstances.get() == NULL)
+    {
+      stateInstances.reset(new std::set<int>());
+    }
+    stateInstances->insert(instanceId);
+  }
+
+  // Map nodes stay put, so the state can be used after the lock is released.
+  // Each instance only runs on one thread at a time.
+  BBandStopState* getBBandStopState(int instanceId, int ratesArrayIndex, int period, double deviation)
+  {
+    BBandStopKey key = {instanceId, ratesArrayIndex, period, deviation};
+    boost::mutex::scoped_lock lock(bbandStopMutex);
+    std::map<BBandStopKey, BBandStopState>::iterator it = bbandStopStates.find(key);
+
+    if(it == bbandStopStates.end())
+    {
+      BBandStopState state;
+      resetBBandStop(&state);
+      it = bbandStopStates.insert(std::make_pair(key, state)).first;
+      addStateInstance(instanceId);
+    }
+
+    return &it->second;
+  }
+
+  // The states of an instance are the keys from (instanceId) up to (instanceId + 1)
+  std::map<BBandStopKey, BBandStopState>::iterator firstBBandStopState(int instanceId)
+  {
+    BBandStopKey key = {instanceId, INT_MIN, INT_MIN, -DBL_MAX};
+    return bbandStopStates.lower_bound(key);
+  }
+
+  void releaseBBandStopStates(int instanceId)
+  {
+    boost::mutex::scoped_lock lock(bbandStopMutex);
+    std::map<BBandStopKey, BBandStopState>::iterator it = firstBBandStopState(instanceId);
+
+    while(it != bbandStopStates.end() && it->first.instanceId == instanceId)
+    {
+      freeBBandStop(&it->second);
+      bbandStopStates.erase(it++);
+    }
+  }
+
+  // Per bar values of the EMA based indicators, one history per instance, rates array and parameter set
+  enum
+  {
+    EMA_HISTORY_MA,
+    EMA_HISTORY_MACD
+  };
+
+  struct EmaHistoryKey
+  {
+    int fields[7];  // instanceId, ratesArrayIndex, indicator, three parameters, EMA unstable period
+
+    bool operator<(const EmaHistoryKey& other) const
+    {
+      return std::lexicographical_compare(fields, fields + 7, other.fields, other.fields + 7);
+    }
+  };
+
+  // TRUE with the values of the bar at index, FALSE without enough bars for a value, -1 on error
+  typedef int (*BarValuesFunction)(const Rates* pRates, int index, const int* params, double* pValues);
+
+  boost::mutex                             emaHistoryMutex;
+  std::map<EmaHistoryKey, IndicatorHistory> emaHistories;
+
+  IndicatorHistory* getEmaHistory(const EmaHistoryKey& key)
+  {
+    boost::mutex::scoped_lock lock(emaHistoryMutex);
+    std::map<EmaHistoryKey, IndicatorHistory>::iterator it = emaHistories.find(key);
+
+    if(it == emaHistories.end())
+    {
+      it = emaHistories.insert(std::make_pair(key, IndicatorHistory())).first;
+      resetIndicatorHistory(&it->second);
+      addStateInstance(key.fields[0]);
+    }
+
+    return &it->second;
+  }
+
+  // The histories of an instance are the keys from (instanceId) up to (instanceId + 1)
+  std::map<EmaHistoryKey, IndicatorHistory>::iterator firstEmaHistory(int instanceId)
+  {
+    EmaHistoryKey key = {{instanceId, INT_MIN, INT_MIN, INT_MIN, INT_MIN, INT_MIN, INT_MIN}};
+    return emaHistories.lower_bound(key);
+  }
+
+  void releaseEmaHistories(int instanceId)
+  {
+    boost::mutex::scoped_lock lock(emaHistoryMutex);
+    std::map<EmaHistoryKey, IndicatorHistory>::iterator it = firstEmaHistory(instanceId);
+
+    while(it != emaHistories.end() && it->first.fields[0] == instanceId)
+    {
+      emaHistories.erase(it++);
+    }
+  }
+
+  // The value of a closed bar only depends on the bars up to it, so it is computed once, when the
+  // bar is new, and read from the history afterwards. The open bar (shift 0) is always computed.
+  int getBarValues(const EmaHistoryKey& key, const Rates* pRates, int shift, BarValuesFunction function, const int* params, double* pValues)
+  {
+    int shift1Index = pRates->info.arraySize - 2, index = shift1Index + 1 - shift, result, i;
+    double values[INDICATOR_HISTORY_VALUES];
+    IndicatorHistory* pHistory;
+
+    if(shift < 1 || index < 0)
+    {
+      return function(pRates, index, params, pValues);
+    }
+
+    pHistory = getEmaHistory(key);
+
+    // After a reset the history is filled as far back as it reaches, then one bar is added per new bar
+    i = alignIndicatorHistory(pHistory, pRates->time, pRates->close, shift1Index) + 1;
+    if(i == 0)
+    {
+      i = std::max(0, shift1Index - INDICATOR_HISTORY_BARS + 1);
+    }
+
+    for(; i <= shift1Index; i++)
+    {
+      result = function(pRates, i, params, values);
+      if(result < 0)
+      {
+        resetIndicatorHistory(pHistory);
+        return result;
+      }
+      addIndicatorHistoryBar(pHistory, pRates->time[i], pRates->close[i], result, values);
+    }
+
+    result = getIndicatorHistoryBar(pHistory, shift1Index - index, values);
+    if(result == INDICATOR_HISTORY_MISSING)
+    {
+      return function(pRates, index, params, pValues);
+    }
+    if(result == TRUE)
+    {
+      std::copy(values, values + INDICATOR_HISTORY_VALUES, pValues);
+    }
+
+    return result;
+  }
+
+  // The EMA functions take the unstable period as an argument, the TA-Lib global setting is
+  // shared by all threads and is left alone.
+
+  // params: price (0 open, 1 high, 2 low, 3 close, 4 volume), period, unstable period. pValues[0] is the EMA
+  int emaBarValues(const Rates* pRates, int index, const int* params, double* pValues)
+  {
+    const double* series[] = {pRates->open, pRates->high, pRates->low, pRates->close, pRates->volume};
+    int hasValue;
+
+    if(params[0] < 0 || params[0] > 4 ||
+      calculateEma(series[params[0]], index, params[1], params[2], &pValues[0], &hasValue) != SUCCESS)
+    {
+      return -1;
+    }
+
+    pValues[1] = pValues[2] = 0;
+    return hasValue;
+  }
+
+  // params: fast, slow and signal periods, unstable period. pValues are the MACD, its signal and histogram
+  int macdBarValues(const Rates* pRates, int index, const int* params, double* pValues)
+  {
+    int hasValue;
+
+    if(calculateMacd(pRates->close, index, params[0], params[1], params[2], params[3], &pValues[0], &pValues[1], &pValues[2], &hasValue) != SUCCESS)
+    {
+      return -1;
+    }
+
+    return hasValue;
+  }
+
+  // Indicator results of an instance, reused by calls with the same indicator, rates array,
+  // parameters and shift until the open bar of the rates array changes (new bar or new tick)
+  enum
+  {
+    CACHED_ATR,
+    CACHED_MA,
+    CACHED_MACD,
+    CACHED_BBANDS,
+    CACHED_BBAND_STOP,
+    CACHED_STDEV,
+    CACHED_CCI
+  };
+
+  struct IndicatorCacheKey
+  {
+    int    fields[6];  // indicator, ratesArrayIndex, shift, three parameters
+    double deviation;
+
+    bool operator<(const IndicatorCacheKey& other) const
+    {
+      if(!std::equal(fields, fields + 6, other.fields))
+      {
+        return std::lexicographical_compare(fields, fields + 6, other.fields, other.fields + 6);
+      }
+      return deviation < other.deviation;
+    }
+  };
+
+  // The open bar of a rates array, along with the array size in case older bars were added
+  struct BarStamp
+  {
+    int    arraySize;
+    time_t time;
+    double prices[5];
+
+    bool operator==(const BarStamp& other) const
+    {
+      return arraySize == other.arraySize && time == other.time && std::equal(prices, prices + 5, other.prices);
+    }
+  };
+
+  struct IndicatorCacheEntry
+  {
+    BarStamp bar;
+    double   result;
+    int      flags;  // Indicator specific, the trend and index of the BBand stop, whether the MACD has values
+    double   values[INDICATOR_HISTORY_VALUES];
+  };
+
+  struct IndicatorCache
+  {
+    std::map<IndicatorCacheKey, IndicatorCacheEntry> entries;
+    long long hits;
+    long long misses;
+  };
+
+  // The caches of the instances run by a thread. An instance runs on one thread at a time,
+  // so the caches are kept per thread and the indicator calls take no lock.
+  boost::thread_specific_ptr<std::map<int, IndicatorCache> > indicatorCaches;
+
+  IndicatorCache* getIndicatorCache(int instanceId)
+  {
+    if(indicatorCaches.get() == NULL)
+    {
+      indicatorCaches.reset(new std::map<int, IndicatorCache>());
+    }
+
+    std::map<int, IndicatorCache>::iterator it = indicatorCaches->find(instanceId);
+
+    if(it == indicatorCaches->end())
+    {
+      IndicatorCache cache;
+      cache.hits = cache.misses = 0;
+      it = indicatorCaches->insert(std::make_pair(instanceId, cache)).first;
+    }
+
+    return &it->second;
+  }
+
+  BarStamp getBarStamp(const Rates* pRates)
+  {
+    int shift0Index = pRates->info.arraySize - 1;
+    BarStamp stamp = {pRates->info.arraySize, 0, {0, 0, 0, 0, 0}};
+
+    if(shift0Index >= 0)
+    {
+      stamp.time      = pRates->time[shift0Index];
+      stamp.prices[0] = pRates->open[shift0Index];
+      stamp.prices[1] = pRates->high[shift0Index];
+      stamp.prices[2] = pRates->low[shift0Index];
+      stamp.prices[3] = pRates->close[shift0Index];
+      stamp.prices[4] = pRates->volume[shift0Index];
+    }
+
+    return stamp;
+  }
+
+  // TRUE with the entry holding the result of the call, FALSE with the entry to store the result in.
+  // Like the other per instance state the entry is only used by the thread running the instance.
+  BOOL findCachedIndicator(int instanceId, const Rates* pRates, const IndicatorCacheKey& key, IndicatorCacheEntry** ppEntry)
+  {
+    IndicatorCache* pCache = getIndicatorCache(instanceId);
+    BarStamp bar = getBarStamp(pRates);
+    std::map<IndicatorCacheKey, IndicatorCacheEntry>::iterator it = pCache->entries.find(key);
+
+    if(it != pCache->entries.end() && it->second.bar == bar)
+    {
+      pCache->hits++;
+      *ppEntry = &it->second;
+      return TRUE;
+    }
+
+    pCache->misses++;
+    if(it == pCache->entries.end())
+    {
+      it = pCache->entries.insert(std::make_pair(key, IndicatorCacheEntry())).first;
+    }
+    it->second.bar = bar;
+    *ppEntry = &it->second;
+    return FALSE;
+  }
+
+  // Scratch memory of the indicators, grown as needed and kept per thread
+  boost::thread_specific_ptr<std::vector<double> > indicatorWorkspace;
+
+  double* getIndicatorWorkspace(int size)
+  {
+    if(indicatorWorkspace.get() == NULL)
+    {
+      indicatorWorkspace.reset(new std::vector<double>());
+    }
+    if((int)indicatorWorkspace->size() < size)
+    {
+      indicatorWorkspace->resize(size);
+    }
+
+    return &(*indicatorWorkspace)[0];
+  }
+}
 
 
 size_t my_write_func(void *ptr, size_t size, size_t nmemb, FILE *stream)
@@ -1552,114 +1908,16 @@ int EasyTrade::dayOfMonth()
 
 double EasyTrade::iSMI(int ratesArrayIndex, int period_Q, int period_R, int period_S, int signal, int shift){
 
-	double* HQ_Buffer;
-	double* SM_Buffer;
-	double* HQ_EMA_1, *SM_EMA_1;
-	double* HQ_EMA_2, *SM_EMA_2;
-	double* SMI_Buffer;
-	int shift0Index = pParams->ratesBuffers->rates[ratesArrayIndex].info.arraySize - 1 ;
-	int arraySize = pParams->ratesBuffers->rates[ratesArrayIndex].info.arraySize;
-	int i, n;
-	int highestHighIndex, lowestLowIndex;
+	Rates* rates = &pParams->ratesBuffers->rates[ratesArrayIndex];
+	double* pWorkspace = getIndicatorWorkspace(SMI_WORKSPACE_SERIES * (rates->info.arraySize > 0 ? rates->info.arraySize : 1));
 	double SMI_Signal;
-	Rates*     rates;
-	TA_RetCode taRetCode;
-    int        outBegIdx, outNBElement;
-	double highestHigh, lowestLow;
-  
-
-	rates = &pParams->ratesBuffers->rates[ratesArrayIndex]; 
-
-	HQ_Buffer = (double*)malloc((pParams->ratesBuffers->rates[ratesArrayIndex].info.arraySize)  * sizeof(double));
-	SM_Buffer = (double*)malloc((pParams->ratesBuffers->rates[ratesArrayIndex].info.arraySize)  * sizeof(double));
-	HQ_EMA_1 = (double*)malloc((pParams->ratesBuffers->rates[ratesArrayIndex].info.arraySize)  * sizeof(double));
-	SM_EMA_1 = (double*)malloc((pParams->ratesBuffers->rates[ratesArrayIndex].info.arraySize)  * sizeof(double));
-	HQ_EMA_2 = (double*)malloc((pParams->ratesBuffers->rates[ratesArrayIndex].info.arraySize)  * sizeof(double));
-	SM_EMA_2 = (double*)malloc((pParams->ratesBuffers->rates[ratesArrayIndex].info.arraySize)  * sizeof(double));
-	SMI_Buffer = (double*)malloc((pParams->ratesBuffers->rates[ratesArrayIndex].info.arraySize)  * sizeof(double));
-
-	for (i = 0; i < arraySize ; i++){
-
-		if (i > period_Q){
-
-			highestHigh = pParams->ratesBuffers->rates[ratesArrayIndex].high[i];
-			lowestLow = pParams->ratesBuffers->rates[ratesArrayIndex].low[i];
-
-			for(n = 0; n < period_Q; n++){ 
 
-				if(pParams->ratesBuffers->rates[ratesArrayIndex].high[i-n] > highestHigh){
-					highestHighIndex = i-n;
-				}
-
-				if(pParams->ratesBuffers->rates[ratesArrayIndex].low[i-n] < lowestLow){
-					lowestLowIndex = i-n;
-				}
-			}
-
-			HQ_Buffer[i] = pParams->ratesBuffers->rates[ratesArrayIndex].high[highestHighIndex]-pParams->ratesBuffers->rates[ratesArrayIndex].low[lowestLowIndex] ;
-			SM_Buffer[i] = pParams->ratesBuffers->rates[ratesArrayIndex].close[i] - (pParams->ratesBuffers->rates[ratesArrayIndex].high[highestHighIndex]+pParams->ratesBuffers->rates[ratesArrayIndex].low[lowestLowIndex])/2 ;
-		
-		} else {
-
-			HQ_Buffer[i] = 0 ;
-			SM_Buffer[i] = 0 ;
-		}
-
-	}
-
-	for (i = 0; i < arraySize ; i++){
-
-		if (i > period_R+period_Q){
-
-			taRetCode = TA_MA(i, i, HQ_Buffer, period_R, TA_MAType_EMA, &outBegIdx, &outNBElement, &HQ_EMA_1[i]);
-			taRetCode = TA_MA(i, i, SM_Buffer, period_R, TA_MAType_EMA, &outBegIdx, &outNBElement, &SM_EMA_1[i]);
-
-		}
-		else {
-
-			HQ_EMA_1[i] = 0;
-			SM_EMA_1[i] = 0;
-		}
-
-	}
-
-	for (i = 0; i < arraySize; i++){
-
-		if (i > period_Q + period_S + period_R){
-
-			taRetCode = TA_MA(i, i, HQ_EMA_1, period_S, TA_MAType_EMA, &outBegIdx, &outNBElement, &HQ_EMA_2[i]);
-			taRetCode = TA_MA(i, i, SM_EMA_1, period_S, TA_MAType_EMA, &outBegIdx, &outNBElement, &SM_EMA_2[i]);
-		}
-		else {
-
-			HQ_EMA_2[i] = 0;
-			SM_EMA_2[i] = 0;
-		}
-
-	}
-
-	for (i = 0; i < arraySize; i++){
-
-		if (i > period_S + period_R + period_Q){
-			SMI_Buffer[i] = 100 * SM_EMA_2[i] / 0.5 / HQ_EMA_2[i];
-		}
-		else {
-			SMI_Buffer[i] = 0;
-		}
+	if (calculateSMI(rates->high, rates->low, rates->close, rates->info.arraySize, period_Q, period_R, period_S, signal, EMA_UNSTABLE_PERIOD, shift, pWorkspace, &SMI_Signal) != SUCCESS)
+	{
+		return INDICATOR_CALCULATION_ERROR;
 	}
 
-	taRetCode = TA_MA(arraySize - shift, arraySize - shift, SMI_Buffer, signal + 1, TA_MAType_EMA, &outBegIdx, &outNBElement, &SMI_Signal);
-
-	free(HQ_Buffer);
-	free(SM_Buffer);
-	free(HQ_EMA_1);
-	free(HQ_EMA_2);
-	free(SM_EMA_1);
-	free(SM_EMA_2);
-	free(SMI_Buffer);
-
 	return(SMI_Signal);
-
 }
 
 double EasyTrade::iSTO(int ratesArrayIndex, int period, int k, int d, int signal, int shift)
@@ -1782,93 +2040,65 @@ int EasyTrade::iMACDTrendBeiLi(int ratesArrayIndex, int fastPeriod, int slowPeri
 
 double EasyTrade::iBBandStop(int ratesArrayIndex, int bb_period, double bb_deviation, int * trend, double * bbStopPrice,int *index)
 {
-	TA_RetCode retCode;
-	int        outBegIdx, outNBElement;
-	double	  upperBand[2000] = {}, middleBand[2000] = {}, lowerBand[2000] = {};
-	int shift1Index = pParams->ratesBuffers->rates[ratesArrayIndex].info.arraySize - 2;
-	int start = 0;
+	int instanceId = (int)pParams->settings[STRATEGY_INSTANCE_ID];
+	IndicatorCacheKey key = {{CACHED_BBAND_STOP, ratesArrayIndex, 0, bb_period, 0, 0}, bb_deviation};
+	IndicatorCacheEntry* pEntry;
+	BBandStopState* pState;
 
-	double upLimit = 10000, downLimit = 0;
-	*trend = 0;
-	*bbStopPrice = 0;
-
-	retCode = TA_BBANDS(start, shift1Index, pParams->ratesBuffers->rates[ratesArrayIndex].close, bb_period, bb_deviation, bb_deviation, TA_MAType_SMA, &outBegIdx, &outNBElement, upperBand, middleBand, lowerBand);
-	if (retCode != TA_SUCCESS)
-	{
-		return INDICATOR_CALCULATION_ERROR;
-	}
-
-	//int bbSize = 0;	
-
-
-	// Loop through and chceck out if BBS exists
-	for (int i = start; i < outNBElement; i++)
+	if (findCachedIndicator(instanceId, &pParams->ratesBuffers->rates[ratesArrayIndex], key, &pEntry))
 	{
-		if (upperBand[i] == 0)
-			break;
-		if (*trend == 0)
+		// Failed calls return an unset index, as before
+		*trend = pEntry->flags;
+		*bbStopPrice = pEntry->values[0];
+		if (pEntry->result == 0)
 		{
-			if (upperBand[i] < upLimit)
-				upLimit = upperBand[i];
-			if (lowerBand[i] > downLimit)
-				downLimit = lowerBand[i];
-		}
-
-		if (*trend == 1)
-		{
-			if (lowerBand[i] > *bbStopPrice)
-				*bbStopPrice = lowerBand[i];
-
-			downLimit = *bbStopPrice;
-		}
-
-		if (*trend == -1)
-		{
-			if (upperBand[i]<*bbStopPrice)
-				*bbStopPrice = upperBand[i];
-
-			upLimit = *bbStopPrice;
+			*index = (int)pEntry->values[1];
 		}
+		return pEntry->result;
+	}
 
-		// Found a new up trend
-		if (pParams->ratesBuffers->rates[ratesArrayIndex].close[outBegIdx+i] > upLimit && *trend != 1)
-		{
-			*trend = 1;
-			*bbStopPrice = lowerBand[i];	
-			*index = outBegIdx + i;
-		}
-		//Found a new down trend
-		else if (pParams->ratesBuffers->rates[ratesArrayIndex].close[outBegIdx+i] < downLimit && *trend != -1)
-		{
-			*trend = -1;
-			*bbStopPrice = upperBand[i];	
-			*index = outBegIdx + i;
-		}	
+	pState = getBBandStopState(instanceId, ratesArrayIndex, bb_period, bb_deviation);
 
-		
+	// Only the bands of the bars added since the last call are computed, see calculateBBandStop()
+	if (calculateBBandStop(pState, pParams->ratesBuffers->rates[ratesArrayIndex].time, pParams->ratesBuffers->rates[ratesArrayIndex].close,
+		pParams->ratesBuffers->rates[ratesArrayIndex].info.arraySize, bb_period, bb_deviation, trend, bbStopPrice, index) != SUCCESS)
+	{
+		*trend = pEntry->flags = 0;
+		*bbStopPrice = pEntry->values[0] = 0;
+		return pEntry->result = INDICATOR_CALCULATION_ERROR;
 	}
 
-	return 0;
+	pEntry->flags = *trend;
+	pEntry->values[0] = *bbStopPrice;
+	pEntry->values[1] = *index;
+	return pEntry->result = 0;
 }
 
 double EasyTrade::iBBands(int ratesArrayIndex, int bb_period, double bb_deviation, int signal, int shift)
 {
   TA_RetCode retCode;
   int        outBegIdx, outNBElement;
-  double	  upperBand, middleBand, lowerBand;
   int shift0Index = pParams->ratesBuffers->rates[ratesArrayIndex].info.arraySize - 1 ;
-    
-  retCode = TA_BBANDS(shift0Index-shift, shift0Index-shift, pParams->ratesBuffers->rates[ratesArrayIndex].open, bb_period, bb_deviation, bb_deviation, TA_MAType_SMA, &outBegIdx, &outNBElement, &upperBand, &middleBand, &lowerBand);
-  if(retCode != TA_SUCCESS)
+  IndicatorCacheKey key = {{CACHED_BBANDS, ratesArrayIndex, shift, bb_period, 0, 0}, bb_deviation};
+  IndicatorCacheEntry* pEntry;
+
+  // All three bands are cached, whichever was asked for
+  if(!findCachedIndicator((int)pParams->settings[STRATEGY_INSTANCE_ID], &pParams->ratesBuffers->rates[ratesArrayIndex], key, &pEntry))
+  {
+    retCode = TA_BBANDS(shift0Index-shift, shift0Index-shift, pParams->ratesBuffers->rates[ratesArrayIndex].open, bb_period, bb_deviation, bb_deviation, TA_MAType_SMA, &outBegIdx, &outNBElement, &pEntry->values[0], &pEntry->values[1], &pEntry->values[2]);
+    pEntry->result = retCode != TA_SUCCESS ? INDICATOR_CALCULATION_ERROR : 0;
+  }
+
+  if(pEntry->result != 0)
   {
     return INDICATOR_CALCULATION_ERROR ;
   }
 
   switch(signal)
   {
-  case 0: return upperBand; break;
-  case 1: return middleBand; break;
-  case 2: return lowerBand; break;
+  case 0: return pEntry->values[0]; break;
+  case 1: return pEntry->values[1]; break;
+  case 2: return pEntry->values[2]; break;
   default: return 0; break;	
   }
     
@@ -1928,45 +2158,47 @@ double EasyTrade::iASI(int ratesArrayIndex, int mode, int length, int smooth, do
 
 double EasyTrade::iMACD(int ratesArrayIndex, int fastPeriod, int slowPeriod, int signalPeriod, int signal, int shift)
 {
-  TA_RetCode retCode;
-  int        outBegIdx, outNBElement;
-  double	   macd1, macd2, macd3;
-  int shift0Index = pParams->ratesBuffers->rates[ratesArrayIndex].info.arraySize - 1 ;
-
-  TA_SetUnstablePeriod(TA_FUNC_UNST_EMA, 35);
+  double macd[INDICATOR_HISTORY_VALUES] = {};
 
-  //retCode = TA_MACD(shift0Index - shift, shift0Index - shift, pParams->ratesBuffers->rates[ratesArrayIndex].close, fastPeriod, slowPeriod, signalPeriod, &outBegIdx, &outNBElement, &macd1, &macd2, &macd3);
-  retCode = TA_MACDEXT(shift0Index - shift, shift0Index - shift, pParams->ratesBuffers->rates[ratesArrayIndex].close, fastPeriod, TA_MAType_EMA, slowPeriod, TA_MAType_EMA, signalPeriod, TA_MAType_EMA, &outBegIdx, &outNBElement, &macd1, &macd2, &macd3);
-
-  TA_SetUnstablePeriod(TA_FUNC_UNST_EMA, 0);
-  if(retCode != TA_SUCCESS)
+  if(iMACDAll(ratesArrayIndex, fastPeriod, slowPeriod, signalPeriod, shift, &macd[0], &macd[1], &macd[2]) != 0)
   {
     return INDICATOR_CALCULATION_ERROR ;
   }
 
   switch(signal)
   {
-  case 0: return macd1; break;
-  case 1: return macd2; break;
-  case 2: return macd3; break;
+  case 0: return macd[0]; break;
+  case 1: return macd[1]; break;
+  case 2: return macd[2]; break;
   default: return 0; break;	
   }
 }
 
 double EasyTrade::iMACDAll(int ratesArrayIndex, int fastPeriod, int slowPeriod, int signalPeriod, int shift,double *pMacd, double *pMmacdSignal,double *pMacdHist)
 {
-	TA_RetCode retCode;
-	int        outBegIdx, outNBElement;	
-	int shift0Index = pParams->ratesBuffers->rates[ratesArrayIndex].info.arraySize - 1;
+	int params[] = {fastPeriod, slowPeriod, signalPeriod, MACD_EMA_UNSTABLE_PERIOD};
+	EmaHistoryKey key = {{(int)pParams->settings[STRATEGY_INSTANCE_ID], ratesArrayIndex, EMA_HISTORY_MACD, fastPeriod, slowPeriod, signalPeriod, MACD_EMA_UNSTABLE_PERIOD}};
+	IndicatorCacheKey cacheKey = {{CACHED_MACD, ratesArrayIndex, shift, fastPeriod, slowPeriod, signalPeriod}, 0};
+	IndicatorCacheEntry* pEntry;
 
-	TA_SetUnstablePeriod(TA_FUNC_UNST_EMA, 35);
-	retCode = TA_MACDEXT(shift0Index - shift, shift0Index - shift, pParams->ratesBuffers->rates[ratesArrayIndex].close, fastPeriod, TA_MAType_EMA, slowPeriod, TA_MAType_EMA, signalPeriod, TA_MAType_EMA, &outBegIdx, &outNBElement, pMacd, pMmacdSignal, pMacdHist);
+	if (!findCachedIndicator(key.fields[0], &pParams->ratesBuffers->rates[ratesArrayIndex], cacheKey, &pEntry))
+	{
+		pEntry->flags = getBarValues(key, &pParams->ratesBuffers->rates[ratesArrayIndex], shift, macdBarValues, params, pEntry->values);
+		pEntry->result = pEntry->flags < 0 ? INDICATOR_CALCULATION_ERROR : 0;
+	}
 
-	TA_SetUnstablePeriod(TA_FUNC_UNST_EMA, 0);
-	if (retCode != TA_SUCCESS)
+	if (pEntry->flags < 0)
 	{
 		return INDICATOR_CALCULATION_ERROR;
 	}
+
+	// Bars without enough history leave the outputs as they are, as TA_MACDEXT did
+	if (pEntry->flags == TRUE)
+	{
+		*pMacd = pEntry->values[0];
+		*pMmacdSignal = pEntry->values[1];
+		*pMacdHist = pEntry->values[2];
+	}
 	return 0;
 
 }
@@ -1975,8 +2207,15 @@ double EasyTrade::iStdev(int ratesArrayIndex, int type, int period, int shift)
 {
   TA_RetCode taRetCode;
   int        outBegIdx, outNBElement;
-  double	   stdev;
+  double	   stdev = 0;
   int shift0Index = pParams->ratesBuffers->rates[ratesArrayIndex].info.arraySize - 1 ;
+  IndicatorCacheKey key = {{CACHED_STDEV, ratesArrayIndex, shift, type, period, 0}, 0};
+  IndicatorCacheEntry* pEntry;
+
+  if(findCachedIndicator((int)pParams->settings[STRATEGY_INSTANCE_ID], &pParams->ratesBuffers->rates[ratesArrayIndex], key, &pEntry))
+  {
+    return pEntry->result;
+  }
 
   switch(type)
   {
@@ -1984,7 +2223,7 @@ double EasyTrade::iStdev(int ratesArrayIndex, int type, int period, int shift)
 	  taRetCode = TA_STDDEV(shift0Index-shift, shift0Index-shift, pParams->ratesBuffers->rates[ratesArrayIndex].open, period, 1, &outBegIdx, &outNBElement, &stdev);
   if(taRetCode != TA_SUCCESS)
   {
-    return INDICATOR_CALCULATION_ERROR ;
+    stdev = INDICATOR_CALCULATION_ERROR ;
   }
 		  }
   break;
@@ -1992,7 +2231,7 @@ double EasyTrade::iStdev(int ratesArrayIndex, int type, int period, int shift)
 	  taRetCode = TA_STDDEV(shift0Index-shift, shift0Index-shift, pParams->ratesBuffers->rates[ratesArrayIndex].high, period, 1, &outBegIdx, &outNBElement, &stdev);
   if(taRetCode != TA_SUCCESS)
   {
-    return INDICATOR_CALCULATION_ERROR ;
+    stdev = INDICATOR_CALCULATION_ERROR ;
   }
 		  }
   break;
@@ -2000,7 +2239,7 @@ double EasyTrade::iStdev(int ratesArrayIndex, int type, int period, int shift)
 	  taRetCode = TA_STDDEV(shift0Index-shift, shift0Index-shift, pParams->ratesBuffers->rates[ratesArrayIndex].low, period, 1, &outBegIdx, &outNBElement, &stdev);
   if(taRetCode != TA_SUCCESS)
   {
-    return INDICATOR_CALCULATION_ERROR ;
+    stdev = INDICATOR_CALCULATION_ERROR ;
   }
 		  }
   break;
@@ -2008,7 +2247,7 @@ double EasyTrade::iStdev(int ratesArrayIndex, int type, int period, int shift)
 	  taRetCode = TA_STDDEV(shift0Index-shift, shift0Index-shift, pParams->ratesBuffers->rates[ratesArrayIndex].close, period, 1, &outBegIdx, &outNBElement, &stdev);
   if(taRetCode != TA_SUCCESS)
   {
-    return INDICATOR_CALCULATION_ERROR ;
+    stdev = INDICATOR_CALCULATION_ERROR ;
   }
 		  }
   break;
@@ -2016,7 +2255,7 @@ double EasyTrade::iStdev(int ratesArrayIndex, int type, int period, int shift)
 
   
 
-  return stdev;
+  return pEntry->result = stdev;
 }
 
 double EasyTrade::iCCI(int ratesArrayIndex, int period, int shift)
@@ -2025,52 +2264,42 @@ double EasyTrade::iCCI(int ratesArrayIndex, int period, int shift)
   int        outBegIdx, outNBElement;
   double	   cci;
   int shift0Index = pParams->ratesBuffers->rates[ratesArrayIndex].info.arraySize - 1 ;
+  IndicatorCacheKey key = {{CACHED_CCI, ratesArrayIndex, shift, period, 0, 0}, 0};
+  IndicatorCacheEntry* pEntry;
+
+  if(findCachedIndicator((int)pParams->settings[STRATEGY_INSTANCE_ID], &pParams->ratesBuffers->rates[ratesArrayIndex], key, &pEntry))
+  {
+    return pEntry->result;
+  }
 
   taRetCode = TA_CCI(shift0Index-shift, shift0Index-shift, pParams->ratesBuffers->rates[ratesArrayIndex].high, pParams->ratesBuffers->rates[ratesArrayIndex].low, pParams->ratesBuffers->rates[ratesArrayIndex].close, period, &outBegIdx, &outNBElement, &cci);
   if(taRetCode != TA_SUCCESS)
   {
-    return INDICATOR_CALCULATION_ERROR ;
+    cci = INDICATOR_CALCULATION_ERROR ;
   }
 
-  return cci;
+  return pEntry->result = cci;
 }
 
 double EasyTrade::iMA(int type, int ratesArrayIndex, int period, int shift)
 {
-  TA_RetCode taRetCode;
-  int        outBegIdx, outNBElement;
-  double	   ma;
-  int shift0Index = pParams->ratesBuffers->rates[ratesArrayIndex].info.arraySize - 1 ;
-  
-  //TA_SetUnstablePeriod(TA_FUNC_UNST_EMA, 100);
+  int params[] = {type, period, EMA_UNSTABLE_PERIOD};
+  EmaHistoryKey key = {{(int)pParams->settings[STRATEGY_INSTANCE_ID], ratesArrayIndex, EMA_HISTORY_MA, type, period, 0, EMA_UNSTABLE_PERIOD}};
+  IndicatorCacheKey cacheKey = {{CACHED_MA, ratesArrayIndex, shift, type, period, 0}, 0};
+  IndicatorCacheEntry* pEntry;
+  double values[INDICATOR_HISTORY_VALUES] = {};
 
-  switch(type)
+  if(findCachedIndicator(key.fields[0], &pParams->ratesBuffers->rates[ratesArrayIndex], cacheKey, &pEntry))
   {
-  case 0:
-    taRetCode = TA_MA(shift0Index-shift, shift0Index-shift, pParams->ratesBuffers->rates[ratesArrayIndex].open, period, TA_MAType_EMA, &outBegIdx, &outNBElement, &ma);
-    break;
-  case 1:
-    taRetCode = TA_MA(shift0Index-shift, shift0Index-shift, pParams->ratesBuffers->rates[ratesArrayIndex].high, period, TA_MAType_EMA, &outBegIdx, &outNBElement, &ma);
-    break;
-  case 2:
-    taRetCode = TA_MA(shift0Index-shift, shift0Index-shift, pParams->ratesBuffers->rates[ratesArrayIndex].low, period, TA_MAType_EMA, &outBegIdx, &outNBElement, &ma);
-    break;
-  case 3:
-    taRetCode = TA_MA(shift0Index-shift, shift0Index-shift, pParams->ratesBuffers->rates[ratesArrayIndex].close, period, TA_MAType_EMA, &outBegIdx, &outNBElement, &ma);
-    break;
-  case 4:
-	taRetCode = TA_MA(shift0Index - shift, shift0Index - shift, pParams->ratesBuffers->rates[ratesArrayIndex].volume, period, TA_MAType_EMA, &outBegIdx, &outNBElement, &ma);
-	break;
+    return pEntry->result;
   }
 
-  //TA_SetUnstablePeriod(TA_FUNC_UNST_EMA, 0);
-
-  if(taRetCode != TA_SUCCESS)
+  if(getBarValues(key, &pParams->ratesBuffers->rates[ratesArrayIndex], shift, emaBarValues, params, values) < 0)
   {
-    return INDICATOR_CALCULATION_ERROR ;
+    return pEntry->result = INDICATOR_CALCULATION_ERROR ;
   }
 
-  return ma;
+  return pEntry->result = values[0];
 }
 
 double EasyTrade::iRSI(int ratesArrayIndex, int period, int shift)
@@ -2393,15 +2622,107 @@ double EasyTrade::iAtr(int ratesArrayIndex, int period, int shift)
   int        outBegIdx, outNBElement;
   double	   atr;
   int shift0Index = pParams->ratesBuffers->rates[ratesArrayIndex].info.arraySize - 1 ;
+  IndicatorCacheKey key = {{CACHED_ATR, ratesArrayIndex, shift, period, 0, 0}, 0};
+  IndicatorCacheEntry* pEntry;
+
+  if(findCachedIndicator((int)pParams->settings[STRATEGY_INSTANCE_ID], &pParams->ratesBuffers->rates[ratesArrayIndex], key, &pEntry))
+  {
+    return pEntry->result;
+  }
 
   taRetCode = TA_ATR(shift0Index-shift, shift0Index-shift, pParams->ratesBuffers->rates[ratesArrayIndex].high, pParams->ratesBuffers->rates[ratesArrayIndex].low, pParams->ratesBuffers->rates[ratesArrayIndex].close, period, &outBegIdx, &outNBElement, &atr);
 
   if(taRetCode != TA_SUCCESS)
   {
-    return INDICATOR_CALCULATION_ERROR ;
+    atr = INDICATOR_CALCULATION_ERROR ;
+  }
+
+  return pEntry->result = atr;
+}
+
+void EasyTrade::getIndicatorCacheCounters(long long* pHits, long long* pMisses)
+{
+  IndicatorCache* pCache = getIndicatorCache((int)pParams->settings[STRATEGY_INSTANCE_ID]);
+
+  *pHits = pCache->hits;
+  *pMisses = pCache->misses;
+}
+
+void EasyTrade::releaseIndicatorCaches()
+{
+  std::map<int, IndicatorCache>::const_iterator it;
+
+  if(indicatorCaches.get() == NULL)
+  {
+    return;
+  }
+
+  for(it = indicatorCaches->begin(); it != indicatorCaches->end(); ++it)
+  {
+    long long calls = it->second.hits + it->second.misses;
+
+    logInfo("Indicator cache of instance %d: %lld hits, %lld misses (%.1lf%% of the indicator calls saved)",
+      it->first, it->second.hits, it->second.misses, calls > 0 ? 100.0 * it->second.hits / calls : 0.0);
+  }
+
+  indicatorCaches.reset();
+}
+
+void EasyTrade::releaseIndicatorStates(int instanceId)
+{
+  releaseBBandStopStates(instanceId);
+  releaseEmaHistories(instanceId);
+
+  if(stateInstances.get() != NULL)
+  {
+    stateInstances->erase(instanceId);
+  }
+}
+
+void EasyTrade::releaseThreadIndicatorStates()
+{
+  std::set<int>::const_iterator it;
+
+  if(stateInstances.get() == NULL)
+  {
+    return;
+  }
+
+  for(it = stateInstances->begin(); it != stateInstances->end(); ++it)
+  {
+    releaseBBandStopStates(*it);
+    releaseEmaHistories(*it);
+  }
+
+  stateInstances.reset();
+}
+
+int EasyTrade::countBBandStopStates(int instanceId)
+{
+  boost::mutex::scoped_lock lock(bbandStopMutex);
+  std::map<BBandStopKey, BBandStopState>::const_iterator it = firstBBandStopState(instanceId);
+  int count = 0;
+
+  for(; it != bbandStopStates.end() && it->first.instanceId == instanceId; ++it)
+  {
+    count++;
   }
 
-  return atr;
+  return count;
+}
+
+int EasyTrade::countEmaHistories(int instanceId)
+{
+  boost::mutex::scoped_lock lock(emaHistoryMutex);
+  std::map<EmaHistoryKey, IndicatorHistory>::const_iterator it = firstEmaHistory(instanceId);
+  int count = 0;
+
+  for(; it != emaHistories.end() && it->first.fields[0] == instanceId; ++it)
+  {
+    count++;
+  }
+
+  return count;
 }
 
 void EasyTrade::print(double valueToPrint)
@@ -5387,6 +5708,11 @@ void EasyTrade::printBarInfo(StrategyParams* pParams, int rate, char * currentTi
 	int   shift0Index = pParams->ratesBuffers->rates[rate].info.arraySize - 1;
 	int   shift1Index = pParams->ratesBuffers->rates[rate].info.arraySize - 2;
 
+	if (!asirikuyLogEnabled(LOG_DEBUG))
+	{
+		return;
+	}
+
 	currentBarTime = pParams->ratesBuffers->rates[rate].time[shift0Index];
 	safe_gmtime(&barTimeInfo, currentBarTime);
 	safe_timeString(currentBarTimeString, currentBarTime);
@@ -782,6 +782,36 @@ double iASIEasy(int ratesArrayIndex, int mode, int length, int smooth, double *
 	return easyTradePtr->iASI(ratesArrayIndex, mode, length, smooth, outBull, outBear);
 }
 
+void getIndicatorCacheCountersEasy(long long *pHits, long long *pMisses)
+{
+	easyTradePtr->getIndicatorCacheCounters(pHits, pMisses);
+}
+
+void releaseIndicatorCachesEasy()
+{
+	EasyTrade::releaseIndicatorCaches();
+}
+
+void releaseIndicatorStatesEasy(int instanceId)
+{
+	EasyTrade::releaseIndicatorStates(instanceId);
+}
+
+void releaseThreadIndicatorStatesEasy()
+{
+	EasyTrade::releaseThreadIndicatorStates();
+}
+
+int countBBandStopStatesEasy(int instanceId)
+{
+	return EasyTrade::countBBandStopStates(instanceId);
+}
+
+int countEmaHistoriesEasy(int instanceId)
+{
+	return EasyTrade::countEmaHistories(instanceId);
+}
+
 double caculateFreeMarginEasy(){
 	return easyTradePtr->caculateFreeMargin();
 }
\ No newline at end of file
@@ -42,6 +42,9 @@
 
 #include "AsirikuyDefines.h"
 
+/* Hours cropped from Monday and Friday when the config does not set them, also used until the framework context is created */
+#define DEFAULT_CROP_HOURS 4
+
 typedef struct loggingConfig_t
 {
   char logFolder[MAX_FILE_PATH_CHARS];
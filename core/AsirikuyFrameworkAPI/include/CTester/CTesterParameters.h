@@ -82,7 +82,22 @@ AsirikuyReturnCode convertCParameters(
   StrategyResults* pCResults,
   StrategyParams*  pParams);
 
-AsirikuyReturnCode allocateOrderInfo(StrategyParams* pParams, int orderInfoArraySize);
-AsirikuyReturnCode freeOrderInfo(StrategyParams* pParams);
+/**
+* Points pParams->orderInfo at a buffer from the calling thread's scratch arena.
+*
+* The arena is reset on every call, so the buffer is valid until the next call
+* on the same thread. No heap call is made once the arena is large enough.
+*/
+AsirikuyReturnCode allocateOrderInfoC(StrategyParams* pParams, int orderInfoArraySize);
+
+/**
+* Detaches pParams->orderInfo. The memory stays with the thread's scratch arena.
+*/
+AsirikuyReturnCode freeOrderInfoC(StrategyParams* pParams);
+
+/**
+* Frees the calling thread's scratch arena.
+*/
+void releaseOrderInfoC();
 
 #endif /* C_TESTER_PARAMETERS_H_ */
\ No newline at end of file
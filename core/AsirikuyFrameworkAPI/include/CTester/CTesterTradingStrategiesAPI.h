@@ -78,6 +78,16 @@ extern "C" {
     CRates*    pInRates_9,
     double*       pOutResults);
 
+  /**
+  * Frees the scratch buffers c_runStrategy keeps for the calling thread and logs the
+  * hits and misses of the indicator caches of the instances it ran before freeing them.
+  * The indicator states of those instances (Bollinger Band stops, EMA histories) are freed as well.
+  *
+  * Call it from the thread that ran the strategy once a test has finished.
+  *
+  */
+  void __stdcall c_releaseStrategyScratch();
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
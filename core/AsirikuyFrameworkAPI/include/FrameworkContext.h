@@ -0,0 +1,94 @@
+/**
+ * @file
+ * @brief     The framework context shared by every instance.
+ * @details   The context is created once from the framework config file, on the first instance
+ * @details   initialization. Threads that initialize instances at the same time wait for it
+ * @details   instead of returning WAIT_FOR_INIT, and all of them get the same result.
+ * @details   Once created the context is never modified, so it can be read without a lock.
+ * @details   Code in this library reads the config from the context. The libraries it links
+ * @details   (logger, TA-Lib, rates buffers, instance states, strategies, order management) keep
+ * @details   their own settings, since they cannot depend on this library. For them the context
+ * @details   only makes sure they are initialized once, before any instance runs.
+ * 
+ * @version   F4.x.x
+ * @date      2026
+ *
+ * @copyright END-USER LICENSE AGREEMENT FOR ASIRIKUY SOFTWARE. IMPORTANT PLEASE READ THE TERMS AND CONDITIONS OF THIS LICENSE AGREEMENT CAREFULLY BEFORE USING THIS SOFTWARE: 
+ * @copyright Asirikuy's End-User License Agreement ("EULA") is a legal agreement between you (either an individual or a single entity) and Asirikuy for the use of the Asirikuy Framework in both source and binary forms. By installing, copying, or otherwise using the Asirikuy Framework, you agree to be bound by the terms of this EULA. This license agreement represents the entire agreement concerning the program between you and Asirikuy, (referred to as "licenser"), and it supersedes any prior proposal, representation, or understanding between the parties. If you do not agree to the terms of this EULA, do not install or use the Asirikuy Framework.
+ * @copyright The Asirikuy Framework is protected by copyright laws and international copyright treaties, as well as other intellectual property laws and treaties. The Asirikuy Framework is licensed, not sold.
+ * @copyright 1. GRANT OF LICENSE.
+ * @copyright The Asirikuy Framework is licensed as follows:
+ * @copyright (a) Installation and Use.
+ * @copyright Asirikuy grants you the right to install and use copies of the Asirikuy Framework in both source and binary forms for personal and business use. You may also make modifications to the source code.
+ * @copyright (b) Backup Copies.
+ * @copyright You may make copies of the Asirikuy Framework as may be necessary for backup and archival purposes.
+ * @copyright 2. DESCRIPTION OF OTHER RIGHTS AND LIMITATIONS.
+ * @copyright (a) Maintenance of Copyright Notices.
+ * @copyright You must not remove or alter any copyright notices on any and all copies of the Asirikuy Framework.
+ * @copyright (b) Distribution.
+ * @copyright You may not distribute copies of the Asirikuy Framework in binary or source forms to third parties outside of the Asirikuy community.
+ * @copyright (c) Rental.
+ * @copyright You may not rent, lease, or lend the Asirikuy Framework.
+ * @copyright (d) Compliance with Applicable Laws.
+ * @copyright You must comply with all applicable laws regarding use of the Asirikuy Framework.
+ * @copyright 3. TERMINATION
+ * @copyright Without prejudice to any other rights, Asirikuy may terminate this EULA if you fail to comply with the terms and conditions of this EULA. In such event, you must destroy all copies of the Asirikuy Framework in your possession.
+ * @copyright 4. COPYRIGHT
+ * @copyright All title, including but not limited to copyrights, in and to the Asirikuy Framework and any copies thereof are owned by Asirikuy or its suppliers. All title and intellectual property rights in and to the content which may be accessed through use of the Asirikuy Framework is the property of the respective content owner and may be protected by applicable copyright or other intellectual property laws and treaties. This EULA grants you no rights to use such content. All rights not expressly granted are reserved by Asirikuy.
+ * @copyright 5. NO WARRANTIES
+ * @copyright Asirikuy expressly disclaims any warranty for the Asirikuy Framework. The Asirikuy Framework is provided 'As Is' without any express or implied warranty of any kind, including but not limited to any warranties of merchantability, noninfringement, or fitness of a particular purpose. Asirikuy does not warrant or assume responsibility for the accuracy or completeness of any information, text, graphics, links or other items contained within the Asirikuy Framework. Asirikuy makes no warranties respecting any harm that may be caused by the transmission of a computer virus, worm, time bomb, logic bomb, or other such computer program. Asirikuy further expressly disclaims any warranty or representation to Authorized Users or to any third party.
+ * @copyright 6. LIMITATION OF LIABILITY
+ * @copyright In no event shall Asirikuy or any contributors to the Asirikuy Framework be liable for any damages (including, without limitation, lost profits, business interruption, or lost information) rising out of 'Authorized Users' use of or inability to use the Asirikuy Framework, even if Asirikuy has been advised of the possibility of such damages. In no event will Asirikuy or any contributors to the Asirikuy Framework be liable for loss of data or for indirect, special, incidental, consequential (including lost profit), or other damages based in contract, tort or otherwise. Asirikuy and contributors to the Asirikuy Framework shall have no liability with respect to the content of the Asirikuy Framework or any part thereof, including but not limited to errors or omissions contained therein, libel, infringements of rights of publicity, privacy, trademark rights, business interruption, personal injury, loss of privacy, moral rights or the disclosure of confidential information.
+ */
+
+#ifndef FRAMEWORK_CONTEXT_H_
+#define FRAMEWORK_CONTEXT_H_
+#pragma once
+
+#include "AsirikuyConfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct frameworkContext_t
+{
+  AsirikuyConfig config;                          /* The config the framework was initialized with */
+  char           accountName[MAX_FILE_PATH_CHARS]; /* The account name used in the log file name */
+} FrameworkContext;
+
+/**
+* Gets the framework context, creating it on the first call.
+*
+* Creating the context parses the config file and initializes the logger, TA-Lib, broker timezones,
+* rates buffers, equity log, instance states, NTP client and temp file folder. Later calls
+* return the existing context and ignore their arguments. If creating the context fails the next
+* call tries again.
+*
+* @param const char* pAsirikuyConfig
+*   The path of the framework's config file.
+*
+* @param const char* pAccountName
+*   The account name, prefixed to the framework log file name. May be NULL.
+*
+* @param const FrameworkContext** ppContext
+*   Set to the framework context on success.
+*
+* @return AsirikuyReturnCode
+*   An enum indicating success or the type of failure that occurred.
+*/
+AsirikuyReturnCode acquireFrameworkContext(const char* pAsirikuyConfig, const char* pAccountName, const FrameworkContext** ppContext);
+
+/**
+* Gets the framework context without creating it.
+*
+* @return const FrameworkContext*
+*   The framework context, or NULL if it has not been created yet.
+*/
+const FrameworkContext* getFrameworkContext();
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* FRAMEWORK_CONTEXT_H_ */
@@ -46,20 +46,6 @@
 extern "C" {
 #endif
 
-/**
-* Sets the number of hours to crop from the start and end of the trading week.
-*
-* For example, if both values are set to 4 the trading week will start at
-* 04:00 on Monday and end at 19:00 on Friday.
-*
-* @param int cropMondayHours
-*   The number of hours to crop from Monday morning.
-*
-* @param int cropFridayHours
-*   The number of hours to crop from Friday night.
-*/
-void setTradingWeekBoundaries(int cropMondayHours, int cropFridayHours);
-
 /**
 * Checks if the specified time is a weekend
 *
@@ -74,6 +60,10 @@ BOOL isWeekend(time_t time);
 /**
 * Checks if a time is before the beginning or after the end of the trading week.
 *
+* The number of hours cropped from Monday morning and Friday night are read from the
+* framework context. For example, if both are 4 the trading week starts at 04:00 on
+* Monday and ends at 19:00 on Friday. Until the context is created both are 4.
+*
 * @param time_t time
 *   The time to evaluate
 *
@@ -42,8 +42,6 @@
 
 #include "AsirikuyConfig.h"
 
-#define DEFAULT_CROP_HOURS 4
-
 #if defined _WIN32 || defined _WIN64
 static DWORD _mxml_tls_index;	/* Index for global storage */
 #elif defined __APPLE__ || defined linux
@@ -39,191 +39,13 @@
 #include "Precompiled.h"
 #include "AsirikuyLogger.h"
 
-#if defined __APPLE__ || defined __linux__
-  #include <sys/time.h>
-  #include <unistd.h>
-#endif
-
-#include <ta_libc.h>
-
 #include "AsirikuyFrameworkAPI.h"
 #include "FrameworkVersion.h"
-#include "AsirikuyConfig.h"
-#include "StrategyUserInterface.h"
-#include "Broker-tz.h"
-#include "TimeZoneOffsets.h"
+#include "FrameworkContext.h"
 #include "ContiguousRatesCircBuf.h"
-#include "Logging.h"
 #include "EquityLog.h"
 #include "CriticalSection.h"
 #include "InstanceStates.h"
-#include "NTPCWrapper.hpp"
-#include "TradingWeekBoundaries.h"
-
-#define LOG_FILENAME "AsirikuyFramework.log"
-
-// Pantheios removed - using standard fprintf for logging
-// const PAN_CHAR_T PANTHEIOS_FE_PROCESS_IDENTITY[] = PANTHEIOS_LITERAL_STRING("AsirikuyFramework");
-
-static void seedRand()
-{
-#if defined _WIN32 || defined _WIN64
-  srand(GetTickCount());
-#elif defined __APPLE__ || defined __linux__
-  struct timeval t1;
-  gettimeofday(&t1, NULL);
-  srand(t1.tv_usec * t1.tv_sec);
-#else
-#  error "Unsupported operating system"
-#endif
-}
-
-static void sleepMilliseconds(int milliseconds)
-{
-#if defined _WIN32 || defined _WIN64
-  Sleep(milliseconds);
-#elif defined __APPLE__ || defined __linux__
-  usleep(milliseconds * 1000);
-#else
-  #error "Unsupported operating system"
-#endif
-}
-
-static int initFramework(char* pAsirikuyConfig, char* pAccountName)
-{
-  static BOOL initialized  = FALSE;
-  static BOOL initializing = FALSE;
-  AsirikuyReturnCode result;
-  TA_RetCode retCode;
-  AsirikuyConfig config;
-  char brokerTZPath[MAX_FILE_PATH_CHARS] = "";
-  // Pantheios removed - using standard fprintf for logging
-  // char pantheiosLogPath[MAX_FILE_PATH_CHARS] = "";
-
-  logInfo("initFramework called: config='%s', account='%s', initialized=%d, initializing=%d\n", 
-          pAsirikuyConfig ? pAsirikuyConfig : "NULL", 
-          pAccountName ? pAccountName : "NULL", 
-          initialized, initializing);
-
-  if(!initialized)
-  {
-    logInfo("initFramework: Framework not initialized yet, entering initialization\n");
-    enterCriticalSection();
-	 if(initializing)
-    {
-      leaveCriticalSection();
-      return (int)WAIT_FOR_INIT;
-    }
-    initializing = TRUE;
-    leaveCriticalSection();
-  }
-
-  if(initialized)
-  {
-    // Framework already initialized - don't add new log files for each test instance
-    // The logger was already initialized during the first initFramework call
-    // Adding multiple log files for different test instances would cause confusion
-    // and waste resources. The duplicate detection in asirikuyLoggerInit will prevent
-    // opening the same file twice, but we shouldn't even try to add new files here.
-    logInfo("initFramework: Framework already initialized, skipping log file addition (logger already configured)\n");
-    initializing = FALSE;
-    return (int)SUCCESS;
-  }
-
-  if(pAsirikuyConfig == NULL)
-  {
-    logError("initFramework: pAsirikuyConfig is NULL\n");
-    initializing = FALSE;
-    return (int)INVALID_CONFIG;
-  }
-
-  strcpy(config.configFileName, pAsirikuyConfig);
-  // Pantheios removed - severity level no longer needed
-  // config.loggingConfig.severityLevel = PANTHEIOS_SEV_NOTICE;
-  config.ratesBufferExtension = DEFAULT_RATES_BUF_EXT;
-  logInfo("initFramework: Parsing config file: %s\n", pAsirikuyConfig);
-  result = parseConfigFile(&config);
-  if(result != SUCCESS)
-  {
-    logError("initFramework: Failed to parse config, result: %d\n", result);
-    initializing = FALSE;
-    return (int)result;
-  }
-
-  seedRand();
-
-  // Initialize the AsirikuyLogger with log file path from config
-  // Note: Logger now supports multiple files, so this will add the Framework log file
-  // alongside any existing log files (e.g., CTester log)
-  char logFilePath[MAX_FILE_PATH_CHARS] = "";
-  logInfo("initFramework: Log folder from config: '%s', length: %zu\n", 
-           config.loggingConfig.logFolder, strlen(config.loggingConfig.logFolder));
-  if(strlen(config.loggingConfig.logFolder) > 0)
-  {
-    strcpy(logFilePath, config.loggingConfig.logFolder);
-    strcat(logFilePath, "/");
-    if(pAccountName != NULL && strlen(pAccountName) > 0)
-    {
-      strcat(logFilePath, pAccountName);
-    }
-    strcat(logFilePath, LOG_FILENAME);
-    logInfo("initFramework: Adding Framework log file: %s\n", logFilePath);
-    // Add Framework log file to logger (logger supports multiple files now)
-    int loggerResult = asirikuyLoggerInit(logFilePath, config.loggingConfig.severityLevel);
-    logNotice("AsirikuyFramework logger initialized to: %s (logger result: %d)\n", logFilePath, loggerResult);
-  }
-  else
-  {
-    logWarning("initFramework: No log folder configured, using stderr only\n");
-    // If no log folder configured, initialize logger without file (stderr only)
-    asirikuyLoggerInit(NULL, config.loggingConfig.severityLevel);
-  }
-  
-  logNotice("AsirikuyFramework initialized.\n");
-
-  retCode = TA_Initialize();
-  if(retCode != TA_SUCCESS)
-  {
-    logTALibError("initFramework()", retCode);
-    initializing = FALSE;
-    return (int)TA_LIB_ERROR;
-  }
-  logNotice("TA-Lib initialized.\n");
-
-  strcat(brokerTZPath, config.configFilePaths.configFolderPath);
-  strcat(brokerTZPath, "/");
-  strcat(brokerTZPath, config.configFilePaths.brokerTzFileName);
-  result = parseTimezoneConfig(brokerTZPath);
-  if(result != SUCCESS)
-  {
-    logAsirikuyError("initFramework()", result);
-    initializing = FALSE;
-    return (int)result;
-  }
-  logNotice("Loaded broker timezone configuration.\n");
-
-  setExtendedBufferSize(config.ratesBufferExtension);
-  resetAllRatesBuffers();
-  logNotice("Rates buffers initialized.\n");
-
-  initEquityLog(config.loggingConfig.enableEquityLog, config.loggingConfig.logFolder);
-  initializeInstanceStates(config.tempFileFolderPath);
-
-  initExtendedEntryBarLog(config.loggingConfig.enableEntryLog, config.loggingConfig.entryBarNumber,config.loggingConfig.logFolder);
-
-  setNtpUpdateInterval(config.ntpConfig.updateInterval);
-  setNtpTimeout(config.ntpConfig.timeout);
-  setTotalNtpReferenceTimes(config.ntpConfig.totalReferenceTimes);
-  logNotice("NTPClient initialized.\n");
-
-  setTempFileFolderPath(config.tempFileFolderPath);
-  setTradingWeekBoundaries(config.cropMondayHours, config.cropFridayHours);
-
-  initialized  = TRUE;
-  initializing = FALSE;
-  logNotice("Framework initialization complete.\n");
-  return (int)SUCCESS;
-}
 
 static int initInstance(int instanceId, int isTesting, char* pAsirikuyConfig, char* pAccountName)
 {
@@ -231,12 +53,13 @@ static int initInstance(int instanceId, int isTesting, char* pAsirikuyConfig, ch
           instanceId, isTesting, pAsirikuyConfig ? pAsirikuyConfig : "NULL", 
           pAccountName ? pAccountName : "NULL");
   
-  int returnCode = initFramework(pAsirikuyConfig, pAccountName);
+  const FrameworkContext* pContext;
+  int returnCode = (int)acquireFrameworkContext(pAsirikuyConfig, pAccountName, &pContext);
   
-  logInfo("initInstance: initFramework returned %d\n", returnCode);
+  logInfo("initInstance: acquireFrameworkContext returned %d\n", returnCode);
   if(returnCode != SUCCESS)
   {
-    logError("initInstance: initFramework failed with code %d\n", returnCode);
+    logError("initInstance: acquireFrameworkContext failed with code %d\n", returnCode);
     return returnCode;
   }
 
@@ -46,6 +46,7 @@
 #include "InstanceStates.h"
 #include "TradingWeekBoundaries.h"
 #include "CTesterParameters.h"
+#include "RunArena.h"
 #include "MQLDefines.h"
 
 typedef struct oldTickVolume_t
@@ -935,6 +936,9 @@ AsirikuyReturnCode convertCParameters(
   return convertRatesArraysC(pParams, &tzOffsets, pCRatesInfo, pCRates_0, pCRates_1, pCRates_2, pCRates_3, pCRates_4, pCRates_5, pCRates_6, pCRates_7, pCRates_8, pCRates_9);
 }
 
+/* One per thread: c_runStrategy runs concurrently on every optimizer thread */
+static THREAD_LOCAL RunArena orderInfoArena;
+
 AsirikuyReturnCode allocateOrderInfoC(StrategyParams* pParams, int orderInfoArraySize)
 {
   if(pParams == NULL)
@@ -943,7 +947,13 @@ AsirikuyReturnCode allocateOrderInfoC(StrategyParams* pParams, int orderInfoArra
     return NULL_POINTER;
   }
 
-  pParams->orderInfo = (OrderInfo*)malloc(orderInfoArraySize * sizeof(OrderInfo));
+  resetRunArena(&orderInfoArena);
+  pParams->orderInfo = (OrderInfo*)runArenaAlloc(&orderInfoArena, orderInfoArraySize * sizeof(OrderInfo));
+  if(pParams->orderInfo == NULL)
+  {
+    logCritical("allocateOrderInfo() failed. Unable to allocate %d orders", orderInfoArraySize);
+    return INSUFFICIENT_MEMORY;
+  }
   
   return SUCCESS;
 }
@@ -956,11 +966,12 @@ AsirikuyReturnCode freeOrderInfoC(StrategyParams* pParams)
     return NULL_POINTER;
   }
 
-  if(pParams->orderInfo)
-  {
-    free(pParams->orderInfo);
-    pParams->orderInfo = NULL;
-  }
+  pParams->orderInfo = NULL;
 
   return SUCCESS;
+}
+
+void releaseOrderInfoC()
+{
+  freeRunArena(&orderInfoArena);
 }
\ No newline at end of file
@@ -45,6 +45,7 @@
 #include "Logging.h"
 #include "AsirikuyStrategies.h"
 #include "StrategyUserInterface.h"
+#include "EasyTradeCWrapper.hpp"
 
 static AsirikuyReturnCode verifyPointers(
   double*       pInSettings,
@@ -139,7 +140,7 @@ extern "C" {
       return result;
     }
 
-    result = allocateOrderInfo(&params, (int)pInSettings[ORDERINFO_ARRAY_SIZE]);
+    result = allocateOrderInfoC(&params, (int)pInSettings[ORDERINFO_ARRAY_SIZE]);
 
     if(result == SUCCESS)
     {
@@ -157,11 +158,11 @@ extern "C" {
     if(result != SUCCESS)
     {
       logAsirikuyError("c_runStrategy()", (AsirikuyReturnCode)result);
-      freeOrderInfo(&params);
+      freeOrderInfoC(&params);
       return result;
     }
 
-    result = freeOrderInfo(&params);
+    result = freeOrderInfoC(&params);
     if(result != SUCCESS)
     {
       logAsirikuyError("c_runStrategy()", (AsirikuyReturnCode)result);
@@ -174,6 +175,13 @@ extern "C" {
     return result;
   }
 
+  void __stdcall c_releaseStrategyScratch()
+  {
+    releaseOrderInfoC();
+    releaseIndicatorCachesEasy();
+    releaseThreadIndicatorStatesEasy();
+  }
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
\ No newline at end of file
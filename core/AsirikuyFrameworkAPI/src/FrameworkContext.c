@@ -0,0 +1,234 @@
+/**
+ * @file
+ * @brief     The framework context shared by every instance.
+ * @details   The context is created once from the framework config file, on the first instance
+ * @details   initialization. Threads that initialize instances at the same time wait for it
+ * @details   instead of returning WAIT_FOR_INIT, and all of them get the same result.
+ * @details   Once created the context is never modified, so it can be read without a lock.
+ * @details   Code in this library reads the config from the context. The libraries it links
+ * @details   (logger, TA-Lib, rates buffers, instance states, strategies, order management) keep
+ * @details   their own settings, since they cannot depend on this library. For them the context
+ * @details   only makes sure they are initialized once, before any instance runs.
+ * 
+ * @version   F4.x.x
+ * @date      2026
+ *
+ * @copyright END-USER LICENSE AGREEMENT FOR ASIRIKUY SOFTWARE. IMPORTANT PLEASE READ THE TERMS AND CONDITIONS OF THIS LICENSE AGREEMENT CAREFULLY BEFORE USING THIS SOFTWARE: 
+ * @copyright Asirikuy's End-User License Agreement ("EULA") is a legal agreement between you (either an individual or a single entity) and Asirikuy for the use of the Asirikuy Framework in both source and binary forms. By installing, copying, or otherwise using the Asirikuy Framework, you agree to be bound by the terms of this EULA. This license agreement represents the entire agreement concerning the program between you and Asirikuy, (referred to as "licenser"), and it supersedes any prior proposal, representation, or understanding between the parties. If you do not agree to the terms of this EULA, do not install or use the Asirikuy Framework.
+ * @copyright The Asirikuy Framework is protected by copyright laws and international copyright treaties, as well as other intellectual property laws and treaties. The Asirikuy Framework is licensed, not sold.
+ * @copyright 1. GRANT OF LICENSE.
+ * @copyright The Asirikuy Framework is licensed as follows:
+ * @copyright (a) Installation and Use.
+ * @copyright Asirikuy grants you the right to install and use copies of the Asirikuy Framework in both source and binary forms for personal and business use. You may also make modifications to the source code.
+ * @copyright (b) Backup Copies.
+ * @copyright You may make copies of the Asirikuy Framework as may be necessary for backup and archival purposes.
+ * @copyright 2. DESCRIPTION OF OTHER RIGHTS AND LIMITATIONS.
+ * @copyright (a) Maintenance of Copyright Notices.
+ * @copyright You must not remove or alter any copyright notices on any and all copies of the Asirikuy Framework.
+ * @copyright (b) Distribution.
+ * @copyright You may not distribute copies of the Asirikuy Framework in binary or source forms to third parties outside of the Asirikuy community.
+ * @copyright (c) Rental.
+ * @copyright You may not rent, lease, or lend the Asirikuy Framework.
+ * @copyright (d) Compliance with Applicable Laws.
+ * @copyright You must comply with all applicable laws regarding use of the Asirikuy Framework.
+ * @copyright 3. TERMINATION
+ * @copyright Without prejudice to any other rights, Asirikuy may terminate this EULA if you fail to comply with the terms and conditions of this EULA. In such event, you must destroy all copies of the Asirikuy Framework in your possession.
+ * @copyright 4. COPYRIGHT
+ * @copyright All title, including but not limited to copyrights, in and to the Asirikuy Framework and any copies thereof are owned by Asirikuy or its suppliers. All title and intellectual property rights in and to the content which may be accessed through use of the Asirikuy Framework is the property of the respective content owner and may be protected by applicable copyright or other intellectual property laws and treaties. This EULA grants you no rights to use such content. All rights not expressly granted are reserved by Asirikuy.
+ * @copyright 5. NO WARRANTIES
+ * @copyright Asirikuy expressly disclaims any warranty for the Asirikuy Framework. The Asirikuy Framework is provided 'As Is' without any express or implied warranty of any kind, including but not limited to any warranties of merchantability, noninfringement, or fitness of a particular purpose. Asirikuy does not warrant or assume responsibility for the accuracy or completeness of any information, text, graphics, links or other items contained within the Asirikuy Framework. Asirikuy makes no warranties respecting any harm that may be caused by the transmission of a computer virus, worm, time bomb, logic bomb, or other such computer program. Asirikuy further expressly disclaims any warranty or representation to Authorized Users or to any third party.
+ * @copyright 6. LIMITATION OF LIABILITY
+ * @copyright In no event shall Asirikuy or any contributors to the Asirikuy Framework be liable for any damages (including, without limitation, lost profits, business interruption, or lost information) rising out of 'Authorized Users' use of or inability to use the Asirikuy Framework, even if Asirikuy has been advised of the possibility of such damages. In no event will Asirikuy or any contributors to the Asirikuy Framework be liable for loss of data or for indirect, special, incidental, consequential (including lost profit), or other damages based in contract, tort or otherwise. Asirikuy and contributors to the Asirikuy Framework shall have no liability with respect to the content of the Asirikuy Framework or any part thereof, including but not limited to errors or omissions contained therein, libel, infringements of rights of publicity, privacy, trademark rights, business interruption, personal injury, loss of privacy, moral rights or the disclosure of confidential information.
+ */
+
+#include "Precompiled.h"
+#include "AsirikuyLogger.h"
+
+#if defined __APPLE__ || defined __linux__
+  #include <sys/time.h>
+  #include <pthread.h>
+#endif
+
+#include <ta_libc.h>
+
+#include "FrameworkContext.h"
+#include "StrategyUserInterface.h"
+#include "Broker-tz.h"
+#include "TimeZoneOffsets.h"
+#include "ContiguousRatesCircBuf.h"
+#include "Logging.h"
+#include "EquityLog.h"
+#include "InstanceStates.h"
+#include "NTPCWrapper.hpp"
+
+#define LOG_FILENAME "AsirikuyFramework.log"
+
+/* Statically initialized, so it does not depend on the library load order */
+#if defined _WIN32 || defined _WIN64
+  static SRWLOCK gContextLock = SRWLOCK_INIT;
+  #define lockContext()                   AcquireSRWLockExclusive(&gContextLock)
+  #define unlockContext()                 ReleaseSRWLockExclusive(&gContextLock)
+  #define loadContext()                   ((const FrameworkContext*)InterlockedCompareExchangePointer((PVOID volatile*)&gpPublishedContext, NULL, NULL))
+  #define publishContext(pContext)        InterlockedExchangePointer((PVOID volatile*)&gpPublishedContext, (PVOID)(pContext))
+#elif defined __APPLE__ || defined __linux__
+  static pthread_mutex_t gContextLock = PTHREAD_MUTEX_INITIALIZER;
+  #define lockContext()                   pthread_mutex_lock(&gContextLock)
+  #define unlockContext()                 pthread_mutex_unlock(&gContextLock)
+  #define loadContext()                   __atomic_load_n(&gpPublishedContext, __ATOMIC_ACQUIRE)
+  #define publishContext(pContext)        __atomic_store_n(&gpPublishedContext, (pContext), __ATOMIC_RELEASE)
+#else
+  #error "Unsupported operating system"
+#endif
+
+static FrameworkContext        gFrameworkContext;
+/* NULL until gFrameworkContext is fully created */
+static const FrameworkContext* gpPublishedContext = NULL;
+
+static void seedRand()
+{
+#if defined _WIN32 || defined _WIN64
+  srand(GetTickCount());
+#elif defined __APPLE__ || defined __linux__
+  struct timeval t1;
+  gettimeofday(&t1, NULL);
+  srand(t1.tv_usec * t1.tv_sec);
+#else
+#  error "Unsupported operating system"
+#endif
+}
+
+static void initFrameworkLogger(const FrameworkContext* pContext)
+{
+  char logFilePath[MAX_FILE_PATH_CHARS] = "";
+
+  // Note: Logger supports multiple files, so this adds the Framework log file
+  // alongside any existing log files (e.g., CTester log)
+  logInfo("initFrameworkLogger: Log folder from config: '%s', length: %zu\n", 
+           pContext->config.loggingConfig.logFolder, strlen(pContext->config.loggingConfig.logFolder));
+  if(strlen(pContext->config.loggingConfig.logFolder) > 0)
+  {
+    strcpy(logFilePath, pContext->config.loggingConfig.logFolder);
+    strcat(logFilePath, "/");
+    strcat(logFilePath, pContext->accountName);
+    strcat(logFilePath, LOG_FILENAME);
+    logInfo("initFrameworkLogger: Adding Framework log file: %s\n", logFilePath);
+    int loggerResult = asirikuyLoggerInit(logFilePath, pContext->config.loggingConfig.severityLevel);
+    logNotice("AsirikuyFramework logger initialized to: %s (logger result: %d)\n", logFilePath, loggerResult);
+  }
+  else
+  {
+    logWarning("initFrameworkLogger: No log folder configured, using stderr only\n");
+    asirikuyLoggerInit(NULL, pContext->config.loggingConfig.severityLevel);
+  }
+}
+
+/* Called with the context lock held, before the context is published */
+static AsirikuyReturnCode createFrameworkContext(FrameworkContext* pContext, const char* pAsirikuyConfig, const char* pAccountName)
+{
+  AsirikuyReturnCode result;
+  TA_RetCode retCode;
+  char brokerTZPath[MAX_FILE_PATH_CHARS] = "";
+
+  memset(pContext, 0, sizeof(FrameworkContext));
+  strcpy(pContext->config.configFileName, pAsirikuyConfig);
+  if(pAccountName != NULL)
+  {
+    strcpy(pContext->accountName, pAccountName);
+  }
+
+  pContext->config.ratesBufferExtension = DEFAULT_RATES_BUF_EXT;
+  logInfo("createFrameworkContext: Parsing config file: %s\n", pAsirikuyConfig);
+  result = parseConfigFile(&pContext->config);
+  if(result != SUCCESS)
+  {
+    logError("createFrameworkContext: Failed to parse config, result: %d\n", result);
+    return result;
+  }
+
+  seedRand();
+  initFrameworkLogger(pContext);
+  logNotice("AsirikuyFramework initialized.\n");
+
+  retCode = TA_Initialize();
+  if(retCode != TA_SUCCESS)
+  {
+    logTALibError("createFrameworkContext()", retCode);
+    return TA_LIB_ERROR;
+  }
+  logNotice("TA-Lib initialized.\n");
+
+  strcat(brokerTZPath, pContext->config.configFilePaths.configFolderPath);
+  strcat(brokerTZPath, "/");
+  strcat(brokerTZPath, pContext->config.configFilePaths.brokerTzFileName);
+  result = parseTimezoneConfig(brokerTZPath);
+  if(result != SUCCESS)
+  {
+    logAsirikuyError("createFrameworkContext()", result);
+    return result;
+  }
+  logNotice("Loaded broker timezone configuration.\n");
+
+  setExtendedBufferSize(pContext->config.ratesBufferExtension);
+  resetAllRatesBuffers();
+  logNotice("Rates buffers initialized.\n");
+
+  initEquityLog(pContext->config.loggingConfig.enableEquityLog, pContext->config.loggingConfig.logFolder);
+  initializeInstanceStates(pContext->config.tempFileFolderPath);
+
+  initExtendedEntryBarLog(pContext->config.loggingConfig.enableEntryLog, pContext->config.loggingConfig.entryBarNumber, pContext->config.loggingConfig.logFolder);
+
+  setNtpUpdateInterval(pContext->config.ntpConfig.updateInterval);
+  setNtpTimeout(pContext->config.ntpConfig.timeout);
+  setTotalNtpReferenceTimes(pContext->config.ntpConfig.totalReferenceTimes);
+  logNotice("NTPClient initialized.\n");
+
+  setTempFileFolderPath(pContext->config.tempFileFolderPath);
+
+  logNotice("Framework initialization complete.\n");
+  return SUCCESS;
+}
+
+AsirikuyReturnCode acquireFrameworkContext(const char* pAsirikuyConfig, const char* pAccountName, const FrameworkContext** ppContext)
+{
+  const FrameworkContext* pContext = loadContext();
+  AsirikuyReturnCode result = SUCCESS;
+
+  if(ppContext == NULL)
+  {
+    logCritical("acquireFrameworkContext() failed. ppContext = NULL");
+    return NULL_POINTER;
+  }
+
+  if(pContext == NULL)
+  {
+    lockContext();
+    pContext = loadContext();
+    if(pContext == NULL)
+    {
+      if(pAsirikuyConfig == NULL)
+      {
+        logError("acquireFrameworkContext: pAsirikuyConfig is NULL\n");
+        result = INVALID_CONFIG;
+      }
+      else
+      {
+        result = createFrameworkContext(&gFrameworkContext, pAsirikuyConfig, pAccountName);
+      }
+
+      if(result == SUCCESS)
+      {
+        pContext = &gFrameworkContext;
+        publishContext(pContext);
+      }
+    }
+    unlockContext();
+  }
+
+  *ppContext = pContext;
+  return result;
+}
+
+const FrameworkContext* getFrameworkContext()
+{
+  return loadContext();
+}
@@ -38,15 +38,8 @@
 #include "AsirikuyLogger.h"
 #include "TradingWeekBoundaries.h"
 #include "AsirikuyTime.h"
-
-static int gCropMondayHours = 4;
-static int gCropFridayHours = 4;
-
-void setTradingWeekBoundaries(int cropMondayHours, int cropFridayHours)
-{
-  gCropMondayHours = cropMondayHours;
-  gCropFridayHours = cropFridayHours;
-}
+#include "AsirikuyConfig.h"
+#include "FrameworkContext.h"
 
 BOOL isWeekend(time_t time)
 {
@@ -86,8 +79,16 @@ BOOL isOutsideTradingBoundaries(StrategyParams* pParams,time_t time)
 
 BOOL isOutsideTradingWeekBoundaries(time_t time)
 {
+	const FrameworkContext* pContext = getFrameworkContext();
 	struct tm * timeStructure;
 	char       timeString[MAX_TIME_STRING_SIZE] = "";
+	int        cropMondayHours = DEFAULT_CROP_HOURS, cropFridayHours = DEFAULT_CROP_HOURS;
+
+	if(pContext != NULL)
+	{
+		cropMondayHours = pContext->config.cropMondayHours;
+		cropFridayHours = pContext->config.cropFridayHours;
+	}
 
 	#if defined _MSC_VER
 		timeStructure = gmtime(&time);
@@ -100,12 +101,12 @@ BOOL isOutsideTradingWeekBoundaries(time_t time)
 
 	logDebug("isOutsideTradingWeekBoundaries() PassedDate = %s Day of week: %d, Hour: %d\n", timeString, timeStructure->tm_wday, timeStructure->tm_hour);
 
-	if((timeStructure->tm_wday == MONDAY) && (timeStructure->tm_hour < gCropMondayHours))
+	if((timeStructure->tm_wday == MONDAY) && (timeStructure->tm_hour < cropMondayHours))
   {
 		return TRUE;
   }
  
-	if((timeStructure->tm_wday == FRIDAY) && (timeStructure->tm_hour > (23 - gCropFridayHours)))
+	if((timeStructure->tm_wday == FRIDAY) && (timeStructure->tm_hour > (23 - cropFridayHours)))
   {
 		return TRUE;
   }
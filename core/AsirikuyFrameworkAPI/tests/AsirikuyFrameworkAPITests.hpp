@@ -39,16 +39,82 @@
 #endif
 
 #include <string>
+#include <sstream>
+#include <fstream>
 #include <stdio.h>
 
 #include <boost/test/unit_test.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/path.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/barrier.hpp>
 
 #include "AsirikuyDefines.h"
 #include "MQLDefines.h"
 #include "AsirikuyConfig.h"
 #include "AsirikuyFrameworkAPI.h"
+#include "FrameworkContext.h"
+
+namespace
+{
+  struct ContextAcquisition
+  {
+    int                     result;
+    const FrameworkContext* pContext;
+  };
+
+  void acquireMissingFrameworkContext(ContextAcquisition* pAcquisition)
+  {
+    pAcquisition->pContext = NULL;
+    pAcquisition->result   = (int)acquireFrameworkContext("missing framework config.xml", "", &pAcquisition->pContext);
+  }
+
+  struct ValidContextAcquisition
+  {
+    std::string             configFileName;
+    int                     result;
+    const FrameworkContext* pContext;
+    std::string             parsedConfigFileName; /* The context as this caller first saw it */
+    int                     parsedCropMondayHours;
+  };
+
+  /* A valid config in folder, cropping cropMondayHours on Mondays, with the broker timezones next to it */
+  std::string writeFrameworkConfig(const boost::filesystem::path& folder, int cropMondayHours)
+  {
+    std::ostringstream name;
+    name << "AsirikuyConfig" << cropMondayHours << ".xml";
+    std::string configFileName = (folder / name.str()).generic_string();
+    std::ofstream config(configFileName.c_str());
+
+    config << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           << "<RatesBufferExtension>10</RatesBufferExtension>\n"
+           << "<TempFileFolderPath>" << folder.generic_string() << "</TempFileFolderPath>\n"
+           << "<ConfigPaths><ConfigFolderPath>" << folder.generic_string() << "</ConfigFolderPath>"
+           << "<BrokerTZFilename>broker-tz.csv</BrokerTZFilename><ParamSpaceFilenameExtension>.set</ParamSpaceFilenameExtension></ConfigPaths>\n"
+           << "<Logging><Folder>" << folder.generic_string() << "</Folder><MaxSeverity>3</MaxSeverity><EnableEquityLog>0</EnableEquityLog>"
+           << "<EnableEntryLog>0</EnableEntryLog><barsToLog>1</barsToLog></Logging>\n"
+           << "<TradingWeekBoundaries><CropMondayHours>" << cropMondayHours << "</CropMondayHours><CropFridayHours>4</CropFridayHours></TradingWeekBoundaries>\n";
+
+    std::ofstream brokerTimezones((folder / "broker-tz.csv").generic_string().c_str());
+    brokerTimezones << "\"Broker\";\"DSTStartMonth\";\"DSTStartNth\";\"DSTStartDay\";\"DSTStartTime\";\"DSTEndMonth\";\"DSTEndNth\";\"DSTEndDay\";\"DSTEndTime\";"
+                    << "\"GMTOffsetStd\";\"GMTOffsetDST\";\"WeekStartDay\";\"WeekStartHour\";\"WeekEndDay\";\"WeekEndHour\"\n"
+                    << "\"UTC\";0;0;0;\"00:00\";0;0;0;\"00:00\";0;0;1;\"00:00\";6;\"00:00\"\n";
+
+    return configFileName;
+  }
+
+  void acquireValidFrameworkContext(ValidContextAcquisition* pAcquisition, boost::barrier* pStart)
+  {
+    pAcquisition->pContext = NULL;
+    pStart->wait();
+    pAcquisition->result = (int)acquireFrameworkContext(pAcquisition->configFileName.c_str(), "", &pAcquisition->pContext);
+    if(pAcquisition->pContext != NULL)
+    {
+      pAcquisition->parsedConfigFileName  = pAcquisition->pContext->config.configFileName;
+      pAcquisition->parsedCropMondayHours = pAcquisition->pContext->config.cropMondayHours;
+    }
+  }
+}
 
 BOOST_AUTO_TEST_SUITE(Asirikuy_Framework_API)
 
@@ -82,4 +148,73 @@ BOOST_AUTO_TEST_CASE(parseConfigFile_spaces_forwardslashes)
   //BOOST_CHECK(result == SUCCESS);
 }
 
+BOOST_AUTO_TEST_CASE(frameworkContext_concurrent_first_calls_wait_for_the_same_result)
+{
+  const int numThreads = 8;
+  const FrameworkContext* pExistingContext = getFrameworkContext();
+  ContextAcquisition acquisitions[numThreads];
+  boost::thread_group threads;
+
+  for(int i = 0; i < numThreads; i++)
+  {
+    threads.add_thread(new boost::thread(acquireMissingFrameworkContext, &acquisitions[i]));
+  }
+  threads.join_all();
+
+  /* No caller is told to come back later. If another test already created the context every caller
+     gets it and the missing config is ignored, otherwise every caller fails and no context is left behind */
+  for(int i = 0; i < numThreads; i++)
+  {
+    BOOST_CHECK_EQUAL(acquisitions[i].result, pExistingContext != NULL ? (int)SUCCESS : (int)MISSING_CONFIG);
+    BOOST_CHECK(acquisitions[i].pContext == pExistingContext);
+  }
+  BOOST_CHECK(getFrameworkContext() == pExistingContext);
+}
+
+BOOST_AUTO_TEST_CASE(frameworkContext_concurrent_first_calls_share_one_parsed_config)
+{
+  const int numThreads = 8;
+  const FrameworkContext* pExistingContext = getFrameworkContext();
+  boost::filesystem::path folder = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("asirikuy-context-%%%%%%%%");
+  ValidContextAcquisition acquisitions[numThreads];
+  boost::barrier start(numThreads);
+  boost::thread_group threads;
+
+  boost::filesystem::create_directories(folder);
+  for(int i = 0; i < numThreads; i++)
+  {
+    acquisitions[i].configFileName = writeFrameworkConfig(folder, i + 1);
+    threads.add_thread(new boost::thread(acquireValidFrameworkContext, &acquisitions[i], &start));
+  }
+  threads.join_all();
+
+  /* Every caller, each with its own config, gets the one context. It was parsed once: no caller saw
+     a config that a later parse replaced */
+  const FrameworkContext* pContext = getFrameworkContext();
+  BOOST_REQUIRE(pContext != NULL);
+  if(pExistingContext != NULL)
+  {
+    BOOST_CHECK(pContext == pExistingContext);
+  }
+  else
+  {
+    BOOST_REQUIRE(pContext->config.cropMondayHours >= 1 && pContext->config.cropMondayHours <= numThreads);
+    BOOST_CHECK_EQUAL(pContext->config.configFileName, acquisitions[pContext->config.cropMondayHours - 1].configFileName);
+  }
+  for(int i = 0; i < numThreads; i++)
+  {
+    BOOST_CHECK_EQUAL(acquisitions[i].result, (int)SUCCESS);
+    BOOST_CHECK(acquisitions[i].pContext == pContext);
+    BOOST_CHECK_EQUAL(acquisitions[i].parsedConfigFileName, pContext->config.configFileName);
+    BOOST_CHECK_EQUAL(acquisitions[i].parsedCropMondayHours, pContext->config.cropMondayHours);
+  }
+
+  /* Later calls do not parse their config either */
+  std::string parsedConfigFileName = pContext->config.configFileName;
+  const FrameworkContext* pLaterContext = NULL;
+  BOOST_CHECK_EQUAL((int)acquireFrameworkContext(writeFrameworkConfig(folder, numThreads + 1).c_str(), "", &pLaterContext), (int)SUCCESS);
+  BOOST_CHECK(pLaterContext == pContext);
+  BOOST_CHECK_EQUAL(pContext->config.configFileName, parsedConfigFileName);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
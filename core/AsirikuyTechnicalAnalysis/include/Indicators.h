@@ -49,6 +49,72 @@
 extern "C" {
 #endif
 
+/* calculateSMI() needs a workspace of SMI_WORKSPACE_SERIES * arraySize doubles */
+#define SMI_WORKSPACE_SERIES 9
+
+#define INDICATOR_HISTORY_BARS    512  /* iMACDTrendBeiLi reads 300 bars back */
+#define INDICATOR_HISTORY_VALUES  3
+#define INDICATOR_HISTORY_MISSING -1
+
+/**
+* The values of an indicator on the latest closed bars, see alignIndicatorHistory().
+*
+* The bars are consecutive, the newest one in slot newestSlot. Each bar is identified by its
+* open time and close, so the history can be found again in a rates array that moved on.
+*/
+typedef struct indicator_history_t
+{
+  int    numBars;
+  int    newestSlot;
+  time_t times[INDICATOR_HISTORY_BARS];
+  double closes[INDICATOR_HISTORY_BARS];
+  int    hasValues[INDICATOR_HISTORY_BARS];  /* FALSE where the bar had too little history for the indicator */
+  double values[INDICATOR_HISTORY_BARS][INDICATOR_HISTORY_VALUES];
+} IndicatorHistory;
+
+/**
+* Trend/stop state machine of a Bollinger Band stop after a bar.
+*/
+typedef struct bband_stop_machine_t
+{
+  double upLimit;
+  double downLimit;
+  int    trend;          /* 1 = up, -1 = down, 0 = no trend yet */
+  double stopPrice;
+  int    trendBar;       /* Bar the trend started on, counted from the reset. -1 = no trend yet */
+  int    isHalted;       /* A zero upper band stops the stop, as it did in the full recompute */
+} BBandStopMachine;
+
+/**
+* Bands of one bar and the stop since the reset after it.
+*/
+typedef struct bband_stop_bar_t
+{
+  double           upper;
+  double           lower;
+  BBandStopMachine machine;
+} BBandStopBar;
+
+/**
+* State of an incremental Bollinger Band stop, see calculateBBandStop().
+*
+* Call resetBBandStop() before the first use and freeBBandStop() after the last. The running
+* sums follow the arithmetic of TA_BBANDS with a simple moving average, so the bands match TA-Lib's.
+*/
+typedef struct bband_stop_state_t
+{
+  int              period;
+  double           deviation;
+  int              barsProcessed;  /* Closed bars processed since the last reset, 0 = not started */
+  time_t           lastBarTime;    /* Open time and close of the last processed bar, to find it again */
+  double           lastClose;
+  double           periodTotal;    /* Sum of the last period - 1 closes */
+  double           periodTotal2;   /* and of their squares */
+  BBandStopMachine machine;        /* The stop since the reset */
+  BBandStopBar*    pBars;          /* The last barsCapacity bars, bar n at pBars[n % barsCapacity] */
+  int              barsCapacity;
+} BBandStopState;
+
 /**
 * A Keltner Channels indicator.
 *
@@ -162,6 +228,260 @@ AsirikuyReturnCode barsToPreviousTime(const time_t* barOpenTimes, time_t time, i
 */
 AsirikuyReturnCode calculateUltimateOscillator(const double* pHigh, const double* pLow, const double* pClose, int arraySize, int fastPeriod, int middlePeriod, int slowPeriod, int fastK, int middleK, int slowK, int shift, double* pOutUltimateOscillator);
 
+/**
+* Initializes a Bollinger Band stop state so the next calculateBBandStop() call starts over.
+* The state must not hold bars yet, use freeBBandStop() for a state that was used.
+*
+* @param BBandStopState* pState
+*   The state to initialize.
+*/
+void resetBBandStop(BBandStopState* pState);
+
+/**
+* Frees the bars a Bollinger Band stop state holds and resets it.
+*
+* @param BBandStopState* pState
+*   The state to free.
+*/
+void freeBBandStop(BBandStopState* pState);
+
+/**
+* A Bollinger Band stop, updated incrementally.
+*
+* The result is the one of the BBS trend/stop state machine started at the oldest bar of the
+* arrays and run over the closed bars (all but the last one), as the full recompute did.
+*
+* The state keeps the bands and the stop since the reset for every bar of the arrays, so a call
+* with one new bar computes only that bar's bands. The stop of the arrays is then replayed from
+* the oldest bar on the stored bands until it reaches the same state as the stop since the reset,
+* which normally takes a trend change or two. Everything is recomputed from the start of the
+* arrays when the last processed bar is no longer in the arrays, the period or deviation changed,
+* or the older closes a new band needs have dropped out (a history reset).
+*
+* @param BBandStopState* pState
+*   The state kept between calls, one per series, period and deviation.
+*
+* @param const time_t* pTime
+*   Array of bar open times. pTime[0] is the oldest bar, pTime[arraySize - 1] is the most recent bar.
+*
+* @param const double* pClose
+*   Array of bar closing prices. pClose[0] is the oldest bar, pClose[arraySize - 1] is the most recent bar.
+*
+* @param int arraySize
+*   The size of the time and close arrays.
+*
+* @param int period
+*   The number of bars of the Bollinger Bands (2 or more).
+*
+* @param double deviation
+*   The number of standard deviations between the middle and the upper/lower band.
+*
+* @param int* pOutTrend
+*   A pointer to the location to store the trend. 1 = up, -1 = down, 0 = none yet.
+*
+* @param double* pOutStopPrice
+*   A pointer to the location to store the stop price, 0 without a trend.
+*
+* @param int* pOutIndex
+*   A pointer to the location to store the array index of the bar the trend started on. Left unchanged without a trend.
+*
+* @return AsirikuyReturnCode
+*   An enum indicating success or the type of failure that occured.
+*/
+AsirikuyReturnCode calculateBBandStop(BBandStopState* pState, const time_t* pTime, const double* pClose, int arraySize, int period, double deviation, int* pOutTrend, double* pOutStopPrice, int* pOutIndex);
+
+/**
+* The Stochastic Momentum Index.
+*
+* The distance of the close from the middle of the highest high and lowest low of periodQ
+* bars (SM) and that range (HQ) are smoothed twice, over periodR and periodS bars. The SMI
+* is 200 * SM / HQ, its value is smoothed over signalPeriod + 1 bars.
+*
+* Each smoothing is what TA_MA with TA_MAType_EMA returns for a single bar: the simple
+* average of the period bars unstablePeriod bars back, followed by unstablePeriod EMA steps
+* (with no unstable period that is a simple moving average). It is kept as running sums
+* over a single pass through the arrays.
+*
+* @param const double* pHigh
+*   Array of bar highs. pHigh[0] is the oldest bar, pHigh[arraySize - 1] is the most recent bar.
+*
+* @param const double* pLow
+*   Array of bar lows. pLow[0] is the oldest bar, pLow[arraySize - 1] is the most recent bar.
+*
+* @param const double* pClose
+*   Array of bar closing prices. pClose[0] is the oldest bar, pClose[arraySize - 1] is the most recent bar.
+*
+* @param int arraySize
+*   The size of the high, low, and close arrays.
+*
+* @param int periodQ
+*   The number of bars of the highest high and lowest low.
+*
+* @param int periodR
+*   The number of bars of the first smoothing.
+*
+* @param int periodS
+*   The number of bars of the second smoothing.
+*
+* @param int signalPeriod
+*   The number of bars of the signal smoothing, minus one.
+*
+* @param int unstablePeriod
+*   The TA-Lib EMA unstable period the smoothings follow.
+*
+* @param int shift
+*   The bar of the value, counted from the end of the arrays. 1 is the most recent bar.
+*
+* @param double* pWorkspace
+*   Room for SMI_WORKSPACE_SERIES * arraySize doubles. It can be reused between calls.
+*
+* @param double* pOutSMI
+*   A pointer to the location to store the SMI signal, 0 when there are not enough bars for it.
+*
+* @return AsirikuyReturnCode
+*   An enum indicating success or the type of failure that occured.
+*/
+AsirikuyReturnCode calculateSMI(const double* pHigh, const double* pLow, const double* pClose, int arraySize, int periodQ, int periodR, int periodS, int signalPeriod, int unstablePeriod, int shift, double* pWorkspace, double* pOutSMI);
+
+/**
+* The exponential moving average of one bar, as TA_MA(index, index, ..., TA_MAType_EMA) returns it
+* with the EMA unstable period set to unstablePeriod: the simple average of the period bars
+* unstablePeriod bars back, followed by unstablePeriod EMA steps.
+*
+* The unstable period is an argument instead of the TA-Lib global setting, so threads can use
+* different unstable periods at the same time.
+*
+* @param const double* pIn
+*   Array of values. pIn[0] is the oldest bar.
+*
+* @param int index
+*   The array index of the bar.
+*
+* @param int period
+*   The EMA period. A period of 1 returns the bar's value.
+*
+* @param int unstablePeriod
+*   The number of EMA steps after the simple average.
+*
+* @param double* pOutEma
+*   A pointer to the location to store the EMA. Only written when there are enough bars for it.
+*
+* @param int* pOutHasValue
+*   A pointer to the location to store FALSE if there are not enough bars before index for the EMA, TRUE otherwise.
+*
+* @return AsirikuyReturnCode
+*   An enum indicating success or the type of failure that occured.
+*/
+AsirikuyReturnCode calculateEma(const double* pIn, int index, int period, int unstablePeriod, double* pOutEma, int* pOutHasValue);
+
+/**
+* The MACD of one bar with EMA averages, as TA_MACDEXT(index, index, ...) returns it with
+* TA_MAType_EMA averages and the EMA unstable period set to unstablePeriod. The TA-Lib global
+* settings are not used, see calculateEma().
+*
+* @param const double* pIn
+*   Array of values. pIn[0] is the oldest bar.
+*
+* @param int index
+*   The array index of the bar.
+*
+* @param int fastPeriod
+*   The period of the fast EMA, 2 or more. It is swapped with slowPeriod when it is the larger one.
+*
+* @param int slowPeriod
+*   The period of the slow EMA, 2 or more.
+*
+* @param int signalPeriod
+*   The period of the signal EMA.
+*
+* @param int unstablePeriod
+*   The number of EMA steps after the simple average of each EMA.
+*
+* @param double* pOutMacd
+*   A pointer to the location to store the MACD. The outputs are only written when there are enough bars for them.
+*
+* @param double* pOutSignal
+*   A pointer to the location to store the signal.
+*
+* @param double* pOutHistogram
+*   A pointer to the location to store the MACD minus the signal.
+*
+* @param int* pOutHasValue
+*   A pointer to the location to store FALSE if there are not enough bars before index for the MACD, TRUE otherwise.
+*
+* @return AsirikuyReturnCode
+*   An enum indicating success or the type of failure that occured.
+*/
+AsirikuyReturnCode calculateMacd(const double* pIn, int index, int fastPeriod, int slowPeriod, int signalPeriod, int unstablePeriod, double* pOutMacd, double* pOutSignal, double* pOutHistogram, int* pOutHasValue);
+
+/**
+* Clears an indicator history.
+*
+* @param IndicatorHistory* pHistory
+*   The history to clear.
+*/
+void resetIndicatorHistory(IndicatorHistory* pHistory);
+
+/**
+* Finds the newest bar of an indicator history in the rates arrays.
+*
+* The history is cleared when that bar is not among the arrays' bars up to lastIndex (a
+* history reset), or when more than INDICATOR_HISTORY_BARS bars were added after it.
+*
+* @param IndicatorHistory* pHistory
+*   The history to align.
+*
+* @param const time_t* pTime
+*   Array of bar open times. pTime[0] is the oldest bar.
+*
+* @param const double* pClose
+*   Array of bar closing prices. pClose[0] is the oldest bar.
+*
+* @param int lastIndex
+*   The index of the newest closed bar in the arrays.
+*
+* @return int
+*   The array index of the newest bar in the history, -1 if the history is empty. The bars after it are to be added.
+*/
+int alignIndicatorHistory(IndicatorHistory* pHistory, const time_t* pTime, const double* pClose, int lastIndex);
+
+/**
+* Adds the next bar to an indicator history, dropping the oldest bar when it is full.
+*
+* @param IndicatorHistory* pHistory
+*   The history to add to.
+*
+* @param time_t time
+*   The open time of the bar.
+*
+* @param double close
+*   The closing price of the bar.
+*
+* @param int hasValues
+*   FALSE if the indicator has no value on the bar.
+*
+* @param const double* pValues
+*   INDICATOR_HISTORY_VALUES values of the indicator on the bar.
+*/
+void addIndicatorHistoryBar(IndicatorHistory* pHistory, time_t time, double close, int hasValues, const double* pValues);
+
+/**
+* Reads the values of a bar from an indicator history.
+*
+* @param const IndicatorHistory* pHistory
+*   The history to read.
+*
+* @param int barsBack
+*   The bar to read, 0 is the newest bar of the history.
+*
+* @param double* pOutValues
+*   Room for INDICATOR_HISTORY_VALUES values. Only written when the bar has values.
+*
+* @return int
+*   TRUE if the values were read, FALSE if the indicator has no value on the bar, INDICATOR_HISTORY_MISSING if the bar is not in the history.
+*/
+int getIndicatorHistoryBar(const IndicatorHistory* pHistory, int barsBack, double* pOutValues);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
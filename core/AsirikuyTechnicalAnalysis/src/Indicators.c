@@ -43,6 +43,9 @@
 #include "Logging.h"
 #include "AsirikuyLogger.h"
 
+/* Variances below this are 0 in TA-Lib's standard deviation (TA_IS_ZERO_OR_NEG) */
+#define BBAND_STOP_MIN_VARIANCE 0.00000001
+
 AsirikuyReturnCode barsToPreviousTime(const time_t* barOpenTimes, time_t time, int shiftIndex, int* pOutBarNumber)
 {
 	int i = 0, barsToTime = 0;
@@ -234,3 +237,648 @@ AsirikuyReturnCode calculateUltimateOscillator(const double* pHigh, const double
 
   return SUCCESS;
 }
+
+static void resetBBandStopMachine(BBandStopMachine* pMachine)
+{
+  memset(pMachine, 0, sizeof(BBandStopMachine));
+  pMachine->upLimit  = 10000;
+  pMachine->trendBar = -1;
+}
+
+void resetBBandStop(BBandStopState* pState)
+{
+  memset(pState, 0, sizeof(BBandStopState));
+  resetBBandStopMachine(&pState->machine);
+}
+
+void freeBBandStop(BBandStopState* pState)
+{
+  free(pState->pBars);
+  resetBBandStop(pState);
+}
+
+/* Starts over from the bar at the next call, keeping the bar storage */
+static void restartBBandStop(BBandStopState* pState, int period, double deviation)
+{
+  BBandStopBar* pBars = pState->pBars;
+  int barsCapacity = pState->barsCapacity;
+
+  resetBBandStop(pState);
+  pState->period       = period;
+  pState->deviation    = deviation;
+  pState->pBars        = pBars;
+  pState->barsCapacity = barsCapacity;
+}
+
+/* Makes room for the last numBars bars, keeping the ones stored */
+static AsirikuyReturnCode reserveBBandStopBars(BBandStopState* pState, int numBars)
+{
+  BBandStopBar* pBars;
+  int bar;
+
+  if(numBars <= pState->barsCapacity)
+  {
+    return SUCCESS;
+  }
+
+  pBars = (BBandStopBar*)malloc(numBars * sizeof(BBandStopBar));
+  if(pBars == NULL)
+  {
+    logCritical("calculateBBandStop() failed. Unable to allocate %d bars", numBars);
+    return INSUFFICIENT_MEMORY;
+  }
+
+  bar = pState->barsProcessed > pState->barsCapacity ? pState->barsProcessed - pState->barsCapacity : 0;
+  for(; bar < pState->barsProcessed; bar++)
+  {
+    pBars[bar % numBars] = pState->pBars[bar % pState->barsCapacity];
+  }
+
+  free(pState->pBars);
+  pState->pBars        = pBars;
+  pState->barsCapacity = numBars;
+  return SUCCESS;
+}
+
+/* One bar of the BBS state machine on its bands */
+static void stepBBandStop(BBandStopMachine* pMachine, double close, double upper, double lower, int bar)
+{
+  if(pMachine->isHalted)
+  {
+    return;
+  }
+
+  if(upper == 0)
+  {
+    pMachine->isHalted = TRUE;
+    return;
+  }
+
+  if(pMachine->trend == 0)
+  {
+    if(upper < pMachine->upLimit)
+    {
+      pMachine->upLimit = upper;
+    }
+    if(lower > pMachine->downLimit)
+    {
+      pMachine->downLimit = lower;
+    }
+  }
+  else if(pMachine->trend == 1)
+  {
+    if(lower > pMachine->stopPrice)
+    {
+      pMachine->stopPrice = lower;
+    }
+    pMachine->downLimit = pMachine->stopPrice;
+  }
+  else
+  {
+    if(upper < pMachine->stopPrice)
+    {
+      pMachine->stopPrice = upper;
+    }
+    pMachine->upLimit = pMachine->stopPrice;
+  }
+
+  if(close > pMachine->upLimit && pMachine->trend != 1)
+  {
+    pMachine->trend     = 1;
+    pMachine->stopPrice = lower;
+    pMachine->trendBar  = bar;
+  }
+  else if(close < pMachine->downLimit && pMachine->trend != -1)
+  {
+    pMachine->trend     = -1;
+    pMachine->stopPrice = upper;
+    pMachine->trendBar  = bar;
+  }
+}
+
+/* TRUE if both machines give the same stop on every following bar. In a trend both limits are overwritten before they are read again. */
+static BOOL isSameBBandStop(const BBandStopMachine* pMachine, const BBandStopMachine* pOther)
+{
+  if(pMachine->trend != pOther->trend || pMachine->isHalted != pOther->isHalted)
+  {
+    return FALSE;
+  }
+  if(pMachine->trend == 0)
+  {
+    return pMachine->upLimit == pOther->upLimit && pMachine->downLimit == pOther->downLimit;
+  }
+  return pMachine->stopPrice == pOther->stopPrice && pMachine->trendBar == pOther->trendBar;
+}
+
+static void addBBandStopBar(BBandStopState* pState, const double* pClose, int index)
+{
+  double close = pClose[index], middle, meanSquare, variance, width;
+  int    bar = pState->barsProcessed++;
+  BBandStopBar* pBar = &pState->pBars[bar % pState->barsCapacity];
+
+  /* Same order of operations as TA_SMA and TA-Lib's standard deviation on the SMA */
+  pState->periodTotal  += close;
+  pState->periodTotal2 += close * close;
+  if(bar < pState->period - 1)
+  {
+    pBar->upper   = pBar->lower = 0;
+    pBar->machine = pState->machine;
+    return;
+  }
+
+  middle     = pState->periodTotal / pState->period;
+  meanSquare = pState->periodTotal2 / pState->period;
+  pState->periodTotal  -= pClose[index - pState->period + 1];
+  pState->periodTotal2 -= pClose[index - pState->period + 1] * pClose[index - pState->period + 1];
+
+  variance   = meanSquare - middle * middle;
+  width      = (variance < BBAND_STOP_MIN_VARIANCE ? 0.0 : sqrt(variance)) * pState->deviation;
+  pBar->upper = middle + width;
+  pBar->lower = middle - width;
+
+  stepBBandStop(&pState->machine, close, pBar->upper, pBar->lower, bar);
+  pBar->machine = pState->machine;
+}
+
+AsirikuyReturnCode calculateBBandStop(BBandStopState* pState, const time_t* pTime, const double* pClose, int arraySize, int period, double deviation, int* pOutTrend, double* pOutStopPrice, int* pOutIndex)
+{
+  int i, bar, lastIndex = -1, shift1Index = arraySize - 2, firstBar;
+  BBandStopMachine machine;
+  AsirikuyReturnCode returnCode;
+
+  if(pState == NULL || pTime == NULL || pClose == NULL || pOutTrend == NULL || pOutStopPrice == NULL || pOutIndex == NULL)
+  {
+    logCritical("calculateBBandStop() failed. NULL argument");
+    return NULL_POINTER;
+  }
+
+  if(period < 2)
+  {
+    logAsirikuyError("calculateBBandStop()", INVALID_PARAMETER);
+    return INVALID_PARAMETER;
+  }
+
+  if(shift1Index < 0)
+  {
+    logAsirikuyError("calculateBBandStop()", NOT_ENOUGH_RATES_DATA);
+    return NOT_ENOUGH_RATES_DATA;
+  }
+
+  /* Find the last processed bar, normally at shift 1 or 2 */
+  if(pState->barsProcessed > 0 && pState->period == period && pState->deviation == deviation)
+  {
+    for(i = shift1Index; i >= 0 && pTime[i] >= pState->lastBarTime; i--)
+    {
+      if(pTime[i] == pState->lastBarTime)
+      {
+        if(pClose[i] == pState->lastClose)
+        {
+          lastIndex = i;
+        }
+        break;
+      }
+    }
+  }
+
+  /* The bands of the new bars need the closes of the period - 1 bars before them */
+  if(lastIndex >= 0 && pState->barsProcessed - 1 - lastIndex > 0 && lastIndex + 2 - period < 0)
+  {
+    lastIndex = -1;
+  }
+
+  if(lastIndex < 0)
+  {
+    restartBBandStop(pState, period, deviation);
+  }
+
+  returnCode = reserveBBandStopBars(pState, shift1Index + 1);
+  if(returnCode != SUCCESS)
+  {
+    resetBBandStop(pState);
+    return returnCode;
+  }
+
+  for(i = lastIndex + 1; i <= shift1Index; i++)
+  {
+    addBBandStopBar(pState, pClose, i);
+  }
+
+  pState->lastBarTime = pTime[shift1Index];
+  pState->lastClose   = pClose[shift1Index];
+
+  /* Bar number of the oldest bar in the arrays. A stop started there is the stop since the reset. */
+  firstBar = pState->barsProcessed - 1 - shift1Index;
+  machine  = pState->machine;
+  if(firstBar > 0)
+  {
+    resetBBandStopMachine(&machine);
+    for(bar = firstBar + period - 1; bar < pState->barsProcessed && !machine.isHalted; bar++)
+    {
+      const BBandStopBar* pBar = &pState->pBars[bar % pState->barsCapacity];
+
+      stepBBandStop(&machine, pClose[bar - firstBar], pBar->upper, pBar->lower, bar);
+      if(isSameBBandStop(&machine, &pBar->machine))
+      {
+        machine = pState->machine;
+        break;
+      }
+    }
+  }
+
+  *pOutTrend     = machine.trend;
+  *pOutStopPrice = machine.stopPrice;
+  if(machine.trendBar >= 0)
+  {
+    *pOutIndex = machine.trendBar - firstBar;
+  }
+
+  return SUCCESS;
+}
+
+/* Series of the calculateSMI() workspace */
+enum
+{
+  SMI_HQ,
+  SMI_SM,
+  SMI_HQ_SMOOTHED,
+  SMI_SM_SMOOTHED,
+  SMI_VALUE,
+  SMI_HIGH_PREFIX,
+  SMI_HIGH_SUFFIX,
+  SMI_LOW_PREFIX,
+  SMI_LOW_SUFFIX
+};
+
+/* TA_MA(i, i, ..., TA_MAType_EMA) for consecutive bars i */
+typedef struct windowed_ema_t
+{
+  int    period;
+  int    unstablePeriod;
+  double k;
+  double seedWeight;  /* (1 - k)^unstablePeriod */
+  double seedTotal;   /* Sum of the period bars of the seed average */
+  double steps;       /* The part of the EMA steps not coming from the seed */
+  int    lastIndex;   /* -1 before the first value */
+} WindowedEma;
+
+static void initWindowedEma(WindowedEma* pEma, int period, int unstablePeriod)
+{
+  int i;
+
+  /* TA_MA returns the input for a period of 1 */
+  pEma->period         = period;
+  pEma->unstablePeriod = period > 1 ? unstablePeriod : 0;
+  pEma->k              = 2.0 / (period + 1);
+  pEma->seedWeight     = 1;
+  pEma->seedTotal      = 0;
+  pEma->steps          = 0;
+  pEma->lastIndex      = -1;
+
+  for(i = 0; i < pEma->unstablePeriod; i++)
+  {
+    pEma->seedWeight *= 1 - pEma->k;
+  }
+}
+
+static int windowedEmaLookback(const WindowedEma* pEma)
+{
+  return pEma->period - 1 + pEma->unstablePeriod;
+}
+
+static double updateWindowedEma(WindowedEma* pEma, const double* pIn, int index)
+{
+  int i, seedIndex = index - pEma->unstablePeriod;
+
+  if(pEma->lastIndex >= 0 && pEma->lastIndex == index - 1)
+  {
+    pEma->seedTotal += pIn[seedIndex] - pIn[seedIndex - pEma->period];
+    pEma->steps      = (1 - pEma->k) * pEma->steps + pEma->k * pIn[index] - pEma->k * pEma->seedWeight * pIn[seedIndex];
+  }
+  else
+  {
+    pEma->seedTotal = 0;
+    for(i = seedIndex - pEma->period + 1; i <= seedIndex; i++)
+    {
+      pEma->seedTotal += pIn[i];
+    }
+
+    pEma->steps = 0;
+    for(i = seedIndex + 1; i <= index; i++)
+    {
+      pEma->steps = (1 - pEma->k) * pEma->steps + pEma->k * pIn[i];
+    }
+  }
+
+  pEma->lastIndex = index;
+  return pEma->seedWeight * pEma->seedTotal / pEma->period + pEma->steps;
+}
+
+/* Running maxima/minima within blocks of period bars, forwards and backwards (van Herk/Gil-Werman).
+   The extreme of bars i - period + 1 to i is then max(pSuffix[i - period + 1], pPrefix[i]). */
+static void calculateBlockExtremes(const double* pIn, int lastIndex, int period, int isMaximum, double* pPrefix, double* pSuffix)
+{
+  int i, blockStart, blockEnd;
+
+  for(blockStart = 0; blockStart <= lastIndex; blockStart += period)
+  {
+    blockEnd = blockStart + period - 1 < lastIndex ? blockStart + period - 1 : lastIndex;
+
+    pPrefix[blockStart] = pIn[blockStart];
+    for(i = blockStart + 1; i <= blockEnd; i++)
+    {
+      pPrefix[i] = (isMaximum ? pIn[i] > pPrefix[i - 1] : pIn[i] < pPrefix[i - 1]) ? pIn[i] : pPrefix[i - 1];
+    }
+
+    pSuffix[blockEnd] = pIn[blockEnd];
+    for(i = blockEnd - 1; i >= blockStart; i--)
+    {
+      pSuffix[i] = (isMaximum ? pIn[i] > pSuffix[i + 1] : pIn[i] < pSuffix[i + 1]) ? pIn[i] : pSuffix[i + 1];
+    }
+  }
+}
+
+AsirikuyReturnCode calculateSMI(const double* pHigh, const double* pLow, const double* pClose, int arraySize, int periodQ, int periodR, int periodS, int signalPeriod, int unstablePeriod, int shift, double* pWorkspace, double* pOutSMI)
+{
+  double *pHQ, *pSM, *pHQSmoothed, *pSMSmoothed, *pSMI, *pHighPrefix, *pHighSuffix, *pLowPrefix, *pLowSuffix;
+  double highestHigh, lowestLow, hq, sm;
+  WindowedEma hqEma1, smEma1, hqEma2, smEma2, signalEma;
+  int i, lastIndex = arraySize - shift;
+
+  if(pHigh == NULL || pLow == NULL || pClose == NULL || pWorkspace == NULL || pOutSMI == NULL)
+  {
+    logCritical("calculateSMI() failed. NULL argument");
+    return NULL_POINTER;
+  }
+
+  if(periodQ < 1 || periodR < 1 || periodS < 1 || signalPeriod < 0 || unstablePeriod < 0 || shift < 1)
+  {
+    logAsirikuyError("calculateSMI()", INVALID_PARAMETER);
+    return INVALID_PARAMETER;
+  }
+
+  if(lastIndex < 0)
+  {
+    logAsirikuyError("calculateSMI()", NOT_ENOUGH_RATES_DATA);
+    return NOT_ENOUGH_RATES_DATA;
+  }
+
+  pHQ         = &pWorkspace[SMI_HQ * arraySize];
+  pSM         = &pWorkspace[SMI_SM * arraySize];
+  pHQSmoothed = &pWorkspace[SMI_HQ_SMOOTHED * arraySize];
+  pSMSmoothed = &pWorkspace[SMI_SM_SMOOTHED * arraySize];
+  pSMI        = &pWorkspace[SMI_VALUE * arraySize];
+  pHighPrefix = &pWorkspace[SMI_HIGH_PREFIX * arraySize];
+  pHighSuffix = &pWorkspace[SMI_HIGH_SUFFIX * arraySize];
+  pLowPrefix  = &pWorkspace[SMI_LOW_PREFIX * arraySize];
+  pLowSuffix  = &pWorkspace[SMI_LOW_SUFFIX * arraySize];
+
+  calculateBlockExtremes(pHigh, lastIndex, periodQ, TRUE, pHighPrefix, pHighSuffix);
+  calculateBlockExtremes(pLow, lastIndex, periodQ, FALSE, pLowPrefix, pLowSuffix);
+
+  initWindowedEma(&hqEma1, periodR, unstablePeriod);
+  initWindowedEma(&smEma1, periodR, unstablePeriod);
+  initWindowedEma(&hqEma2, periodS, unstablePeriod);
+  initWindowedEma(&smEma2, periodS, unstablePeriod);
+  initWindowedEma(&signalEma, signalPeriod + 1, unstablePeriod);
+
+  /* Bars without enough history for a stage are 0 */
+  for(i = 0; i <= lastIndex; i++)
+  {
+    pHQ[i] = 0;
+    pSM[i] = 0;
+    if(i > periodQ)
+    {
+      highestHigh = pHighSuffix[i - periodQ + 1] > pHighPrefix[i] ? pHighSuffix[i - periodQ + 1] : pHighPrefix[i];
+      lowestLow   = pLowSuffix[i - periodQ + 1] < pLowPrefix[i] ? pLowSuffix[i - periodQ + 1] : pLowPrefix[i];
+      pHQ[i] = highestHigh - lowestLow;
+      pSM[i] = pClose[i] - (highestHigh + lowestLow) / 2;
+    }
+
+    pHQSmoothed[i] = 0;
+    pSMSmoothed[i] = 0;
+    if(i >= windowedEmaLookback(&hqEma1))
+    {
+      hq = updateWindowedEma(&hqEma1, pHQ, i);
+      sm = updateWindowedEma(&smEma1, pSM, i);
+      if(i > periodR + periodQ)
+      {
+        pHQSmoothed[i] = hq;
+        pSMSmoothed[i] = sm;
+      }
+    }
+
+    pSMI[i] = 0;
+    if(i >= windowedEmaLookback(&hqEma2))
+    {
+      hq = updateWindowedEma(&hqEma2, pHQSmoothed, i);
+      sm = updateWindowedEma(&smEma2, pSMSmoothed, i);
+      if(i > periodQ + periodS + periodR)
+      {
+        pSMI[i] = 100 * sm / 0.5 / hq;
+      }
+    }
+  }
+
+  *pOutSMI = 0;
+  if(lastIndex >= windowedEmaLookback(&signalEma))
+  {
+    *pOutSMI = updateWindowedEma(&signalEma, pSMI, lastIndex);
+  }
+
+  return SUCCESS;
+}
+
+static int emaLookback(int period, int unstablePeriod)
+{
+  return period > 1 ? period - 1 + unstablePeriod : 0;
+}
+
+static double stepEma(double ema, double value, int period)
+{
+  /* TA_MA returns the input for a period of 1 */
+  if(period == 1)
+  {
+    return value;
+  }
+
+  return ((value - ema) * (2.0 / (period + 1))) + ema;
+}
+
+/* TA_INT_EMA's arithmetic, index must be at least emaLookback() */
+static double emaAt(const double* pIn, int index, int period, int unstablePeriod)
+{
+  int i, seedIndex = index - emaLookback(period, unstablePeriod) + period - 1;
+  double ema = 0;
+
+  for(i = seedIndex - period + 1; i <= seedIndex; i++)
+  {
+    ema += pIn[i];
+  }
+  ema /= period;
+
+  for(i = seedIndex + 1; i <= index; i++)
+  {
+    ema = stepEma(ema, pIn[i], period);
+  }
+
+  return ema;
+}
+
+AsirikuyReturnCode calculateEma(const double* pIn, int index, int period, int unstablePeriod, double* pOutEma, int* pOutHasValue)
+{
+  if(pIn == NULL || pOutEma == NULL || pOutHasValue == NULL)
+  {
+    logCritical("calculateEma() failed. NULL argument");
+    return NULL_POINTER;
+  }
+
+  if(index < 0 || period < 1 || unstablePeriod < 0)
+  {
+    logAsirikuyError("calculateEma()", INVALID_PARAMETER);
+    return INVALID_PARAMETER;
+  }
+
+  *pOutHasValue = index >= emaLookback(period, unstablePeriod);
+  if(*pOutHasValue)
+  {
+    *pOutEma = emaAt(pIn, index, period, unstablePeriod);
+  }
+
+  return SUCCESS;
+}
+
+AsirikuyReturnCode calculateMacd(const double* pIn, int index, int fastPeriod, int slowPeriod, int signalPeriod, int unstablePeriod, double* pOutMacd, double* pOutSignal, double* pOutHistogram, int* pOutHasValue)
+{
+  double fastEma, slowEma, macd = 0, signal = 0;
+  int i, firstIndex, period;
+
+  if(pIn == NULL || pOutMacd == NULL || pOutSignal == NULL || pOutHistogram == NULL || pOutHasValue == NULL)
+  {
+    logCritical("calculateMacd() failed. NULL argument");
+    return NULL_POINTER;
+  }
+
+  if(index < 0 || fastPeriod < 2 || slowPeriod < 2 || signalPeriod < 1 || unstablePeriod < 0)
+  {
+    logAsirikuyError("calculateMacd()", INVALID_PARAMETER);
+    return INVALID_PARAMETER;
+  }
+
+  if(slowPeriod < fastPeriod)
+  {
+    period     = slowPeriod;
+    slowPeriod = fastPeriod;
+    fastPeriod = period;
+  }
+
+  *pOutHasValue = index >= emaLookback(slowPeriod, unstablePeriod) + emaLookback(signalPeriod, unstablePeriod);
+  if(!*pOutHasValue)
+  {
+    return SUCCESS;
+  }
+
+  /* The signal is the EMA of the MACD bars from firstIndex on, as TA_MACDEXT computes it */
+  firstIndex = index - emaLookback(signalPeriod, unstablePeriod);
+  fastEma    = emaAt(pIn, firstIndex, fastPeriod, unstablePeriod);
+  slowEma    = emaAt(pIn, firstIndex, slowPeriod, unstablePeriod);
+
+  for(i = firstIndex; i <= index; i++)
+  {
+    if(i > firstIndex)
+    {
+      fastEma = stepEma(fastEma, pIn[i], fastPeriod);
+      slowEma = stepEma(slowEma, pIn[i], slowPeriod);
+    }
+    macd = fastEma - slowEma;
+
+    if(i - firstIndex < signalPeriod)
+    {
+      signal += macd;
+      if(i - firstIndex == signalPeriod - 1)
+      {
+        signal /= signalPeriod;
+      }
+    }
+    else
+    {
+      signal = stepEma(signal, macd, signalPeriod);
+    }
+  }
+
+  *pOutMacd      = macd;
+  *pOutSignal    = signal;
+  *pOutHistogram = macd - signal;
+  return SUCCESS;
+}
+
+void resetIndicatorHistory(IndicatorHistory* pHistory)
+{
+  pHistory->numBars    = 0;
+  pHistory->newestSlot = INDICATOR_HISTORY_BARS - 1;
+}
+
+int alignIndicatorHistory(IndicatorHistory* pHistory, const time_t* pTime, const double* pClose, int lastIndex)
+{
+  time_t newestTime;
+  int    i;
+
+  if(pHistory->numBars == 0)
+  {
+    return -1;
+  }
+
+  /* Normally the newest bar is at shift 1 or 2 */
+  newestTime = pHistory->times[pHistory->newestSlot];
+  for(i = lastIndex; i >= 0 && i >= lastIndex - INDICATOR_HISTORY_BARS && pTime[i] >= newestTime; i--)
+  {
+    if(pTime[i] == newestTime && pClose[i] == pHistory->closes[pHistory->newestSlot])
+    {
+      return i;
+    }
+  }
+
+  resetIndicatorHistory(pHistory);
+  return -1;
+}
+
+void addIndicatorHistoryBar(IndicatorHistory* pHistory, time_t time, double close, int hasValues, const double* pValues)
+{
+  int i;
+
+  pHistory->newestSlot = (pHistory->newestSlot + 1) % INDICATOR_HISTORY_BARS;
+  if(pHistory->numBars < INDICATOR_HISTORY_BARS)
+  {
+    pHistory->numBars++;
+  }
+
+  pHistory->times[pHistory->newestSlot]     = time;
+  pHistory->closes[pHistory->newestSlot]    = close;
+  pHistory->hasValues[pHistory->newestSlot] = hasValues;
+  for(i = 0; i < INDICATOR_HISTORY_VALUES; i++)
+  {
+    pHistory->values[pHistory->newestSlot][i] = hasValues ? pValues[i] : 0;
+  }
+}
+
+int getIndicatorHistoryBar(const IndicatorHistory* pHistory, int barsBack, double* pOutValues)
+{
+  int i, slot;
+
+  if(barsBack < 0 || barsBack >= pHistory->numBars)
+  {
+    return INDICATOR_HISTORY_MISSING;
+  }
+
+  slot = (pHistory->newestSlot - barsBack + INDICATOR_HISTORY_BARS) % INDICATOR_HISTORY_BARS;
+  if(!pHistory->hasValues[slot])
+  {
+    return FALSE;
+  }
+
+  for(i = 0; i < INDICATOR_HISTORY_VALUES; i++)
+  {
+    pOutValues[i] = pHistory->values[slot][i];
+  }
+
+  return TRUE;
+}
@@ -34,7 +34,189 @@
  * @copyright In no event shall Asirikuy or any contributors to the Asirikuy Framework be liable for any damages (including, without limitation, lost profits, business interruption, or lost information) rising out of 'Authorized Users' use of or inability to use the Asirikuy Framework, even if Asirikuy has been advised of the possibility of such damages. In no event will Asirikuy or any contributors to the Asirikuy Framework be liable for loss of data or for indirect, special, incidental, consequential (including lost profit), or other damages based in contract, tort or otherwise. Asirikuy and contributors to the Asirikuy Framework shall have no liability with respect to the content of the Asirikuy Framework or any part thereof, including but not limited to errors or omissions contained therein, libel, infringements of rights of publicity, privacy, trademark rights, business interruption, personal injury, loss of privacy, moral rights or the disclosure of confidential information.
  */
 
+#include <vector>
+#include <algorithm>
+
 #include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+#include <ta_libc.h>
+
+#include "Indicators.h"
+
+namespace
+{
+  struct BBandStopResult
+  {
+    int    trend;
+    double stopPrice;
+    int    index;
+  };
+
+  /* Random walk closes, one bar every 15 minutes */
+  void makeBBandStopSeries(int numBars, unsigned int seed, std::vector<time_t>& times, std::vector<double>& closes)
+  {
+    double close = 1.3;
+
+    times.resize(numBars);
+    closes.resize(numBars);
+    for(int i = 0; i < numBars; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      close += ((int)((seed >> 16) % 201) - 100) * 0.00002;
+      times[i]  = 1262304000 + 900 * (time_t)i;
+      closes[i] = close;
+    }
+  }
+
+  /* The full recompute iBBandStop did on every call: TA_BBANDS over the whole arrays, then the stop from the oldest bar on */
+  BBandStopResult fullBBandStop(const double* pClose, int arraySize, int period, double deviation)
+  {
+    BBandStopResult result = {0, 0, -1};
+    std::vector<double> upperBand(arraySize), middleBand(arraySize), lowerBand(arraySize);
+    int outBegIdx, outNBElement;
+    double upLimit = 10000, downLimit = 0;
+
+    BOOST_REQUIRE_EQUAL(TA_BBANDS(0, arraySize - 2, pClose, period, deviation, deviation, TA_MAType_SMA, &outBegIdx, &outNBElement, &upperBand[0], &middleBand[0], &lowerBand[0]), TA_SUCCESS);
+
+    for(int i = 0; i < outNBElement; i++)
+    {
+      if(upperBand[i] == 0)
+        break;
+      if(result.trend == 0)
+      {
+        if(upperBand[i] < upLimit)
+          upLimit = upperBand[i];
+        if(lowerBand[i] > downLimit)
+          downLimit = lowerBand[i];
+      }
+      if(result.trend == 1)
+      {
+        if(lowerBand[i] > result.stopPrice)
+          result.stopPrice = lowerBand[i];
+        downLimit = result.stopPrice;
+      }
+      if(result.trend == -1)
+      {
+        if(upperBand[i] < result.stopPrice)
+          result.stopPrice = upperBand[i];
+        upLimit = result.stopPrice;
+      }
+
+      if(pClose[outBegIdx + i] > upLimit && result.trend != 1)
+      {
+        result.trend = 1;
+        result.stopPrice = lowerBand[i];
+        result.index = outBegIdx + i;
+      }
+      else if(pClose[outBegIdx + i] < downLimit && result.trend != -1)
+      {
+        result.trend = -1;
+        result.stopPrice = upperBand[i];
+        result.index = outBegIdx + i;
+      }
+    }
+
+    return result;
+  }
+
+  /* The former iSMI: TA_MA on every bar of every stage. Its highest high / lowest low search is replaced by the plain extremes. */
+  double perBarSMI(const double* pHigh, const double* pLow, const double* pClose, int arraySize, int periodQ, int periodR, int periodS, int signal, int shift)
+  {
+    std::vector<double> hq(arraySize), sm(arraySize), hqEma1(arraySize), smEma1(arraySize), hqEma2(arraySize), smEma2(arraySize), smi(arraySize);
+    int outBegIdx, outNBElement;
+    double smiSignal = 0;
+
+    for(int i = periodQ + 1; i < arraySize; i++)
+    {
+      double highestHigh = pHigh[i], lowestLow = pLow[i];
+      for(int n = 0; n < periodQ; n++)
+      {
+        highestHigh = std::max(highestHigh, pHigh[i - n]);
+        lowestLow = std::min(lowestLow, pLow[i - n]);
+      }
+      hq[i] = highestHigh - lowestLow;
+      sm[i] = pClose[i] - (highestHigh + lowestLow) / 2;
+    }
+    for(int i = periodR + periodQ + 1; i < arraySize; i++)
+    {
+      TA_MA(i, i, &hq[0], periodR, TA_MAType_EMA, &outBegIdx, &outNBElement, &hqEma1[i]);
+      TA_MA(i, i, &sm[0], periodR, TA_MAType_EMA, &outBegIdx, &outNBElement, &smEma1[i]);
+    }
+    for(int i = periodQ + periodS + periodR + 1; i < arraySize; i++)
+    {
+      TA_MA(i, i, &hqEma1[0], periodS, TA_MAType_EMA, &outBegIdx, &outNBElement, &hqEma2[i]);
+      TA_MA(i, i, &smEma1[0], periodS, TA_MAType_EMA, &outBegIdx, &outNBElement, &smEma2[i]);
+      smi[i] = 100 * smEma2[i] / 0.5 / hqEma2[i];
+    }
+    TA_MA(arraySize - shift, arraySize - shift, &smi[0], signal + 1, TA_MAType_EMA, &outBegIdx, &outNBElement, &smiSignal);
+
+    return smiSignal;
+  }
+
+  void checkSMIAgainstPerBar(int unstablePeriod)
+  {
+    const int numBars = 1200;
+    std::vector<time_t> times;
+    std::vector<double> closes, highs(numBars), lows(numBars), workspace(SMI_WORKSPACE_SERIES * numBars);
+    const int periods[][4] = {{13, 25, 2, 12}, {5, 3, 3, 0}, {21, 8, 5, 3}, {1, 1, 1, 1}};
+
+    makeBBandStopSeries(numBars, 13, times, closes);
+    for(int i = 0; i < numBars; i++)
+    {
+      highs[i] = closes[i] + 0.0001 * (1 + i % 7);
+      lows[i]  = closes[i] - 0.0001 * (1 + i % 5);
+    }
+
+    for(int p = 0; p < 4; p++)
+    {
+      for(int shift = 1; shift <= 3; shift++)
+      {
+        double smi = -1;
+        BOOST_REQUIRE_EQUAL(calculateSMI(&highs[0], &lows[0], &closes[0], numBars, periods[p][0], periods[p][1], periods[p][2], periods[p][3], unstablePeriod, shift, &workspace[0], &smi), SUCCESS);
+        BOOST_CHECK_SMALL(smi - perBarSMI(&highs[0], &lows[0], &closes[0], numBars, periods[p][0], periods[p][1], periods[p][2], periods[p][3], shift), 1e-8);
+      }
+    }
+  }
+
+  BBandStopResult incrementalBBandStop(BBandStopState* pState, const time_t* pTime, const double* pClose, int arraySize, int period, double deviation)
+  {
+    BBandStopResult result = {0, 0, -1};
+
+    BOOST_REQUIRE_EQUAL(calculateBBandStop(pState, pTime, pClose, arraySize, period, deviation, &result.trend, &result.stopPrice, &result.index), SUCCESS);
+    return result;
+  }
+
+  /* EMA (period 10) and MACD (12, 26, 9) of every bar with one unstable period, filled by one thread */
+  struct EmaRun
+  {
+    const std::vector<double>* pCloses;
+    int                        unstablePeriod;
+    std::vector<double>        values;
+    int                        failures;
+
+    void operator()()
+    {
+      const std::vector<double>& closes = *pCloses;
+      double ema, macd, signal, histogram;
+      int hasValue;
+
+      values.assign(4 * closes.size(), 0);
+      failures = 0;
+      for(int i = 0; i < (int)closes.size(); i++)
+      {
+        if(calculateEma(&closes[0], i, 10, unstablePeriod, &ema, &hasValue) != SUCCESS) failures++;
+        if(hasValue) values[4 * i] = ema;
+        if(calculateMacd(&closes[0], i, 12, 26, 9, unstablePeriod, &macd, &signal, &histogram, &hasValue) != SUCCESS) failures++;
+        if(hasValue)
+        {
+          values[4 * i + 1] = macd;
+          values[4 * i + 2] = signal;
+          values[4 * i + 3] = histogram;
+        }
+      }
+    }
+  };
+}
 
 BOOST_AUTO_TEST_SUITE(Asirikuy_Technical_Analysis)
 
@@ -43,4 +225,286 @@ BOOST_AUTO_TEST_CASE(placeholder)
   BOOST_CHECK(true);
 }
 
+BOOST_AUTO_TEST_CASE(bbandStop_incremental_matches_the_full_recompute_on_growing_history)
+{
+  const int period = 20, numBars = 3000;
+  std::vector<time_t> times;
+  std::vector<double> closes;
+  BBandStopState state;
+  int numTrendChanges = 0, lastTrend = 0;
+
+  makeBBandStopSeries(numBars, 7, times, closes);
+  resetBBandStop(&state);
+
+  for(int n = 2; n <= numBars; n++)
+  {
+    BBandStopResult expected = fullBBandStop(&closes[0], n, period, 2);
+    BBandStopResult actual = incrementalBBandStop(&state, &times[0], &closes[0], n, period, 2);
+
+    BOOST_REQUIRE_EQUAL(actual.trend, expected.trend);
+    BOOST_REQUIRE_EQUAL(actual.index, expected.index);
+    BOOST_REQUIRE_CLOSE(actual.stopPrice, expected.stopPrice, 1e-9);
+
+    /* A second call on the same bar changes nothing */
+    BBandStopResult again = incrementalBBandStop(&state, &times[0], &closes[0], n, period, 2);
+    BOOST_REQUIRE_EQUAL(again.index, actual.index);
+    BOOST_REQUIRE_EQUAL(again.stopPrice, actual.stopPrice);
+
+    if(actual.trend != lastTrend) numTrendChanges++;
+    lastTrend = actual.trend;
+  }
+
+  BOOST_CHECK_EQUAL(state.barsProcessed, numBars - 1);
+  BOOST_CHECK(numTrendChanges > 10);
+  freeBBandStop(&state);
+}
+
+BOOST_AUTO_TEST_CASE(bbandStop_incremental_matches_the_full_recompute_on_a_sliding_window)
+{
+  const int period = 20, windowSize = 300, numBars = 2500;
+  std::vector<time_t> times;
+  std::vector<double> closes;
+  BBandStopState state;
+
+  makeBBandStopSeries(numBars, 11, times, closes);
+  resetBBandStop(&state);
+
+  /* The window slides one bar at a time like the tester's rates windows, the state only ever adds the new bar's bands */
+  for(int n = windowSize; n <= numBars; n++)
+  {
+    int firstBar = n - windowSize;
+    BBandStopResult expected = fullBBandStop(&closes[firstBar], windowSize, period, 2);
+    BBandStopResult actual = incrementalBBandStop(&state, &times[firstBar], &closes[firstBar], windowSize, period, 2);
+
+    BOOST_REQUIRE_EQUAL(actual.trend, expected.trend);
+    BOOST_REQUIRE_EQUAL(actual.index, expected.index);
+    BOOST_REQUIRE_CLOSE(actual.stopPrice, expected.stopPrice, 1e-9);
+  }
+
+  BOOST_CHECK_EQUAL(state.barsProcessed, numBars - 1);
+  freeBBandStop(&state);
+}
+
+BOOST_AUTO_TEST_CASE(bbandStop_incremental_recomputes_on_a_history_reset)
+{
+  const int period = 20, numBars = 800;
+  std::vector<time_t> times, otherTimes;
+  std::vector<double> closes, otherCloses;
+  BBandStopState state;
+
+  makeBBandStopSeries(numBars, 3, times, closes);
+  makeBBandStopSeries(numBars, 5, otherTimes, otherCloses);
+  resetBBandStop(&state);
+  incrementalBBandStop(&state, &times[0], &closes[0], numBars, period, 2);
+
+  /* Same times, different prices: another symbol on the same instance */
+  BBandStopResult expected = fullBBandStop(&otherCloses[0], numBars / 2, period, 2);
+  BBandStopResult actual = incrementalBBandStop(&state, &otherTimes[0], &otherCloses[0], numBars / 2, period, 2);
+  BOOST_CHECK_EQUAL(actual.trend, expected.trend);
+  BOOST_CHECK_EQUAL(actual.index, expected.index);
+  BOOST_CHECK_CLOSE(actual.stopPrice, expected.stopPrice, 1e-9);
+  BOOST_CHECK_EQUAL(state.barsProcessed, numBars / 2 - 1);
+
+  /* The window jumped further than period bars ahead: the older closes are gone */
+  expected = fullBBandStop(&otherCloses[numBars / 2], numBars / 2, period, 2);
+  actual = incrementalBBandStop(&state, &otherTimes[numBars / 2], &otherCloses[numBars / 2], numBars / 2, period, 2);
+  BOOST_CHECK_EQUAL(actual.trend, expected.trend);
+  BOOST_CHECK_EQUAL(actual.index, expected.index);
+  BOOST_CHECK_CLOSE(actual.stopPrice, expected.stopPrice, 1e-9);
+
+  /* Another deviation starts over too */
+  expected = fullBBandStop(&otherCloses[numBars / 2], numBars / 2, period, 1);
+  actual = incrementalBBandStop(&state, &otherTimes[numBars / 2], &otherCloses[numBars / 2], numBars / 2, period, 1);
+  BOOST_CHECK_EQUAL(actual.trend, expected.trend);
+  BOOST_CHECK_EQUAL(actual.index, expected.index);
+  BOOST_CHECK_CLOSE(actual.stopPrice, expected.stopPrice, 1e-9);
+  freeBBandStop(&state);
+}
+
+BOOST_AUTO_TEST_CASE(smi_single_pass_matches_the_per_bar_ta_ma_version)
+{
+  BOOST_REQUIRE_EQUAL(TA_GetUnstablePeriod(TA_FUNC_UNST_EMA), 0);
+  checkSMIAgainstPerBar(0);
+}
+
+BOOST_AUTO_TEST_CASE(smi_single_pass_follows_the_ema_unstable_period)
+{
+  TA_SetUnstablePeriod(TA_FUNC_UNST_EMA, 35);
+  checkSMIAgainstPerBar(35);
+  TA_SetUnstablePeriod(TA_FUNC_UNST_EMA, 0);
+}
+
+BOOST_AUTO_TEST_CASE(smi_is_zero_without_enough_bars)
+{
+  std::vector<double> prices(30, 1.3), workspace(SMI_WORKSPACE_SERIES * 30);
+  double smi = -1;
+
+  BOOST_REQUIRE_EQUAL(calculateSMI(&prices[0], &prices[0], &prices[0], 30, 13, 25, 2, 12, 0, 1, &workspace[0], &smi), SUCCESS);
+  BOOST_CHECK_EQUAL(smi, 0);
+  BOOST_CHECK_EQUAL(calculateSMI(&prices[0], &prices[0], &prices[0], 30, 13, 25, 2, 12, 0, 0, &workspace[0], &smi), INVALID_PARAMETER);
+}
+
+BOOST_AUTO_TEST_CASE(ema_and_macd_match_ta_lib_for_any_unstable_period)
+{
+  const int numBars = 600, unstablePeriods[] = {0, 35, 100}, emaPeriods[] = {1, 2, 10, 30};
+  const int macdPeriods[][3] = {{12, 26, 9}, {26, 12, 9}, {3, 10, 1}, {2, 2, 2}};
+  std::vector<time_t> times;
+  std::vector<double> closes;
+  int outBegIdx, outNBElement, hasValue;
+  double unused;
+
+  makeBBandStopSeries(numBars, 29, times, closes);
+
+  for(int u = 0; u < 3; u++)
+  {
+    TA_SetUnstablePeriod(TA_FUNC_UNST_EMA, unstablePeriods[u]);
+    for(int i = 0; i < numBars; i += 7)
+    {
+      for(int p = 0; p < 4; p++)
+      {
+        double ema = -1, expected = -1;
+        BOOST_REQUIRE_EQUAL(TA_MA(i, i, &closes[0], emaPeriods[p], TA_MAType_EMA, &outBegIdx, &outNBElement, &expected), TA_SUCCESS);
+        BOOST_REQUIRE_EQUAL(calculateEma(&closes[0], i, emaPeriods[p], unstablePeriods[u], &ema, &hasValue), SUCCESS);
+        BOOST_REQUIRE_EQUAL(hasValue, outNBElement);
+        BOOST_CHECK_CLOSE(ema, expected, 1e-9);
+      }
+
+      for(int p = 0; p < 4; p++)
+      {
+        double macd = -1, signal = -1, histogram = -1, expected[3] = {-1, -1, -1};
+        BOOST_REQUIRE_EQUAL(TA_MACDEXT(i, i, &closes[0], macdPeriods[p][0], TA_MAType_EMA, macdPeriods[p][1], TA_MAType_EMA, macdPeriods[p][2], TA_MAType_EMA,
+          &outBegIdx, &outNBElement, &expected[0], &expected[1], &expected[2]), TA_SUCCESS);
+        BOOST_REQUIRE_EQUAL(calculateMacd(&closes[0], i, macdPeriods[p][0], macdPeriods[p][1], macdPeriods[p][2], unstablePeriods[u], &macd, &signal, &histogram, &hasValue), SUCCESS);
+        BOOST_REQUIRE_EQUAL(hasValue, outNBElement);
+        BOOST_CHECK_SMALL(macd - expected[0], 1e-12);
+        BOOST_CHECK_SMALL(signal - expected[1], 1e-12);
+        BOOST_CHECK_SMALL(histogram - expected[2], 1e-12);
+      }
+    }
+  }
+  TA_SetUnstablePeriod(TA_FUNC_UNST_EMA, 0);
+
+  BOOST_CHECK_EQUAL(calculateEma(&closes[0], -1, 10, 0, &unused, &hasValue), INVALID_PARAMETER);
+  BOOST_CHECK_EQUAL(calculateMacd(&closes[0], 100, 1, 26, 9, 0, &unused, &unused, &unused, &hasValue), INVALID_PARAMETER);
+}
+
+BOOST_AUTO_TEST_CASE(ema_and_macd_are_deterministic_across_threads)
+{
+  const int numThreads = 8, numRepeats = 4;
+  std::vector<time_t> times;
+  std::vector<double> closes;
+  std::vector<EmaRun> expected(numThreads), runs(numThreads * numRepeats);
+  boost::thread_group threads;
+
+  makeBBandStopSeries(2000, 31, times, closes);
+
+  /* Each thread has its own unstable period, as instances running with different settings would */
+  for(int t = 0; t < numThreads; t++)
+  {
+    expected[t].pCloses = &closes;
+    expected[t].unstablePeriod = 5 * t;
+    expected[t]();
+  }
+
+  for(int r = 0; r < numThreads * numRepeats; r++)
+  {
+    runs[r].pCloses = &closes;
+    runs[r].unstablePeriod = expected[r % numThreads].unstablePeriod;
+  }
+  for(int r = 0; r < numThreads * numRepeats; r++)
+  {
+    threads.create_thread(boost::ref(runs[r]));
+  }
+  threads.join_all();
+
+  for(int r = 0; r < numThreads * numRepeats; r++)
+  {
+    BOOST_CHECK_EQUAL(runs[r].failures, 0);
+    BOOST_CHECK(runs[r].values == expected[r % numThreads].values);
+  }
+  BOOST_CHECK(expected[0].values != expected[1].values);
+}
+
+BOOST_AUTO_TEST_CASE(indicatorHistory_follows_a_sliding_rates_window)
+{
+  const int windowSize = 200, numBars = 3 * INDICATOR_HISTORY_BARS;
+  std::vector<time_t> times;
+  std::vector<double> closes;
+  IndicatorHistory* pHistory = new IndicatorHistory;
+  double values[INDICATOR_HISTORY_VALUES];
+
+  makeBBandStopSeries(numBars, 17, times, closes);
+  resetIndicatorHistory(pHistory);
+
+  /* Closed bars are those up to index windowSize - 2, the value of bar k is k */
+  for(int n = windowSize; n <= numBars; n++)
+  {
+    int firstBar = n - windowSize, lastIndex = windowSize - 2;
+    int i = alignIndicatorHistory(pHistory, &times[firstBar], &closes[firstBar], lastIndex) + 1;
+
+    if(n > windowSize) BOOST_REQUIRE_EQUAL(i, lastIndex);
+    for(; i <= lastIndex; i++)
+    {
+      double barValues[INDICATOR_HISTORY_VALUES] = {(double)(firstBar + i), 1, 2};
+      addIndicatorHistoryBar(pHistory, times[firstBar + i], closes[firstBar + i], (firstBar + i) % 10 != 0, barValues);
+    }
+  }
+
+  /* The history reaches further back than the window */
+  BOOST_CHECK_EQUAL(pHistory->numBars, INDICATOR_HISTORY_BARS);
+  for(int barsBack = 0; barsBack < INDICATOR_HISTORY_BARS; barsBack++)
+  {
+    int bar = numBars - 2 - barsBack;
+    BOOST_REQUIRE_EQUAL(getIndicatorHistoryBar(pHistory, barsBack, values), bar % 10 != 0);
+    if(bar % 10 != 0) BOOST_CHECK_EQUAL(values[0], bar);
+  }
+  BOOST_CHECK_EQUAL(getIndicatorHistoryBar(pHistory, INDICATOR_HISTORY_BARS, values), INDICATOR_HISTORY_MISSING);
+
+  /* Past the capacity the oldest bars are dropped */
+  for(int bar = 0; bar < numBars; bar++)
+  {
+    double barValues[INDICATOR_HISTORY_VALUES] = {(double)bar, 0, 0};
+    addIndicatorHistoryBar(pHistory, times[bar], closes[bar], TRUE, barValues);
+  }
+  BOOST_CHECK_EQUAL(pHistory->numBars, INDICATOR_HISTORY_BARS);
+  BOOST_CHECK_EQUAL(getIndicatorHistoryBar(pHistory, INDICATOR_HISTORY_BARS - 1, values), TRUE);
+  BOOST_CHECK_EQUAL(values[0], numBars - INDICATOR_HISTORY_BARS);
+  BOOST_CHECK_EQUAL(getIndicatorHistoryBar(pHistory, INDICATOR_HISTORY_BARS, values), INDICATOR_HISTORY_MISSING);
+
+  delete pHistory;
+}
+
+BOOST_AUTO_TEST_CASE(indicatorHistory_resets_when_its_newest_bar_is_gone)
+{
+  std::vector<time_t> times, otherTimes;
+  std::vector<double> closes, otherCloses;
+  IndicatorHistory* pHistory = new IndicatorHistory;
+  double barValues[INDICATOR_HISTORY_VALUES] = {1, 2, 3};
+
+  makeBBandStopSeries(2000, 19, times, closes);
+  makeBBandStopSeries(2000, 23, otherTimes, otherCloses);
+  resetIndicatorHistory(pHistory);
+  BOOST_CHECK_EQUAL(alignIndicatorHistory(pHistory, &times[0], &closes[0], 100), -1);
+
+  for(int bar = 0; bar <= 100; bar++)
+  {
+    addIndicatorHistoryBar(pHistory, times[bar], closes[bar], TRUE, barValues);
+  }
+  BOOST_CHECK_EQUAL(alignIndicatorHistory(pHistory, &times[0], &closes[0], 100), 100);
+  BOOST_CHECK_EQUAL(alignIndicatorHistory(pHistory, &times[50], &closes[50], 60), 50);
+
+  /* Another symbol at the same times */
+  BOOST_CHECK_EQUAL(alignIndicatorHistory(pHistory, &otherTimes[0], &otherCloses[0], 100), -1);
+  BOOST_CHECK_EQUAL(pHistory->numBars, 0);
+
+  /* The newest bar is further back than a full history */
+  for(int bar = 0; bar <= 100; bar++)
+  {
+    addIndicatorHistoryBar(pHistory, times[bar], closes[bar], TRUE, barValues);
+  }
+  BOOST_CHECK_EQUAL(alignIndicatorHistory(pHistory, &times[0], &closes[0], 101 + INDICATOR_HISTORY_BARS), -1);
+
+  delete pHistory;
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,56 @@
+/** @file  fitnessCache.h
+ @brief Fitness of the parameter sets the genetic optimizer already tested
+
+ Gaul evaluates elites, duplicate offspring and chromosomes that map to the same
+ parameter values (mapParamValue only has (stop-start)/step+1 values per parameter)
+ again and again, and every evaluation is a full backtest of every symbol. The cache
+ keys the fitness by the decoded parameter values and the optimization goal in an open
+ addressing hash table that doubles when it gets half full.
+
+ Lookups and stores are serialized, so the cache can be shared by the OpenMP threads
+ evaluating a generation. Two threads that miss on the same set at the same time both
+ run it and store the same fitness.
+ */
+
+#pragma once
+
+typedef struct fitness_cache_t
+{
+  double*        keys;      /* capacity * numParams decoded parameter values */
+  int*           goals;
+  double*        fitness;
+  unsigned char* used;
+  int            numParams;
+  int            capacity;
+  int            count;
+  long           hits;
+  long           misses;
+} FitnessCache;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** int initFitnessCache(FitnessCache *pCache, int numParams, int initialCapacity);
+ @return true on success, false if the table could not be allocated
+ */
+int initFitnessCache(FitnessCache *pCache, int numParams, int initialCapacity);
+
+/** int lookupFitness(FitnessCache *pCache, const double *params, int goal, double *pFitness);
+ @brief Counts a hit or a miss
+ @return true and the cached fitness in pFitness if the set was tested for this goal
+ */
+int lookupFitness(FitnessCache *pCache, const double *params, int goal, double *pFitness);
+
+/** int storeFitness(FitnessCache *pCache, const double *params, int goal, double fitness);
+ @return true on success, false if the table could not grow (the set is not cached then)
+ */
+int storeFitness(FitnessCache *pCache, const double *params, int goal, double fitness);
+
+/** void freeFitnessCache(FitnessCache *pCache);
+ */
+void freeFitnessCache(FitnessCache *pCache);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
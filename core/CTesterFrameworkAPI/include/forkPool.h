@@ -0,0 +1,60 @@
+/** @file  forkPool.h
+ @brief Worker processes for the brute force optimizer
+
+ Threads of one process share the framework globals (logger, instance tables, TA-Lib
+ settings), which limits how far a brute force run scales. In process mode the
+ optimizer forks numWorkers children before the run. Worker w runs combinations w,
+ w+numWorkers, ... single threaded, reading the history the parent loaded through the
+ copy-on-write pages it inherited. Every result is written to the worker's pipe as one
+ record (TestResult followed by the parameter set) and the parent hands the records to
+ the optimizationUpdate callback as they arrive, so the callback keeps running in the
+ calling process.
+
+ Available on Linux and macOS, startForkWorkers fails elsewhere.
+ */
+
+#pragma once
+
+#include "CTesterFrameworkDefines.h"
+
+#define FORK_POOL_PARENT  -1
+#define FORK_POOL_FAILED  -2
+#define MAX_FORK_WORKERS  256
+
+typedef struct fork_pool_t
+{
+  int numWorkers;
+  int pids[MAX_FORK_WORKERS];
+  int fds[MAX_FORK_WORKERS];  /* Read end of each worker's pipe, -1 once closed */
+} ForkPool;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** int startForkWorkers(ForkPool *pPool, int numWorkers);
+ @return The worker index (0..numWorkers-1) in the children, FORK_POOL_PARENT in the
+         parent, FORK_POOL_FAILED if no worker could be started (nothing is left running)
+ */
+int startForkWorkers(ForkPool *pPool, int numWorkers);
+
+/** void forkWorkerUpdate(TestResult testResult, double* settings, int numSettings);
+ @brief optimizationUpdate replacement for the workers, sends the result to the parent
+ */
+void forkWorkerUpdate(TestResult testResult, double* settings, int numSettings);
+
+/** void finishForkWorker(int exitCode);
+ @brief Closes the worker's pipe and ends the worker process, never returns
+ */
+void finishForkWorker(int exitCode);
+
+/** int collectForkResults(ForkPool *pPool, int numSettings, void (*optimizationUpdate)(TestResult testResult, double* settings, int numSettings), volatile int* pStop);
+ @brief Hands the workers' results to optimizationUpdate until every worker finished.
+        The workers are terminated when *pStop becomes non zero.
+ @return The number of workers that did not exit cleanly
+ */
+int collectForkResults(ForkPool *pPool, int numSettings, void (*optimizationUpdate)(TestResult testResult, double* settings, int numSettings), volatile int* pStop);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
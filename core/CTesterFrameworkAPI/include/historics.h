@@ -1,10 +1,57 @@
 /** @file  historics.h
     @brief Historic OHLC data management
+
+    Besides the CSV files written by the Python front end the tester understands a
+    compact columnar binary format. A binary file starts with a HistoryFileHeader,
+    followed by the time column (int, padded to a multiple of 8 bytes) and then one
+    double column per field, each numBars long. Rates files store the columns in
+    ASTRates order (open, high, low, close, volume, swapLong, swapShort), quote files
+    store the price and tick files store bid and ask.
+
+    Binary files are memory-mapped, so repeated backtests over the same symbols skip
+    text parsing entirely. openHistorySeries() prefers "<name>.bin" next to the CSV
+    file when it exists and is not older than the CSV, and falls back to the CSV file
+    otherwise.
 */
 
 #pragma once
 #include "CTesterFrameworkDefines.h"
 
+#define HISTORY_FILE_MAGIC   0x52485341 /* "ASHR" */
+#define HISTORY_FILE_VERSION 1
+#define HISTORY_MAX_COLUMNS  7
+
+typedef enum historyKind_t
+{
+  HISTORY_RATES  = 0, /* dd/mm/yy HH:MM,open,high,low,close,volume[,swap,swap] */
+  HISTORY_QUOTES = 1, /* dd/mm/yy HH:MM,price (%s_QUOTES.csv) */
+  HISTORY_TICKS  = 2  /* dd-mm-yyyy-HH-MM-SS,bid,ask (%s_TICK.csv) */
+} HistoryKind;
+
+typedef struct history_file_header_t
+{
+  int magic;
+  int version;
+  int kind;
+  int numColumns;
+  int numBars;
+  int reserved;
+} HistoryFileHeader;
+
+typedef struct history_series_t
+{
+  int           kind;
+  int           numBars;
+  int           numColumns;
+  const int*    time;
+  const double* column[HISTORY_MAX_COLUMNS];
+  int           cursor;      /* Next row returned by nextHistoryRow */
+  void*         mapping;     /* Mapped binary file, NULL if the series was parsed from CSV */
+  size_t        mappingSize;
+  void*         mapHandle;   /* File mapping handle (Windows only) */
+  void*         buffer;      /* Heap block holding a CSV-parsed series */
+} HistorySeries;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -18,6 +65,67 @@ extern "C" {
 */
 int __stdcall readHistoricFile(char *historicPath, Rates **rates, char **error);
 
+/** int readHistoryCsv(const char *csvPath, int kind, HistorySeries *pSeries);
+ @brief Parses a CSV history file in a single pass into one heap block
+ @return true on success, false if the file could not be read
+*/
+int readHistoryCsv(const char *csvPath, int kind, HistorySeries *pSeries);
+
+/** int mapHistoryFile(const char *binPath, int kind, HistorySeries *pSeries);
+ @brief Memory-maps a binary history file
+ @return true on success, false if the file is missing, truncated or of another kind
+*/
+int mapHistoryFile(const char *binPath, int kind, HistorySeries *pSeries);
+
+/** int openHistorySeries(const char *csvPath, int kind, HistorySeries *pSeries);
+ @brief Maps the binary sibling of csvPath when it is up to date, parses the CSV file otherwise
+ @return true on success, false if neither file could be read
+*/
+int openHistorySeries(const char *csvPath, int kind, HistorySeries *pSeries);
+
+/** int nextHistoryRow(HistorySeries *pSeries);
+ @brief Returns the row at the cursor and advances it, -1 once the series is exhausted
+*/
+int nextHistoryRow(HistorySeries *pSeries);
+
+/** int alignHistorySeries(const HistorySeries *pSeries, int column, const ASTRates *pRates, int numCandles, double *pAligned);
+ @brief Resamples one column onto the bar timestamps of pRates in a single merge pass
+ Bar k receives the first row whose time is >= the bar time, or the last row once the
+ series is exhausted. Rows with a negative time are skipped.
+ @param pAligned Receives numCandles values
+ @return true on success, false if the series has no usable rows
+*/
+int alignHistorySeries(const HistorySeries *pSeries, int column, const ASTRates *pRates, int numCandles, double *pAligned);
+
+/** void closeHistorySeries(HistorySeries *pSeries);
+ @brief Unmaps or frees the series
+*/
+void closeHistorySeries(HistorySeries *pSeries);
+
+/** int writeHistoryFile(const char *binPath, const HistorySeries *pSeries);
+ @brief Writes a series in the binary format
+ @return true on success
+*/
+int writeHistoryFile(const char *binPath, const HistorySeries *pSeries);
+
+/** int convertHistoryFile(char *csvPath, char *binPath, int kind);
+ @brief One-shot CSV to binary conversion
+ @return Number of rows converted, -1 on error
+*/
+int __stdcall convertHistoryFile(char *csvPath, char *binPath, int kind);
+
+/** int loadHistoricRates(char *historyPath, ASTRates **rates, int *numBars);
+ @brief Loads a rates history (.csv or .bin) into a calloc'd ASTRates array
+ @param rates Receives the array, release it with freeHistoricRates
+ @return true on success
+*/
+int __stdcall loadHistoricRates(char *historyPath, ASTRates **rates, int *numBars);
+
+/** void freeHistoricRates(ASTRates *rates);
+ @brief Releases an array returned by loadHistoricRates
+*/
+void __stdcall freeHistoricRates(ASTRates *rates);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
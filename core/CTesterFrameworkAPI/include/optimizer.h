@@ -43,12 +43,41 @@ typedef struct genetic_optimization_settings_t
 	int discardAssymetricSets;
 	int minTradesAYear;
 	int optimizationGoal;
+	int numIslands;			//0 or 1 = single population, otherwise sub-populations of population entities evolving on their own threads
+	int migrationInterval;	//Generations between elite exchanges of the islands, 0 = 10. population * migrationProbability elites (at least 1) migrate
 } GeneticOptimizationSettings;
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Value of parameter param in brute force combination number combination (0 to the number of combinations - 1).
+   The first parameter varies fastest, the order the brute force results are reported in. */
+double getParameterSetValue(int combination, int param, OptimizationParam *optimizationParams);
+
+/* Fitness of one run for an OptimizationGoal, the value the optimizer maximizes. Returns false for unsupported goals. */
+int getGoalFitness(TestResult testResult, int optimizationGoal, double initialBalance, double *pFitness);
+
+/* True (and logged) for the runs the genetic optimizer gives a fitness of 0: losing, assymetric,
+   under minTradesAYear or stopped by an abort criterion */
+int isDiscardedResult(TestResult testResult, GeneticOptimizationSettings optimizationSettings, double initialBalance, int iteration);
+
+/* isDiscardedResult without the log, for runs the optimizer already judged and logged */
+int isDiscardedResultQuiet(TestResult testResult, GeneticOptimizationSettings optimizationSettings, double initialBalance);
+
+/* True once stopOptimization was called, until the next optimization starts */
+int isOptimizationStopped();
+
+/* Clears a stopOptimization request */
+void clearOptimizationStop();
+
+/* While kept, an optimization starts without clearing a stopOptimization request, so a
+   stop between the optimizations of a walk-forward ends it */
+void keepOptimizationStop(int isKept);
+
+/* Called as an optimization starts: clears a stopOptimization request unless it is kept */
+void startOptimizationStop();
+
 void __stdcall stopOptimization(
 );
 
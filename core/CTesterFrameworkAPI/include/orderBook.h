@@ -0,0 +1,57 @@
+/** @file  orderBook.h
+ @brief Per-system order bookkeeping for runPortfolioTest
+
+ Every system owns one OrderBook. Its array holds the open and pending orders of the
+ system in [0, numOpen) in the order they were opened, directly followed by the most
+ recently closed orders, newest first. The array is handed to the strategy as is, so
+ nothing has to be gathered per bar, and the tester only walks the live orders when it
+ checks pending orders, SL/TP levels and swaps.
+
+ The array grows geometrically, so the number of open orders is only limited by
+ memory. Closed orders are kept up to historySize (ORDERINFO_ARRAY_SIZE, the number of
+ entries the strategy reads). Entries past the open and closed orders are zero and
+ there is always at least one of them.
+ */
+
+#pragma once
+
+#include "CTesterFrameworkDefines.h"
+
+typedef struct order_book_t
+{
+  COrderInfo* orders;
+  int         capacity;
+  int         openOrdersCount[2]; /* [BUY] counts BUY, BUYLIMIT, BUYSTOP, [SELL] the rest */
+  int         numOpen;
+  int         numClosed;          /* Closed orders kept after the open ones */
+  int         historySize;
+} OrderBook;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** int initOrderBook(OrderBook *pBook, int historySize);
+ @param historySize Closed orders kept, also the minimum array size
+ @return true on success, false if the array could not be allocated
+ */
+int initOrderBook(OrderBook *pBook, int historySize);
+
+/** COrderInfo* addOrder(OrderBook *pBook, int type);
+ @brief Appends a zeroed open order of the given type and counts it
+ @return The new order, valid until the book changes again, NULL if the array could not grow
+ */
+COrderInfo* addOrder(OrderBook *pBook, int type);
+
+/** void retireOrder(OrderBook *pBook, int index);
+ @brief Moves open order index to the front of the closed orders and uncounts it
+ */
+void retireOrder(OrderBook *pBook, int index);
+
+/** void freeOrderBook(OrderBook *pBook);
+ */
+void freeOrderBook(OrderBook *pBook);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
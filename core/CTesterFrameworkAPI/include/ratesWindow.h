@@ -0,0 +1,57 @@
+/** @file  ratesWindow.h
+ @brief Sliding rate windows over the loaded history
+
+ The strategy needs its bars as contiguous CRates, while the loaded history is ASTRates
+ (with swaps, so a window can not point into it) and is shared by the optimizer threads.
+ Each window keeps a buffer of twice numBarsRequired bars that is filled from the loaded
+ history as the window moves, so every bar is converted once and the buffer is compacted
+ once every numBarsRequired bars instead of copying the whole window on every bar. The
+ strategy receives a pointer into the buffer. The forming bar (last element of the window)
+ is patched so that its high/low/close equal its open and its volume is 0, exactly as the
+ copying path did, and its closed values are restored when the window moves on.
+ */
+
+#pragma once
+
+#include "CTesterFrameworkDefines.h"
+
+typedef struct rates_window_t
+{
+  const ASTRates* source;   /* Loaded history, read only */
+  CRates* buffer;           /* Converted bars firstBar..endBar-1, NULL if the timeframe is unused */
+  int     capacity;
+  int     firstBar;
+  int     endBar;
+  int     numCandles;
+  int     windowSize;       /* numBarsRequired for this timeframe */
+  int     currentBar;       /* History index of the forming bar, -1 before the first move */
+  int     invalidBars;      /* Bars with time == -1 in the current window */
+  CRates  savedBar;         /* Closed values of the forming bar */
+  CRates  emptyBar;         /* Returned for unused timeframes */
+} RatesWindow;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** int initRatesWindow(RatesWindow *pWindow, const ASTRates *pSource, int numCandles, int windowSize);
+ @brief Prepares the window over pSource, which must outlive it. windowSize <= 0 disables the timeframe.
+ @return true on success, false if the buffer could not be allocated
+ */
+int initRatesWindow(RatesWindow *pWindow, const ASTRates *pSource, int numCandles, int windowSize);
+
+/** CRates* moveRatesWindow(RatesWindow *pWindow, int barIndex, int *pHasInvalidTime);
+ @brief Points the window at the windowSize bars ending at barIndex (the forming bar).
+ @param pHasInvalidTime Set to true if any bar in the window has time == -1
+ @return Pointer to the first bar of the window, valid until the next move
+ */
+CRates* moveRatesWindow(RatesWindow *pWindow, int barIndex, int *pHasInvalidTime);
+
+/** void freeRatesWindow(RatesWindow *pWindow);
+ @brief Releases the buffer
+ */
+void freeRatesWindow(RatesWindow *pWindow);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
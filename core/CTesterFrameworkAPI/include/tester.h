@@ -52,13 +52,18 @@ typedef struct testResult_t {
 	int numLongs;
 	double yearsTraded;
 	char   symbol[5000]; 
+	int    aborted;				//1 if an abort criterion of TestSettings stopped an optimization run early, the statistics then cover the bars run
 } TestResult;
 
+/* The abort criteria only apply to optimization runs (no testUpdate callback), 0 turns a criterion off */
 typedef struct testSettings_t{
 	double spread;
 	int fromDate;
 	int toDate;
 	int is_calculate_expectancy;
+	double abortMaxDD;			//Max drawdown depth (%) at which a run stops, the final drawdown can only be deeper
+	double abortMaxDDLength;	//Max drawdown length (days) at which a run stops, the final length can only be longer
+	double abortEquityFloor;	//Fraction of the initial balance under which the balance stops a run
 } TestSettings;
 
 typedef struct statistic_item_t
@@ -72,13 +77,14 @@ typedef struct statistic_item_t
 
 #include "CTesterFrameworkDefines.h"
 
-#define MAX_ORDERS 200
 #define MIN_STATISTICS_SIZE 200
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* pRates is only read, concurrent runs may share the same history. pRatesInfo, the
+   settings and the account info are written and must be private to each run. */
 TestResult __stdcall runPortfolioTest (
 	int				testId,
 	double**		pInSettings,
@@ -98,6 +104,9 @@ TestResult __stdcall runPortfolioTest (
 	void			(*signalUpdate)(TradeSignal signal)
 	);
 
+/* Seconds since the epoch for a UTC calendar date, independent of the local timezone */
+time_t mkgmtime(short year, short month, short day, short hour, short minute, short second);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
\ No newline at end of file
@@ -0,0 +1,100 @@
+/** @file  tradeStatistics.h
+ @brief Streaming test statistics
+
+ Closed trades are folded into running sums as they happen: profit factor and win
+ rates, the running peak and drawdown, the regression sums behind R2 (with a Welford
+ mean/variance of the balance curve) and the weekly returns behind Sharpe, Ulcer and
+ Martin (Welford again, with runs of tradeless weeks added in one step). The trade list
+ is still kept, in an array that grows geometrically, because the tester needs the
+ first trade time and the fallback below needs the whole list.
+
+ finishTradeStatistics() then fills TestResult in O(1). Against the full recomputation
+ (calculate_trade_by_trade_statistics and calculate_weekly_statistics) drawdown, profit
+ factor, winning percentage and risk/reward are identical, and r2, sharpe, ulcerIndex and
+ martin agree to a relative tolerance of 1e-9. Runs without trades, and runs with trades
+ past the last week counted before lastDate, go through the full recomputation.
+ */
+
+#pragma once
+
+#include "CTesterFrameworkDefines.h"
+
+#define SECONDS_PER_TEST_WEEK (DAYS_PER_WEEK * SECONDS_PER_DAY)
+
+typedef struct trade_statistics_t
+{
+  StatisticItem* items;        /* Every closed trade, in order */
+  int            count;
+  int            capacity;
+
+  double initialBalance;
+  int    isCompoundingDisabled;
+
+  /* Trade by trade */
+  int    firstTime;
+  double firstBalance;
+  double maxBalance;
+  double maxDDDepth;
+  int    maxDDLength;
+  int    ddStartTime;
+  double totalWin;
+  double totalLose;
+  double totalWinningTrades;
+  double totalLosingTrades;
+  double averageWinningTrade;
+  double averageLosingTrade;
+  double sumTimeSqr;           /* Sum of x^2, x = seconds since the first trade */
+  double sumTimeBalance;       /* Sum of x*y, y = balance (or log balance) change since the first trade */
+  double sumBalanceSqr;        /* Sum of y^2 */
+  double balanceMean;          /* Welford mean of y */
+  double balanceM2;            /* Welford sum of squared deviations of y */
+
+  /* Weekly */
+  int    weekEnd;              /* End of the week the last trade fell into */
+  int    closedWeeks;
+  double weekStartBalance;
+  double lastBalance;
+  double weekPeakBalance;
+  double ulcerSum;
+  double weekMean;             /* Welford mean of the weekly returns */
+  double weekM2;
+} TradeStatistics;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** int initTradeStatistics(TradeStatistics *pStatistics, double initialBalance, int isCompoundingDisabled, int initialCapacity);
+ @return true on success, false if the trade list could not be allocated
+ */
+int initTradeStatistics(TradeStatistics *pStatistics, double initialBalance, int isCompoundingDisabled, int initialCapacity);
+
+/** int addTradeStatistic(TradeStatistics *pStatistics, double profit, double balance, int time);
+ @brief Records a closed trade, amortized O(1)
+ @return true on success, false if the trade list could not grow
+ */
+int addTradeStatistic(TradeStatistics *pStatistics, double profit, double balance, int time);
+
+/** void finishTradeStatistics(TradeStatistics *pStatistics, int totalTrades, int lastDate, TestResult *testResult);
+ @brief Fills the drawdown, ratio and regression fields of testResult. testResult->cagr must already be set.
+ */
+void finishTradeStatistics(TradeStatistics *pStatistics, int totalTrades, int lastDate, TestResult *testResult);
+
+/** int exceedsAbortLimits(const TradeStatistics *pStatistics, const TestSettings *pSettings, double balance);
+ @brief Checks the early abort criteria of pSettings against the trades closed so far.
+        Drawdown depth and length only grow, a run past either limit ends past it too.
+ @return true if the run can stop
+ */
+int exceedsAbortLimits(const TradeStatistics *pStatistics, const TestSettings *pSettings, double balance);
+
+/** void freeTradeStatistics(TradeStatistics *pStatistics);
+ */
+void freeTradeStatistics(TradeStatistics *pStatistics);
+
+/** Full recomputation over the trade list, the reference for the streaming path */
+void calculate_trade_by_trade_statistics(StatisticItem *statistics, int statisticsSize, double initialBalance, int is_compounding_disabled, int totalTrades, TestResult *testResult);
+void calculate_weekly_statistics(StatisticItem *statistics, int statisticsSize, double initialBalance, int is_compounding_disabled, int lastDate, TestResult *testResult);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
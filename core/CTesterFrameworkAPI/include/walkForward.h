@@ -0,0 +1,112 @@
+/** @file  walkForward.h
+ @brief Walk-forward optimization
+
+ The test period (testSettings fromDate/toDate, within the history) is split into
+ windows of inSampleDays followed by outOfSampleDays, the windows starting stepDays
+ apart. Each in-sample period is optimized with runOptimizationMultipleSymbols on the
+ history the caller loaded once. The set with the highest optimization goal fitness,
+ summed over the symbols, is then tested on the out-of-sample period with all symbols
+ trading one account. Sets with a run the genetic optimizer would kill
+ (isDiscardedResult) do not qualify; a window without a qualifying set does not trade.
+
+ Each out-of-sample test starts from the balance the previous one ended with, so the
+ window balances form the stitched out-of-sample equity curve. An out-of-sample period
+ ends where the next one starts: with stepDays under outOfSampleDays it is cut short,
+ above it the curve is flat in between. Trades still open at the end of a period run to
+ their exit, as in any backtest.
+
+ stopOptimization ends the walk-forward, also when it is called between two windows.
+
+ Not available under MPI, where each rank only sees the results of its own runs.
+ */
+
+#pragma once
+
+#include "CTesterFrameworkDefines.h"
+
+typedef struct walk_forward_settings_t
+{
+  int inSampleDays;
+  int outOfSampleDays;
+  int stepDays;             /* 0 = outOfSampleDays */
+} WalkForwardSettings;
+
+typedef struct walk_forward_window_t
+{
+  int        index;
+  int        inSampleFrom;
+  int        inSampleTo;
+  int        outOfSampleFrom;
+  int        outOfSampleTo;
+  int        hasSet;               /* false if no set qualified, the window did not trade */
+  double     inSampleFitness;      /* Summed goal fitness of the chosen set */
+  double     startBalance;         /* Stitched equity curve at outOfSampleFrom */
+  double     endBalance;           /* and at the end of the out-of-sample test */
+  TestResult outOfSampleResult;
+} WalkForwardWindow;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** int getWalkForwardWindows(WalkForwardSettings walkForwardSettings, int fromDate, int toDate, WalkForwardWindow *windows, int maxWindows);
+ @brief Lays out the windows of a walk-forward run over [fromDate, toDate]. Only the dates and index of each window are set.
+ @return The number of windows, at most maxWindows (windows may be NULL to count them), 0 for invalid settings
+ */
+int getWalkForwardWindows(WalkForwardSettings walkForwardSettings, int fromDate, int toDate, WalkForwardWindow *windows, int maxWindows);
+
+/* The in-sample optimizer and out-of-sample tester of a walk-forward, with the arguments of
+   runOptimizationMultipleSymbols and runPortfolioTest */
+typedef int (__stdcall *WalkForwardOptimizer)(OptimizationParam *optimizationParams, int numOptimizedParams, OptimizationType optimizationType,
+	GeneticOptimizationSettings optimizationSettings, int numThreads, double* pInSettings, char** pInTradeSymbol, char* pInAccountCurrency,
+	char* pInBrokerName, char* pInRefBrokerName, double* pInAccountInfo, TestSettings* testSettings, CRatesInfo** pRatesInfo, int numCandles,
+	int numSymbols, ASTRates*** pRates, double minLotSize, void (*optimizationUpdate)(TestResult testResult, double* settings, int numSettings),
+	void (*optimizationFinished)(), char **error);
+
+typedef TestResult (__stdcall *WalkForwardTester)(int testId, double** pInSettings, char** pInTradeSymbol, char* pInAccountCurrency,
+	char* pInBrokerName, char* pInRefBrokerName, double** pInAccountInfo, TestSettings *testSettings, CRatesInfo** pRatesInfo, int numCandles,
+	int numSystems, ASTRates*** pRates, double minLotSize,
+	void (*testUpdate)(int testId, double percentageOfTestCompleted, COrderInfo lastOrder, double currentBalance, char* symbol),
+	void (*testFinished)(TestResult testResults), void (*signalUpdate)(TradeSignal signal));
+
+/** void setWalkForwardRunners(WalkForwardOptimizer optimizer, WalkForwardTester tester);
+ @brief Replaces the runners of the following walk-forwards, for tests. NULL restores
+        runOptimizationMultipleSymbols or runPortfolioTest. An optimizer honours
+        stopOptimization by calling startOptimizationStop as it starts.
+ */
+void setWalkForwardRunners(WalkForwardOptimizer optimizer, WalkForwardTester tester);
+
+/** int runWalkForwardOptimization(...);
+ @brief Takes the arguments of runOptimizationMultipleSymbols plus the window settings.
+        optimizationUpdate (may be NULL) gets every in-sample run, walkForwardUpdate every
+        window with the chosen set once its out-of-sample test finished.
+ @return true on success, false with a description in error otherwise
+ */
+int __stdcall runWalkForwardOptimization(
+	OptimizationParam	*optimizationParams,
+	int					numOptimizedParams,
+	OptimizationType	optimizationType,
+	GeneticOptimizationSettings optimizationSettings,
+	int					numThreads,
+	double*				pInSettings,
+	char**				pInTradeSymbol,
+	char*				pInAccountCurrency,
+	char*				pInBrokerName,
+	char*				pInRefBrokerName,
+	double*				pInAccountInfo,
+	TestSettings*		testSettings,
+	CRatesInfo**		pRatesInfo,
+	int					numCandles,
+	int					numSymbols,
+	ASTRates***			pRates,
+	double				minLotSize,
+	WalkForwardSettings	walkForwardSettings,
+	void				(*optimizationUpdate)(TestResult testResult, double* settings, int numSettings),
+	void				(*walkForwardUpdate)(WalkForwardWindow window, double* settings, int numSettings),
+	void				(*optimizationFinished)(),
+	char				**error
+);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -0,0 +1,47 @@
+/** @file  workerInstances.h
+ @brief Instance IDs private to each optimizer worker
+
+ The framework keys its rates buffers, instance states and state files by instance ID.
+ When every optimizer thread ran with the set file STRATEGY_INSTANCE_ID they all shared
+ one rates buffer slot and one instance state, so one thread could see another one's
+ bars as already run. Every worker now runs the set file ID under an ID of its own,
+ taken from [WORKER_INSTANCE_ID_BASE, INT_MAX), above any ID a set file uses.
+
+ The set file IDs are registered when a worker ID is handed out and getConfigInstanceId
+ looks them up again, so the ID itself carries no part of the set file ID. Any ID below
+ WORKER_INSTANCE_ID_BASE (plain backtests, live trading) is its own config ID.
+
+ A worker initializes its instance in its own thread on every run and releases it
+ afterwards, so at most workers * symbols framework slots are in use at a time.
+ */
+
+#pragma once
+
+#define WORKER_INSTANCE_ID_BASE 1000000000
+#define MAX_WORKER_CONFIG_IDS   64
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** int getWorkerInstanceId(int configInstanceId, int worker);
+ @param configInstanceId Set file instance ID
+ @param worker           Zero based worker (thread) number
+ @return The instance ID the worker runs configInstanceId with, configInstanceId itself
+         if MAX_WORKER_CONFIG_IDS set file IDs are already registered
+ */
+int getWorkerInstanceId(int configInstanceId, int worker);
+
+/** int getConfigInstanceId(int instanceId);
+ @return The set file instance ID registered for instanceId, instanceId itself for non worker IDs
+ */
+int getConfigInstanceId(int instanceId);
+
+/** void releaseWorkerInstance(int instanceId);
+ @brief Frees the rates buffers, the instance state and the indicator states the framework holds for a worker instance ID
+ */
+void releaseWorkerInstance(int instanceId);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -24,6 +24,9 @@ project "CTesterFrameworkAPI"
 	"AsirikuyCommon", 
 	"Log"
   }
+  if _OPTIONS["gaul-thread-safe"] then
+    defines{"GAUL_THREAD_SAFE"}
+  end
   libdirs{
 	"../../bin/**",
 	"../../../bin/" .. _ACTION .. "/x64/Debug/lib",  -- Gaul library location
@@ -40,10 +40,9 @@ static void seedRand()
 
 static int startCTesterFramework(char* pAsirikuyTesterLog, int severityLevel)
 {
-  static BOOL initialized  = FALSE;
-  static BOOL initializing = FALSE;
+  static BOOL initialized = FALSE;
 
-  // Thread-safe access to static initialization state
+  // Initialization is short, concurrent callers wait for it instead of getting WAIT_FOR_INIT
   enterCriticalSection();
   
   if(initialized)
@@ -52,25 +51,14 @@ static int startCTesterFramework(char* pAsirikuyTesterLog, int severityLevel)
     return (int)SUCCESS;
   }
 
-  if(initializing)
-  {
-    leaveCriticalSection();
-    return (int)WAIT_FOR_INIT;
-  }
-
-  initializing = TRUE;
-  leaveCriticalSection(); // Release lock during initialization to avoid deadlock
-  
   seedRand();
 
-  // Initialize the common logger (logger has its own critical section protection)
+  // Initialize the common logger (logger has its own lock)
   asirikuyLoggerInit(pAsirikuyTesterLog, severityLevel);
 
   logNotice("CTesterFramework initialization complete.");
   
-  enterCriticalSection();
   initialized = TRUE;
-  initializing = FALSE;
   leaveCriticalSection();
   return (int)SUCCESS;
 }
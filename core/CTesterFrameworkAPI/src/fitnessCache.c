@@ -0,0 +1,139 @@
+//
+//  fitnessCache.c
+//  ast
+//
+//  Fitness of the parameter sets the genetic optimizer already tested.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include "CTesterFrameworkDefines.h"
+#include "fitnessCache.h"
+
+#define MIN_FITNESS_CACHE_CAPACITY 64
+
+static unsigned long long hashSet(const double *params, int numParams, int goal){
+	unsigned long long hash = 14695981039346656037ULL, bits;
+	double value;
+	int i;
+
+	for (i = 0; i < numParams; i++){
+		value = params[i] == 0 ? 0.0 : params[i]; //-0.0 and 0.0 are the same set
+		memcpy(&bits, &value, sizeof(bits));
+		hash = (hash ^ bits) * 1099511628211ULL;
+		hash ^= hash >> 29;
+	}
+	hash = (hash ^ (unsigned long long)(unsigned int)goal) * 1099511628211ULL;
+	return hash ^ (hash >> 32);
+}
+
+static int findSlot(const FitnessCache *pCache, const double *params, int goal){
+	int slot = (int)(hashSet(params, pCache->numParams, goal) & (unsigned long long)(pCache->capacity - 1));
+	int i;
+
+	while (pCache->used[slot]){
+		if (pCache->goals[slot] == goal){
+			for (i = 0; i < pCache->numParams && pCache->keys[slot * pCache->numParams + i] == params[i]; i++);
+			if (i == pCache->numParams) return slot;
+		}
+		slot = (slot + 1) & (pCache->capacity - 1);
+	}
+	return slot;
+}
+
+static int allocateTable(FitnessCache *pCache, int capacity){
+	pCache->keys    = (double*)malloc((size_t)capacity * (pCache->numParams > 0 ? pCache->numParams : 1) * sizeof(double));
+	pCache->goals   = (int*)malloc(capacity * sizeof(int));
+	pCache->fitness = (double*)malloc(capacity * sizeof(double));
+	pCache->used    = (unsigned char*)calloc(capacity, sizeof(unsigned char));
+
+	if (pCache->keys == NULL || pCache->goals == NULL || pCache->fitness == NULL || pCache->used == NULL){
+		free(pCache->keys); free(pCache->goals); free(pCache->fitness); free(pCache->used);
+		return false;
+	}
+
+	pCache->capacity = capacity;
+	return true;
+}
+
+static int growTable(FitnessCache *pCache){
+	FitnessCache old = *pCache;
+	int i, slot;
+
+	if (!allocateTable(pCache, old.capacity * 2)){
+		*pCache = old;
+		return false;
+	}
+
+	for (i = 0; i < old.capacity; i++){
+		if (!old.used[i]) continue;
+		slot = findSlot(pCache, &old.keys[i * old.numParams], old.goals[i]);
+		memcpy(&pCache->keys[slot * pCache->numParams], &old.keys[i * old.numParams], old.numParams * sizeof(double));
+		pCache->goals[slot] = old.goals[i];
+		pCache->fitness[slot] = old.fitness[i];
+		pCache->used[slot] = 1;
+	}
+
+	free(old.keys); free(old.goals); free(old.fitness); free(old.used);
+	return true;
+}
+
+int initFitnessCache(FitnessCache *pCache, int numParams, int initialCapacity){
+	int capacity = MIN_FITNESS_CACHE_CAPACITY;
+
+	memset(pCache, 0, sizeof(FitnessCache));
+	pCache->numParams = numParams;
+
+	//Power of two, at most half full
+	while (capacity < 2 * initialCapacity) capacity *= 2;
+
+	return allocateTable(pCache, capacity);
+}
+
+int lookupFitness(FitnessCache *pCache, const double *params, int goal, double *pFitness){
+	int slot, found = false;
+
+	#pragma omp critical (fitnessCache)
+	{
+		if (pCache->capacity > 0){
+			slot = findSlot(pCache, params, goal);
+			if (pCache->used[slot]){
+				*pFitness = pCache->fitness[slot];
+				found = true;
+			}
+		}
+		if (found) pCache->hits++;
+		else pCache->misses++;
+	}
+
+	return found;
+}
+
+int storeFitness(FitnessCache *pCache, const double *params, int goal, double fitness){
+	int slot, stored = false;
+
+	#pragma omp critical (fitnessCache)
+	{
+		if (pCache->capacity > 0 && (2 * (pCache->count + 1) <= pCache->capacity || growTable(pCache))){
+			slot = findSlot(pCache, params, goal);
+			if (!pCache->used[slot]){
+				memcpy(&pCache->keys[slot * pCache->numParams], params, pCache->numParams * sizeof(double));
+				pCache->goals[slot] = goal;
+				pCache->used[slot] = 1;
+				pCache->count++;
+			}
+			pCache->fitness[slot] = fitness;
+			stored = true;
+		}
+	}
+
+	return stored;
+}
+
+void freeFitnessCache(FitnessCache *pCache){
+	free(pCache->keys);
+	free(pCache->goals);
+	free(pCache->fitness);
+	free(pCache->used);
+	memset(pCache, 0, sizeof(FitnessCache));
+}
@@ -0,0 +1,203 @@
+//
+//  forkPool.c
+//  ast
+//
+//  Worker processes for the brute force optimizer.
+//
+
+#include <stdlib.h>
+#include "forkPool.h"
+#include "AsirikuyLogger.h"
+
+#if defined __linux__ || defined __APPLE__
+
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#define STOP_POLL_INTERVAL_MS 500
+
+static int workerFd = -1;
+
+static int writeAll(int fd, const void *buffer, size_t size){
+	const char *pData = (const char*)buffer;
+	ssize_t written;
+
+	while (size > 0){
+		written = write(fd, pData, size);
+		if (written < 0 && errno == EINTR) continue;
+		if (written <= 0) return false;
+		pData += written;
+		size -= written;
+	}
+	return true;
+}
+
+/* Returns the bytes read, less than size only at the end of the pipe */
+static size_t readAll(int fd, void *buffer, size_t size){
+	char *pData = (char*)buffer;
+	size_t total = 0;
+	ssize_t got;
+
+	while (total < size){
+		got = read(fd, pData + total, size - total);
+		if (got < 0 && errno == EINTR) continue;
+		if (got <= 0) break;
+		total += got;
+	}
+	return total;
+}
+
+int startForkWorkers(ForkPool *pPool, int numWorkers){
+	int w, k, pipeFds[2];
+	pid_t pid;
+
+	if (numWorkers > MAX_FORK_WORKERS) numWorkers = MAX_FORK_WORKERS;
+	pPool->numWorkers = 0;
+
+	//Flush before forking so buffered output is not written twice
+	fflush(stdout);
+	fflush(stderr);
+
+	for (w = 0; w < numWorkers; w++){
+		if (pipe(pipeFds) != 0) break;
+
+		pid = fork();
+		if (pid < 0){
+			close(pipeFds[0]);
+			close(pipeFds[1]);
+			break;
+		}
+
+		if (pid == 0){
+			//Only the own write end stays open, the parent sees EOF when the worker ends
+			for (k = 0; k < pPool->numWorkers; k++) close(pPool->fds[k]);
+			close(pipeFds[0]);
+			workerFd = pipeFds[1];
+			return w;
+		}
+
+		close(pipeFds[1]);
+		pPool->pids[w] = (int)pid;
+		pPool->fds[w] = pipeFds[0];
+		pPool->numWorkers++;
+	}
+
+	if (pPool->numWorkers == 0) return FORK_POOL_FAILED;
+
+	//Workers that could not be started leave their combinations unrun, stop the others
+	if (pPool->numWorkers < numWorkers){
+		for (w = 0; w < pPool->numWorkers; w++){
+			kill((pid_t)pPool->pids[w], SIGTERM);
+			close(pPool->fds[w]);
+			waitpid((pid_t)pPool->pids[w], NULL, 0);
+		}
+		pPool->numWorkers = 0;
+		return FORK_POOL_FAILED;
+	}
+
+	return FORK_POOL_PARENT;
+}
+
+void forkWorkerUpdate(TestResult testResult, double* settings, int numSettings){
+	if (workerFd < 0) return;
+
+	if (!writeAll(workerFd, &numSettings, sizeof(int)) ||
+		!writeAll(workerFd, &testResult, sizeof(TestResult)) ||
+		!writeAll(workerFd, settings, numSettings * 2 * sizeof(double))){
+		//The parent is gone
+		finishForkWorker(EXIT_FAILURE);
+	}
+}
+
+void finishForkWorker(int exitCode){
+	//_exit skips the exit handlers, the logger's queued lines are written here
+	asirikuyLoggerFlush();
+	fflush(stdout);
+	fflush(stderr);
+	if (workerFd >= 0) close(workerFd);
+	_exit(exitCode);
+}
+
+int collectForkResults(ForkPool *pPool, int numSettings, void (*optimizationUpdate)(TestResult testResult, double* settings, int numSettings), volatile int* pStop){
+	struct pollfd pollFds[MAX_FORK_WORKERS];
+	int w, numOpen = pPool->numWorkers, numFailed = 0, status, recordSettings, isStopped = false;
+	TestResult *pResult = (TestResult*)malloc(sizeof(TestResult));
+	double *settings = (double*)malloc((numSettings > 0 ? numSettings : 1) * 2 * sizeof(double));
+	size_t got;
+	pid_t waited;
+
+	while (numOpen > 0){
+		if (!isStopped && pStop != NULL && *pStop){
+			for (w = 0; w < pPool->numWorkers; w++) kill((pid_t)pPool->pids[w], SIGTERM);
+			isStopped = true;
+		}
+
+		for (w = 0; w < pPool->numWorkers; w++){
+			pollFds[w].fd = pPool->fds[w];
+			pollFds[w].events = POLLIN;
+			pollFds[w].revents = 0;
+		}
+
+		if (poll(pollFds, pPool->numWorkers, STOP_POLL_INTERVAL_MS) < 0){
+			if (errno == EINTR) continue;
+			break;
+		}
+
+		for (w = 0; w < pPool->numWorkers; w++){
+			if (pPool->fds[w] < 0 || pollFds[w].revents == 0) continue;
+
+			got = readAll(pPool->fds[w], &recordSettings, sizeof(int));
+			if (got == sizeof(int) && recordSettings == numSettings && pResult != NULL && settings != NULL &&
+				readAll(pPool->fds[w], pResult, sizeof(TestResult)) == sizeof(TestResult) &&
+				readAll(pPool->fds[w], settings, numSettings * 2 * sizeof(double)) == numSettings * 2 * sizeof(double)){
+				if (optimizationUpdate != NULL) optimizationUpdate(*pResult, settings, numSettings);
+				continue;
+			}
+
+			if (got != 0){
+				fprintf(stderr, "[OPT] ERROR: Truncated result from optimizer worker %d\n", w);
+				fflush(stderr);
+			}
+			close(pPool->fds[w]);
+			pPool->fds[w] = -1;
+			numOpen--;
+		}
+	}
+
+	for (w = 0; w < pPool->numWorkers; w++){
+		if (pPool->fds[w] >= 0) close(pPool->fds[w]);
+		pPool->fds[w] = -1;
+
+		status = 0;
+		while ((waited = waitpid((pid_t)pPool->pids[w], &status, 0)) < 0 && errno == EINTR);
+		if (waited < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) numFailed++;
+	}
+
+	free(pResult);
+	free(settings);
+	return numFailed;
+}
+
+#else
+
+int startForkWorkers(ForkPool *pPool, int numWorkers){
+	pPool->numWorkers = 0;
+	return FORK_POOL_FAILED;
+}
+
+void forkWorkerUpdate(TestResult testResult, double* settings, int numSettings){
+}
+
+void finishForkWorker(int exitCode){
+	exit(exitCode);
+}
+
+int collectForkResults(ForkPool *pPool, int numSettings, void (*optimizationUpdate)(TestResult testResult, double* settings, int numSettings), volatile int* pStop){
+	return 0;
+}
+
+#endif
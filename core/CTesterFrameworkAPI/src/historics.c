@@ -8,6 +8,15 @@
 
 #include "CTesterFrameworkDefines.h"
 #include "historics.h"
+#include "AsirikuyLogger.h"
+#include <sys/stat.h>
+#if defined _WIN32 || defined _WIN64
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
 
 time_t parseDate(const char * str)
 {
@@ -90,3 +99,356 @@ int __stdcall  readHistoricFile(char *historicPath, Rates **result, char **error
     return i;
 }
 
+static int historyColumns(int kind){
+	switch (kind){
+		case HISTORY_RATES:  return 7;
+		case HISTORY_QUOTES: return 1;
+		case HISTORY_TICKS:  return 2;
+		default:             return -1;
+	}
+}
+
+/* Byte size of the time column, padded so that the double columns stay 8-byte aligned */
+static size_t historyTimeBytes(int numBars){
+	return (((size_t)numBars * sizeof(int) + 7) / 8) * 8;
+}
+
+/* Accepts both dd/mm/yy HH:MM and dd-mm-yyyy-HH-MM-SS. Two digit years below 50 are 20xx. */
+static const char* parseHistoryDate(const char *p, int *pTime){
+	int fields[6] = {0, 0, 0, 0, 0, 0};
+	int n = 0, year;
+
+	while (*p != ',' && *p != '\n' && *p != '\0' && n < 6){
+		if (*p >= '0' && *p <= '9'){
+			int value = 0;
+			while (*p >= '0' && *p <= '9') value = value * 10 + (*p++ - '0');
+			fields[n++] = value;
+		} else {
+			p++;
+		}
+	}
+	while (*p != ',' && *p != '\n' && *p != '\0') p++;
+
+	year = fields[2];
+	if (year < 100) year += (year < 50) ? 2000 : 1900;
+
+	*pTime = (int)mkgmtime(year, fields[1], fields[0], fields[3], fields[4], fields[5]);
+	return p;
+}
+
+int readHistoryCsv(const char *csvPath, int kind, HistorySeries *pSeries){
+	FILE *file;
+	char *text, *p;
+	long size;
+	int capacity = 1, numColumns = historyColumns(kind), row = 0, c;
+	int *time;
+	double *columns;
+
+	memset(pSeries, 0, sizeof(HistorySeries));
+	if (numColumns < 0) return false;
+
+	file = fopen(csvPath, "rb");
+	if (file == NULL) return false;
+
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	rewind(file);
+
+	text = (char*)malloc(size + 1);
+	if (text == NULL || (long)fread(text, 1, size, file) != size){
+		free(text);
+		fclose(file);
+		return false;
+	}
+	fclose(file);
+	text[size] = '\0';
+
+	for (p = text; *p != '\0'; p++){
+		if (*p == '\n') capacity++;
+	}
+
+	pSeries->buffer = malloc(historyTimeBytes(capacity) + (size_t)capacity * numColumns * sizeof(double));
+	if (pSeries->buffer == NULL){
+		free(text);
+		return false;
+	}
+	time    = (int*)pSeries->buffer;
+	columns = (double*)((char*)pSeries->buffer + historyTimeBytes(capacity));
+
+	p = text;
+	while (*p != '\0'){
+		if (*p == '\n' || *p == '\r'){
+			p++;
+			continue;
+		}
+
+		p = (char*)parseHistoryDate(p, &time[row]);
+
+		for (c = 0; c < numColumns; c++){
+			double value = 0;
+			if (*p == ','){
+				char *next;
+				p++;
+				value = strtod(p, &next);
+				p = next;
+			}
+			columns[(size_t)c * capacity + row] = value;
+		}
+
+		while (*p != '\n' && *p != '\0') p++;
+		row++;
+	}
+	free(text);
+
+	pSeries->kind       = kind;
+	pSeries->numBars    = row;
+	pSeries->numColumns = numColumns;
+	pSeries->time       = time;
+	for (c = 0; c < numColumns; c++){
+		pSeries->column[c] = &columns[(size_t)c * capacity];
+	}
+
+	return true;
+}
+
+int mapHistoryFile(const char *binPath, int kind, HistorySeries *pSeries){
+	const HistoryFileHeader *header;
+	size_t size, expected;
+	void *mapping;
+	int c;
+
+	memset(pSeries, 0, sizeof(HistorySeries));
+
+#if defined _WIN32 || defined _WIN64
+	{
+		HANDLE file, mapHandle;
+		LARGE_INTEGER fileSize;
+
+		file = CreateFileA(binPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE) return false;
+
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(HistoryFileHeader)){
+			CloseHandle(file);
+			return false;
+		}
+		size = (size_t)fileSize.QuadPart;
+
+		mapHandle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		CloseHandle(file);
+		if (mapHandle == NULL) return false;
+
+		mapping = MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0);
+		if (mapping == NULL){
+			CloseHandle(mapHandle);
+			return false;
+		}
+		pSeries->mapHandle = mapHandle;
+	}
+#else
+	{
+		struct stat fileStat;
+		int fd = open(binPath, O_RDONLY);
+		if (fd < 0) return false;
+
+		if (fstat(fd, &fileStat) != 0 || fileStat.st_size < (off_t)sizeof(HistoryFileHeader)){
+			close(fd);
+			return false;
+		}
+		size = (size_t)fileStat.st_size;
+
+		mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (mapping == MAP_FAILED) return false;
+	}
+#endif
+
+	pSeries->mapping     = mapping;
+	pSeries->mappingSize = size;
+
+	header = (const HistoryFileHeader*)mapping;
+	if (header->magic != HISTORY_FILE_MAGIC || header->version != HISTORY_FILE_VERSION || header->kind != kind
+		|| header->numColumns != historyColumns(kind) || header->numBars < 0){
+		closeHistorySeries(pSeries);
+		return false;
+	}
+
+	expected = sizeof(HistoryFileHeader) + historyTimeBytes(header->numBars) + (size_t)header->numBars * header->numColumns * sizeof(double);
+	if (size < expected){
+		closeHistorySeries(pSeries);
+		return false;
+	}
+
+	pSeries->kind       = kind;
+	pSeries->numBars    = header->numBars;
+	pSeries->numColumns = header->numColumns;
+	pSeries->time       = (const int*)((const char*)mapping + sizeof(HistoryFileHeader));
+	for (c = 0; c < header->numColumns; c++){
+		pSeries->column[c] = (const double*)((const char*)mapping + sizeof(HistoryFileHeader) + historyTimeBytes(header->numBars)) + (size_t)c * header->numBars;
+	}
+
+	return true;
+}
+
+/* "<name>.csv" -> "<name>.bin", any other path gets ".bin" appended */
+static void historyBinaryPath(const char *csvPath, char *binPath, size_t length){
+	size_t pathLength = strlen(csvPath);
+
+	if (pathLength >= 4 && strcmp(csvPath + pathLength - 4, ".csv") == 0) pathLength -= 4;
+	snprintf(binPath, length, "%.*s.bin", (int)pathLength, csvPath);
+}
+
+int openHistorySeries(const char *csvPath, int kind, HistorySeries *pSeries){
+	char binPath[MAX_FILE_PATH_CHARS];
+	struct stat csvStat, binStat;
+	int hasCsv;
+
+	historyBinaryPath(csvPath, binPath, sizeof(binPath));
+	hasCsv = (stat(csvPath, &csvStat) == 0);
+
+	if (stat(binPath, &binStat) == 0 && (!hasCsv || binStat.st_mtime >= csvStat.st_mtime)){
+		if (mapHistoryFile(binPath, kind, pSeries)) return true;
+		logWarning("Binary history %s is not valid, falling back to %s", binPath, csvPath);
+	}
+
+	if (!hasCsv) {
+		memset(pSeries, 0, sizeof(HistorySeries));
+		return false;
+	}
+	return readHistoryCsv(csvPath, kind, pSeries);
+}
+
+int nextHistoryRow(HistorySeries *pSeries){
+	if (pSeries->cursor >= pSeries->numBars) return -1;
+	return pSeries->cursor++;
+}
+
+int alignHistorySeries(const HistorySeries *pSeries, int column, const ASTRates *pRates, int numCandles, double *pAligned){
+	int j = 0, last = -1, skipped = 0, k;
+
+	if (column < 0 || column >= pSeries->numColumns) return false;
+
+	for (k = 0; k < numCandles; k++){
+		while (j < pSeries->numBars && pSeries->time[j] < pRates[k].time){
+			if (pSeries->time[j] >= 0) last = j; else skipped++;
+			j++;
+		}
+		while (j < pSeries->numBars && pSeries->time[j] < 0){
+			skipped++;
+			j++;
+		}
+
+		if (j < pSeries->numBars){
+			pAligned[k] = pSeries->column[column][j];
+		} else if (last >= 0){
+			pAligned[k] = pSeries->column[column][last];
+		} else {
+			return false;
+		}
+	}
+
+	if (skipped > 0){
+		logWarning("alignHistorySeries: skipped %d rows with an invalid time", skipped);
+	}
+	return true;
+}
+
+void closeHistorySeries(HistorySeries *pSeries){
+#if defined _WIN32 || defined _WIN64
+	if (pSeries->mapping != NULL) UnmapViewOfFile(pSeries->mapping);
+	if (pSeries->mapHandle != NULL) CloseHandle((HANDLE)pSeries->mapHandle);
+#else
+	if (pSeries->mapping != NULL) munmap(pSeries->mapping, pSeries->mappingSize);
+#endif
+	free(pSeries->buffer);
+	memset(pSeries, 0, sizeof(HistorySeries));
+}
+
+int writeHistoryFile(const char *binPath, const HistorySeries *pSeries){
+	HistoryFileHeader header;
+	FILE *file;
+	char padding[8] = {0};
+	size_t timeBytes = historyTimeBytes(pSeries->numBars);
+	size_t rawTimeBytes = (size_t)pSeries->numBars * sizeof(int);
+	int c, ok;
+
+	memset(&header, 0, sizeof(header));
+	header.magic      = HISTORY_FILE_MAGIC;
+	header.version    = HISTORY_FILE_VERSION;
+	header.kind       = pSeries->kind;
+	header.numColumns = pSeries->numColumns;
+	header.numBars    = pSeries->numBars;
+
+	file = fopen(binPath, "wb");
+	if (file == NULL) return false;
+
+	ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	ok = ok && fwrite(pSeries->time, 1, rawTimeBytes, file) == rawTimeBytes;
+	ok = ok && fwrite(padding, 1, timeBytes - rawTimeBytes, file) == timeBytes - rawTimeBytes;
+	for (c = 0; c < pSeries->numColumns && ok; c++){
+		ok = fwrite(pSeries->column[c], sizeof(double), pSeries->numBars, file) == (size_t)pSeries->numBars;
+	}
+
+	if (fclose(file) != 0) ok = false;
+	return ok;
+}
+
+int __stdcall convertHistoryFile(char *csvPath, char *binPath, int kind){
+	HistorySeries series;
+	int numBars;
+
+	if (!readHistoryCsv(csvPath, kind, &series)){
+		logError("convertHistoryFile: cannot read %s", csvPath);
+		return -1;
+	}
+
+	numBars = series.numBars;
+	if (!writeHistoryFile(binPath, &series)){
+		logError("convertHistoryFile: cannot write %s", binPath);
+		numBars = -1;
+	}
+
+	closeHistorySeries(&series);
+	return numBars;
+}
+
+int __stdcall loadHistoricRates(char *historyPath, ASTRates **rates, int *numBars){
+	HistorySeries series;
+	size_t pathLength = strlen(historyPath);
+	int k, loaded;
+
+	*rates = NULL;
+	*numBars = 0;
+
+	if (pathLength >= 4 && strcmp(historyPath + pathLength - 4, ".bin") == 0){
+		loaded = mapHistoryFile(historyPath, HISTORY_RATES, &series);
+	} else {
+		loaded = openHistorySeries(historyPath, HISTORY_RATES, &series);
+	}
+	if (!loaded) return false;
+
+	/* calloc keeps the struct padding zeroed so arrays from both loaders compare equal byte for byte */
+	*rates = (ASTRates*)calloc(series.numBars > 0 ? series.numBars : 1, sizeof(ASTRates));
+	if (*rates == NULL){
+		closeHistorySeries(&series);
+		return false;
+	}
+
+	for (k = 0; k < series.numBars; k++){
+		(*rates)[k].open      = series.column[0][k];
+		(*rates)[k].high      = series.column[1][k];
+		(*rates)[k].low       = series.column[2][k];
+		(*rates)[k].close     = series.column[3][k];
+		(*rates)[k].volume    = series.column[4][k];
+		(*rates)[k].swapLong  = series.column[5][k];
+		(*rates)[k].swapShort = series.column[6][k];
+		(*rates)[k].time      = series.time[k];
+	}
+	*numBars = series.numBars;
+
+	closeHistorySeries(&series);
+	return true;
+}
+
+void __stdcall freeHistoricRates(ASTRates *rates){
+	free(rates);
+}
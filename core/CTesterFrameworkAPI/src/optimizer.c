@@ -1,6 +1,6 @@
 #include "CTesterFrameworkDefines.h"
 #include "Precompiled.h"
-#include "AsirikuyFrameworkAPI.h"  // For initInstanceC and WAIT_FOR_INIT, SUCCESS
+#include "AsirikuyFrameworkAPI.h"  // For initInstanceC and SUCCESS
 // Temporarily undefine AsirikuyLogger macros that conflict with Gaul's log_util.h enum
 // We'll include AsirikuyLogger.h after gaul.h to restore them
 #ifdef LOG_WARNING
@@ -11,6 +11,9 @@
 #endif
 #include "gaul.h"  // From vendor/Gaul/src/gaul.h
 #include "AsirikuyLogger.h"  // Restore our logging macros
+#include "workerInstances.h"
+#include "fitnessCache.h"
+#include "forkPool.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>  // For memset
@@ -30,7 +33,9 @@
 #endif
 
 #define MAXIMUM_PARAMETER_COMBINATIONS 10000000
+#define DEFAULT_MIGRATION_INTERVAL 10
 static int stopOpti = 0;
+static int keepStopOpti = 0;
 
 //Global copy of the parameters
 OptimizationParam	*globalOptimizationParams;
@@ -47,19 +52,54 @@ ASTRates***			globalRates;
 char**				globalMultiTradeSymbol;
 void				(*globalOptimizationUpdate)(TestResult testResult, double* settings, int numSettings);
 int					currentIteration = 0, globalNumSymbols;
-double				generationDifferences[5] = {-1};				
+double				globalGenerationDifferences[5] = {-1};				
+FitnessCache		globalFitnessCache;
+
+/* One sub-population of the island model. Islands evolve on their own threads for
+   migrationInterval generations at a time and keep their own convergence history. */
+typedef struct island_t
+{
+	population	*pop;
+	int			index;
+	int			generation;					//Generations evolved before the current ga_evolution call
+	int			isFinished;
+	double		generationDifferences[5];
+} Island;
+
+static Island			*globalIslands = NULL;
+static int				globalNumIslands = 0;
+static THREAD_LOCAL int	islandWorker = -1;	//OpenMP thread evolving the island, Gaul's nested regions run inactive on it
+
+static Island* findIsland(population *pop)
+{
+	int i;
+
+	for (i = 0; i < globalNumIslands; i++){
+		if (globalIslands[i].pop == pop) return &globalIslands[i];
+	}
+	return NULL;
+}
 
 
 static boolean generationHook(int generation, population *pop)
 {
 	int i;
 	double averageDifference, standardDeviation, generationDifferencesFull ;
+	Island *island = findIsland(pop);
+	double *generationDifferences = island != NULL ? island->generationDifferences : globalGenerationDifferences;
+
+	if (island != NULL){
+		//Each ga_evolution call on an island restarts at 0, the generation was already checked at the end of the previous one
+		if (generation == 0 && island->generation > 0) return TRUE;
+		generation += island->generation;
+	}
 
 	//Stop optmization if we get to max number of generations
 	if (globalOptimizationSettings.maxGenerations > 0 && generation > globalOptimizationSettings.maxGenerations - 1)
 	{
 		fprintf(stderr, "[OPT] Max num of generations (%d) reached!\n", globalOptimizationSettings.maxGenerations);
 		fflush(stderr);
+		if (island != NULL) island->isFinished = TRUE;
 		return FALSE;
 	}
 
@@ -95,6 +135,7 @@ static boolean generationHook(int generation, population *pop)
 		if ( standardDeviation < 0.05*averageDifference && generationDifferencesFull == 1){
 		fprintf(stderr, "[OPT] Solutions have converged!\n");
 		fflush(stderr);
+		if (island != NULL) island->isFinished = TRUE;
 		return FALSE;
 		}
 	
@@ -105,14 +146,103 @@ static boolean generationHook(int generation, population *pop)
 	{
 		fprintf(stderr, "[OPT] stopOptimization was called -> Stoping optimization\n");
 		fflush(stderr);
+		if (island != NULL) island->isFinished = TRUE;
 		return FALSE;
 	}
 	
-	fprintf(stderr, "[OPT] Generation %d started\n", generation +1);
+	if (island != NULL){
+		fprintf(stderr, "[OPT] Island %d: generation %d started\n", island->index, generation +1);
+	}
+	else {
+		fprintf(stderr, "[OPT] Generation %d started\n", generation +1);
+	}
 	fflush(stderr);
 	return TRUE;	/* TRUE indicates that evolution should continue. */
 }
 
+/* Runs the islands until all of them finished (generation limit, convergence or
+   stopOptimization). Every migrationInterval generations each island sends copies of
+   its numMigrants best entities to the next island of the ring, where they replace the
+   worst ones. Islands only wait for each other at these exchanges.
+
+   Gaul's random number generator and population table are process globals, so the
+   islands only evolve in parallel in builds against a Gaul built with its locking
+   (premake --gaul-thread-safe). Otherwise they evolve one after the other and Gaul's
+   own parallel evaluation uses the threads. */
+static void evolveIslands(Island *islands, int numIslands, int migrationInterval, int numMigrants)
+{
+	int i, k, numActive, lenChromosomes = islands[0].pop->len_chromosomes;
+	int *migrants = (int*)malloc(numIslands * numMigrants * lenChromosomes * sizeof(int));
+	double *migrantFitness = (double*)malloc(numIslands * numMigrants * sizeof(double));
+	population *target;
+	entity *elite, *worst;
+	#if defined _OPENMP && defined GAUL_THREAD_SAFE
+	int maxActiveLevels = omp_get_max_active_levels();
+	#endif
+
+	if (migrants == NULL || migrantFitness == NULL) numMigrants = 0;
+
+	#if defined _OPENMP && defined GAUL_THREAD_SAFE
+	//Gaul's own parallel evaluation runs single threaded inside every island
+	omp_set_max_active_levels(1);
+	#endif
+
+	do {
+		#if defined _OPENMP && defined GAUL_THREAD_SAFE
+		#pragma omp parallel for private(i) schedule(dynamic, 1)
+		for (i = 0; i < numIslands; i++){
+			if (islands[i].isFinished) continue;
+			islandWorker = omp_get_thread_num();
+			islands[i].generation += ga_evolution(islands[i].pop, migrationInterval);
+			islandWorker = -1;
+		}
+		#else
+		for (i = 0; i < numIslands; i++){
+			if (islands[i].isFinished) continue;
+			islands[i].generation += ga_evolution(islands[i].pop, migrationInterval);
+		}
+		#endif
+
+		numActive = 0;
+		for (i = 0; i < numIslands; i++){
+			if (!islands[i].isFinished) numActive++;
+		}
+		if (numActive == 0 || numMigrants == 0) continue;
+
+		//Take all the elites first, the migrants could otherwise push an island's own elites out
+		for (i = 0; i < numIslands; i++){
+			for (k = 0; k < numMigrants; k++){
+				elite = ga_get_entity_from_rank(islands[i].pop, k);
+				memcpy(&migrants[(i * numMigrants + k) * lenChromosomes], elite->chromosome[0], lenChromosomes * sizeof(int));
+				migrantFitness[i * numMigrants + k] = elite->fitness;
+			}
+		}
+
+		//Finished islands still send their elites but keep their population
+		for (i = 0; i < numIslands; i++){
+			if (islands[(i + 1) % numIslands].isFinished) continue;
+			target = islands[(i + 1) % numIslands].pop;
+			for (k = 0; k < numMigrants; k++){
+				worst = ga_get_entity_from_rank(target, target->size - 1 - k);
+				memcpy(worst->chromosome[0], &migrants[(i * numMigrants + k) * lenChromosomes], lenChromosomes * sizeof(int));
+				worst->fitness = migrantFitness[i * numMigrants + k];
+			}
+			//The migrants took the ranks of the worst entities, rank them by their fitness again
+			sort_population(target);
+		}
+
+		fprintf(stderr, "[OPT] %d islands active, %d elites migrated per island\n", numActive, numMigrants);
+		fflush(stderr);
+	} while (numActive > 0);
+
+	#if defined _OPENMP && defined GAUL_THREAD_SAFE
+	omp_set_max_active_levels(maxActiveLevels);
+	#endif
+
+	free(migrants);
+	free(migrantFitness);
+}
+
 //Calculates total number of combinations for given optimization parameters
 int getParameterSetsNumber (int startIndex, int numOptimizedParams, OptimizationParam *optimizationParams){
 	int i, numSteps = 1;
@@ -123,29 +253,185 @@ int getParameterSetsNumber (int startIndex, int numOptimizedParams, Optimization
 	return numSteps;
 }
 
+//Value of parameter param in combination number combination. Combinations are numbered in mixed radix
+//with the first parameter varying fastest, the order the optimization results have always been reported in
+double getParameterSetValue (int combination, int param, OptimizationParam *optimizationParams){
+	int i;
+
+	for(i=0; i<param; i++){
+		combination = combination / ((int)((optimizationParams[i].stop - optimizationParams[i].start) / optimizationParams[i].step) + 1);
+	}
+	combination = combination % ((int)((optimizationParams[param].stop - optimizationParams[param].start) / optimizationParams[param].step) + 1);
+
+	return optimizationParams[param].start + combination * optimizationParams[param].step;
+}
+
 //Maps an optimization value to a valid value from the 1-100 scale
 double mapParamValue (int value, OptimizationParam optParam){
-	double *posibleValues;
-	int i;
 	int numPosibleValues = (int)fabs((optParam.stop-optParam.start)/optParam.step) + 1;
+	int index = numPosibleValues * value / 100;
+
+	//The top allele (100) maps to the last value
+	if (index > numPosibleValues - 1) index = numPosibleValues - 1;
+	return optParam.start + optParam.step * index;
+}
 
-	posibleValues = (double*)malloc(sizeof(double) * numPosibleValues);
-	for (i=0; i<numPosibleValues; i++){
-		posibleValues[i] = optParam.start + optParam.step * i;
+int getGoalFitness(TestResult testResult, int optimizationGoal, double initialBalance, double *pFitness){
+	switch (optimizationGoal){
+		case (OPTI_GOAL_PROFIT):
+			*pFitness = testResult.finalBalance-initialBalance;
+			break;
+		case (OPTI_GOAL_MAX_DD):
+			*pFitness = initialBalance/testResult.maxDDDepth; //fitness calculated against initial balance
+			break;
+		case (OPTI_GOAL_MAX_DD_LENGTH):
+			*pFitness = (double)(testResult.yearsTraded*365)/testResult.maxDDLength; //fitness calculated against total days of test
+			break;
+		case (OPTI_GOAL_PF):
+			*pFitness = testResult.pf;
+			break;
+		case (OPTI_GOAL_R2):
+			*pFitness = testResult.r2;
+			break;
+		case (OPTI_GOAL_ULCER_INDEX):
+			*pFitness = 10/testResult.ulcerIndex;
+			break;
+		case (OPTI_GOAL_SHARPE):
+			*pFitness = testResult.sharpe;
+			break;
+		case (OPTI_GOAL_CAGR_TO_MAXDD):
+			*pFitness = testResult.cagr/testResult.maxDDDepth;
+			break;
+		default:
+			return false;
 	}
-	return posibleValues[(int)numPosibleValues * value / 100];
+	return true;
+}
+
+static int checkDiscardedResult(TestResult testResult, GeneticOptimizationSettings optimizationSettings, double initialBalance, int iteration, int isLogged){
+	int isDiscarded = false;
+
+	if (testResult.finalBalance-initialBalance < 0){ 
+		isDiscarded = true;
+		if (isLogged){
+			fprintf(stderr, "[OPT] Iteration %d gave negative balance ... killing it\n", iteration);
+			fflush(stderr);
+		}
+	}
+	
+	if (optimizationSettings.discardAssymetricSets && abs(testResult.numShorts - testResult.numLongs) > 0.5*min(testResult.numShorts, testResult.numLongs)){
+		isDiscarded = true;
+		if (isLogged){
+			fprintf(stderr, "[OPT] Iteration %d gave assymetric results (%d longs %d shorts) ... killing it\n", iteration, testResult.numShorts, testResult.numLongs);
+			fflush(stderr);
+		}
+	}
+
+	if (testResult.totalTrades/testResult.yearsTraded < optimizationSettings.minTradesAYear){
+		isDiscarded = true;
+		if (isLogged){
+			fprintf(stderr, "[OPT] Iteration %d gave less than %d trades a year in average... killing it\n", iteration, optimizationSettings.minTradesAYear);
+			fflush(stderr);
+		}
+	}
+
+	if (testResult.aborted){
+		isDiscarded = true;
+		if (isLogged){
+			fprintf(stderr, "[OPT] Iteration %d was stopped by an abort criterion ... killing it\n", iteration);
+			fflush(stderr);
+		}
+	}
+
+	return isDiscarded;
+}
+
+int isDiscardedResult(TestResult testResult, GeneticOptimizationSettings optimizationSettings, double initialBalance, int iteration){
+	return checkDiscardedResult(testResult, optimizationSettings, initialBalance, iteration, true);
+}
+
+int isDiscardedResultQuiet(TestResult testResult, GeneticOptimizationSettings optimizationSettings, double initialBalance){
+	return checkDiscardedResult(testResult, optimizationSettings, initialBalance, 0, false);
+}
+
+int isOptimizationStopped(){
+	return stopOpti;
+}
+
+void clearOptimizationStop(){
+	stopOpti = 0;
+}
+
+void keepOptimizationStop(int isKept){
+	keepStopOpti = isKept;
+}
+
+void startOptimizationStop(){
+	if (!keepStopOpti) stopOpti = 0;
+}
+
+/* Builds the per symbol timeframe tables handed to runPortfolioTest. The candles are not
+   copied: runPortfolioTest only reads pRates, so every run on every thread points at the
+   caller's history. Timeframes that are not required (or missing) point at one shared
+   zeroed block, so no run ever sees a NULL timeframe. */
+static ASTRates*** shareHistory(ASTRates*** pRates, CRatesInfo** pRatesInfo, int numSymbols, int numCandles, ASTRates** pEmptyRates)
+{
+	ASTRates*** sharedRates;
+	int n, k;
+
+	*pEmptyRates = (ASTRates*)calloc(numCandles, sizeof(ASTRates));
+	sharedRates = (ASTRates***)malloc(numSymbols * sizeof(ASTRates**));
+
+	if (*pEmptyRates == NULL || sharedRates == NULL){
+		free(*pEmptyRates); *pEmptyRates = NULL;
+		free(sharedRates);
+		return NULL;
+	}
+
+	for (n=0;n<numSymbols;n++){
+		sharedRates[n] = (ASTRates**)malloc(10 * sizeof(ASTRates*));
+		if (sharedRates[n] == NULL){
+			while (n-- > 0) free(sharedRates[n]);
+			free(sharedRates);
+			free(*pEmptyRates); *pEmptyRates = NULL;
+			return NULL;
+		}
+
+		for (k=0;k<10;k++){
+			if (pRatesInfo[n][k].totalBarsRequired > 0 && pRates != NULL && pRates[n] != NULL && pRates[n][k] != NULL){
+				sharedRates[n][k] = pRates[n][k];
+			} else {
+				sharedRates[n][k] = *pEmptyRates;
+			}
+		}
+	}
+
+	return sharedRates;
+}
+
+static void releaseSharedHistory(ASTRates*** sharedRates, int numSymbols, ASTRates* emptyRates)
+{
+	int n;
+
+	if (sharedRates != NULL){
+		for (n=0;n<numSymbols;n++){
+			free(sharedRates[n]);
+		}
+		free(sharedRates);
+	}
+	free(emptyRates);
 }
 
 /* Calculate fitness function */
 boolean testFitnessMultipleSymbols(population *pop, entity *entity)
 {
-	double **localSettings, *currentSet, chromosomeMappedValue;
+	double **localSettings, *currentSet, chromosomeMappedValue, *decodedSet, cachedFitness, goalFitness;
 	TestSettings *localTestSettings;
 	CRatesInfo **localRatesInfo;
 	AccountInfo **localAccountInfo;
 	TestResult testResult = {0};
 	int k, n, chromosomeValue, localCurrentIteration;
-	int testId;
+	int testId, workerInstanceId;
 	char **localSymbol;
 	ASTRates ***localRates;
 
@@ -163,6 +449,20 @@ boolean testFitnessMultipleSymbols(population *pop, entity *entity)
 		fflush(stderr);
 	#endif
 
+	//Chromosomes that map to an already tested set get its fitness without running it again
+	decodedSet = (double*)malloc((globalNumOptimizedParams > 0 ? globalNumOptimizedParams : 1) * sizeof(double));
+	for (k = 0; k < pop->len_chromosomes; k++){
+		decodedSet[k] = mapParamValue(((int*)entity->chromosome[0])[k], globalOptimizationParams[k]);
+	}
+
+	if (lookupFitness(&globalFitnessCache, decodedSet, globalOptimizationSettings.optimizationGoal, &cachedFitness)){
+		entity->fitness = cachedFitness;
+		fprintf(stderr, "[OPT] Iteration %d: parameter set already tested, fitness = %lf\n", localCurrentIteration, cachedFitness);
+		fflush(stderr);
+		free(decodedSet);
+		return TRUE;
+	}
+
 	entity->fitness = 0.0;
 
 	for (n=0;n<globalNumSymbols;n++)
@@ -183,23 +483,8 @@ boolean testFitnessMultipleSymbols(population *pop, entity *entity)
 	localRatesInfo[0] = (CRatesInfo*)malloc(10 * sizeof(CRatesInfo));
 	memcpy(localRatesInfo[0], globalMultiRatesInfo[n], 10 * sizeof(CRatesInfo));
 
-	localRates = (ASTRates ***)malloc(1 * sizeof(ASTRates**));
-	localRates[0] = (ASTRates **)malloc(10 * sizeof(ASTRates*));
-
-	fprintf(stderr, "[OPT] SavingRates\n");
-	fflush(stderr);
-	// Always allocate ALL timeframes - runPortfolioTest may access them without NULL checks
-	for (k=0;k<10;k++){
-		localRates[0][k] = (ASTRates *)malloc(globalNumCandles * sizeof(ASTRates));
-		// Always zero out first to ensure valid data
-		memset (localRates[0][k], 0, globalNumCandles * sizeof(ASTRates));
-		// Copy data if available and needed
-		if (localRatesInfo[0][k].totalBarsRequired > 0 && globalRates[n][k] != NULL) {
-			memcpy (localRates[0][k], globalRates[n][k], globalNumCandles * sizeof(ASTRates));
-		}
-	}
-	fprintf(stderr, "[OPT] endSavingRates\n");
-	fflush(stderr);
+	//The history is shared read-only by every run
+	localRates = &globalRates[n];
 
 	localAccountInfo = (AccountInfo**)malloc(1 * sizeof(AccountInfo*));
 	localAccountInfo[0] = (AccountInfo*)malloc(sizeof(AccountInfo));
@@ -211,7 +496,7 @@ boolean testFitnessMultipleSymbols(population *pop, entity *entity)
 	for (k = 0; k < pop->len_chromosomes; k++)
     {
 		chromosomeValue = ((int*)entity->chromosome[0])[k];
-		chromosomeMappedValue = mapParamValue(chromosomeValue, globalOptimizationParams[k]);
+		chromosomeMappedValue = decodedSet[k];
 		fprintf(stderr, "[OPT] Iteration: %d. Gen %d mapped to %lf from gen value %d\n", localCurrentIteration, k, chromosomeMappedValue, chromosomeValue);
 		fflush(stderr);
 		localSettings[0][globalOptimizationParams[k].index] = chromosomeMappedValue;
@@ -222,82 +507,32 @@ boolean testFitnessMultipleSymbols(population *pop, entity *entity)
 	testId = 1;
 
 	#ifdef _OPENMP
-	testId = omp_get_thread_num();	
+	testId = islandWorker >= 0 ? islandWorker : omp_get_thread_num();	
 	#endif
 
-	// Preserve instance ID from set file if set, otherwise use calculated value for uniqueness
-	// Note: For multi-threaded optimization, all threads will use the same instance ID from set file.
-	// This is safe because: (1) state files aren't written during backtesting/optimization,
-	// (2) in-memory state access is protected by critical sections, and (3) config lookup needs
-	// the original instance ID to find the correct config file.
-	if (localSettings[0][STRATEGY_INSTANCE_ID] == 0) {
-		localSettings[0][STRATEGY_INSTANCE_ID] = (testId+1)+2*(n+1);
-	}
+	// Each thread runs from its own instance ID range, see the brute force loop
+	workerInstanceId = getWorkerInstanceId(localSettings[0][STRATEGY_INSTANCE_ID] != 0 ? (int)localSettings[0][STRATEGY_INSTANCE_ID] : n+1, testId);
+	localSettings[0][STRATEGY_INSTANCE_ID] = workerInstanceId;
 	
 	// Cast AccountInfo** to double** for runPortfolioTest (it treats AccountInfo as double array)
 	testResult = runPortfolioTest(testId+1, localSettings, localSymbol, globalAccountCurrency, globalBrokerName, globalRefBrokerName, (double**)localAccountInfo, 
 						localTestSettings, localRatesInfo, globalNumCandles, 1, localRates, globalMinLotSize, NULL, NULL, NULL);
+	releaseWorkerInstance(workerInstanceId);
 
 	if (testResult.r2 < 0) testResult.r2 = 0;
 
 	globalOptimizationUpdate(testResult, currentSet, globalNumOptimizedParams);	
 
-	switch (globalOptimizationSettings.optimizationGoal){
-		case (OPTI_GOAL_PROFIT):
-			entity->fitness += testResult.finalBalance-localAccountInfo[0]->balance;
-			break;
-		case (OPTI_GOAL_MAX_DD):
-			entity->fitness += globalInitialBalance/testResult.maxDDDepth; //fitness calculated against initial balance
-			break;
-		case (OPTI_GOAL_MAX_DD_LENGTH):
-			entity->fitness += (double)(testResult.yearsTraded*365)/testResult.maxDDLength; //fitness calculated against total days of test
-			break;
-		case (OPTI_GOAL_PF):
-			entity->fitness += testResult.pf;
-			break;
-		case (OPTI_GOAL_R2):
-			entity->fitness += testResult.r2;
-			break;
-		case (OPTI_GOAL_ULCER_INDEX):
-			entity->fitness += 10/testResult.ulcerIndex;
-			break;
-		case (OPTI_GOAL_SHARPE):
-			entity->fitness += testResult.sharpe;
-			break;
-		case (OPTI_GOAL_CAGR_TO_MAXDD):
-			entity->fitness += testResult.cagr/testResult.maxDDDepth;
-			break;
-		default:
-			fprintf(stderr, "[OPT] ERROR: Optimization Goal %d not supported\n", globalOptimizationSettings.optimizationGoal);
-			fflush(stderr);
-			return false;
-	}
-
-	if (testResult.finalBalance-localAccountInfo[0]->balance < 0){ 
-		entity->fitness = 0.0;
-		fprintf(stderr, "[OPT] Iteration %d gave negative balance ... killing it\n", localCurrentIteration);
-		fflush(stderr);
-	}
-	
-	if (globalOptimizationSettings.discardAssymetricSets && abs(testResult.numShorts - testResult.numLongs) > 0.5*min(testResult.numShorts, testResult.numLongs)){
-		entity->fitness = 0.0;
-		fprintf(stderr, "[OPT] Iteration %d gave assymetric results (%d longs %d shorts) ... killing it\n", localCurrentIteration, testResult.numShorts, testResult.numLongs);
+	if (!getGoalFitness(testResult, globalOptimizationSettings.optimizationGoal, globalInitialBalance, &goalFitness)){
+		fprintf(stderr, "[OPT] ERROR: Optimization Goal %d not supported\n", globalOptimizationSettings.optimizationGoal);
 		fflush(stderr);
+		free(decodedSet);
+		return false;
 	}
+	entity->fitness += goalFitness;
 
-	if (testResult.totalTrades/testResult.yearsTraded < globalOptimizationSettings.minTradesAYear){
+	if (isDiscardedResult(testResult, globalOptimizationSettings, localAccountInfo[0]->balance, localCurrentIteration)){
 		entity->fitness = 0.0;
-		fprintf(stderr, "[OPT] Iteration %d gave less than %d trades a year in average... killing it\n", localCurrentIteration, globalOptimizationSettings.minTradesAYear);
-		fflush(stderr);
-	}
-
-	for (k=0;k<10;k++){
-			// Timeframe 0 is always allocated, others only if totalBarsRequired > 0
-			if (k == 0 || localRatesInfo[0][k].totalBarsRequired > 0) {
-				if (localRates[0][k] != NULL) {
-					free(localRates[0][k]); localRates[0][k] = NULL;
-				}
-			}
 	}
 
 	free(localTestSettings); localTestSettings = NULL;
@@ -308,12 +543,13 @@ boolean testFitnessMultipleSymbols(population *pop, entity *entity)
 	free(currentSet); currentSet = NULL;
 	free(localRatesInfo[0]); localRatesInfo[0] = NULL;
 	free(localRatesInfo); localRatesInfo = NULL;
-	free(localRates[0]); localRates[0] = NULL;
-	free(localRates); localRates = NULL;
 	free(localAccountInfo[0]); localAccountInfo[0] = NULL;
 	free(localAccountInfo); localAccountInfo = NULL;
 	}
 
+	storeFitness(&globalFitnessCache, decodedSet, globalOptimizationSettings.optimizationGoal, entity->fitness);
+	free(decodedSet);
+
 	return TRUE;
 }
 
@@ -322,17 +558,6 @@ void __stdcall stopOptimization(){
 	stopOpti = 1;
 };
 
-static void sleepMilliseconds(int milliseconds)
-{
-#if defined _WIN32 || defined _WIN64
-  Sleep(milliseconds);
-#elif defined __APPLE__ || defined __linux__
-  usleep(milliseconds * 1000);
-#else
-  #error "Unsupported operating system"
-#endif
-}
-
 int __stdcall runOptimizationMultipleSymbols(
 	OptimizationParam	*optimizationParams,
 	int					numOptimizedParams,
@@ -374,7 +599,7 @@ int __stdcall runOptimizationMultipleSymbols(
 	
 	//General variables
 	char error_t[MAX_ERROR_LENGTH];
-	int i, j, finishCtr = 0, n, p;
+	int i, j, n, p;
 	int numParamsInSet;
 	int testId;
 	
@@ -386,13 +611,14 @@ int __stdcall runOptimizationMultipleSymbols(
 	char *safeAccountCurrency = (pInAccountCurrency != NULL && pInAccountCurrency[0] != '\0') ? pInAccountCurrency : (char*)defaultAccountCurrency;
 
 	//Brute force variables
-	int numCombinations, maxSteps, steps/*, localNumCandles*/;
-	double *sets, *combination, elem, **localSettings;
+	int numCombinations/*, localNumCandles*/;
+	double **localSettings;
 	/*ASTRates *localRates;*/
 	CRatesInfo **localRatesInfo;
 	AccountInfo **localAccountInfo;  // Keep as AccountInfo** for type safety, cast to double** when calling runPortfolioTest
 	TestSettings *localTestSettings;
 	ASTRates ***localRates;
+	ASTRates ***sharedRates, *emptyRates;
 	char **localSymbol;
 	TestResult testResult;
 	double *currentSet;
@@ -404,7 +630,13 @@ int __stdcall runOptimizationMultipleSymbols(
 
 	int myId = 0, numProcs = 1;
 
-	stopOpti = 0;
+	//Process mode variables
+	ForkPool forkPool;
+	char *processesEnv;
+	int numProcesses, forkWorker = FORK_POOL_FAILED, numFailedWorkers, workerBase = 0;
+	int firstCombination, combinationStride;
+
+	startOptimizationStop();
 
 	#if HAVE_MPI == 1
 	//MPI variables
@@ -426,6 +658,12 @@ int __stdcall runOptimizationMultipleSymbols(
 		#else
 		putenv("OMP_STACKSIZE=256M");
 		#endif
+		// Every thread keeps one framework instance per symbol (workerInstances.h), the pre-initialized
+		// instance needs one more
+		if (numThreads * numSymbols >= MAX_INSTANCES) {
+			numThreads = (MAX_INSTANCES - 1) / numSymbols > 0 ? (MAX_INSTANCES - 1) / numSymbols : 1;
+			fprintf(stderr, "[OPENMP] Limiting to %d threads, %d symbols per thread must fit in %d framework instances\n", numThreads, numSymbols, MAX_INSTANCES);
+		}
 		// Set OpenMP thread count based on numThreads parameter
 		omp_set_num_threads(numThreads);
 		fprintf(stderr, "[OPENMP] Enabled with %d threads on %d available CPU cores\n", numThreads, omp_get_num_procs());
@@ -453,27 +691,13 @@ int __stdcall runOptimizationMultipleSymbols(
 			return true;
 		}
 
-		combination = (double*)malloc(numOptimizedParams * sizeof(double));
-		sets = (double*)malloc(numCombinations * numOptimizedParams * sizeof(double));
-		n = 0;
-		
-		while (finishCtr < numOptimizedParams) {
-			finishCtr = 0;
-			j = n;
-			for(i=0; i<numOptimizedParams; i++){
-				maxSteps = (int)((optimizationParams[i].stop - optimizationParams[i].start) / optimizationParams[i].step) + 1;
-				steps = j % maxSteps;
-				j = (int)(j / maxSteps);
-				elem = optimizationParams[i].start + steps * optimizationParams[i].step;
-				if(j > 0 && steps == 0) finishCtr++;
-				combination[i] = elem;
-			}
-			if (finishCtr < numOptimizedParams){
-				for(p=0; p<numOptimizedParams; p++){
-					sets[n*numOptimizedParams + p] = combination[p];
-				}
-			}
-			n++;
+		//Each run decodes its parameter set from the combination number (getParameterSetValue)
+		sharedRates = shareHistory(pRates, pRatesInfo, numSymbols, numCandles, &emptyRates);
+		if (sharedRates == NULL){
+			fprintf(stderr, "[OPT] ERROR: Failed to allocate the shared history tables\n");
+			fflush(stderr);
+			if(optimizationFinished != NULL) optimizationFinished();
+			return false;
 		}
 
 		fprintf(stderr, "[OPT] Finished parameter generation, starting runs.\n");
@@ -481,54 +705,59 @@ int __stdcall runOptimizationMultipleSymbols(
 		fprintf(stderr, "[DEBUG] Finished parameter generation. Starting runs. numCombinations=%d, myId=%d, numProcs=%d\n", numCombinations, myId, numProcs);
 		fflush(stderr);
 		
-		// CRITICAL: Initialize framework ONCE before parallel loop to avoid race conditions
-		// This ensures all threads find the framework already initialized
-		fprintf(stderr, "[INIT] DEBUG: About to check OpenMP and numThreads\n");
-		fflush(stderr);
+		// Create the framework context from the default config before the parallel loop, otherwise
+		// the config of whichever thread initializes its instance first would be used
 		#ifdef _OPENMP
 		if(numThreads > 1) {
-			fprintf(stderr, "[INIT] DEBUG: _OPENMP is defined, numThreads=%d\n", numThreads);
-			fflush(stderr);
-			fprintf(stderr, "[INIT] DEBUG: numThreads > 1 is TRUE, entering pre-init block\n");
-			fflush(stderr);
-			fprintf(stderr, "[INIT] Pre-initializing framework before parallel loop (using instanceId=1)\n");
-			fflush(stderr);
+			int preInitResult;
+
 			fprintf(stderr, "[OPT] Pre-initializing framework before parallel loop\n");
 			fflush(stderr);
-			int preInitResult = WAIT_FOR_INIT;
-			int preInitTries = 0;
-			int maxPreInitTries = 50;
-			int preInitDelay = 500;
-			int preInitExponentialDelay = preInitDelay;
-			
-			while(preInitResult == WAIT_FOR_INIT && preInitTries < maxPreInitTries) {
-				fprintf(stderr, "[INIT] Pre-init attempt %d/%d, waiting %dms\n", preInitTries+1, maxPreInitTries, preInitExponentialDelay);
-				fflush(stderr);
-				preInitResult = initInstanceC(1, 1, "./config/AsirikuyConfig.xml", "");
-				fprintf(stderr, "[INIT] Pre-init returned: %d\n", preInitResult);
-				fflush(stderr);
-				if(preInitResult == WAIT_FOR_INIT) {
-					sleepMilliseconds(preInitExponentialDelay);
-					if(preInitExponentialDelay < 2000) {
-						preInitExponentialDelay = (int)(preInitExponentialDelay * 1.2);
-					}
-				}
-				preInitTries++;
-			}
-			
+			preInitResult = initInstanceC(1, 1, "./config/AsirikuyConfig.xml", "");
 			if(preInitResult == SUCCESS) {
-				fprintf(stderr, "[INIT] Framework pre-initialized successfully. All threads can now use it.\n");
-				fflush(stderr);
 				fprintf(stderr, "[OPT] Framework pre-initialized successfully\n");
-				fflush(stderr);
 			} else {
-				fprintf(stderr, "[INIT] WARNING: Framework pre-initialization failed with code %d. Threads will retry individually.\n", preInitResult);
+				fprintf(stderr, "[OPT] WARNING: Framework pre-initialization failed with code %d. Threads will initialize it with their own config.\n", preInitResult);
+			}
+			fflush(stderr);
+		}
+		#endif
+
+		//MPI ranks stride over the combinations, a single process runs them all
+		firstCombination = myId;
+		combinationStride = numProcs;
+
+		//Process mode: AST_OPTIMIZER_PROCESSES single threaded worker processes run the combinations (forkPool.h)
+		processesEnv = getenv("AST_OPTIMIZER_PROCESSES");
+		numProcesses = processesEnv != NULL ? atoi(processesEnv) : 0;
+		if (numProcesses > MAX_FORK_WORKERS) numProcesses = MAX_FORK_WORKERS;
+
+		if (numProcesses > 1 && !globalExecUnderMPI){
+			forkWorker = startForkWorkers(&forkPool, numProcesses);
+
+			if (forkWorker == FORK_POOL_PARENT){
+				fprintf(stderr, "[OPT] Running %d combinations in %d worker processes\n", numCombinations, forkPool.numWorkers);
 				fflush(stderr);
-				fprintf(stderr, "[OPT] WARNING: Framework pre-initialization failed with code %d\n", preInitResult);
+				numFailedWorkers = collectForkResults(&forkPool, numParamsInSet, optimizationUpdate, &stopOpti);
+				if (numFailedWorkers > 0){
+					fprintf(stderr, "[OPT] WARNING: %d optimizer worker processes did not finish cleanly\n", numFailedWorkers);
+					fflush(stderr);
+				}
+				//The workers ran everything
+				firstCombination = numCombinations;
+			}
+			else if (forkWorker >= 0){
+				firstCombination = forkWorker;
+				combinationStride = numProcesses;
+				workerBase = forkWorker;
+				numThreads = 1;
+				optimizationUpdate = forkWorkerUpdate;
+			}
+			else {
+				fprintf(stderr, "[OPT] WARNING: Could not start %d optimizer worker processes, using threads\n", numProcesses);
 				fflush(stderr);
 			}
 		}
-		#endif
 		
 		//Run the optimization for each set
 		// Use MPI distribution if MPI is enabled, otherwise use OpenMP parallel for
@@ -539,7 +768,7 @@ int __stdcall runOptimizationMultipleSymbols(
 		
 		#if HAVE_MPI == 1
 		// MPI mode: use manual work distribution
-		for (i = 0 + myId; i<numCombinations; i += numProcs){
+		for (i = firstCombination; i<numCombinations; i += combinationStride){
 		#else
 		// Non-MPI mode: use OpenMP parallel for (only if numThreads > 1 to avoid overhead)
 		#ifdef _OPENMP
@@ -550,7 +779,7 @@ int __stdcall runOptimizationMultipleSymbols(
 		}
 		#pragma omp parallel for private(i, n, p, localSettings, currentSet, localRatesInfo, localSymbol, localRates, localAccountInfo, localTestSettings, testResult) schedule(dynamic) if(numThreads > 1)
 		#endif
-		for (i = 0; i<numCombinations; i++){
+		for (i = firstCombination; i<numCombinations; i += combinationStride){
 			// Thread-local copies of strings that may be modified by normalizeCurrency
 			char *localAccountCurrency = NULL;
 			char *localBrokerName = NULL;
@@ -629,36 +858,14 @@ int __stdcall runOptimizationMultipleSymbols(
 					localRefBrokerName[255] = '\0';
 				}
 
-				localRates    = (ASTRates ***)malloc(1 * sizeof(ASTRates**));
-				localRates[0] = (ASTRates **)malloc(10 * sizeof(ASTRates*));
-						
-				// Always allocate ALL timeframes - runPortfolioTest may access them without NULL checks
-				for(p=0;p<10;p++){
-					localRates[0][p] = (ASTRates *)malloc(numCandles * sizeof(ASTRates));
-					// Always zero out first to ensure valid data
-					memset (localRates[0][p], 0, numCandles * sizeof(ASTRates));
-					// Copy data if available and needed
-					if (localRatesInfo[0][p].totalBarsRequired > 0 && pRates != NULL && pRates[n] != NULL && pRates[n][p] != NULL) {
-						memcpy (localRates[0][p], pRates[n][p], numCandles * sizeof(ASTRates));
-					}
-				}
+				//The history is shared read-only by every run
+				localRates = &sharedRates[n];
 
 				// Check if pInAccountInfo is NULL before using it
 				if (pInAccountInfo == NULL) {
 					fprintf(stderr, "[OPT] ERROR: pInAccountInfo is NULL, cannot allocate localAccountInfo\n");
 					fflush(stderr);
 					// Clean up and skip this iteration
-					for (p=0;p<10;p++){
-						if (localRates != NULL && localRates[0] != NULL && localRates[0][p] != NULL) {
-							free(localRates[0][p]); localRates[0][p] = NULL;
-						}
-					}
-					if (localRates != NULL && localRates[0] != NULL) {
-						free(localRates[0]); localRates[0] = NULL;
-					}
-					if (localRates != NULL) {
-						free(localRates); localRates = NULL;
-					}
 					if (localSymbol != NULL && localSymbol[0] != NULL) {
 						free(localSymbol[0]); localSymbol[0] = NULL;
 					}
@@ -688,17 +895,6 @@ int __stdcall runOptimizationMultipleSymbols(
 					fprintf(stderr, "[OPT] ERROR: Failed to allocate localAccountInfo\n");
 					fflush(stderr);
 					// Clean up and skip this iteration
-					for (p=0;p<10;p++){
-						if (localRates != NULL && localRates[0] != NULL && localRates[0][p] != NULL) {
-							free(localRates[0][p]); localRates[0][p] = NULL;
-						}
-					}
-					if (localRates != NULL && localRates[0] != NULL) {
-						free(localRates[0]); localRates[0] = NULL;
-					}
-					if (localRates != NULL) {
-						free(localRates); localRates = NULL;
-					}
 					if (localSymbol != NULL && localSymbol[0] != NULL) {
 						free(localSymbol[0]); localSymbol[0] = NULL;
 					}
@@ -728,17 +924,6 @@ int __stdcall runOptimizationMultipleSymbols(
 					fflush(stderr);
 					free(localAccountInfo); localAccountInfo = NULL;
 					// Clean up and skip this iteration
-					for (p=0;p<10;p++){
-						if (localRates != NULL && localRates[0] != NULL && localRates[0][p] != NULL) {
-							free(localRates[0][p]); localRates[0][p] = NULL;
-						}
-					}
-					if (localRates != NULL && localRates[0] != NULL) {
-						free(localRates[0]); localRates[0] = NULL;
-					}
-					if (localRates != NULL) {
-						free(localRates); localRates = NULL;
-					}
 					if (localSymbol != NULL && localSymbol[0] != NULL) {
 						free(localSymbol[0]); localSymbol[0] = NULL;
 					}
@@ -775,17 +960,6 @@ int __stdcall runOptimizationMultipleSymbols(
 					if (localAccountInfo != NULL) {
 						free(localAccountInfo); localAccountInfo = NULL;
 					}
-					for (p=0;p<10;p++){
-						if (localRates != NULL && localRates[0] != NULL && localRates[0][p] != NULL) {
-							free(localRates[0][p]); localRates[0][p] = NULL;
-						}
-					}
-					if (localRates != NULL && localRates[0] != NULL) {
-						free(localRates[0]); localRates[0] = NULL;
-					}
-					if (localRates != NULL) {
-						free(localRates); localRates = NULL;
-					}
 					if (localSymbol != NULL && localSymbol[0] != NULL) {
 						free(localSymbol[0]); localSymbol[0] = NULL;
 					}
@@ -812,9 +986,9 @@ int __stdcall runOptimizationMultipleSymbols(
 				memcpy (localTestSettings, &testSettings[n], sizeof(TestSettings));
 
 				for(p=0; p<numOptimizedParams; p++){
-					localSettings[0][optimizationParams[p].index] = sets[i*numOptimizedParams+p];
+					localSettings[0][optimizationParams[p].index] = getParameterSetValue(i, p, optimizationParams);
 					currentSet[p*2] = (double)optimizationParams[p].index;
-					currentSet[p*2+1] = (double)sets[i*numOptimizedParams+p];
+					currentSet[p*2+1] = localSettings[0][optimizationParams[p].index];
 					fprintf(stderr, "[OPT] localSettings[0][optimizationParams[p].index]= %lf, currentSet[p*2] =%lf,currentSet[p*2+1]=%lf\n", 
 						localSettings[0][optimizationParams[p].index],currentSet[p*2],currentSet[p*2+1]);
 					fflush(stderr);
@@ -831,14 +1005,11 @@ int __stdcall runOptimizationMultipleSymbols(
 					testId = 1;
 				}
 
-				// Preserve instance ID from set file if set, otherwise use calculated value for uniqueness
-				// Note: For multi-threaded optimization, all threads will use the same instance ID from set file.
-				// This is safe because: (1) state files aren't written during backtesting/optimization,
-				// (2) in-memory state access is protected by critical sections, and (3) config lookup needs
-				// the original instance ID to find the correct config file.
-				if (localSettings[0][STRATEGY_INSTANCE_ID] == 0) {
-					localSettings[0][STRATEGY_INSTANCE_ID] = (testId+1)+2*(n+1);
-				}
+				// Run the set file instance ID (or the symbol number if there is none) from this thread's own
+				// ID range, so threads never share rates buffers, instance states or state files. The tester
+				// maps the ID back to the set file ID to find the instance config.
+				int workerInstanceId = getWorkerInstanceId(localSettings[0][STRATEGY_INSTANCE_ID] != 0 ? (int)localSettings[0][STRATEGY_INSTANCE_ID] : n+1, workerBase + thread_id);
+				localSettings[0][STRATEGY_INSTANCE_ID] = workerInstanceId;
 
 				fprintf(stderr, "[OPT] localSettings[0][ADDITIONAL_PARAM_8]= %lf\n", localSettings[0][ADDITIONAL_PARAM_8]);
 				fflush(stderr);
@@ -889,17 +1060,6 @@ int __stdcall runOptimizationMultipleSymbols(
 					         (void*)safeAccountCurrency, (void*)safeBrokerName, (void*)safeRefBrokerName);
 					fflush(stderr);
 					// Clean up and skip this iteration
-					for (p=0;p<10;p++){
-						if (localRates != NULL && localRates[0] != NULL && localRates[0][p] != NULL) {
-							free(localRates[0][p]); localRates[0][p] = NULL;
-						}
-					}
-					if (localRates != NULL && localRates[0] != NULL) {
-						free(localRates[0]); localRates[0] = NULL;
-					}
-					if (localRates != NULL) {
-						free(localRates); localRates = NULL;
-					}
 					if (localTestSettings != NULL) {
 						free(localTestSettings); localTestSettings = NULL;
 					}
@@ -1052,6 +1212,7 @@ int __stdcall runOptimizationMultipleSymbols(
 				
 				testResult = runPortfolioTest(currentTestId, localSettings, localSymbol, accountCurrencyToUse, brokerNameToUse, refBrokerNameToUse, (double**)localAccountInfo, 
 									localTestSettings, localRatesInfo, numCandles, 1, localRates, minLotSize, NULL, NULL, NULL);
+				releaseWorkerInstance(workerInstanceId);
 				
 				// CRITICAL: Log after runPortfolioTest returns
 				#ifdef _OPENMP
@@ -1102,12 +1263,6 @@ int __stdcall runOptimizationMultipleSymbols(
 					fflush(stderr);
 				}
 
-				for (p=0;p<10;p++){
-						if (localRates[0][p] != NULL) {
-							free(localRates[0][p]); localRates[0][p] = NULL;
-						}
-					}
-
 					free(localTestSettings); localTestSettings = NULL;
 					free(localSymbol[0]); localSymbol[0] = NULL;
 					free(localSymbol); localSymbol = NULL;
@@ -1116,8 +1271,6 @@ int __stdcall runOptimizationMultipleSymbols(
 					free(currentSet); currentSet = NULL;
 					free(localRatesInfo[0]); localRatesInfo[0] = NULL;
 					free(localRatesInfo); localRatesInfo = NULL;
-					free(localRates[0]); localRates[0] = NULL;
-					free(localRates); localRates = NULL;
 					free(localAccountInfo[0]); localAccountInfo[0] = NULL;
 					free(localAccountInfo); localAccountInfo = NULL;
 					// Free thread-local string copies
@@ -1156,6 +1309,9 @@ int __stdcall runOptimizationMultipleSymbols(
 		// All iterations must complete before execution continues past this point
 		// If we reach this point, ALL threads have finished their loop iterations
 
+		//Worker processes end here, the parent reports the end of the optimization
+		if (forkWorker >= 0) finishForkWorker(EXIT_SUCCESS);
+
 		#ifdef _OPENMP
 		if(numThreads > 1) {
 			fprintf(stderr, "[SYNC] Implicit barrier reached - all OpenMP parallel iterations completed.\n");
@@ -1172,8 +1328,7 @@ int __stdcall runOptimizationMultipleSymbols(
 		if(optimizationFinished != NULL) optimizationFinished();
 		fprintf(stderr, "[SYNC] optimizationFinished callback completed\n");
 		fflush(stderr);
-		free(combination); combination = NULL;
-		free(sets); sets = NULL;
+		releaseSharedHistory(sharedRates, numSymbols, emptyRates);
 
 		return true;
 	}
@@ -1189,31 +1344,18 @@ int __stdcall runOptimizationMultipleSymbols(
 	
 		
 		globalMultiRatesInfo = (CRatesInfo**)malloc(numSymbols * sizeof(CRatesInfo*));
-		globalRates = (ASTRates ***)malloc(numSymbols * sizeof(ASTRates**));
 
 		for (n=0;n<numSymbols;n++){	
+			globalMultiRatesInfo[n] = (CRatesInfo*)malloc(10 * sizeof(CRatesInfo));
+			memcpy(globalMultiRatesInfo[n], pRatesInfo[n], 10 * sizeof(CRatesInfo));
+		}
 
-		globalMultiRatesInfo[n] = (CRatesInfo*)malloc(10 * sizeof(CRatesInfo));
-		memcpy(globalMultiRatesInfo[n], pRatesInfo[n], 10 * sizeof(CRatesInfo));
-
-		globalRates[n] = (ASTRates **)malloc(10 * sizeof(ASTRates));
-
-			for(i=0;i<10;i++){
-				if (i == 0 || globalMultiRatesInfo[n][i].totalBarsRequired > 0) {
-					// Timeframe 0 must always be allocated as runPortfolioTest accesses it without NULL checks
-					// Higher timeframes are only allocated if needed
-					globalRates[n][i] = (ASTRates *)malloc(numCandles * sizeof(ASTRates));
-					if (globalMultiRatesInfo[n][i].totalBarsRequired > 0) {
-						memcpy (globalRates[n][i], pRates[n][i], numCandles * sizeof(ASTRates));
-					} else {
-						// Zero out timeframe 0 if not needed (shouldn't happen, but be safe)
-						memset (globalRates[n][i], 0, numCandles * sizeof(ASTRates));
-					}
-				} else {
-					// Initialize to NULL when not needed (only for timeframes > 0)
-					globalRates[n][i] = NULL;
-				}
-			}
+		globalRates = shareHistory(pRates, pRatesInfo, numSymbols, numCandles, &emptyRates);
+		if (globalRates == NULL){
+			fprintf(stderr, "[OPT] ERROR: Failed to allocate the shared history tables\n");
+			fflush(stderr);
+			if(optimizationFinished != NULL) optimizationFinished();
+			return false;
 		}
 
 		globalAccountInfo = (double*)malloc(sizeof(AccountInfo));
@@ -1284,6 +1426,11 @@ int __stdcall runOptimizationMultipleSymbols(
 				return false;
 		}
 
+		if (!initFitnessCache(&globalFitnessCache, numOptimizedParams, optimizationSettings.population * 4)){
+			fprintf(stderr, "[OPT] WARNING: Failed to allocate the fitness cache, every chromosome will be tested\n");
+			fflush(stderr);
+		}
+
 		//MPI Child threads
 		if (myId != 0){
 			pop = ga_genesis_integer(
@@ -1309,6 +1456,76 @@ int __stdcall runOptimizationMultipleSymbols(
 			fflush(stderr);
 			ga_attach_mpi_slave( pop );
 		}
+		//Island model, each island evolves on its own thread
+		else if (optimizationSettings.numIslands > 1 && !globalExecUnderMPI){
+			Island *islands = (Island*)calloc(optimizationSettings.numIslands, sizeof(Island));
+			int numMigrants = (int)(optimizationSettings.population * optimizationSettings.migrationProbability);
+			int migrationInterval = optimizationSettings.migrationInterval > 0 ? optimizationSettings.migrationInterval : DEFAULT_MIGRATION_INTERVAL;
+			int numIslands = 0;
+
+			if (numMigrants < 1) numMigrants = 1;
+			if (numMigrants > optimizationSettings.population / 2) numMigrants = optimizationSettings.population / 2;
+
+			for (n = 0; islands != NULL && n < optimizationSettings.numIslands; n++){
+				islands[n].pop = ga_genesis_integer(
+				   optimizationSettings.population,			/* const int              population_size */
+				   1,										/* const int              num_chromo */
+				   numParamsInSet,							/* const int              len_chromo */
+				   generationHook,							/* GAgeneration_hook      generation_hook */
+				   NULL,									/* GAiteration_hook       iteration_hook */
+				   NULL,									/* GAdata_destructor      data_destructor */
+				   NULL,									/* GAdata_ref_incrementor data_ref_incrementor */
+				   testFitnessMultipleSymbols,   			/* GAevaluate             evaluate */
+				   ga_seed_integer_random,					/* GAseed                 seed */
+				   NULL,									/* GAadapt                adapt */
+				   ga_select_one_sus,						/* GAselect_one           select_one */
+				   ga_select_two_sus,						/* GAselect_two           select_two */
+				   mutateFunction,							/* GAmutate				  mutate */
+				   crossoverFunction,						/* GAcrossover			  crossover */
+				   NULL,									/* GAreplace              replace */
+				   NULL										/* void *                 userdata */
+				);
+				if (islands[n].pop == NULL) break;
+
+				ga_population_set_allele_min_integer(islands[n].pop, 1);
+				ga_population_set_allele_max_integer(islands[n].pop, 100);
+
+				ga_population_set_parameters(
+				   islands[n].pop,											/* population              *pop */
+				   (ga_scheme_type)optimizationSettings.evolutionaryMode,	/* const ga_class_type     class */
+				   (ga_elitism_type)optimizationSettings.elitismMode,		/* const ga_elitism_type   elitism */
+				   optimizationSettings.crossoverProbability,				/* double                  crossover */
+				   optimizationSettings.mutationProbability,				/* double                  mutation */
+				   0.0														/* double                  migration */
+				);
+
+				islands[n].index = n;
+				for (j = 0; j < 5; j++) islands[n].generationDifferences[j] = -1;
+				numIslands++;
+			}
+
+			fprintf(stderr, "[OPT] Island model: %d islands of %d, %d elites migrate every %d generations\n", numIslands, optimizationSettings.population, numMigrants, migrationInterval);
+			fflush(stderr);
+
+			if (numIslands > 0){
+				globalIslands = islands;
+				globalNumIslands = numIslands;
+				evolveIslands(islands, numIslands, migrationInterval, numMigrants);
+				globalNumIslands = 0;
+				globalIslands = NULL;
+			}
+			else {
+				fprintf(stderr, "[OPT] ERROR: Failed to create the islands\n");
+				fflush(stderr);
+			}
+
+			for (n = 0; n < numIslands; n++){
+				ga_extinction(islands[n].pop);
+			}
+			free(islands);
+
+			if(optimizationFinished != NULL) optimizationFinished();
+		}
 		//Main thread for MPI and no MPI
 		else {
 			pop = ga_genesis_integer(
@@ -1363,6 +1580,12 @@ int __stdcall runOptimizationMultipleSymbols(
 			if(optimizationFinished != NULL) optimizationFinished();
 			if(globalExecUnderMPI) ga_detach_mpi_slaves();
 		}
+		fprintf(stderr, "[OPT] Fitness cache: %ld hits, %ld misses, %d parameter sets tested\n", globalFitnessCache.hits, globalFitnessCache.misses, globalFitnessCache.count);
+		fflush(stderr);
+		freeFitnessCache(&globalFitnessCache);
+
+		releaseSharedHistory(globalRates, numSymbols, emptyRates);
+		globalRates = NULL;
 		return true;
 
 	}
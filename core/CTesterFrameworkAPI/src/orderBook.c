@@ -0,0 +1,77 @@
+//
+//  orderBook.c
+//  ast
+//
+//  Per-system open and closed orders used by runPortfolioTest.
+//
+
+#include "orderBook.h"
+
+#define INITIAL_ORDER_BOOK_CAPACITY 16
+
+static int isBuySide(double type){
+	return (type == BUY || type == BUYLIMIT || type == BUYSTOP);
+}
+
+int initOrderBook(OrderBook *pBook, int historySize){
+	memset(pBook, 0, sizeof(OrderBook));
+
+	if (historySize < 0) historySize = 0;
+	pBook->historySize = historySize;
+	pBook->capacity = historySize + 1 > INITIAL_ORDER_BOOK_CAPACITY ? historySize + 1 : INITIAL_ORDER_BOOK_CAPACITY;
+	pBook->orders = (COrderInfo*)calloc(pBook->capacity, sizeof(COrderInfo));
+
+	if (pBook->orders == NULL) {
+		pBook->capacity = 0;
+		return false;
+	}
+
+	return true;
+}
+
+COrderInfo* addOrder(OrderBook *pBook, int type){
+	COrderInfo *pOrders;
+	int newCapacity;
+
+	//Keep one zero entry after the orders
+	if (pBook->numOpen + pBook->numClosed + 2 > pBook->capacity) {
+		newCapacity = pBook->capacity * 2;
+		pOrders = (COrderInfo*)realloc(pBook->orders, newCapacity * sizeof(COrderInfo));
+		if (pOrders == NULL) return NULL;
+
+		memset(&pOrders[pBook->capacity], 0, (newCapacity - pBook->capacity) * sizeof(COrderInfo));
+		pBook->orders = pOrders;
+		pBook->capacity = newCapacity;
+	}
+
+	//Make room between the open and the closed orders
+	memmove(&pBook->orders[pBook->numOpen + 1], &pBook->orders[pBook->numOpen], pBook->numClosed * sizeof(COrderInfo));
+	memset(&pBook->orders[pBook->numOpen], 0, sizeof(COrderInfo));
+
+	pBook->orders[pBook->numOpen].type = type;
+	pBook->openOrdersCount[isBuySide(type) ? BUY : SELL]++;
+
+	return &pBook->orders[pBook->numOpen++];
+}
+
+void retireOrder(OrderBook *pBook, int index){
+	COrderInfo closed = pBook->orders[index];
+
+	pBook->openOrdersCount[isBuySide(closed.type) ? BUY : SELL]--;
+
+	//Close the gap in the open orders, the closed one becomes the newest history entry
+	memmove(&pBook->orders[index], &pBook->orders[index + 1], (pBook->numOpen - index - 1) * sizeof(COrderInfo));
+	pBook->numOpen--;
+	pBook->orders[pBook->numOpen] = closed;
+	pBook->numClosed++;
+
+	if (pBook->numClosed > pBook->historySize) {
+		pBook->numClosed = pBook->historySize;
+		memset(&pBook->orders[pBook->numOpen + pBook->numClosed], 0, sizeof(COrderInfo));
+	}
+}
+
+void freeOrderBook(OrderBook *pBook){
+	free(pBook->orders);
+	memset(pBook, 0, sizeof(OrderBook));
+}
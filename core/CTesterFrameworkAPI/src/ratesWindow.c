@@ -0,0 +1,125 @@
+//
+//  ratesWindow.c
+//  ast
+//
+//  Sliding rate windows used by runPortfolioTest.
+//
+
+#include "ratesWindow.h"
+
+static void convertBar(CRates *pDest, const ASTRates *pSource){
+	pDest->open   = pSource->open;
+	pDest->high   = pSource->high;
+	pDest->low    = pSource->low;
+	pDest->close  = pSource->close;
+	pDest->volume = pSource->volume;
+	pDest->time   = pSource->time;
+}
+
+static int countInvalidBars(const ASTRates *pSource, int fromBar, int toBar){
+	int k, count = 0;
+
+	for (k = fromBar; k <= toBar; k++){
+		count += (pSource[k].time == -1);
+	}
+
+	return count;
+}
+
+int initRatesWindow(RatesWindow *pWindow, const ASTRates *pSource, int numCandles, int windowSize){
+	memset(pWindow, 0, sizeof(RatesWindow));
+	pWindow->numCandles = numCandles;
+	pWindow->windowSize = windowSize;
+	pWindow->currentBar = -1;
+
+	if (windowSize <= 0 || pSource == NULL) {
+		pWindow->windowSize = 0;
+		return true;
+	}
+
+	pWindow->source   = pSource;
+	pWindow->capacity = 2 * windowSize;
+	if (pWindow->capacity > numCandles && numCandles >= windowSize) {
+		pWindow->capacity = numCandles;
+	}
+
+	pWindow->buffer = (CRates*)malloc(pWindow->capacity * sizeof(CRates));
+
+	if (pWindow->buffer == NULL) {
+		freeRatesWindow(pWindow);
+		return false;
+	}
+
+	return true;
+}
+
+CRates* moveRatesWindow(RatesWindow *pWindow, int barIndex, int *pHasInvalidTime){
+	int start, previousStart, k;
+	CRates *pCurrent;
+
+	if (pHasInvalidTime != NULL) *pHasInvalidTime = false;
+
+	if (pWindow->windowSize <= 0) {
+		return &pWindow->emptyBar;
+	}
+
+	//Give the previous forming bar back its closed values
+	if (pWindow->currentBar >= 0) {
+		pWindow->buffer[pWindow->currentBar - pWindow->firstBar] = pWindow->savedBar;
+	}
+
+	start = barIndex - pWindow->windowSize + 1;
+
+	if (start < 0 || barIndex >= pWindow->numCandles) {
+		pWindow->currentBar = -1;
+		if (pHasInvalidTime != NULL) *pHasInvalidTime = true;
+		return pWindow->buffer;
+	}
+
+	//Count the invalid bars entering and leaving the window, or the whole window after a jump
+	previousStart = pWindow->currentBar - pWindow->windowSize + 1;
+	if (pWindow->currentBar >= 0 && barIndex >= pWindow->currentBar && start <= pWindow->currentBar) {
+		pWindow->invalidBars += countInvalidBars(pWindow->source, pWindow->currentBar + 1, barIndex);
+		pWindow->invalidBars -= countInvalidBars(pWindow->source, previousStart, start - 1);
+	} else {
+		pWindow->invalidBars = countInvalidBars(pWindow->source, start, barIndex);
+	}
+
+	//Keep the buffered bars that are still in the window, moving them to the front when the buffer is full
+	if (start < pWindow->firstBar || start >= pWindow->endBar) {
+		pWindow->firstBar = pWindow->endBar = start;
+	} else if (barIndex - pWindow->firstBar >= pWindow->capacity) {
+		memmove(pWindow->buffer, &pWindow->buffer[start - pWindow->firstBar], (pWindow->endBar - start) * sizeof(CRates));
+		pWindow->firstBar = start;
+	}
+
+	for (k = pWindow->endBar; k <= barIndex; k++){
+		convertBar(&pWindow->buffer[k - pWindow->firstBar], &pWindow->source[k]);
+	}
+	if (barIndex >= pWindow->endBar) {
+		pWindow->endBar = barIndex + 1;
+	}
+
+	pCurrent = &pWindow->buffer[barIndex - pWindow->firstBar];
+	pWindow->currentBar = barIndex;
+	pWindow->savedBar   = *pCurrent;
+
+	pCurrent->high   = pCurrent->open;
+	pCurrent->low    = pCurrent->open;
+	pCurrent->close  = pCurrent->open;
+	pCurrent->volume = 0;
+
+	if (pHasInvalidTime != NULL) {
+		*pHasInvalidTime = pWindow->invalidBars > 0;
+	}
+
+	return &pWindow->buffer[start - pWindow->firstBar];
+}
+
+void freeRatesWindow(RatesWindow *pWindow){
+	free(pWindow->buffer); pWindow->buffer = NULL;
+	pWindow->source = NULL;
+	pWindow->capacity = 0;
+	pWindow->windowSize = 0;
+	pWindow->currentBar = -1;
+}
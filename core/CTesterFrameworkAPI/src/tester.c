@@ -7,6 +7,12 @@
 //
 
 #include "tester.h"
+#include "ratesWindow.h"
+#include "historics.h"
+#include "RunArena.h"
+#include "tradeStatistics.h"
+#include "orderBook.h"
+#include "workerInstances.h"
 #include "OrderSignals.h"
 #include "CTesterDefines.h"
 #include "CTesterTradingStrategiesAPI.h"
@@ -54,17 +60,6 @@ static double getCurrentTimeMs(void)
 #endif
 }
 
-static void sleepMilliseconds(int milliseconds)
-{
-#if defined _WIN32 || defined _WIN64
-  Sleep(milliseconds); 
-#elif defined __APPLE__ || defined __linux__
-  usleep(milliseconds * 1000);
-#else
-  #error "Unsupported operating system"
-#endif
-}
-
 const int SecondsPerMinute = 60;
 const int SecondsPerHour = 3600;
 const int SecondsPerDay = 86400;
@@ -170,42 +165,46 @@ int getDecimals(double minLotSize){
 	return(decimals);
 }
 
-int openOrder(StrategyResults* strategyResults, int* openOrdersCount, COrderInfo* openOrders, int instanceId, int* ticketNumber, int openTime, double openPrice, int type, TradeSignal lastSignal, int *numSignals, double currentBalance, double minLotSize, double minimumStop){
-	int orderIndex = openOrdersCount[BUY] + openOrdersCount[SELL];
+int openOrder(StrategyResults* strategyResults, OrderBook* pBook, int instanceId, int* ticketNumber, int openTime, double openPrice, int type, TradeSignal lastSignal, int *numSignals, double currentBalance, double minLotSize, double minimumStop){
+	COrderInfo* pOrder;
 
-	if (strategyResults->lots >= minLotSize)
+	if (strategyResults->lots < minLotSize)
 	{
-		openOrders[orderIndex].lots = roundN(strategyResults->lots, getDecimals(minLotSize));
+		logWarning("Order %d, lots = %lf, below minimum lot size (%lf). Order was NOT opened (rounding up is prevented to avoid increasing risk)", *ticketNumber + 1,  (double)strategyResults->lots, (double) minLotSize);
+		return false;
 	}
-	else {
-		logWarning("Order %d, lots = %lf, below minimum lot size (%lf). Order was NOT opened (rounding up is prevented to avoid increasing risk)", (int)openOrders[orderIndex].ticket,  (double)strategyResults->lots, (double) minLotSize);
+
+	pOrder = addOrder(pBook, type);
+	if (pOrder == NULL)
+	{
+		logError("Order %d could not be opened, failed to grow the order book beyond %d orders.", *ticketNumber + 1, pBook->capacity);
 		return false;
 	}
 
-	openOrders[orderIndex].ticket = *ticketNumber + 1;
-	openOrders[orderIndex].instanceId = instanceId;
-	openOrders[orderIndex].openTime = openTime;
+	pOrder->lots = roundN(strategyResults->lots, getDecimals(minLotSize));
+
+	pOrder->ticket = *ticketNumber + 1;
+	pOrder->instanceId = instanceId;
+	pOrder->openTime = openTime;
 
 	if(type == BUY || type == SELL){
-		openOrders[orderIndex].openPrice = openPrice;
+		pOrder->openPrice = openPrice;
 	} else {
-		openOrders[orderIndex].openPrice= strategyResults->entryPrice;
-		openPrice = openOrders[orderIndex].openPrice;
+		pOrder->openPrice= strategyResults->entryPrice;
+		openPrice = pOrder->openPrice;
 	}
 
-	openOrders[orderIndex].isOpen = true;
-	openOrders[orderIndex].swap = 0;
-	openOrders[orderIndex].profit = 0;
-	openOrders[orderIndex].stopLoss = 0;
-	openOrders[orderIndex].takeProfit = 0;
+	pOrder->isOpen = true;
+	pOrder->swap = 0;
+	pOrder->profit = 0;
+	pOrder->stopLoss = 0;
+	pOrder->takeProfit = 0;
 
 	if (type == BUY  || type == BUYLIMIT || type == BUYSTOP){
 
-		openOrders[orderIndex].type = type;
-
 		if (strategyResults->brokerSL != 0){
 			if (openPrice - strategyResults->brokerSL <= openPrice - minimumStop && strategyResults->brokerSL != 0){
-				openOrders[orderIndex].stopLoss = openPrice - strategyResults->brokerSL;
+				pOrder->stopLoss = openPrice - strategyResults->brokerSL;
 			} else {
 				logWarning("OpenOrder. Invalid SL requested. Current ask is %lf, minimum allowed SL is %lf, attempted SL is %lf. This SL modification has been aborted.", openPrice, openPrice - minimumStop, openPrice - strategyResults->brokerSL);
 			}
@@ -213,22 +212,19 @@ int openOrder(StrategyResults* strategyResults, int* openOrdersCount, COrderInfo
 		
 		if (strategyResults->brokerTP != 0){
 			if (openPrice + strategyResults->brokerTP >= openPrice + minimumStop && strategyResults->brokerTP != 0){
-				openOrders[orderIndex].takeProfit = openPrice + strategyResults->brokerTP;
+				pOrder->takeProfit = openPrice + strategyResults->brokerTP;
 			} else {
 				logWarning("OpenOrder. Invalid TP requested. Current ask is %lf, minimum allowed TP is %lf, attempted TP is %lf. This TP modification has been aborted.", openPrice, openPrice + minimumStop, openPrice + strategyResults->brokerTP);
 			}
 		}
-
-		openOrdersCount[BUY]++;
 	}
 	else {
-		openOrders[orderIndex].type = type;
-		openOrders[orderIndex].stopLoss = 0;
-		openOrders[orderIndex].takeProfit = 0;
+		pOrder->stopLoss = 0;
+		pOrder->takeProfit = 0;
 
 		if (strategyResults->brokerSL != 0){
 			if (openPrice + strategyResults->brokerSL >= openPrice + minimumStop && strategyResults->brokerSL != 0){
-				openOrders[orderIndex].stopLoss = openPrice + strategyResults->brokerSL;
+				pOrder->stopLoss = openPrice + strategyResults->brokerSL;
 			} else {
 				logWarning("OpenOrder. Invalid SL requested. Current bid is %lf, minimum allowed SL is %lf, attempted SL is %lf. This SL modification has been aborted.", openPrice, openPrice + minimumStop, openPrice + strategyResults->brokerSL);
 			}
@@ -236,28 +232,26 @@ int openOrder(StrategyResults* strategyResults, int* openOrdersCount, COrderInfo
 
 		if (strategyResults->brokerTP != 0){
 			if (openPrice - strategyResults->brokerTP <= openPrice - minimumStop && strategyResults->brokerTP != 0){
-				openOrders[orderIndex].takeProfit = openPrice - strategyResults->brokerTP;
+				pOrder->takeProfit = openPrice - strategyResults->brokerTP;
 			} else {
 				logWarning("OpenOrder. Invalid TP requested. Current bid is %lf, minimum allowed TP is %lf, attempted TP is %lf. This TP modification has been aborted.", openPrice, openPrice - minimumStop, openPrice - strategyResults->brokerTP);
 			}
 		}
-		
-		openOrdersCount[SELL]++;
 	}
 
-	if (strategyResults->brokerTP == 0) openOrders[orderIndex].takeProfit = 0;
-	if (strategyResults->brokerSL == 0) openOrders[orderIndex].stopLoss   = 0;
+	if (strategyResults->brokerTP == 0) pOrder->takeProfit = 0;
+	if (strategyResults->brokerSL == 0) pOrder->stopLoss   = 0;
 
 	if(globalSignalUpdate!=NULL){
 		lastSignal.no = numSignals[lastSignal.testId];
 		numSignals[lastSignal.testId]++;
 		if (type == BUY) lastSignal.type = SIGNAL_BUY;
 		if (type == SELL) lastSignal.type = SIGNAL_SELL;
-		lastSignal.orderId = (int)openOrders[orderIndex].ticket;
-		lastSignal.price = openOrders[orderIndex].openPrice;
-		lastSignal.lots = openOrders[orderIndex].lots;
-		lastSignal.sl = openOrders[orderIndex].stopLoss;
-		lastSignal.tp = openOrders[orderIndex].takeProfit;
+		lastSignal.orderId = (int)pOrder->ticket;
+		lastSignal.price = pOrder->openPrice;
+		lastSignal.lots = pOrder->lots;
+		lastSignal.sl = pOrder->stopLoss;
+		lastSignal.tp = pOrder->takeProfit;
 		lastSignal.profit = 0;
 		lastSignal.balance = currentBalance;
 		globalSignalUpdate(lastSignal);
@@ -409,8 +403,9 @@ int updateOrder(int instanceId, StrategyResults* strategyResults, int* openOrder
 }
 
 
-double closeOrder(StrategyResults* strategyResults, int* openOrdersCount, COrderInfo* openOrders, int instanceId, int closeTime, double closePrice, COrderInfo* result, char* tradeSymbol, int type, double *profit, double contractSize, void (*globalSignalUpdate)(TradeSignal signal), TradeSignal lastSignal, int *numSignals, double currentBalance, double tickConversion, double* avgTradeDuration){
-	int orderIndex = openOrdersCount[BUY] + openOrdersCount[SELL];
+double closeOrder(StrategyResults* strategyResults, OrderBook* pBook, int instanceId, int closeTime, double closePrice, COrderInfo* result, char* tradeSymbol, int type, double *profit, double contractSize, void (*globalSignalUpdate)(TradeSignal signal), TradeSignal lastSignal, int *numSignals, double currentBalance, double tickConversion, double* avgTradeDuration){
+	COrderInfo* openOrders = pBook->orders;
+	int orderIndex = pBook->numOpen;
 	int i, found;
 	double totalProfit = 0;
 
@@ -439,11 +434,6 @@ double closeOrder(StrategyResults* strategyResults, int* openOrdersCount, COrder
 			openOrders[i].isOpen = false;
 			memcpy(result, &openOrders[i], sizeof(COrderInfo));
 			totalProfit+= openOrders[i].profit+openOrders[i].swap;
-
-			if (openOrders[i].type == BUY || openOrders[i].type == BUYLIMIT || openOrders[i].type == BUYSTOP)
-				openOrdersCount[BUY]--;
-			else
-				openOrdersCount[SELL]--;
 			found = true;
 
 			if(globalSignalUpdate!=NULL){
@@ -461,9 +451,8 @@ double closeOrder(StrategyResults* strategyResults, int* openOrdersCount, COrder
 				globalSignalUpdate(lastSignal);
 			}
 
-			//Move the closed position to the last position of the array
-			memmove(&openOrders[i], &openOrders[i+1], sizeof(COrderInfo)*(MAX_ORDERS - i - 1));
-			memcpy(&openOrders[MAX_ORDERS-1], result, sizeof(COrderInfo));
+			//Move the closed position to the system's closed orders
+			retireOrder(pBook, i);
 			i--;
 		}
 	}
@@ -477,7 +466,8 @@ double closeOrder(StrategyResults* strategyResults, int* openOrdersCount, COrder
 }
 
 //Checks if open orders touch the SL or TP
-double checkTPSL(double bid, double ask, int i, int shift1, CRates *rates0, int* openOrdersCount, COrderInfo* openOrders, int instanceId, int closeTime, COrderInfo* result, char* tradeSymbol, double *profit, double contractSize, TradeSignal lastSignal, int *numSignals, double currentBalance, double tickConversion, double* avgTradeDuration){
+double checkTPSL(double bid, double ask, int i, int shift1, CRates *rates0, OrderBook* pBook, int instanceId, int closeTime, COrderInfo* result, char* tradeSymbol, double *profit, double contractSize, TradeSignal lastSignal, int *numSignals, double currentBalance, double tickConversion, double* avgTradeDuration){
+	COrderInfo* openOrders = pBook->orders;
 	int found, touchedTPSL, triggeredSL;
 	double totalProfit = 0;
 	double spread = fabs(ask-bid);
@@ -542,10 +532,6 @@ double checkTPSL(double bid, double ask, int i, int shift1, CRates *rates0, int*
 			*avgTradeDuration += openOrders[i].closeTime-openOrders[i].openTime;
 			memcpy(result, &openOrders[i], sizeof(COrderInfo));
 			totalProfit+= openOrders[i].profit+openOrders[i].swap;
-			if (openOrders[i].type == BUY)
-				openOrdersCount[BUY]--;
-			else
-				openOrdersCount[SELL]--;
 			found = true;
 
 			if(globalSignalUpdate!=NULL){
@@ -562,9 +548,8 @@ double checkTPSL(double bid, double ask, int i, int shift1, CRates *rates0, int*
 				lastSignal.balance = currentBalance + lastSignal.profit;
 				globalSignalUpdate(lastSignal);
 			}
-			//Move the closed position to the last position of the array
-			memmove(&openOrders[i], &openOrders[i+1], sizeof(COrderInfo)*(MAX_ORDERS - i - 1));
-			memcpy(&openOrders[MAX_ORDERS-1], result, sizeof(COrderInfo));
+			//Move the closed position to the system's closed orders
+			retireOrder(pBook, i);
 			i--;
 		}
 
@@ -614,30 +599,49 @@ int addInterest(int* openOrdersCount, COrderInfo* openOrders, int instanceId, in
 	return(newAdditionTime);
 }
 
-void addStatisticValue(StatisticItem **statistics, int *statisticsSize, double profit, double finalBalance, int currentBrokerTime){
-	if(*statisticsSize > MIN_STATISTICS_SIZE - 1){
-		StatisticItem *temp;
-		temp = (StatisticItem*)realloc(*statistics, (*statisticsSize + 1)*sizeof(StatisticItem)); /* give the pointer some memory */
-		if ( temp != NULL ) {
-			*statistics=temp;
+/* ME_analysis.csv rows of the current run, written out once by flush_me() */
+typedef struct expectancy_buffer_t
+{
+	char*  text;
+	size_t length;
+	size_t capacity;
+	int    isActive;
+} ExpectancyBuffer;
+
+static THREAD_LOCAL ExpectancyBuffer expectancyBuffer;
+
+static void appendExpectancyText(const char* text){
+	size_t textLength = strlen(text);
+	size_t newCapacity;
+	char*  newText;
+
+	if (expectancyBuffer.length + textLength + 1 > expectancyBuffer.capacity){
+		newCapacity = expectancyBuffer.capacity > 0 ? expectancyBuffer.capacity : 64 * 1024;
+		while (expectancyBuffer.length + textLength + 1 > newCapacity) newCapacity *= 2;
+
+		newText = (char*)realloc(expectancyBuffer.text, newCapacity);
+		if (newText == NULL){
+			logError("Failed to buffer ME analysis row, %d bytes already buffered.", (int)expectancyBuffer.length);
+			return;
 		}
-		else free(statistics);
+		expectancyBuffer.text = newText;
+		expectancyBuffer.capacity = newCapacity;
 	}
-	(*statistics)[*statisticsSize].balance = finalBalance;
-	(*statistics)[*statisticsSize].profit = profit;
-	(*statistics)[*statisticsSize].time = currentBrokerTime;
-	(*statisticsSize)++;
+
+	memcpy(expectancyBuffer.text + expectancyBuffer.length, text, textLength + 1);
+	expectancyBuffer.length += textLength;
 }
 
 void initialize_me(int is_calculate_expectancy){
-	FILE* fp;
 	int p;
 	char mathematicalExpectancyLabels[MAX_FILE_PATH_CHARS] = "";
 	char label[MAX_FILE_PATH_CHARS] = "";
+	char header[MAX_FILE_PATH_CHARS*2] = "";
 
-	if (is_calculate_expectancy == FALSE) return;
+	expectancyBuffer.length = 0;
+	expectancyBuffer.isActive = is_calculate_expectancy != FALSE;
 
-	fp=fopen("ME_analysis.csv","w");
+	if (is_calculate_expectancy == FALSE) return;
 
 	for(p=1;  p < MATHEMATICAL_EXPECTANCY_LIMIT+1; p++){
 			if (p % MATHEMATICAL_EXPECTANCY_DIVISION == 0){
@@ -650,28 +654,26 @@ void initialize_me(int is_calculate_expectancy){
 			}
 	}
 
-	fprintf(fp,"OpenPrice,OrderType,%s\n",mathematicalExpectancyLabels);
-	fclose(fp);
+	sprintf(header, "OpenPrice,OrderType,%s\n", mathematicalExpectancyLabels);
+	appendExpectancyText(header);
 }
 
 void calculate_mathematical_expectancy(int orderType, int numCandles, int shift, double me_entry, ASTRates* rates, double spread, int is_calculate_expectancy){
 
 	char mathematicalExpectancyString[MAX_FILE_PATH_CHARS*2] = "";
 	char me_string[MAX_FILE_PATH_CHARS*2] = "";
+	char row[MAX_FILE_PATH_CHARS*3] = "";
 	int p;
-	FILE* fp;
 	double me_mae;
 	double me_mfe;
 
-	if (is_calculate_expectancy == FALSE) return;
+	if (is_calculate_expectancy == FALSE || expectancyBuffer.isActive == FALSE) return;
 
 	me_mae = 0;
 	me_mfe = 0;
 
 					if(shift+MATHEMATICAL_EXPECTANCY_LIMIT < numCandles-2){
 
-						fp=fopen("ME_analysis.csv","a");
-
 						for(p=1;  p < MATHEMATICAL_EXPECTANCY_LIMIT+1; p++){
 
 							if (orderType == BUY){
@@ -707,12 +709,30 @@ void calculate_mathematical_expectancy(int orderType, int numCandles, int shift,
 							}					
 						}
 						
-						if (orderType == BUY) fprintf(fp,"%f,BUY,%s\n",me_entry, mathematicalExpectancyString);
-						if (orderType == SELL) fprintf(fp,"%f,SELL,%s\n",me_entry, mathematicalExpectancyString);
-						fclose(fp);
+						if (orderType == BUY) sprintf(row,"%f,BUY,%s\n",me_entry, mathematicalExpectancyString);
+						if (orderType == SELL) sprintf(row,"%f,SELL,%s\n",me_entry, mathematicalExpectancyString);
+						appendExpectancyText(row);
 					}
 }
 
+//Writes the buffered ME analysis in one go and releases the buffer
+void flush_me(){
+	FILE* fp;
+
+	if (expectancyBuffer.isActive == TRUE){
+		fp=fopen("ME_analysis.csv","w");
+		if (fp == NULL){
+			logError("Failed to write ME_analysis.csv.");
+		} else {
+			fwrite(expectancyBuffer.text, 1, expectancyBuffer.length, fp);
+			fclose(fp);
+		}
+	}
+
+	free(expectancyBuffer.text);
+	memset(&expectancyBuffer, 0, sizeof(ExpectancyBuffer));
+}
+
 //Checks if pending orders are triggered
 void checkPending(double bid, double ask, int i, COrderInfo* openOrders, int instanceId, int openTime, int numCandles, int shift, ASTRates* rates, int testUpdate, int is_calculate_expectancy){
 
@@ -792,218 +812,32 @@ void save_statistics_to_file(TestResult testResult,
 			fclose(statisticsFile) ;
 }
 
-void calculate_trade_by_trade_statistics(StatisticItem *statistics, 
-                                         int statisticsSize, 
-                                         double initialBalance, 
-                                         int is_compounding_disabled, 
-                                         int totalTrades,
-                                         TestResult *testResult, 
-                                         int numSystems,
-                                         int is_optimization){
-    //Calculate statistics
-    // variables for jonathan worst case definition
-	
-    double maxBalance = initialBalance;
-	double avgBalanceLog = 0;
-	double maxDDDepth = 0;
-	int maxDDLength = 0;
-	int ddStartTime = statistics[0].time;
-	double averageWinningTrade = 0;
-	double averageLosingTrade = 0;
-    double seriesCumulativeSquareReturns = 0;
-	double seriesCumulativeReturns = 0;
-	double sigma = 0;
-    double *regressionResiduals;
-    double sumBalanceTime = 0;
-    double timeSqrSum = 0;
-    double tradeReturn = 0;
-    double previousBalance;
-    double  profit;
-    double totalWin = 0;
-    double totalLose = 0;
-    double avgTime=0;
-    double avgBalance=0;
-    double totalWinningTrades = 0;
-    double totalLosingTrades = 0;
-    double maxDDDepthTemp = 0;
-    double maxDDLengthTemp;
-    double yPs = 0;
-	double yRs = 0;
-    double linearRegressionSlope;
-    double linearRegressionIntercept;
-    double regressionResidualsStandardDeviation;
-    
-    
-    int j;
-    
-	for(j=0; j < statisticsSize; j++){
-        
-        timeSqrSum += pow((double)statistics[j].time-statistics[0].time, 2) ;
-
-        // calculations needed for linear regression
-		if(is_compounding_disabled == TRUE){
-			sumBalanceTime += (statistics[j].time-statistics[0].time)*(statistics[j].balance-statistics[0].balance);
-		} else {
-			sumBalanceTime += (statistics[j].time-statistics[0].time)*(log(statistics[j].balance)- log(statistics[0].balance));
-		}
-        
-        avgTime += (statistics[j].time-statistics[0].time) / (double)statisticsSize;
-		avgBalance += (statistics[j].balance-statistics[0].balance) / statisticsSize;
-		avgBalanceLog += (log(statistics[j].balance)-log(statistics[0].balance)) / statisticsSize;
-
-		//Calculate profit factor
-		if(statistics[j].profit > 0){
-			totalWin += statistics[j].profit;
-			totalWinningTrades +=1;
-			averageWinningTrade = averageWinningTrade*(totalWinningTrades-1)/totalWinningTrades + fabs((statistics[j].profit/statistics[j].balance)/totalWinningTrades);
-		} else { 
-			totalLose += fabs(statistics[j].profit);
-			totalLosingTrades +=1;
-			averageLosingTrade = averageLosingTrade*(totalLosingTrades-1)/totalLosingTrades + fabs((statistics[j].profit/statistics[j].balance)/totalLosingTrades);
-		}
-
-		//calculate maxdrawdown depth and max drawdown length
-		if(statistics[j].balance < maxBalance){
-
-			if(is_compounding_disabled == TRUE){
-				maxDDDepthTemp  = ((maxBalance-statistics[j].balance)/initialBalance)*100 ;
-			} else {
-				maxDDDepthTemp  = ((maxBalance-statistics[j].balance)/maxBalance)*100 ;
-			}
-
-			maxDDLengthTemp = fabs(difftime(statistics[j].time, ddStartTime));
-		}
-		else //if(statistics[j].balance > maxBalance)
-		{
-		   maxBalance = statistics[j].balance;
-		   maxDDDepthTemp = 0;
-		   maxDDLengthTemp = 0;
-		   ddStartTime = statistics[j].time;
-		}
-
-
-		if(maxDDDepthTemp > maxDDDepth){
-			maxDDDepth = maxDDDepthTemp ;
-		}
-
-		if(maxDDLengthTemp > maxDDLength){
-			maxDDLength = maxDDLengthTemp ;
-		}
-	}
-
-	linearRegressionSlope = (sumBalanceTime) / timeSqrSum ;
-	linearRegressionIntercept = statistics[0].balance;
-    
-	yPs = 0;
-	yRs = 0;
+/* Opens a %s_TICK series, NULL if neither the binary nor the CSV file exists */
+static HistorySeries* openTickSeries(const char *csvPath){
+	HistorySeries *pSeries = (HistorySeries*)malloc(sizeof(HistorySeries));
 
-	regressionResiduals = (double*)malloc(statisticsSize * sizeof(double));
-
-	// determination coefficient calculation
-	for(j=0; j < statisticsSize; j++){
-		if(is_compounding_disabled == TRUE){
-			regressionResiduals[j] = linearRegressionSlope*(statistics[j].time-statistics[0].time) - (statistics[j].balance-statistics[0].balance) ;
-			yPs += pow((linearRegressionSlope*(statistics[j].time-statistics[0].time) - (statistics[j].balance-statistics[0].balance)), 2);
-			yRs += pow(((statistics[j].balance-statistics[0].balance) - avgBalance), 2);
-		} else {
-			regressionResiduals[j] = linearRegressionSlope*(statistics[j].time-statistics[0].time) - (log(statistics[j].balance)- log(statistics[0].balance)) ;
-			yPs += pow((linearRegressionSlope*(statistics[j].time-statistics[0].time) - (log(statistics[j].balance)- log(statistics[0].balance))), 2);
-			yRs += pow(((log(statistics[j].balance)- log(statistics[0].balance)) - avgBalanceLog), 2);
-		}
-	}
-
-	testResult->maxDDDepth = maxDDDepth;
-	testResult->maxDDLength = maxDDLength;
-    testResult->winning = totalWinningTrades/totalTrades*100;
-    
-	if (totalLose == 0) testResult->pf = 0;
-	else testResult->pf = totalWin / totalLose;
-
-	if ((yRs == 0) || (1-yPs/yRs) < 0) testResult->r2 = 0; 
-	else testResult->r2 = (1-yPs/yRs);
-	
-	testResult->risk_reward= averageWinningTrade/averageLosingTrade;
-	testResult->avgTradeDuration /= totalTrades;
-    
-    if (testResult->maxDDDepth > 100){
-		testResult->maxDDDepth = 100;
+	if (pSeries != NULL && !openHistorySeries(csvPath, HISTORY_TICKS, pSeries)){
+		free(pSeries);
+		pSeries = NULL;
 	}
-    
-    regressionResidualsStandardDeviation = standardDeviation(regressionResiduals, statisticsSize);
-    free(regressionResiduals); regressionResiduals = NULL;
-    
+	return pSeries;
 }
 
-void calculate_weekly_statistics(StatisticItem *statistics, 
-                                 int statisticsSize, 
-                                 double initialBalance,
-                                 int is_compounding_disabled,
-                                 int lastDate,
-                                 TestResult *testResult){
-   
-/* Ulcer Index, Sharpe and martin ratio calculations */
-
-	int n = 0;
-	int j = 0;
-	int lastTradeIndex = 0;
-	double sumSqrt = 0;
-	double cumWeekReturn = 0;
-	double cumWeekReturnSquare = 0;
-	double maxBalance = initialBalance;
-
-	double meanWeekly;
-	double sigmaWeekly;
-	double weekReturn;
-    
-	
-    int startDate = statistics[0].time;
-	int analysisTime = statistics[0].time;
-    double startWeekBalance = initialBalance;
-	double lastWeekBalance = startWeekBalance;
+/* Loads a %s_QUOTES series resampled to the bars of pRates, NULL if it is missing or empty */
+static double* loadConversionRates(const char *csvPath, const ASTRates *pRates, int numCandles){
+	HistorySeries series;
+	double *pAligned;
 
-	while (analysisTime < lastDate)
-	{
-		n++;
-		analysisTime += 604800;
-
-		while ((statistics[j].time < analysisTime) & (j < statisticsSize))
-		{   
-		   lastWeekBalance = statistics[j].balance;
-		   lastTradeIndex = j;
-		   j++;	   
-		}
-        
-		if(is_compounding_disabled == TRUE){
-			weekReturn = (lastWeekBalance-startWeekBalance)/initialBalance;
-		} else {
-			weekReturn = (lastWeekBalance-startWeekBalance)/startWeekBalance;
-		}
-
-		cumWeekReturn += weekReturn;
-		cumWeekReturnSquare += weekReturn*weekReturn;
-        startWeekBalance = statistics[j-1].balance;
-		
-		if (lastWeekBalance > maxBalance) {
-		maxBalance = lastWeekBalance;
-		}
-		else {
-		sumSqrt += pow((100 * ((lastWeekBalance / maxBalance) -1)), 2); 
-		}
+	if (!openHistorySeries(csvPath, HISTORY_QUOTES, &series)) return NULL;
 
+	pAligned = (double*)malloc(numCandles * sizeof(double));
+	if (pAligned != NULL && !alignHistorySeries(&series, 0, pRates, numCandles, pAligned)){
+		free(pAligned);
+		pAligned = NULL;
 	}
 
-	/* if above 100 make the UlcerIndex 100 (all strategies above 100 are useless) */
-	if (sqrt(sumSqrt/n) > 100)
-		testResult->ulcerIndex = 100; 
-	else
-		testResult->ulcerIndex = sqrt(sumSqrt/n);
-
-	meanWeekly = cumWeekReturn/n;
-	sigmaWeekly = sqrt((n*cumWeekReturnSquare-cumWeekReturn*cumWeekReturn)/(n*(n-1)));
-
-	testResult->sharpe = 7.2111103*(meanWeekly/sigmaWeekly);
-	testResult->martin = testResult->cagr/testResult->ulcerIndex; 
-    
+	closeHistorySeries(&series);
+	return pAligned;
 }
 
 TestResult __stdcall runPortfolioTest (
@@ -1038,8 +872,8 @@ TestResult __stdcall runPortfolioTest (
 	#endif
 	
 	//Test variables
-	int		j, n, m, s, openOrdersCount[2] = {0}, openOrdersCountSystem[2] = {0}, operation, tries;
-	int		sourceIndex = 0, currentBrokerTime = 0, totalTrades = 0, numShorts = 0, numLongs = 0;
+	int		j, n, m, s, operation;
+	int		currentBrokerTime = 0, totalTrades = 0, numShorts = 0, numLongs = 0;
 	int*     lastProcessedBar;
 	struct	parameterInfo_t;
 	double	percentageCompleted, swapLong, swapShort;
@@ -1051,9 +885,12 @@ TestResult __stdcall runPortfolioTest (
     int     is_optimization = FALSE;
 	BOOL    abortTest;
 	CRates   ***rates;
+	RatesWindow **ratesWindows;
+	int     hasInvalidTime;
 	StrategyResults *strategyResults={0};
-	COrderInfo openOrders[MAX_ORDERS]={0};
-	COrderInfo systemOrders[MAX_ORDERS]={0};
+	RunArena barArena;
+	OrderBook* orderBooks;
+	OrderBook* pBook;
 	COrderInfo lastOrder;
 	TestResult testResult = {0};
 	int* i;
@@ -1064,8 +901,7 @@ TestResult __stdcall runPortfolioTest (
 	double  finalBalance;
     double  previousBalance;
 	double  initialBalance;
-	StatisticItem *statistics;	
-	int statisticsSize;
+	TradeStatistics tradeStatistics;
 	int totalOrders = 0;
 	int lastTradeIndex;
 	int *numSignals;
@@ -1081,18 +917,11 @@ TestResult __stdcall runPortfolioTest (
 	char **quoteSymbols;
     double profit;
 
-	// tick file data
-	FILE** tickFiles;
-	FILE** baseFiles;
-	FILE** quoteFiles;
-	
-	char data[200] = "";
-	char *ptr;
-	char *timeString;
-	struct tm lDate;
-	char date[20] = "";
-	time_t currentDateTime;
-    char *strtokSave;
+	// tick and conversion data, memory-mapped when a binary history exists (see historics.h)
+	HistorySeries** tickFiles;
+	double** baseConversion;
+	double** quoteConversion;
+	int row;
 
 	int updateOrderType;
 
@@ -1104,13 +933,12 @@ TestResult __stdcall runPortfolioTest (
     if(is_optimization == FALSE) initialize_me(testSettings[0].is_calculate_expectancy);
 
 	// assign tick file array size
-	tickFiles = (FILE**)malloc(numSystems * sizeof(FILE*));
+	tickFiles = (HistorySeries**)malloc(numSystems * sizeof(HistorySeries*));
 
 	for (n=0; n<numSystems; n++){
 		sprintf (buffer, "%s_TICK.csv", pInTradeSymbol[n]);
 		logInfo("Searching for tick data: %s", buffer);
-		tickFiles[n] = NULL;
-		tickFiles[n] = fopen(buffer , "r+" );
+		tickFiles[n] = openTickSeries(buffer);
 	}
 
 	
@@ -1118,25 +946,32 @@ TestResult __stdcall runPortfolioTest (
 	initialBalance =pInAccountInfo[0][IDX_BALANCE];
 	finalBalance = pInAccountInfo[0][IDX_BALANCE];
 	previousBalance  = finalBalance;
-	statisticsSize = 0;
 	testResult.avgTradeDuration = 0;
-	statistics = (StatisticItem*)malloc(MIN_STATISTICS_SIZE * sizeof(StatisticItem));
+	initTradeStatistics(&tradeStatistics, initialBalance, (int)pInSettings[0][DISABLE_COMPOUNDING], MIN_STATISTICS_SIZE);
 	numBarsRequired = (int**)malloc(numSystems * sizeof(int*));
 	i = (int*)malloc(numSystems * sizeof(int));
 	testsFinished = (int*)malloc(numSystems * sizeof(int));
 	lastProcessedBar = (int*)malloc(numSystems * sizeof(int));
 	maxNumbarsRequired = 0;
 
-	quoteFiles = (FILE**)malloc(numSystems * sizeof(FILE*));
-	baseFiles = (FILE**)malloc(numSystems * sizeof(FILE*));
+	quoteConversion = (double**)malloc(numSystems * sizeof(double*));
+	baseConversion = (double**)malloc(numSystems * sizeof(double*));
 	quoteSymbols = (char**)malloc(numSystems * sizeof(char*));
 	baseSymbols = (char**)malloc(numSystems * sizeof(char*));
 
 	
 	rates = (CRates***)malloc(sizeof(CRates**) * numSystems);
+	ratesWindows = (RatesWindow**)malloc(sizeof(RatesWindow*) * numSystems);
+
+	orderBooks = (OrderBook*)malloc(sizeof(OrderBook) * numSystems);
 
-	for (n=0; n<numSystems; n++)
+	for (n=0; n<numSystems; n++){
 		rates[n] = (CRates**)malloc(sizeof(CRates*) * 10);
+		ratesWindows[n] = (RatesWindow*)malloc(sizeof(RatesWindow) * 10);
+		if (!initOrderBook(&orderBooks[n], (int)pInSettings[n][ORDERINFO_ARRAY_SIZE])){
+			logError("Failed to allocate the order book of system %d", n);
+		}
+	}
 	
 	if(signalUpdate != NULL) { 
 		numSignals = (int*)malloc(numSystems * sizeof(int));
@@ -1182,8 +1017,9 @@ TestResult __stdcall runPortfolioTest (
 
 	// Construct instance-specific config path: tmp/{SYMBOL}_{INSTANCE_ID}/AsirikuyConfig.xml or tmp/{SYMBOL}_{INSTANCE_ID}_optimize/AsirikuyConfig.xml
 	// Check for optimization mode (is_optimization flag) to determine folder name
+	// Optimizer workers run with IDs from their own range (workerInstances.h), the config belongs to the set file ID
 	char instanceConfigPath[MAX_FILE_PATH_CHARS] = "";
-	int instanceId = (int)pInSettings[j][STRATEGY_INSTANCE_ID];
+	int instanceId = getConfigInstanceId((int)pInSettings[j][STRATEGY_INSTANCE_ID]);
 	char* configPathToUse = "./config/AsirikuyConfig.xml";  // Default fallback
 	
 	// Try instance-specific config path first (for both optimization and backtest)
@@ -1276,38 +1112,14 @@ TestResult __stdcall runPortfolioTest (
 		fflush(stderr);
 	}
 
-	result = WAIT_FOR_INIT;
-	tries = 0;
-	// CRITICAL: Increase retry count and delay for OpenMP parallel execution
-	// Multiple threads may try to initialize simultaneously, so we need more retries
-	// Framework initialization can take several seconds, so we need longer delays
-	int maxTries = 50;  // Increased from 3 to 50 for parallel execution
-	int retryDelay = 500;  // Increased to 500ms - framework init can take time
-	int exponentialDelay = retryDelay;  // Start with base delay, increase exponentially
-
-	while(result == WAIT_FOR_INIT && tries < maxTries){
-		fprintf(stderr, "[INIT] Calling initInstanceC: attempt %d/%d, instanceId=%d, config=%s, waiting %dms\n", tries+1, maxTries, (int)pInSettings[j][STRATEGY_INSTANCE_ID], configPathToUse, exponentialDelay);
-		fflush(stderr);
-		logInfo("Calling initInstanceC: attempt %d/%d, instanceId=%d, config=%s, waiting %dms\n", tries+1, maxTries, (int)pInSettings[j][STRATEGY_INSTANCE_ID], configPathToUse, exponentialDelay);
-		result = initInstanceC ((int)pInSettings[j][STRATEGY_INSTANCE_ID], 1, configPathToUse, "");
-		fprintf(stderr, "[INIT] initInstanceC returned: %d\n", result);
-		fflush(stderr);
-		logInfo("initInstanceC returned: %d\n", result);
-		if(result == WAIT_FOR_INIT) {
-			sleepMilliseconds(exponentialDelay);
-			// Exponential backoff: increase delay up to 2 seconds max
-			if(exponentialDelay < 2000) {
-				exponentialDelay = (int)(exponentialDelay * 1.2);  // Increase by 20% each time
-			}
-		}
-		tries++;
-	}
-	
-	if(result == WAIT_FOR_INIT) {
-		fprintf(stderr, "[INIT] ERROR: initInstanceC failed after %d attempts with WAIT_FOR_INIT. Framework initialization may be taking too long or stuck.\n", maxTries);
-		fflush(stderr);
-		logError("initInstanceC failed after %d attempts with WAIT_FOR_INIT. Framework initialization may be taking too long or stuck.\n", maxTries);
-	}
+	// Concurrent callers wait inside initInstanceC while the first one creates the framework context
+	fprintf(stderr, "[INIT] Calling initInstanceC: instanceId=%d, config=%s\n", (int)pInSettings[j][STRATEGY_INSTANCE_ID], configPathToUse);
+	fflush(stderr);
+	logInfo("Calling initInstanceC: instanceId=%d, config=%s\n", (int)pInSettings[j][STRATEGY_INSTANCE_ID], configPathToUse);
+	result = initInstanceC ((int)pInSettings[j][STRATEGY_INSTANCE_ID], 1, configPathToUse, "");
+	fprintf(stderr, "[INIT] initInstanceC returned: %d\n", result);
+	fflush(stderr);
+	logInfo("initInstanceC returned: %d\n", result);
 		if(result!=SUCCESS){
 			switch (result){
 				case UNKNOWN_INSTANCE_ID:
@@ -1336,6 +1148,7 @@ TestResult __stdcall runPortfolioTest (
 			testResult.maxDDDepth = 0;
 			testResult.cagr = 0;
 			testResult.r2 = -1;  // Signal error
+			flush_me();
 			return testResult;
 		}
 	}
@@ -1421,14 +1234,14 @@ TestResult __stdcall runPortfolioTest (
         }
         // else: quote symbol is empty but conversionResult is SUCCESS (or no conversion needed) - this is OK
         
-		baseFiles[n] = NULL;
-		quoteFiles[n] = NULL;
+		baseConversion[n] = NULL;
+		quoteConversion[n] = NULL;
 
 		if(strlen(baseSymbols[n]) != 0){
 			logDebug("Opening base file");
 			sprintf (buffer, "%s_QUOTES.csv", baseSymbols[n]);			
-			baseFiles[n] = fopen(buffer , "r" );
-			if (baseFiles[n] == NULL) {
+			baseConversion[n] = loadConversionRates(buffer, pRates[n][0], numCandles);
+			if (baseConversion[n] == NULL) {
     			logWarning("Base conversion file not found: %s. Trading results may be inaccurate. Expected file: %s_QUOTES.csv", baseSymbols[n], baseSymbols[n]);
 			} else {
 				logDebug("Successfully opened base conversion file: %s_QUOTES.csv", baseSymbols[n]);
@@ -1438,8 +1251,8 @@ TestResult __stdcall runPortfolioTest (
 		if(strlen(quoteSymbols[n]) != 0){
 			logDebug("Opening quotes file");
 			sprintf (buffer, "%s_QUOTES.csv", quoteSymbols[n]);		
-			quoteFiles[n] = fopen(buffer , "r" );
-			if (quoteFiles[n] == NULL) {
+			quoteConversion[n] = loadConversionRates(buffer, pRates[n][0], numCandles);
+			if (quoteConversion[n] == NULL) {
     			logWarning("Quote conversion file not found: %s. Trading results may be inaccurate. Expected file: %s_QUOTES.csv", quoteSymbols[n], quoteSymbols[n]);
 			} else {
 				logDebug("Successfully opened quote conversion file: %s_QUOTES.csv", quoteSymbols[n]);
@@ -1447,21 +1260,27 @@ TestResult __stdcall runPortfolioTest (
 		}
 	}
 
+	// Per-bar buffers are carved from an arena that is reset on every bar (see RunArena.h)
+	m = 1;
+	for(s = 0; s<numSystems; s++){
+		if ((int)pInSettings[s][MAX_OPEN_ORDERS] > m) m = (int)pInSettings[s][MAX_OPEN_ORDERS];
+	}
+	initRunArena(&barArena, m * sizeof(StrategyResults));
+
 	logInfo("Starting main test loop. Max numbars required = %d, numCandles = %d", maxNumbarsRequired, numCandles);
 	logInfo("Requested testing limits. StartDate = %d, EndDate = %d", testSettings[0].fromDate, testSettings[0].toDate);
 
+	// Rates are handed to the strategy as sliding windows over the loaded history (see ratesWindow.h)
 	for(s = 0; s<numSystems; s++){
-	rates[s][0] = (CRates*)malloc(sizeof(CRates) * numBarsRequired[s][0]);
 	i[s] = maxNumbarsRequired - 1;
 	lastProcessedBar[s] = 0;
 	testsFinished[s] = 0;
 
-		for (n = 1; n < 10; n++){
-			if (numBarsRequired[s][n] > 0){
-			rates[s][n] = (CRates*)malloc(sizeof(CRates) * numBarsRequired[s][n]);
-			} else {
-			rates[s][n] = (CRates*)malloc(sizeof(CRates) * 1);
+		for (n = 0; n < 10; n++){
+			if (!initRatesWindow(&ratesWindows[s][n], pRates[s][n], numCandles, numBarsRequired[s][n])){
+				logError("Failed to allocate the rates window for system %d, rates %d (%d bars)", s, n, numBarsRequired[s][n]);
 			}
+			rates[s][n] = &ratesWindows[s][n].emptyBar;
 		}
 	}
 	
@@ -1537,31 +1356,11 @@ TestResult __stdcall runPortfolioTest (
 
 			while ( (int)currentBrokerTime < (int)pRates[s][0][i[s]].time){
 
-			if (fgets(data, 200, tickFiles[s]) == NULL) break;
+			if ((row = nextHistoryRow(tickFiles[s])) < 0) break;
 
-			timeString = strtok_r(data, ",", &strtokSave);
-			ptr = strtok_r(NULL, ",", &strtokSave);
-			sscanf(ptr,"%lf",&bidAsk[IDX_BID]);
-			ptr = strtok_r(NULL, ",", &strtokSave);
-			sscanf(ptr,"%lf",&bidAsk[IDX_ASK]);
-            
-			ptr = strtok_r(timeString, "-", &strtokSave);
-			sscanf(ptr,"%d",&lDate.tm_mday);
-			ptr = strtok_r(NULL, "-", &strtokSave);
-			sscanf(ptr,"%d",&lDate.tm_mon);
-			ptr = strtok_r(NULL, "-", &strtokSave);
-			sscanf(ptr,"%d",&lDate.tm_year);
-			ptr = strtok_r(NULL, "-", &strtokSave);
-			sscanf(ptr,"%d",&lDate.tm_hour);
-			ptr = strtok_r(NULL, "-", &strtokSave);
-			sscanf(ptr,"%d",&lDate.tm_min);
-			ptr = strtok_r(NULL, "-", &strtokSave);
-			sscanf(ptr,"%d",&lDate.tm_sec);
-
-			currentDateTime = mkgmtime(lDate.tm_year, lDate.tm_mon, lDate.tm_mday, lDate.tm_hour, lDate.tm_min, lDate.tm_sec);
-			strftime(date, 20, "%d/%m/%Y %H:%M:%S", gmtime(&currentDateTime));
-			
-			currentBrokerTime = (int)currentDateTime;
+			bidAsk[IDX_BID] = tickFiles[s]->column[0][row];
+			bidAsk[IDX_ASK] = tickFiles[s]->column[1][row];
+			currentBrokerTime = tickFiles[s]->time[row];
 			}
 
 			if (i[s]<numCandles-1){
@@ -1590,10 +1389,8 @@ TestResult __stdcall runPortfolioTest (
 
 		// reset strategy results
 
-		strategyResults = (StrategyResults*)malloc(sizeof(StrategyResults) * (int)pInSettings[s][MAX_OPEN_ORDERS]);
-
-		for(m = 0; m < (int)pInSettings[s][MAX_OPEN_ORDERS]; m++){
-			memset( (double *) &strategyResults[m], 0, 10 * sizeof(double)); }
+		resetRunArena(&barArena);
+		strategyResults = (StrategyResults*)runArenaCalloc(&barArena, (int)pInSettings[s][MAX_OPEN_ORDERS], sizeof(StrategyResults));
 
 		//Update Variables
 		if (currentBrokerTime == 0){
@@ -1604,47 +1401,9 @@ TestResult __stdcall runPortfolioTest (
 
 		// we should now get quote currency values if necessary
 
-		if(quoteFiles[s] != NULL){	
-
-			currentDateTime = 0;
-
-			while ( (int)currentDateTime < (int)pRates[s][0][i[s]].time){
-
-			if (fgets(data, 200, quoteFiles[s]) == NULL) break;
-
-			timeString = strtok_r(data, ",", &strtokSave);
-
-			ptr = strtok_r(NULL, ",", &strtokSave);
-			sscanf(ptr,"%lf",&bidAsk[IDX_QUOTE_CONVERSION_BID]);
+		if(quoteConversion[s] != NULL){
+			bidAsk[IDX_QUOTE_CONVERSION_BID] = quoteConversion[s][i[s]];
 			bidAsk[IDX_QUOTE_CONVERSION_ASK] = bidAsk[IDX_QUOTE_CONVERSION_BID];
-
-			ptr = strtok_r(timeString, "/", &strtokSave);
-			sscanf(ptr,"%d",&lDate.tm_mday);
-			ptr = strtok_r(NULL, "/", &strtokSave);
-			sscanf(ptr,"%d",&lDate.tm_mon);
-			ptr = strtok_r(NULL, " ", &strtokSave);
-			sscanf(ptr,"%d",&lDate.tm_year);
-			ptr = strtok_r(NULL, ":", &strtokSave);
-			sscanf(ptr,"%d",&lDate.tm_hour);
-			ptr = strtok_r(NULL, " ", &strtokSave);
-			sscanf(ptr,"%d",&lDate.tm_min);
-
-			lDate.tm_sec = 0;
-
-			if(lDate.tm_year < 50) lDate.tm_year += 2000 ; else lDate.tm_year += 1900;
-
-			currentDateTime = mkgmtime(lDate.tm_year, lDate.tm_mon, lDate.tm_mday, lDate.tm_hour, lDate.tm_min, lDate.tm_sec);
-			
-			/* Validate parsed time - negative times are invalid (before Unix epoch) */
-			if(currentDateTime < 0)
-			{
-				logError("DATA ISSUE: Invalid time parsed from quote conversion file %s_QUOTES.csv: timestamp=%zd (date: %02d/%02d/%04d %02d:%02d). This date is before Unix epoch (1970-01-01). Raw line: %.100s. Skipping this entry.", 
-				         quoteSymbols[s], currentDateTime, lDate.tm_mday, lDate.tm_mon, lDate.tm_year, lDate.tm_hour, lDate.tm_min, data);
-				break; /* Skip this invalid entry */
-			}
-			
-			strftime(date, 20, "%d/%m/%Y %H:%M:%S", gmtime(&currentDateTime));
-			}
 		} else {
 			if(strlen(quoteSymbols[s]) > 0) {
 				// Sanitize symbol for logging - remove any newlines that might cause message splitting
@@ -1664,48 +1423,9 @@ TestResult __stdcall runPortfolioTest (
 
 		// we should now get base currency values if necessary
 
-		if(baseFiles[s] != NULL){
-			logDebug("Reading base conversion rates from file for system %d", s);	
-
-			currentDateTime = 0;
-
-			while ( (int)currentDateTime < (int)pRates[s][0][i[s]].time){
-
-			if (fgets(data, 200, baseFiles[s]) == NULL) break;
-
-			timeString = strtok_r(data, ",", &strtokSave);
-
-			ptr = strtok_r(NULL, ",", &strtokSave);
-			sscanf(ptr,"%lf",&bidAsk[IDX_BASE_CONVERSION_BID]);
+		if(baseConversion[s] != NULL){
+			bidAsk[IDX_BASE_CONVERSION_BID] = baseConversion[s][i[s]];
 			bidAsk[IDX_BASE_CONVERSION_ASK] = bidAsk[IDX_BASE_CONVERSION_BID];
-
-			ptr = strtok_r(timeString, "/", &strtokSave);
-			sscanf(ptr,"%d",&lDate.tm_mday);
-			ptr = strtok_r(NULL, "/", &strtokSave);
-			sscanf(ptr,"%d",&lDate.tm_mon);
-			ptr = strtok_r(NULL, " ", &strtokSave);
-			sscanf(ptr,"%d",&lDate.tm_year);
-			ptr = strtok_r(NULL, ":", &strtokSave);
-			sscanf(ptr,"%d",&lDate.tm_hour);
-			ptr = strtok_r(NULL, " ", &strtokSave);
-			sscanf(ptr,"%d",&lDate.tm_min);
-
-			lDate.tm_sec = 0;
-
-			if(lDate.tm_year < 50) lDate.tm_year += 2000 ; else lDate.tm_year += 1900;
-
-			currentDateTime = mkgmtime(lDate.tm_year, lDate.tm_mon, lDate.tm_mday, lDate.tm_hour, lDate.tm_min, lDate.tm_sec);
-			
-			/* Validate parsed time - negative times are invalid (before Unix epoch) */
-			if(currentDateTime < 0)
-			{
-				logError("DATA ISSUE: Invalid time parsed from base conversion file %s_QUOTES.csv: timestamp=%zd (date: %02d/%02d/%04d %02d:%02d). This date is before Unix epoch (1970-01-01). Raw line: %.100s. Skipping this entry.", 
-				         baseSymbols[s], currentDateTime, lDate.tm_mday, lDate.tm_mon, lDate.tm_year, lDate.tm_hour, lDate.tm_min, data);
-				break; /* Skip this invalid entry */
-			}
-			
-			strftime(date, 20, "%d/%m/%Y %H:%M:%S", gmtime(&currentDateTime));
-			}
 		} else {
 			if(strlen(baseSymbols[s]) > 0) {
 				// Sanitize symbol for logging - remove any newlines that might cause message splitting
@@ -1736,54 +1456,18 @@ TestResult __stdcall runPortfolioTest (
 
 		lastProcessedBar[s] = i[s];
 
-		for(j=0; j<numBarsRequired[s][0]; j++){
-			sourceIndex = i[s] - numBarsRequired[s][0] + j + 1;
-			if(j==(numBarsRequired[s][0]-1)){   //Current Bar
-				rates[s][0][j].high	 = pRates[s][0][sourceIndex].open;
-				rates[s][0][j].low	 = pRates[s][0][sourceIndex].open;
-				rates[s][0][j].close  = pRates[s][0][sourceIndex].open;
-				rates[s][0][j].volume = 0;	
-				swapLong  = pRates[s][0][sourceIndex].swapLong;
-				swapShort = pRates[s][0][sourceIndex].swapShort;
-
-			}
-			else{		//Past Bars
-				rates[s][0][j].high	 = pRates[s][0][sourceIndex].high;
-				rates[s][0][j].low	 = pRates[s][0][sourceIndex].low;
-				rates[s][0][j].close  = pRates[s][0][sourceIndex].close;
-				rates[s][0][j].volume = pRates[s][0][sourceIndex].volume;
-			}
-			rates[s][0][j].time = pRates[s][0][sourceIndex].time;
-			rates[s][0][j].open = pRates[s][0][sourceIndex].open;
+		swapLong  = pRates[s][0][i[s]].swapLong;
+		swapShort = pRates[s][0][i[s]].swapShort;
 
-			if (pRates[s][0][sourceIndex].time == -1) {
-				logError("Invalid time (-1) found at sourceIndex %d for system %d, bar %d. Aborting test.", sourceIndex, s, i[s]);
-				abortTest = true;
-			}
+		rates[s][0] = moveRatesWindow(&ratesWindows[s][0], i[s], &hasInvalidTime);
+		if (hasInvalidTime) {
+			logError("Invalid time (-1) found in rates window for system %d, bar %d. Aborting test.", s, i[s]);
+			abortTest = true;
 		}
 
 		for (n = 1; n < 10; n++){
-		if (numBarsRequired[s][n] > 0){
-			for(j=0; j<numBarsRequired[s][n]; j++){
-				sourceIndex = i[s] - numBarsRequired[s][n] + j + 1;
-				if(j==(numBarsRequired[s][n]-1)){   //Current Bar
-					rates[s][n][j].high   = pRates[s][n][sourceIndex].open;
-					rates[s][n][j].low	   = pRates[s][n][sourceIndex].open;
-					rates[s][n][j].close  = pRates[s][n][sourceIndex].open;
-					rates[s][n][j].volume = 0;	
-				}
-				else{		//Past Bars
-					rates[s][n][j].high   = pRates[s][n][sourceIndex].high;
-					rates[s][n][j].low	   = pRates[s][n][sourceIndex].low;
-					rates[s][n][j].close  = pRates[s][n][sourceIndex].close;
-					rates[s][n][j].volume = pRates[s][n][sourceIndex].volume;
-				}
-				rates[s][n][j].time = pRates[s][n][sourceIndex].time;
-				rates[s][n][j].open = pRates[s][n][sourceIndex].open;
-
-				if (pRates[s][n][sourceIndex].time == -1) abortTest = true;
-			}
-		}
+			rates[s][n] = moveRatesWindow(&ratesWindows[s][n], i[s], &hasInvalidTime);
+			if (hasInvalidTime) abortTest = true;
 		}
 		} else {
 
@@ -1828,43 +1512,21 @@ TestResult __stdcall runPortfolioTest (
             conversionRate = 1/bidAsk[IDX_QUOTE_CONVERSION_ASK];
         }
 
-		pInAccountInfo[s][IDX_EQUITY] = calculateAccountEquity(pInAccountInfo[s], openOrdersCount, openOrders, conversionRate);
+		pBook = &orderBooks[s];
+		pInAccountInfo[s][IDX_EQUITY] = calculateAccountEquity(pInAccountInfo[s], pBook->openOrdersCount, pBook->orders, conversionRate);
         
-		for(m=0; m<openOrdersCount[BUY] + openOrdersCount[SELL]; m++){
-			checkPending(bidAsk[IDX_BID], bidAsk[IDX_ASK], m, openOrders, (int)pInSettings[s][STRATEGY_INSTANCE_ID], currentBrokerTime, numCandles, i[s]-1, pRates[s][0], testUpdate != NULL, testSettings[0].is_calculate_expectancy);
-			if(checkTPSL(bidAsk[IDX_BID], bidAsk[IDX_ASK], m, numBarsRequired[s][0]-2, rates[s][0], openOrdersCount, openOrders, (int)pInSettings[s][STRATEGY_INSTANCE_ID], currentBrokerTime, &lastOrder, pInTradeSymbol[s], &profit, pInAccountInfo[s][IDX_CONTRACT_SIZE],lastSignal, numSignals, finalBalance, conversionRate, &testResult.avgTradeDuration)){
+		for(m=0; m<pBook->numOpen; m++){
+			checkPending(bidAsk[IDX_BID], bidAsk[IDX_ASK], m, pBook->orders, (int)pInSettings[s][STRATEGY_INSTANCE_ID], currentBrokerTime, numCandles, i[s]-1, pRates[s][0], testUpdate != NULL, testSettings[0].is_calculate_expectancy);
+			if(checkTPSL(bidAsk[IDX_BID], bidAsk[IDX_ASK], m, numBarsRequired[s][0]-2, rates[s][0], pBook, (int)pInSettings[s][STRATEGY_INSTANCE_ID], currentBrokerTime, &lastOrder, pInTradeSymbol[s], &profit, pInAccountInfo[s][IDX_CONTRACT_SIZE],lastSignal, numSignals, finalBalance, conversionRate, &testResult.avgTradeDuration)){
 					finalBalance += profit;
 					if(is_optimization == FALSE){
 						testUpdate(s, percentageCompleted, lastOrder, finalBalance, pInTradeSymbol[s]);
                     }
-                    addStatisticValue(&statistics, &statisticsSize, profit, finalBalance, currentBrokerTime);
+                    addTradeStatistic(&tradeStatistics, profit, finalBalance, currentBrokerTime);
 				}
 		}
 
-		lastInterestAdditionTime = addInterest(openOrdersCount, openOrders, (int)pInSettings[s][STRATEGY_INSTANCE_ID], (int)currentBrokerTime, (int)pInAccountInfo[s][IDX_CONTRACT_SIZE], swapLong, swapShort, bidAsk, lastInterestAdditionTime);
-
-		for (m=0;m<MAX_ORDERS;m++){
-			systemOrders[m].instanceId = 0;
-			systemOrders[m].isOpen     = 0;
-			systemOrders[m].swap       = 0;
-			systemOrders[m].profit     = 0;
-			}
-
-		openOrdersCountSystem[BUY] = 0;
-		openOrdersCountSystem[SELL] = 0;
-
-		n = 0;
-		m = 0;
-		while (m < MAX_ORDERS ){
-			if (openOrders[m].instanceId == pInSettings[s][STRATEGY_INSTANCE_ID]){
-			systemOrders[n] = openOrders[m] ;
-			if ((openOrders[m].type ==BUY || openOrders[m].type ==BUYLIMIT || openOrders[m].type ==BUYSTOP) && (openOrders[m].isOpen == 1)) openOrdersCountSystem[BUY]++;
-			if ((openOrders[m].type ==SELL || openOrders[m].type ==SELLLIMIT || openOrders[m].type == SELLSTOP) && (openOrders[m].isOpen == 1)) openOrdersCountSystem[SELL]++;
-			n++;	
-			}
-
-			m++;
-		}
+		lastInterestAdditionTime = addInterest(pBook->openOrdersCount, pBook->orders, (int)pInSettings[s][STRATEGY_INSTANCE_ID], (int)currentBrokerTime, (int)pInAccountInfo[s][IDX_CONTRACT_SIZE], swapLong, swapShort, bidAsk, lastInterestAdditionTime);
 
 		result = SUCCESS;
 
@@ -1873,7 +1535,7 @@ TestResult __stdcall runPortfolioTest (
 		if((currentBrokerTime > testSettings[s].fromDate) && (currentBrokerTime < testSettings[s].toDate)){
 		BOOL isFirstStrategyRun = (i[s] == maxNumbarsRequired);
 		logDebug("Running strategy for system %d at bar %d, time = %d", s, i[s], currentBrokerTime);
-		result = c_runStrategy(pInSettings[s], pInTradeSymbol[s], pInAccountCurrency, pInBrokerName, pInRefBrokerName, &currentBrokerTime, openOrdersCountSystem, systemOrders,
+		result = c_runStrategy(pInSettings[s], pInTradeSymbol[s], pInAccountCurrency, pInBrokerName, pInRefBrokerName, &currentBrokerTime, pBook->openOrdersCount, pBook->orders,
 								pInAccountInfo[s], bidAsk, pRatesInfo[s], rates[s][0], rates[s][1], rates[s][2], rates[s][3], rates[s][4], rates[s][5], rates[s][6], rates[s][7], rates[s][8], rates[s][9], (double *)strategyResults);
 		logDebug("Strategy execution completed for system %d, result = %d", s, result);
 		} else {
@@ -1906,8 +1568,8 @@ TestResult __stdcall runPortfolioTest (
 					if ((operation & SIGNAL_OPEN_BUYSTOP) != 0) updateOrderType = BUYSTOP;
 
 					logDebug("BUY signal type %d. Instance ID = %d", (int)updateOrderType, (int)pInSettings[s][STRATEGY_INSTANCE_ID]);
-					openOrder(&strategyResults[m], openOrdersCount, openOrders, (int)pInSettings[s][STRATEGY_INSTANCE_ID], &totalTrades, currentBrokerTime, bidAsk[IDX_ASK], (int)updateOrderType,lastSignal, numSignals, finalBalance, minLotSize, pInAccountInfo[s][IDX_MINIMUM_STOP]);
-					logDebug("Open Order. ticket = %lf, instanceID = %lf, Entry = %lf, SL = %lf, TP =%lf", openOrders[openOrdersCount[BUY]+openOrdersCount[SELL]-1].ticket, openOrders[openOrdersCount[BUY]+openOrdersCount[SELL]-1].instanceId, openOrders[openOrdersCount[BUY]+openOrdersCount[SELL]-1].openPrice, openOrders[openOrdersCount[BUY]+openOrdersCount[SELL]-1].stopLoss, openOrders[openOrdersCount[BUY]+openOrdersCount[SELL]-1].takeProfit);
+					openOrder(&strategyResults[m], pBook, (int)pInSettings[s][STRATEGY_INSTANCE_ID], &totalTrades, currentBrokerTime, bidAsk[IDX_ASK], (int)updateOrderType,lastSignal, numSignals, finalBalance, minLotSize, pInAccountInfo[s][IDX_MINIMUM_STOP]);
+					if (pBook->numOpen > 0) logDebug("Open Order. ticket = %lf, instanceID = %lf, Entry = %lf, SL = %lf, TP =%lf", pBook->orders[pBook->numOpen-1].ticket, pBook->orders[pBook->numOpen-1].instanceId, pBook->orders[pBook->numOpen-1].openPrice, pBook->orders[pBook->numOpen-1].stopLoss, pBook->orders[pBook->numOpen-1].takeProfit);
 					numLongs++;
 
 
@@ -1923,12 +1585,12 @@ TestResult __stdcall runPortfolioTest (
 					if ((operation & SIGNAL_CLOSE_BUYSTOP) != 0) updateOrderType = BUYSTOP;
 
 					logDebug("Close BUY Signal. Instance ID = %d", (int)pInSettings[s][STRATEGY_INSTANCE_ID]);
-					if (closeOrder(&strategyResults[m], openOrdersCount, openOrders, (int)pInSettings[s][STRATEGY_INSTANCE_ID], currentBrokerTime, bidAsk[IDX_BID], &lastOrder, pInTradeSymbol[s], (int)updateOrderType, &profit, pInAccountInfo[s][IDX_CONTRACT_SIZE], globalSignalUpdate,lastSignal, numSignals, finalBalance, conversionRate, &testResult.avgTradeDuration)){
+					if (closeOrder(&strategyResults[m], pBook, (int)pInSettings[s][STRATEGY_INSTANCE_ID], currentBrokerTime, bidAsk[IDX_BID], &lastOrder, pInTradeSymbol[s], (int)updateOrderType, &profit, pInAccountInfo[s][IDX_CONTRACT_SIZE], globalSignalUpdate,lastSignal, numSignals, finalBalance, conversionRate, &testResult.avgTradeDuration)){
 						finalBalance += profit;
 						if(is_optimization == FALSE){
                             testUpdate(s, percentageCompleted, lastOrder, finalBalance, pInTradeSymbol[s]);
                         }
-						addStatisticValue(&statistics, &statisticsSize, profit, finalBalance, currentBrokerTime);
+						addTradeStatistic(&tradeStatistics, profit, finalBalance, currentBrokerTime);
 					}
 
 					//totalTrades,numShorts,numLongs should be counted on real open orders, excclude those stop and limit orders.
@@ -1947,7 +1609,7 @@ TestResult __stdcall runPortfolioTest (
 					if ((operation & SIGNAL_UPDATE_BUYLIMIT) != 0) updateOrderType = BUYLIMIT;
 					if ((operation & SIGNAL_UPDATE_BUYSTOP) != 0) updateOrderType = BUYSTOP;
 					
-					updateOrder((int)pInSettings[s][STRATEGY_INSTANCE_ID], &strategyResults[m], openOrdersCount, openOrders, bidAsk, (int)updateOrderType,lastSignal, numSignals, finalBalance, pInAccountInfo[s][IDX_MINIMUM_STOP]);
+					updateOrder((int)pInSettings[s][STRATEGY_INSTANCE_ID], &strategyResults[m], pBook->openOrdersCount, pBook->orders, bidAsk, (int)updateOrderType,lastSignal, numSignals, finalBalance, pInAccountInfo[s][IDX_MINIMUM_STOP]);
 				}
 
 				//SELL
@@ -1958,8 +1620,8 @@ TestResult __stdcall runPortfolioTest (
 					if ((operation & SIGNAL_OPEN_SELLSTOP) != 0) updateOrderType = SELLSTOP;
 
 					logDebug("SELL signal type %d. Instance ID = %d", (int)updateOrderType, (int)pInSettings[s][STRATEGY_INSTANCE_ID]);
-					openOrder(&strategyResults[m], openOrdersCount, openOrders, (int)pInSettings[s][STRATEGY_INSTANCE_ID], &totalTrades, currentBrokerTime, bidAsk[IDX_BID], (int)updateOrderType,lastSignal, numSignals, finalBalance, minLotSize, pInAccountInfo[s][IDX_MINIMUM_STOP]);
-					logDebug("Open Order. ticket = %lf, instanceID = %lf, Entry = %lf, SL = %lf, TP =%lf", openOrders[openOrdersCount[BUY]+openOrdersCount[SELL]-1].ticket, openOrders[openOrdersCount[BUY]+openOrdersCount[SELL]-1].instanceId, openOrders[openOrdersCount[BUY]+openOrdersCount[SELL]-1].openPrice, openOrders[openOrdersCount[BUY]+openOrdersCount[SELL]-1].stopLoss, openOrders[openOrdersCount[BUY]+openOrdersCount[SELL]-1].takeProfit);
+					openOrder(&strategyResults[m], pBook, (int)pInSettings[s][STRATEGY_INSTANCE_ID], &totalTrades, currentBrokerTime, bidAsk[IDX_BID], (int)updateOrderType,lastSignal, numSignals, finalBalance, minLotSize, pInAccountInfo[s][IDX_MINIMUM_STOP]);
+					if (pBook->numOpen > 0) logDebug("Open Order. ticket = %lf, instanceID = %lf, Entry = %lf, SL = %lf, TP =%lf", pBook->orders[pBook->numOpen-1].ticket, pBook->orders[pBook->numOpen-1].instanceId, pBook->orders[pBook->numOpen-1].openPrice, pBook->orders[pBook->numOpen-1].stopLoss, pBook->orders[pBook->numOpen-1].takeProfit);
 					numShorts++;
 
 					if(is_optimization == FALSE && updateOrderType == SELL) calculate_mathematical_expectancy(SELL, numCandles, i[s], bidAsk[IDX_BID], pRates[s][0], fabs(bidAsk[IDX_ASK]-bidAsk[IDX_BID]), testSettings[0].is_calculate_expectancy) ;
@@ -1972,12 +1634,12 @@ TestResult __stdcall runPortfolioTest (
 					if ((operation & SIGNAL_CLOSE_SELLSTOP) != 0) updateOrderType = SELLSTOP;
 
 					logDebug("Close SELL Signal. Instance ID = %d", (int)pInSettings[s][STRATEGY_INSTANCE_ID]);
-					if (closeOrder(&strategyResults[m], openOrdersCount, openOrders, (int)pInSettings[s][STRATEGY_INSTANCE_ID], currentBrokerTime, bidAsk[IDX_ASK], &lastOrder, pInTradeSymbol[s], (int)updateOrderType, &profit, pInAccountInfo[s][IDX_CONTRACT_SIZE], globalSignalUpdate,lastSignal, numSignals, finalBalance, conversionRate, &testResult.avgTradeDuration)){
+					if (closeOrder(&strategyResults[m], pBook, (int)pInSettings[s][STRATEGY_INSTANCE_ID], currentBrokerTime, bidAsk[IDX_ASK], &lastOrder, pInTradeSymbol[s], (int)updateOrderType, &profit, pInAccountInfo[s][IDX_CONTRACT_SIZE], globalSignalUpdate,lastSignal, numSignals, finalBalance, conversionRate, &testResult.avgTradeDuration)){
 						finalBalance += profit;
 						if(is_optimization == FALSE){
                             testUpdate(s, percentageCompleted, lastOrder, finalBalance, pInTradeSymbol[s]);						
                         }
-						addStatisticValue(&statistics, &statisticsSize, profit, finalBalance, currentBrokerTime);
+						addTradeStatistic(&tradeStatistics, profit, finalBalance, currentBrokerTime);
 
 						//totalTrades,numShorts,numLongs should be counted on real open orders, excclude those stop and limit orders.
 						if (updateOrderType == SELLLIMIT || updateOrderType == SELLSTOP)
@@ -1995,7 +1657,7 @@ TestResult __stdcall runPortfolioTest (
 					if ((operation & SIGNAL_UPDATE_SELLLIMIT) != 0) updateOrderType = SELLLIMIT;
 					if ((operation & SIGNAL_UPDATE_SELLSTOP) != 0) updateOrderType = SELLSTOP;
 
-					updateOrder((int)pInSettings[s][STRATEGY_INSTANCE_ID], &strategyResults[m], openOrdersCount, openOrders, bidAsk, (int)updateOrderType, lastSignal, numSignals, finalBalance, pInAccountInfo[s][IDX_MINIMUM_STOP]);
+					updateOrder((int)pInSettings[s][STRATEGY_INSTANCE_ID], &strategyResults[m], pBook->openOrdersCount, pBook->orders, bidAsk, (int)updateOrderType, lastSignal, numSignals, finalBalance, pInAccountInfo[s][IDX_MINIMUM_STOP]);
 				}
 			}
 			} //If trading signals
@@ -2004,8 +1666,6 @@ TestResult __stdcall runPortfolioTest (
 
 		previousBalance = finalBalance;
 
-		free(strategyResults); strategyResults = NULL;
-
 		if(tickFiles[s] == NULL)
 			i[s]++;
 
@@ -2024,6 +1684,13 @@ TestResult __stdcall runPortfolioTest (
 			finalBalance = 0;
 			break;
 		}
+
+		//Optimization runs stop as soon as they cannot pass the abort criteria any more
+		if (is_optimization == TRUE && exceedsAbortLimits(&tradeStatistics, &testSettings[0], finalBalance)){
+			logInfo("Run aborted at bar %d: maxDD = %lf, maxDDLength = %lf days, balance = %lf", i[0], tradeStatistics.maxDDDepth, tradeStatistics.maxDDLength/(double)SecondsPerDay, finalBalance);
+			testResult.aborted = true;
+			break;
+		}
 	}
 	
 	// CRITICAL: Log when main loop completes
@@ -2042,19 +1709,21 @@ TestResult __stdcall runPortfolioTest (
 	//save_openorder_to_file(pInTradeSymbol[0], openOrders, openOrdersCount);
 
 
-	orderIndex = openOrdersCount[BUY] + openOrdersCount[SELL];
+	orderIndex = 0;
+	for (n=0; n<numSystems; n++) orderIndex += orderBooks[n].numOpen;
 	logInfo("Saving open orders to file. orderIndex = %d", orderIndex);
 	if (orderIndex > 0)
 		save_openorder_to_file();
 
 	logInfo("Saved open orders to file. orderIndex = %d", orderIndex);
 	//For all the open orders
-	for (index = 0; index<orderIndex; index++){
-		if (openOrders[index].isOpen){
-			openOrders[index].closeTime = currentBrokerTime;
-			openOrders[index].closePrice = 0;
+	for (n=0; n<numSystems; n++){
+		pBook = &orderBooks[n];
+		for (index = 0; index<pBook->numOpen; index++){
+			pBook->orders[index].closeTime = currentBrokerTime;
+			pBook->orders[index].closePrice = 0;
 			if(testUpdate != NULL) {
-				testUpdate(0, percentageCompleted, openOrders[index], finalBalance, pInTradeSymbol[0]);
+				testUpdate(0, percentageCompleted, pBook->orders[index], finalBalance, pInTradeSymbol[0]);
 			}
 		}
 	}
@@ -2070,25 +1739,11 @@ TestResult __stdcall runPortfolioTest (
 	testResult.finalBalance = finalBalance;
 	testResult.numShorts = numShorts;
 	testResult.numLongs = numLongs;
-    testResult.yearsTraded = fabs(difftime(statistics[0].time, lastDate)/(3600*24*365));
+    testResult.yearsTraded = fabs(difftime(tradeStatistics.items[0].time, lastDate)/(3600*24*365));
 	testResult.cagr = 100*(pow(finalBalance/initialBalance, 1/testResult.yearsTraded)-1);
 	
 
-    calculate_trade_by_trade_statistics(statistics, 
-                                        statisticsSize, 
-                                        initialBalance, 
-                                        pInSettings[0][DISABLE_COMPOUNDING],
-                                        totalTrades,
-                                        &testResult, 
-                                        numSystems,
-                                        is_optimization);
-	
-    calculate_weekly_statistics(statistics, 
-                                statisticsSize, 
-                                initialBalance,
-                                pInSettings[0][DISABLE_COMPOUNDING],
-                                lastDate,
-                                &testResult);
+    finishTradeStatistics(&tradeStatistics, totalTrades, lastDate, &testResult);
     
     for(s=0;s<numSystems;s++){
 		strcat (testResult.symbol, pInTradeSymbol[s]);
@@ -2109,18 +1764,21 @@ TestResult __stdcall runPortfolioTest (
 	for(s = 0; s<numSystems; s++){
 
 		for (n = 0; n < 10; n++){
-			free(rates[s][n]); rates[s][n] = NULL;
+			freeRatesWindow(&ratesWindows[s][n]);
+			rates[s][n] = NULL;
 		}
+		free(ratesWindows[s]); ratesWindows[s] = NULL;
 		free(rates[s]); rates[s] = NULL;
+		freeOrderBook(&orderBooks[s]);
 
-		if (tickFiles[s] != NULL)
-			fclose(tickFiles[s]);
+		if (tickFiles[s] != NULL){
+			closeHistorySeries(tickFiles[s]);
+			free(tickFiles[s]); tickFiles[s] = NULL;
+		}
 
-		if (quoteFiles[s] != NULL)
-			fclose(quoteFiles[s]);
+		free(quoteConversion[s]); quoteConversion[s] = NULL;
 
-		if (baseFiles[s] != NULL)
-			fclose(baseFiles[s]);
+		free(baseConversion[s]); baseConversion[s] = NULL;
 
 		free(baseSymbols[s]); baseSymbols[s] = NULL;
 		free(quoteSymbols[s]); quoteSymbols[s] = NULL;
@@ -2129,14 +1787,19 @@ TestResult __stdcall runPortfolioTest (
 	free(i); i = NULL;
 	free(testsFinished); testsFinished = NULL;
 	free(tickFiles); tickFiles = NULL;
-	free(quoteFiles); quoteFiles = NULL;
-	free(baseFiles); baseFiles = NULL;
+	free(quoteConversion); quoteConversion = NULL;
+	free(baseConversion); baseConversion = NULL;
 	free(baseSymbols); baseSymbols = NULL;
 	free(quoteSymbols); quoteSymbols = NULL;
 	free(rates); rates = NULL;
+	free(ratesWindows); ratesWindows = NULL;
+	free(orderBooks); orderBooks = NULL;
 	free(lastProcessedBar); lastProcessedBar = NULL;
     
-	free(statistics); statistics = NULL;
+	freeTradeStatistics(&tradeStatistics);
+	freeRunArena(&barArena);
+	flush_me();
+	c_releaseStrategyScratch();
 	
 
 	for(s=0;s<numSystems;s++){ 
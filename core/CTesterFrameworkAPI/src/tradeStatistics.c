@@ -0,0 +1,400 @@
+//
+//  tradeStatistics.c
+//  ast
+//
+//  Streaming test statistics used by runPortfolioTest.
+//
+
+#include <math.h>
+#include "tradeStatistics.h"
+
+/* Ordinate of the balance regression: balance change, or log balance change when compounding */
+static double regressionOrdinate(const TradeStatistics *p, double balance){
+	if (p->isCompoundingDisabled == TRUE) return balance - p->firstBalance;
+	return log(balance) - log(p->firstBalance);
+}
+
+/* Adds count weeks with the same return (Chan et al. update of the Welford sums) */
+static void addWeeklyReturns(TradeStatistics *p, double weekReturn, int count){
+	double total = p->closedWeeks + count;
+	double delta = weekReturn - p->weekMean;
+
+	p->weekMean += delta * count / total;
+	p->weekM2   += delta * delta * p->closedWeeks * count / total;
+	p->closedWeeks += count;
+}
+
+/* Closes the current week on lastBalance and then numEmptyWeeks weeks without trades */
+static void closeWeeks(TradeStatistics *p, int numEmptyWeeks){
+	double weekReturn;
+
+	if (p->isCompoundingDisabled == TRUE){
+		weekReturn = (p->lastBalance - p->weekStartBalance) / p->initialBalance;
+	} else {
+		weekReturn = (p->lastBalance - p->weekStartBalance) / p->weekStartBalance;
+	}
+	addWeeklyReturns(p, weekReturn, 1);
+	p->weekStartBalance = p->lastBalance;
+
+	if (p->lastBalance > p->weekPeakBalance){
+		p->weekPeakBalance = p->lastBalance;
+	} else {
+		p->ulcerSum += pow((100 * ((p->lastBalance / p->weekPeakBalance) - 1)), 2);
+	}
+
+	/* A week without trades has a zero return and the same distance to the peak */
+	if (numEmptyWeeks > 0){
+		addWeeklyReturns(p, 0, numEmptyWeeks);
+		p->ulcerSum += numEmptyWeeks * pow((100 * ((p->lastBalance / p->weekPeakBalance) - 1)), 2);
+	}
+
+	p->weekEnd += (numEmptyWeeks + 1) * SECONDS_PER_TEST_WEEK;
+}
+
+int initTradeStatistics(TradeStatistics *pStatistics, double initialBalance, int isCompoundingDisabled, int initialCapacity){
+	memset(pStatistics, 0, sizeof(TradeStatistics));
+
+	pStatistics->initialBalance        = initialBalance;
+	pStatistics->isCompoundingDisabled = isCompoundingDisabled;
+	pStatistics->maxBalance            = initialBalance;
+	pStatistics->weekStartBalance      = initialBalance;
+	pStatistics->weekPeakBalance       = initialBalance;
+	pStatistics->capacity              = initialCapacity > 0 ? initialCapacity : 1;
+	pStatistics->items = (StatisticItem*)malloc(pStatistics->capacity * sizeof(StatisticItem));
+
+	return pStatistics->items != NULL;
+}
+
+int addTradeStatistic(TradeStatistics *p, double profit, double balance, int time){
+	StatisticItem *pItem;
+	double x, y, delta, maxDDDepthTemp = 0, maxDDLengthTemp = 0;
+
+	if (p->count == p->capacity){
+		StatisticItem *temp = (StatisticItem*)realloc(p->items, 2 * p->capacity * sizeof(StatisticItem));
+		if (temp == NULL) return false;
+		p->items = temp;
+		p->capacity *= 2;
+	}
+
+	if (p->count == 0){
+		p->firstTime    = time;
+		p->firstBalance = balance;
+		p->ddStartTime  = time;
+		p->weekEnd      = time + SECONDS_PER_TEST_WEEK;
+	} else if (time >= p->weekEnd){
+		closeWeeks(p, (time - p->weekEnd) / SECONDS_PER_TEST_WEEK);
+	}
+
+	pItem = &p->items[p->count++];
+	pItem->balance = balance;
+	pItem->profit  = profit;
+	pItem->time    = time;
+	p->lastBalance = balance;
+
+	// regression sums, same terms as calculate_trade_by_trade_statistics
+	x = (double)time - p->firstTime;
+	y = regressionOrdinate(p, balance);
+	p->sumTimeSqr     += pow(x, 2);
+	p->sumTimeBalance += (time - p->firstTime) * y;
+	p->sumBalanceSqr  += y * y;
+	delta = y - p->balanceMean;
+	p->balanceMean += delta / p->count;
+	p->balanceM2   += delta * (y - p->balanceMean);
+
+	// profit factor
+	if (profit > 0){
+		p->totalWin += profit;
+		p->totalWinningTrades += 1;
+		p->averageWinningTrade = p->averageWinningTrade*(p->totalWinningTrades-1)/p->totalWinningTrades + fabs((profit/balance)/p->totalWinningTrades);
+	} else {
+		p->totalLose += fabs(profit);
+		p->totalLosingTrades += 1;
+		p->averageLosingTrade = p->averageLosingTrade*(p->totalLosingTrades-1)/p->totalLosingTrades + fabs((profit/balance)/p->totalLosingTrades);
+	}
+
+	// max drawdown depth and length
+	if (balance < p->maxBalance){
+		if (p->isCompoundingDisabled == TRUE){
+			maxDDDepthTemp = ((p->maxBalance-balance)/p->initialBalance)*100;
+		} else {
+			maxDDDepthTemp = ((p->maxBalance-balance)/p->maxBalance)*100;
+		}
+		maxDDLengthTemp = fabs(difftime(time, p->ddStartTime));
+	} else {
+		p->maxBalance  = balance;
+		p->ddStartTime = time;
+	}
+
+	if (maxDDDepthTemp > p->maxDDDepth) p->maxDDDepth = maxDDDepthTemp;
+	if (maxDDLengthTemp > p->maxDDLength) p->maxDDLength = maxDDLengthTemp;
+
+	return true;
+}
+
+void finishTradeStatistics(TradeStatistics *p, int totalTrades, int lastDate, TestResult *testResult){
+	double yPs, yRs, meanWeekly, sigmaWeekly;
+	int numWeeks;
+
+	if (p->count == 0){
+		calculate_trade_by_trade_statistics(p->items, p->count, p->initialBalance, p->isCompoundingDisabled, totalTrades, testResult);
+		calculate_weekly_statistics(p->items, p->count, p->initialBalance, p->isCompoundingDisabled, lastDate, testResult);
+		return;
+	}
+
+	testResult->maxDDDepth  = p->maxDDDepth;
+	testResult->maxDDLength = p->maxDDLength;
+	testResult->winning     = p->totalWinningTrades/totalTrades*100;
+
+	if (p->totalLose == 0) testResult->pf = 0;
+	else testResult->pf = p->totalWin / p->totalLose;
+
+	// residuals of the fit through the first trade: sum((slope*x - y)^2) with slope = sum(xy)/sum(x^2)
+	yPs = p->sumBalanceSqr - p->sumTimeBalance * p->sumTimeBalance / p->sumTimeSqr;
+	yRs = p->balanceM2;
+	if ((yRs == 0) || (1-yPs/yRs) < 0) testResult->r2 = 0;
+	else testResult->r2 = (1-yPs/yRs);
+
+	testResult->risk_reward = p->averageWinningTrade/p->averageLosingTrade;
+	testResult->avgTradeDuration /= totalTrades;
+
+	if (testResult->maxDDDepth > 100){
+		testResult->maxDDDepth = 100;
+	}
+
+	// weeks counted by calculate_weekly_statistics: while (analysisTime < lastDate)
+	numWeeks = (lastDate > p->firstTime) ? (int)(((double)lastDate - p->firstTime + SECONDS_PER_TEST_WEEK - 1) / SECONDS_PER_TEST_WEEK) : 0;
+
+	// trades on or after the last counted week are ignored there
+	if (numWeeks <= p->closedWeeks){
+		calculate_weekly_statistics(p->items, p->count, p->initialBalance, p->isCompoundingDisabled, lastDate, testResult);
+		return;
+	}
+
+	closeWeeks(p, numWeeks - p->closedWeeks - 1);
+
+	if (sqrt(p->ulcerSum/numWeeks) > 100)
+		testResult->ulcerIndex = 100;
+	else
+		testResult->ulcerIndex = sqrt(p->ulcerSum/numWeeks);
+
+	meanWeekly  = p->weekMean;
+	sigmaWeekly = sqrt(p->weekM2/(numWeeks-1));
+
+	testResult->sharpe = 7.2111103*(meanWeekly/sigmaWeekly);
+	testResult->martin = testResult->cagr/testResult->ulcerIndex;
+}
+
+int exceedsAbortLimits(const TradeStatistics *p, const TestSettings *pSettings, double balance){
+	if (pSettings->abortMaxDD > 0 && p->maxDDDepth > pSettings->abortMaxDD) return true;
+	if (pSettings->abortMaxDDLength > 0 && p->maxDDLength > pSettings->abortMaxDDLength * SECONDS_PER_DAY) return true;
+	if (pSettings->abortEquityFloor > 0 && balance < pSettings->abortEquityFloor * p->initialBalance) return true;
+	return false;
+}
+
+void freeTradeStatistics(TradeStatistics *pStatistics){
+	free(pStatistics->items);
+	pStatistics->items    = NULL;
+	pStatistics->count    = 0;
+	pStatistics->capacity = 0;
+}
+
+void calculate_trade_by_trade_statistics(StatisticItem *statistics, 
+                                         int statisticsSize, 
+                                         double initialBalance, 
+                                         int is_compounding_disabled, 
+                                         int totalTrades,
+                                         TestResult *testResult){
+    //Calculate statistics
+    // variables for jonathan worst case definition
+	
+    double maxBalance = initialBalance;
+	double avgBalanceLog = 0;
+	double maxDDDepth = 0;
+	int maxDDLength = 0;
+	int ddStartTime = statistics[0].time;
+	double averageWinningTrade = 0;
+	double averageLosingTrade = 0;
+    double seriesCumulativeSquareReturns = 0;
+	double seriesCumulativeReturns = 0;
+	double sigma = 0;
+    double sumBalanceTime = 0;
+    double timeSqrSum = 0;
+    double tradeReturn = 0;
+    double previousBalance;
+    double  profit;
+    double totalWin = 0;
+    double totalLose = 0;
+    double avgTime=0;
+    double avgBalance=0;
+    double totalWinningTrades = 0;
+    double totalLosingTrades = 0;
+    double maxDDDepthTemp = 0;
+    double maxDDLengthTemp;
+    double yPs = 0;
+	double yRs = 0;
+    double linearRegressionSlope;
+    
+    
+    int j;
+    
+	for(j=0; j < statisticsSize; j++){
+        
+        timeSqrSum += pow((double)statistics[j].time-statistics[0].time, 2) ;
+
+        // calculations needed for linear regression
+		if(is_compounding_disabled == TRUE){
+			sumBalanceTime += (statistics[j].time-statistics[0].time)*(statistics[j].balance-statistics[0].balance);
+		} else {
+			sumBalanceTime += (statistics[j].time-statistics[0].time)*(log(statistics[j].balance)- log(statistics[0].balance));
+		}
+        
+        avgTime += (statistics[j].time-statistics[0].time) / (double)statisticsSize;
+		avgBalance += (statistics[j].balance-statistics[0].balance) / statisticsSize;
+		avgBalanceLog += (log(statistics[j].balance)-log(statistics[0].balance)) / statisticsSize;
+
+		//Calculate profit factor
+		if(statistics[j].profit > 0){
+			totalWin += statistics[j].profit;
+			totalWinningTrades +=1;
+			averageWinningTrade = averageWinningTrade*(totalWinningTrades-1)/totalWinningTrades + fabs((statistics[j].profit/statistics[j].balance)/totalWinningTrades);
+		} else { 
+			totalLose += fabs(statistics[j].profit);
+			totalLosingTrades +=1;
+			averageLosingTrade = averageLosingTrade*(totalLosingTrades-1)/totalLosingTrades + fabs((statistics[j].profit/statistics[j].balance)/totalLosingTrades);
+		}
+
+		//calculate maxdrawdown depth and max drawdown length
+		if(statistics[j].balance < maxBalance){
+
+			if(is_compounding_disabled == TRUE){
+				maxDDDepthTemp  = ((maxBalance-statistics[j].balance)/initialBalance)*100 ;
+			} else {
+				maxDDDepthTemp  = ((maxBalance-statistics[j].balance)/maxBalance)*100 ;
+			}
+
+			maxDDLengthTemp = fabs(difftime(statistics[j].time, ddStartTime));
+		}
+		else //if(statistics[j].balance > maxBalance)
+		{
+		   maxBalance = statistics[j].balance;
+		   maxDDDepthTemp = 0;
+		   maxDDLengthTemp = 0;
+		   ddStartTime = statistics[j].time;
+		}
+
+
+		if(maxDDDepthTemp > maxDDDepth){
+			maxDDDepth = maxDDDepthTemp ;
+		}
+
+		if(maxDDLengthTemp > maxDDLength){
+			maxDDLength = maxDDLengthTemp ;
+		}
+	}
+
+	linearRegressionSlope = (sumBalanceTime) / timeSqrSum ;
+    
+	yPs = 0;
+	yRs = 0;
+
+	// determination coefficient calculation
+	for(j=0; j < statisticsSize; j++){
+		if(is_compounding_disabled == TRUE){
+			yPs += pow((linearRegressionSlope*(statistics[j].time-statistics[0].time) - (statistics[j].balance-statistics[0].balance)), 2);
+			yRs += pow(((statistics[j].balance-statistics[0].balance) - avgBalance), 2);
+		} else {
+			yPs += pow((linearRegressionSlope*(statistics[j].time-statistics[0].time) - (log(statistics[j].balance)- log(statistics[0].balance))), 2);
+			yRs += pow(((log(statistics[j].balance)- log(statistics[0].balance)) - avgBalanceLog), 2);
+		}
+	}
+
+	testResult->maxDDDepth = maxDDDepth;
+	testResult->maxDDLength = maxDDLength;
+    testResult->winning = totalWinningTrades/totalTrades*100;
+    
+	if (totalLose == 0) testResult->pf = 0;
+	else testResult->pf = totalWin / totalLose;
+
+	if ((yRs == 0) || (1-yPs/yRs) < 0) testResult->r2 = 0; 
+	else testResult->r2 = (1-yPs/yRs);
+	
+	testResult->risk_reward= averageWinningTrade/averageLosingTrade;
+	testResult->avgTradeDuration /= totalTrades;
+    
+    if (testResult->maxDDDepth > 100){
+		testResult->maxDDDepth = 100;
+	}
+    
+}
+
+void calculate_weekly_statistics(StatisticItem *statistics, 
+                                 int statisticsSize, 
+                                 double initialBalance,
+                                 int is_compounding_disabled,
+                                 int lastDate,
+                                 TestResult *testResult){
+   
+/* Ulcer Index, Sharpe and martin ratio calculations */
+
+	int n = 0;
+	int j = 0;
+	int lastTradeIndex = 0;
+	double sumSqrt = 0;
+	double cumWeekReturn = 0;
+	double cumWeekReturnSquare = 0;
+	double maxBalance = initialBalance;
+
+	double meanWeekly;
+	double sigmaWeekly;
+	double weekReturn;
+    
+	
+    int startDate = statistics[0].time;
+	int analysisTime = statistics[0].time;
+    double startWeekBalance = initialBalance;
+	double lastWeekBalance = startWeekBalance;
+
+	while (analysisTime < lastDate)
+	{
+		n++;
+		analysisTime += SECONDS_PER_TEST_WEEK;
+
+		while ((statistics[j].time < analysisTime) & (j < statisticsSize))
+		{   
+		   lastWeekBalance = statistics[j].balance;
+		   lastTradeIndex = j;
+		   j++;	   
+		}
+        
+		if(is_compounding_disabled == TRUE){
+			weekReturn = (lastWeekBalance-startWeekBalance)/initialBalance;
+		} else {
+			weekReturn = (lastWeekBalance-startWeekBalance)/startWeekBalance;
+		}
+
+		cumWeekReturn += weekReturn;
+		cumWeekReturnSquare += weekReturn*weekReturn;
+        startWeekBalance = statistics[j-1].balance;
+		
+		if (lastWeekBalance > maxBalance) {
+		maxBalance = lastWeekBalance;
+		}
+		else {
+		sumSqrt += pow((100 * ((lastWeekBalance / maxBalance) -1)), 2); 
+		}
+
+	}
+
+	/* if above 100 make the UlcerIndex 100 (all strategies above 100 are useless) */
+	if (sqrt(sumSqrt/n) > 100)
+		testResult->ulcerIndex = 100; 
+	else
+		testResult->ulcerIndex = sqrt(sumSqrt/n);
+
+	meanWeekly = cumWeekReturn/n;
+	sigmaWeekly = sqrt((n*cumWeekReturnSquare-cumWeekReturn*cumWeekReturn)/(n*(n-1)));
+
+	testResult->sharpe = 7.2111103*(meanWeekly/sigmaWeekly);
+	testResult->martin = testResult->cagr/testResult->ulcerIndex; 
+    
+}
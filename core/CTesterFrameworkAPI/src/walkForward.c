@@ -0,0 +1,371 @@
+//
+//  walkForward.c
+//  ast
+//
+//  Walk-forward optimization over the history loaded once by the caller.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "CTesterFrameworkDefines.h"
+#include "walkForward.h"
+#include "workerInstances.h"
+#include "fitnessCache.h"
+
+//Goal fitness of every in-sample run of the current window, keyed by the set values and the symbol index
+static FitnessCache	runFitness;
+static int			numSetValues, numRunSymbols, runIteration;
+static char**		runSymbols;
+static double		runInitialBalance;
+static GeneticOptimizationSettings runOptimizationSettings;
+static OptimizationType runOptimizationType;
+static void			(*runOptimizationUpdate)(TestResult testResult, double* settings, int numSettings);
+
+static WalkForwardOptimizer	inSampleOptimizer = runOptimizationMultipleSymbols;
+static WalkForwardTester	outOfSampleTester = runPortfolioTest;
+
+void setWalkForwardRunners(WalkForwardOptimizer optimizer, WalkForwardTester tester){
+	inSampleOptimizer = optimizer != NULL ? optimizer : runOptimizationMultipleSymbols;
+	outOfSampleTester = tester != NULL ? tester : runPortfolioTest;
+}
+
+int getWalkForwardWindows(WalkForwardSettings walkForwardSettings, int fromDate, int toDate, WalkForwardWindow *windows, int maxWindows){
+	long long inSample  = (long long)walkForwardSettings.inSampleDays * SECONDS_PER_DAY;
+	long long outOfSample = (long long)walkForwardSettings.outOfSampleDays * SECONDS_PER_DAY;
+	long long step = (long long)(walkForwardSettings.stepDays > 0 ? walkForwardSettings.stepDays : walkForwardSettings.outOfSampleDays) * SECONDS_PER_DAY;
+	long long start, outOfSampleTo;
+	int count = 0;
+
+	if (walkForwardSettings.inSampleDays <= 0 || walkForwardSettings.outOfSampleDays <= 0 || walkForwardSettings.stepDays < 0) return 0;
+
+	for (start = fromDate; start + inSample < toDate; start += step){
+		if (windows != NULL){
+			if (count >= maxWindows) break;
+
+			//The out-of-sample period ends where the next one starts
+			outOfSampleTo = start + inSample + (outOfSample < step ? outOfSample : step);
+			if (outOfSampleTo > toDate) outOfSampleTo = toDate;
+
+			windows[count].index           = count;
+			windows[count].inSampleFrom    = (int)start;
+			windows[count].inSampleTo      = (int)(start + inSample);
+			windows[count].outOfSampleFrom = (int)(start + inSample);
+			windows[count].outOfSampleTo   = (int)outOfSampleTo;
+		}
+		count++;
+	}
+
+	return count;
+}
+
+/* optimizationUpdate of the in-sample optimizations, runs on the optimizer threads */
+static void collectInSampleRun(TestResult testResult, double* settings, int numSettings){
+	double *key, fitness;
+	int k, symbol, iteration, hasFitness, isDiscarded;
+
+	if (runOptimizationUpdate != NULL) runOptimizationUpdate(testResult, settings, numSettings);
+	if (numSettings != numSetValues) return;
+
+	for (symbol = 0; symbol < numRunSymbols && strcmp(testResult.symbol, runSymbols[symbol]) != 0; symbol++);
+
+	key = (double*)malloc((numSetValues + 1) * sizeof(double));
+	if (key == NULL) return;
+	for (k = 0; k < numSetValues; k++){
+		key[k] = settings[k*2+1];
+	}
+	key[numSetValues] = symbol;
+
+	#pragma omp critical (walkForward)
+	{
+		iteration = ++runIteration;
+	}
+
+	//The genetic optimizer already logged why it discarded the run
+	if (runOptimizationType == OPTI_GENETIC){
+		isDiscarded = isDiscardedResultQuiet(testResult, runOptimizationSettings, runInitialBalance);
+	} else {
+		isDiscarded = isDiscardedResult(testResult, runOptimizationSettings, runInitialBalance, iteration);
+	}
+
+	hasFitness = getGoalFitness(testResult, runOptimizationSettings.optimizationGoal, runInitialBalance, &fitness);
+	if (isDiscarded || !hasFitness || fitness != fitness){
+		fitness = -HUGE_VAL;
+	}
+
+	//A set run twice for the same symbol is only counted once
+	storeFitness(&runFitness, key, 0, fitness);
+	free(key);
+}
+
+/* Sums the runs of each set over the symbols, the best set that ran on every symbol wins */
+static int chooseBestSet(double *bestSet, double *pBestFitness){
+	FitnessCache setFitness, setRuns;
+	double fitness, runs;
+	const double *key;
+	int slot, hasSet = false;
+
+	if (!initFitnessCache(&setFitness, numSetValues, runFitness.count)) return false;
+	if (!initFitnessCache(&setRuns, numSetValues, runFitness.count)){
+		freeFitnessCache(&setFitness);
+		return false;
+	}
+
+	for (slot = 0; slot < runFitness.capacity; slot++){
+		if (!runFitness.used[slot]) continue;
+		key = &runFitness.keys[slot * runFitness.numParams];
+
+		if (!lookupFitness(&setFitness, key, 0, &fitness)) fitness = 0;
+		if (!lookupFitness(&setRuns, key, 0, &runs)) runs = 0;
+		storeFitness(&setFitness, key, 0, fitness + runFitness.fitness[slot]);
+		storeFitness(&setRuns, key, 0, runs + 1);
+	}
+
+	for (slot = 0; slot < setFitness.capacity; slot++){
+		if (!setFitness.used[slot] || setFitness.fitness[slot] == -HUGE_VAL) continue;
+		key = &setFitness.keys[slot * setFitness.numParams];
+
+		if (lookupFitness(&setRuns, key, 0, &runs) && (int)runs == numRunSymbols && (!hasSet || setFitness.fitness[slot] > *pBestFitness)){
+			memcpy(bestSet, key, numSetValues * sizeof(double));
+			*pBestFitness = setFitness.fitness[slot];
+			hasSet = true;
+		}
+	}
+
+	freeFitnessCache(&setFitness);
+	freeFitnessCache(&setRuns);
+	return hasSet;
+}
+
+/* Dates covered by the base timeframe of every symbol */
+static int getHistoryRange(ASTRates*** pRates, int numSymbols, int numCandles, int *pFromDate, int *pToDate){
+	int n, first, last;
+
+	*pFromDate = 0;
+	*pToDate = 0;
+
+	for (n = 0; n < numSymbols; n++){
+		for (first = 0; first < numCandles && pRates[n][0][first].time <= 0; first++);
+		for (last = numCandles - 1; last > first && pRates[n][0][last].time <= 0; last--);
+		if (first >= last) return false;
+
+		if (n == 0 || pRates[n][0][first].time > *pFromDate) *pFromDate = pRates[n][0][first].time;
+		if (n == 0 || pRates[n][0][last].time < *pToDate) *pToDate = pRates[n][0][last].time;
+	}
+
+	return *pFromDate < *pToDate;
+}
+
+static void setError(char **error, const char *description){
+	fprintf(stderr, "[WF] ERROR: %s\n", description);
+	fflush(stderr);
+	if (error == NULL) return;
+	*error = (char*)malloc(strlen(description) + 1);
+	if (*error != NULL) strcpy(*error, description);
+}
+
+int __stdcall runWalkForwardOptimization(
+	OptimizationParam	*optimizationParams,
+	int					numOptimizedParams,
+	OptimizationType	optimizationType,
+	GeneticOptimizationSettings optimizationSettings,
+	int					numThreads,
+	double*				pInSettings,
+	char**				pInTradeSymbol,
+	char*				pInAccountCurrency,
+	char*				pInBrokerName,
+	char*				pInRefBrokerName,
+	double*				pInAccountInfo,
+	TestSettings*		testSettings,
+	CRatesInfo**		pRatesInfo,
+	int					numCandles,
+	int					numSymbols,
+	ASTRates***			pRates,
+	double				minLotSize,
+	WalkForwardSettings	walkForwardSettings,
+	void				(*optimizationUpdate)(TestResult testResult, double* settings, int numSettings),
+	void				(*walkForwardUpdate)(WalkForwardWindow window, double* settings, int numSettings),
+	void				(*optimizationFinished)(),
+	char				**error
+)
+{
+	WalkForwardWindow *windows, *pWindow;
+	TestSettings *windowSettings;
+	CRatesInfo **runRatesInfo;
+	double **runSettings, **runAccountInfo, *bestSet, *currentSet, balance;
+	int numWindows, w, n, p, fromDate, toDate, configInstanceId, isSuccess = true;
+
+	#if HAVE_MPI == 1
+	if (getenv("OMPI_COMM_WORLD_RANK") != NULL || getenv("PMI_RANK") != NULL){
+		setError(error, "Walk-forward optimization is not available under MPI");
+		return false;
+	}
+	#endif
+
+	if (!getHistoryRange(pRates, numSymbols, numCandles, &fromDate, &toDate)){
+		setError(error, "No history to run a walk-forward optimization on");
+		return false;
+	}
+	if (testSettings[0].fromDate > fromDate) fromDate = testSettings[0].fromDate;
+	if (testSettings[0].toDate > 0 && testSettings[0].toDate < toDate) toDate = testSettings[0].toDate;
+
+	numWindows = getWalkForwardWindows(walkForwardSettings, fromDate, toDate, NULL, 0);
+	if (numWindows == 0){
+		setError(error, "The test period does not fit one in-sample and out-of-sample window");
+		return false;
+	}
+
+	windows        = (WalkForwardWindow*)calloc(numWindows, sizeof(WalkForwardWindow));
+	windowSettings = (TestSettings*)malloc(numSymbols * sizeof(TestSettings));
+	runSettings    = (double**)calloc(numSymbols, sizeof(double*));
+	runAccountInfo = (double**)calloc(numSymbols, sizeof(double*));
+	runRatesInfo   = (CRatesInfo**)calloc(numSymbols, sizeof(CRatesInfo*));
+	bestSet        = (double*)malloc((numOptimizedParams > 0 ? numOptimizedParams : 1) * sizeof(double));
+	currentSet     = (double*)malloc((numOptimizedParams > 0 ? numOptimizedParams : 1) * 2 * sizeof(double));
+
+	for (n = 0; runSettings != NULL && runAccountInfo != NULL && runRatesInfo != NULL && n < numSymbols; n++){
+		runSettings[n]    = (double*)malloc(64 * sizeof(double));
+		runAccountInfo[n] = (double*)malloc(sizeof(AccountInfo));
+		runRatesInfo[n]   = (CRatesInfo*)malloc(10 * sizeof(CRatesInfo));
+		if (runSettings[n] == NULL || runAccountInfo[n] == NULL || runRatesInfo[n] == NULL) isSuccess = false;
+	}
+
+	if (windows == NULL || windowSettings == NULL || runSettings == NULL || runAccountInfo == NULL || runRatesInfo == NULL || bestSet == NULL || currentSet == NULL){
+		isSuccess = false;
+	}
+
+	if (!isSuccess){
+		setError(error, "Failed to allocate the walk-forward tables");
+	} else {
+		getWalkForwardWindows(walkForwardSettings, fromDate, toDate, windows, numWindows);
+	}
+
+	fprintf(stderr, "[WF] %d windows of %d in-sample and %d out-of-sample days\n", numWindows, walkForwardSettings.inSampleDays, walkForwardSettings.outOfSampleDays);
+	fflush(stderr);
+
+	numSetValues          = numOptimizedParams;
+	numRunSymbols         = numSymbols;
+	runSymbols            = pInTradeSymbol;
+	runInitialBalance     = pInAccountInfo[IDX_BALANCE];
+	runOptimizationSettings = optimizationSettings;
+	runOptimizationType   = optimizationType;
+	runOptimizationUpdate = optimizationUpdate;
+	configInstanceId      = (int)pInSettings[STRATEGY_INSTANCE_ID];
+	balance               = pInAccountInfo[IDX_BALANCE];
+
+	//A stop requested at any point, also between two windows, ends the walk-forward
+	clearOptimizationStop();
+	keepOptimizationStop(true);
+
+	for (w = 0; isSuccess && w < numWindows; w++){
+		pWindow = &windows[w];
+
+		if (isOptimizationStopped()){
+			fprintf(stderr, "[WF] Stopped before window %d\n", w);
+			fflush(stderr);
+			break;
+		}
+
+		fprintf(stderr, "[WF] Window %d: optimizing %d to %d\n", w, pWindow->inSampleFrom, pWindow->inSampleTo);
+		fflush(stderr);
+
+		for (n = 0; n < numSymbols; n++){
+			windowSettings[n] = testSettings[n];
+			windowSettings[n].fromDate = pWindow->inSampleFrom;
+			windowSettings[n].toDate   = pWindow->inSampleTo;
+		}
+
+		runIteration = 0;
+		if (!initFitnessCache(&runFitness, numOptimizedParams + 1, 1024)){
+			setError(error, "Failed to allocate the in-sample results table");
+			isSuccess = false;
+			break;
+		}
+
+		if (!inSampleOptimizer(optimizationParams, numOptimizedParams, optimizationType, optimizationSettings, numThreads, pInSettings, pInTradeSymbol,
+							   pInAccountCurrency, pInBrokerName, pInRefBrokerName, pInAccountInfo, windowSettings, pRatesInfo, numCandles, numSymbols,
+							   pRates, minLotSize, collectInSampleRun, NULL, error)){
+			if (error != NULL && *error == NULL) setError(error, "In-sample optimization failed");
+			freeFitnessCache(&runFitness);
+			isSuccess = false;
+			break;
+		}
+
+		if (isOptimizationStopped()){
+			fprintf(stderr, "[WF] Stopped during window %d\n", w);
+			fflush(stderr);
+			freeFitnessCache(&runFitness);
+			break;
+		}
+
+		pWindow->hasSet = chooseBestSet(bestSet, &pWindow->inSampleFitness);
+		freeFitnessCache(&runFitness);
+
+		//Out-of-sample test of the chosen set, continuing the stitched balance
+		pWindow->startBalance = balance;
+
+		if (pWindow->hasSet){
+			for (n = 0; n < numSymbols; n++){
+				memcpy(runSettings[n], pInSettings, 64 * sizeof(double));
+				for (p = 0; p < numOptimizedParams; p++){
+					runSettings[n][optimizationParams[p].index] = bestSet[p];
+				}
+				runSettings[n][STRATEGY_INSTANCE_ID] = getWorkerInstanceId(configInstanceId != 0 ? configInstanceId : n+1, n);
+
+				memcpy(runAccountInfo[n], pInAccountInfo, sizeof(AccountInfo));
+				runAccountInfo[n][IDX_BALANCE] = balance;
+				runAccountInfo[n][IDX_EQUITY]  = balance;
+
+				memcpy(runRatesInfo[n], pRatesInfo[n], 10 * sizeof(CRatesInfo));
+
+				windowSettings[n].fromDate = pWindow->outOfSampleFrom;
+				windowSettings[n].toDate   = pWindow->outOfSampleTo;
+				windowSettings[n].abortMaxDD = 0;
+				windowSettings[n].abortMaxDDLength = 0;
+				windowSettings[n].abortEquityFloor = 0;
+			}
+
+			pWindow->outOfSampleResult = outOfSampleTester(w+1, runSettings, pInTradeSymbol, pInAccountCurrency, pInBrokerName, pInRefBrokerName, runAccountInfo,
+														   windowSettings, runRatesInfo, numCandles, numSymbols, pRates, minLotSize, NULL, NULL, NULL);
+
+			for (n = 0; n < numSymbols; n++){
+				releaseWorkerInstance((int)runSettings[n][STRATEGY_INSTANCE_ID]);
+			}
+
+			balance = pWindow->outOfSampleResult.finalBalance;
+		}
+
+		pWindow->endBalance = balance;
+
+		fprintf(stderr, "[WF] Window %d: out-of-sample %d to %d, balance %lf -> %lf\n", w, pWindow->outOfSampleFrom, pWindow->outOfSampleTo, pWindow->startBalance, pWindow->endBalance);
+		fflush(stderr);
+
+		for (p = 0; p < numOptimizedParams; p++){
+			currentSet[p*2]   = (double)optimizationParams[p].index;
+			currentSet[p*2+1] = bestSet[p];
+		}
+
+		if (walkForwardUpdate != NULL) walkForwardUpdate(*pWindow, currentSet, pWindow->hasSet ? numOptimizedParams : 0);
+	}
+
+	keepOptimizationStop(false);
+	runOptimizationUpdate = NULL;
+	runSymbols = NULL;
+
+	for (n = 0; runSettings != NULL && runAccountInfo != NULL && runRatesInfo != NULL && n < numSymbols; n++){
+		free(runSettings[n]);
+		free(runAccountInfo[n]);
+		free(runRatesInfo[n]);
+	}
+	free(runSettings);
+	free(runAccountInfo);
+	free(runRatesInfo);
+	free(windowSettings);
+	free(windows);
+	free(bestSet);
+	free(currentSet);
+
+	if (isSuccess && optimizationFinished != NULL) optimizationFinished();
+
+	return isSuccess;
+}
@@ -0,0 +1,71 @@
+//
+//  workerInstances.c
+//  ast
+//
+//  Instance IDs private to each optimizer worker.
+//
+
+#include <limits.h>
+#include "workerInstances.h"
+#include "ContiguousRatesCircBuf.h"
+#include "InstanceStates.h"
+#include "CriticalSection.h"
+#include "AsirikuyLogger.h"
+#include "EasyTradeCWrapper.hpp"
+
+/* Set file IDs in the order they were first run, a worker ID ends in the index of its set file ID */
+static int gConfigInstanceIds[MAX_WORKER_CONFIG_IDS];
+static int gNumConfigInstanceIds = 0;
+
+static int findConfigSlot(int configInstanceId, int isAdding){
+	int slot;
+
+	for(slot = 0; slot < gNumConfigInstanceIds; slot++){
+		if(gConfigInstanceIds[slot] == configInstanceId) return slot;
+	}
+
+	if(!isAdding || gNumConfigInstanceIds == MAX_WORKER_CONFIG_IDS) return -1;
+
+	gConfigInstanceIds[gNumConfigInstanceIds] = configInstanceId;
+	return gNumConfigInstanceIds++;
+}
+
+int getWorkerInstanceId(int configInstanceId, int worker){
+	int slot;
+
+	if(worker < 0 || worker >= (INT_MAX - WORKER_INSTANCE_ID_BASE) / MAX_WORKER_CONFIG_IDS){
+		logError("getWorkerInstanceId() Worker %d is out of range. Running instance ID %d unchanged.", worker, configInstanceId);
+		return configInstanceId;
+	}
+
+	enterCriticalSection();
+	slot = findConfigSlot(configInstanceId, 1);
+	leaveCriticalSection();
+
+	if(slot < 0){
+		logError("getWorkerInstanceId() More than %d set file instance IDs. Running instance ID %d unchanged.", MAX_WORKER_CONFIG_IDS, configInstanceId);
+		return configInstanceId;
+	}
+
+	return WORKER_INSTANCE_ID_BASE + worker * MAX_WORKER_CONFIG_IDS + slot;
+}
+
+int getConfigInstanceId(int instanceId){
+	int slot, configInstanceId = instanceId;
+
+	if(instanceId < WORKER_INSTANCE_ID_BASE) return instanceId;
+
+	slot = (instanceId - WORKER_INSTANCE_ID_BASE) % MAX_WORKER_CONFIG_IDS;
+
+	enterCriticalSection();
+	if(slot < gNumConfigInstanceIds) configInstanceId = gConfigInstanceIds[slot];
+	leaveCriticalSection();
+
+	return configInstanceId;
+}
+
+void releaseWorkerInstance(int instanceId){
+	resetInstanceBuffer(instanceId);
+	clearInstanceState(instanceId);
+	releaseIndicatorStatesEasy(instanceId);
+}
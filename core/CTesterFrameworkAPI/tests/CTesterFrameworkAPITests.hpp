@@ -0,0 +1,946 @@
+/**
+ * @file
+ * @brief     Unit tests for the CTesterFrameworkAPI project
+ *
+ * @version   F4.x.x
+ * @date      2026
+ *
+ * @copyright END-USER LICENSE AGREEMENT FOR ASIRIKUY SOFTWARE
+ */
+
+#include <vector>
+#include <set>
+#include <string>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include "ratesWindow.h"
+#include "historics.h"
+#include "tradeStatistics.h"
+#include "orderBook.h"
+#include "workerInstances.h"
+#include "InstanceStates.h"
+#include "fitnessCache.h"
+#include "forkPool.h"
+#include "walkForward.h"
+#include "ContiguousRatesCircBuf.h"
+#include "CriticalSection.h"
+
+namespace
+{
+  std::vector<ASTRates> makeHistory(int numCandles)
+  {
+    std::vector<ASTRates> history(numCandles);
+
+    for(int k = 0; k < numCandles; k++)
+    {
+      history[k].open      = 1.1 + 0.001 * (k % 17);
+      history[k].high      = history[k].open + 0.002;
+      history[k].low       = history[k].open - 0.003;
+      history[k].close     = history[k].open + 0.0005 * (k % 3);
+      history[k].volume    = 10 + k;
+      history[k].swapLong  = -0.1;
+      history[k].swapShort = 0.05;
+      history[k].time      = 1000000 + 300 * k;
+    }
+
+    return history;
+  }
+
+  /* The window fill runPortfolioTest used before rates windows became views. */
+  bool copyRatesWindow(CRates* pDest, const ASTRates* pSource, int barIndex, int windowSize)
+  {
+    bool abortTest = false;
+
+    for(int j = 0; j < windowSize; j++)
+    {
+      int sourceIndex = barIndex - windowSize + j + 1;
+      if(j == (windowSize - 1))
+      {
+        pDest[j].high   = pSource[sourceIndex].open;
+        pDest[j].low    = pSource[sourceIndex].open;
+        pDest[j].close  = pSource[sourceIndex].open;
+        pDest[j].volume = 0;
+      }
+      else
+      {
+        pDest[j].high   = pSource[sourceIndex].high;
+        pDest[j].low    = pSource[sourceIndex].low;
+        pDest[j].close  = pSource[sourceIndex].close;
+        pDest[j].volume = pSource[sourceIndex].volume;
+      }
+      pDest[j].time = pSource[sourceIndex].time;
+      pDest[j].open = pSource[sourceIndex].open;
+
+      if(pSource[sourceIndex].time == -1) abortTest = true;
+    }
+
+    return abortTest;
+  }
+
+  bool sameBar(const CRates& a, const CRates& b)
+  {
+    return a.open == b.open && a.high == b.high && a.low == b.low && a.close == b.close && a.volume == b.volume && a.time == b.time;
+  }
+
+  void checkClose(double streamed, double reference, double tolerance, const char* name)
+  {
+    if(isnan(reference))
+    {
+      BOOST_CHECK_MESSAGE(isnan(streamed), name);
+      return;
+    }
+    BOOST_CHECK_MESSAGE(streamed == reference || fabs(streamed - reference) <= tolerance * fmax(1.0, fabs(reference)), name << ": " << streamed << " vs " << reference);
+  }
+
+  /* Streams a pseudo random trade list and compares against the full recomputation */
+  void compareTradeStatistics(int numTrades, int isCompoundingDisabled, int maxGap, unsigned int seed)
+  {
+    const double initialBalance = 10000;
+    TradeStatistics streamed;
+    TestResult streamedResult = {0}, referenceResult = {0};
+    double balance = initialBalance;
+    int time = 1262304000, lastDate;
+
+    BOOST_REQUIRE(initTradeStatistics(&streamed, initialBalance, isCompoundingDisabled, 4));
+    for(int k = 0; k < numTrades; k++)
+    {
+      seed = seed * 1103515245 + 12345;
+      double profit = ((int)((seed >> 8) % 2001) - 950) * 0.5;
+      balance += profit;
+      time += 300 + (seed >> 4) % maxGap;
+      BOOST_REQUIRE(addTradeStatistic(&streamed, profit, balance, time));
+    }
+    lastDate = time + 86400 * 17;
+
+    streamedResult.cagr = referenceResult.cagr = 12.5;
+    streamedResult.avgTradeDuration = referenceResult.avgTradeDuration = 3600.0 * numTrades;
+
+    std::vector<StatisticItem> items(streamed.items, streamed.items + streamed.count);
+    calculate_trade_by_trade_statistics(&items[0], numTrades, initialBalance, isCompoundingDisabled, numTrades, &referenceResult);
+    calculate_weekly_statistics(&items[0], numTrades, initialBalance, isCompoundingDisabled, lastDate, &referenceResult);
+    finishTradeStatistics(&streamed, numTrades, lastDate, &streamedResult);
+
+    BOOST_CHECK_EQUAL(streamedResult.maxDDDepth, referenceResult.maxDDDepth);
+    BOOST_CHECK_EQUAL(streamedResult.maxDDLength, referenceResult.maxDDLength);
+    BOOST_CHECK_EQUAL(streamedResult.pf, referenceResult.pf);
+    BOOST_CHECK_EQUAL(streamedResult.winning, referenceResult.winning);
+    BOOST_CHECK_EQUAL(streamedResult.risk_reward, referenceResult.risk_reward);
+    BOOST_CHECK_EQUAL(streamedResult.avgTradeDuration, referenceResult.avgTradeDuration);
+    checkClose(streamedResult.r2, referenceResult.r2, 1e-9, "r2");
+    checkClose(streamedResult.sharpe, referenceResult.sharpe, 1e-9, "sharpe");
+    checkClose(streamedResult.ulcerIndex, referenceResult.ulcerIndex, 1e-9, "ulcerIndex");
+    checkClose(streamedResult.martin, referenceResult.martin, 1e-9, "martin");
+
+    freeTradeStatistics(&streamed);
+  }
+
+  void writeTextFile(const char* path, const std::string& content)
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << content;
+  }
+
+  std::vector<TestResult> forkedResults;
+  std::vector<double> forkedSettings;
+
+  void collectForkedResult(TestResult testResult, double* settings, int numSettings)
+  {
+    forkedResults.push_back(testResult);
+    forkedSettings.insert(forkedSettings.end(), settings, settings + 2 * numSettings);
+  }
+
+  /* One optimizer run in miniature: the worker's instance gets a rates buffer from the
+     framework, feeds it bars and averages the window. Returns -1 on failure. */
+  double runWorkerCombo(int combo, int worker)
+  {
+    const int windowSize = 40;
+    const int numBars = 300;
+    RatesInfo ratesInfo[MAX_RATES_BUFFERS];
+    RatesBuffers* pBuffers = NULL;
+    int instanceId = getWorkerInstanceId(7, worker);
+    double checksum = 0;
+
+    memset(ratesInfo, 0, sizeof(ratesInfo));
+    ratesInfo[0].isEnabled = TRUE;
+    ratesInfo[0].timeframe = 60;
+    ratesInfo[0].arraySize = windowSize;
+    ratesInfo[0].point     = 0.00001;
+    ratesInfo[0].digits    = 5;
+
+    if(allocateRates(&pBuffers, instanceId, ratesInfo) != SUCCESS || pBuffers->instanceId != instanceId)
+    {
+      return -1;
+    }
+
+    for(int bar = 0; bar < numBars; bar++)
+    {
+      Rates* pRates = &pBuffers->rates[0];
+      double sum = 0;
+
+      if(incrementRatesOffset(instanceId, 0) != SUCCESS)
+      {
+        return -1;
+      }
+      pRates->close[windowSize - 1] = 1.0 + 0.001 * ((combo * 31 + bar * 7) % 97);
+
+      for(int k = 0; k < windowSize; k++)
+      {
+        sum += pRates->close[k];
+      }
+      checksum += sum / windowSize;
+    }
+
+    releaseWorkerInstance(instanceId);
+    return checksum;
+  }
+  /* Stub strategy of the walk-forward tests. In-sample runs of setting value v earn
+     stubProfits[window][symbol][v-1] (0 = not run on that symbol), an out-of-sample test
+     earns 1000 * v. */
+  const double stubProfits[2][2][3] = {
+    {{100, 500, 50}, {100, 0, 50}},  /* Set 2 is best on the first symbol only */
+    {{10, 20, 300}, {10, 20, 300}}
+  };
+
+  struct StubWalkForward
+  {
+    int stopAtWindow;                           /* Window a stop arrives at as its optimization starts, -1 none */
+    int numOptimizations;
+    std::vector<double> testedValues;           /* Setting value and starting balance of each out-of-sample test */
+    std::vector<double> testedBalances;
+    std::vector<WalkForwardWindow> windows;
+    std::vector<double> windowValues;
+  } stubWalkForward;
+
+  int __stdcall stubInSampleOptimizer(OptimizationParam *optimizationParams, int numOptimizedParams, OptimizationType optimizationType,
+    GeneticOptimizationSettings optimizationSettings, int numThreads, double* pInSettings, char** pInTradeSymbol, char* pInAccountCurrency,
+    char* pInBrokerName, char* pInRefBrokerName, double* pInAccountInfo, TestSettings* testSettings, CRatesInfo** pRatesInfo, int numCandles,
+    int numSymbols, ASTRates*** pRates, double minLotSize, void (*optimizationUpdate)(TestResult testResult, double* settings, int numSettings),
+    void (*optimizationFinished)(), char **error)
+  {
+    int window = stubWalkForward.numOptimizations++;
+
+    if(window == stubWalkForward.stopAtWindow) stopOptimization();
+    startOptimizationStop();
+    if(isOptimizationStopped()) return true;
+
+    for(int v = 1; v <= 3; v++)
+    {
+      for(int n = 0; n < numSymbols; n++)
+      {
+        double profit = stubProfits[window][n][v - 1];
+        double set[2] = {(double)optimizationParams[0].index, (double)v};
+        TestResult result;
+
+        if(profit == 0) continue;
+
+        memset(&result, 0, sizeof(TestResult));
+        strcpy(result.symbol, pInTradeSymbol[n]);
+        result.finalBalance = pInAccountInfo[IDX_BALANCE] + profit;
+        result.totalTrades  = 10;
+        result.numLongs     = 5;
+        result.numShorts    = 5;
+        result.yearsTraded  = 1;
+        optimizationUpdate(result, set, numOptimizedParams);
+      }
+    }
+
+    return true;
+  }
+
+  TestResult __stdcall stubOutOfSampleTester(int testId, double** pInSettings, char** pInTradeSymbol, char* pInAccountCurrency,
+    char* pInBrokerName, char* pInRefBrokerName, double** pInAccountInfo, TestSettings *testSettings, CRatesInfo** pRatesInfo, int numCandles,
+    int numSystems, ASTRates*** pRates, double minLotSize,
+    void (*testUpdate)(int testId, double percentageOfTestCompleted, COrderInfo lastOrder, double currentBalance, char* symbol),
+    void (*testFinished)(TestResult testResults), void (*signalUpdate)(TradeSignal signal))
+  {
+    double value = pInSettings[0][0];
+    TestResult result;
+
+    for(int n = 1; n < numSystems; n++)
+    {
+      BOOST_CHECK_EQUAL(pInSettings[n][0], value);
+      BOOST_CHECK_EQUAL(pInAccountInfo[n][IDX_BALANCE], pInAccountInfo[0][IDX_BALANCE]);
+    }
+
+    stubWalkForward.testedValues.push_back(value);
+    stubWalkForward.testedBalances.push_back(pInAccountInfo[0][IDX_BALANCE]);
+
+    memset(&result, 0, sizeof(TestResult));
+    result.testId       = testId;
+    result.finalBalance = pInAccountInfo[0][IDX_BALANCE] + 1000 * value;
+    return result;
+  }
+
+  void recordWalkForwardWindow(WalkForwardWindow window, double* settings, int numSettings)
+  {
+    stubWalkForward.windows.push_back(window);
+    stubWalkForward.windowValues.push_back(numSettings > 0 ? settings[1] : 0);
+  }
+
+  /* Two symbols with 20 days of daily bars, giving two windows of 10 in-sample and 5 out-of-sample days */
+  bool runStubWalkForward(int stopAtWindow)
+  {
+    const int fromDate = 1262304000;
+    const int numCandles = 21;
+    std::vector<ASTRates> history = makeHistory(numCandles);
+    ASTRates* timeframes[2][10] = {{0}};
+    ASTRates** rates[2] = {timeframes[0], timeframes[1]};
+    CRatesInfo ratesInfo[2][10];
+    CRatesInfo* pRatesInfo[2] = {ratesInfo[0], ratesInfo[1]};
+    TestSettings testSettings[2];
+    double settings[64] = {0}, accountInfo[64] = {0};
+    char symbolA[] = "EURUSD", symbolB[] = "GBPUSD", currency[] = "USD", broker[] = "Stub";
+    char* symbols[2] = {symbolA, symbolB};
+    OptimizationParam param;
+    GeneticOptimizationSettings optimizationSettings;
+    WalkForwardSettings walkForwardSettings = {10, 5, 0};
+    char* error = NULL;
+
+    for(int k = 0; k < numCandles; k++)
+    {
+      history[k].time = fromDate + k * SECONDS_PER_DAY;
+    }
+    timeframes[0][0] = history.data();
+    timeframes[1][0] = history.data();
+    memset(ratesInfo, 0, sizeof(ratesInfo));
+    memset(testSettings, 0, sizeof(testSettings));
+    memset(&param, 0, sizeof(param));
+    memset(&optimizationSettings, 0, sizeof(optimizationSettings));
+    optimizationSettings.optimizationGoal = OPTI_GOAL_PROFIT;
+    accountInfo[IDX_BALANCE] = 10000;
+    accountInfo[IDX_EQUITY]  = 10000;
+
+    stubWalkForward = StubWalkForward();
+    stubWalkForward.stopAtWindow = stopAtWindow;
+
+    setWalkForwardRunners(stubInSampleOptimizer, stubOutOfSampleTester);
+    bool isSuccess = runWalkForwardOptimization(&param, 1, OPTI_BRUTE_FORCE, optimizationSettings, 1, settings, symbols, currency, broker, broker,
+                                                accountInfo, testSettings, pRatesInfo, numCandles, 2, rates, 0.01, walkForwardSettings, NULL,
+                                                recordWalkForwardWindow, NULL, &error) != 0;
+    setWalkForwardRunners(NULL, NULL);
+    clearOptimizationStop();
+    free(error);
+    return isSuccess;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(CTester_Framework_API)
+
+BOOST_AUTO_TEST_CASE(ratesWindow_matches_copying_path)
+{
+  const int numCandles    = 600;
+  const int windowSizes[] = {1, 2, 37, 250};
+  std::vector<ASTRates> history = makeHistory(numCandles);
+
+  history[400].time = -1;
+
+  for(size_t w = 0; w < sizeof(windowSizes) / sizeof(windowSizes[0]); w++)
+  {
+    const int windowSize = windowSizes[w];
+    std::vector<CRates> copied(windowSize);
+    RatesWindow window;
+
+    BOOST_REQUIRE(initRatesWindow(&window, &history[0], numCandles, windowSize));
+
+    for(int bar = windowSize - 1; bar < numCandles; bar++)
+    {
+      int hasInvalidTime;
+      CRates* pView = moveRatesWindow(&window, bar, &hasInvalidTime);
+      bool copyAborted = copyRatesWindow(&copied[0], &history[0], bar, windowSize);
+
+      BOOST_REQUIRE_EQUAL((bool)hasInvalidTime, copyAborted);
+      for(int j = 0; j < windowSize; j++)
+      {
+        BOOST_REQUIRE_MESSAGE(sameBar(pView[j], copied[j]), "window " << windowSize << ", bar " << bar << ", index " << j);
+      }
+
+      /* Tick updates on the forming bar must not leak into later windows */
+      pView[windowSize - 1].high   += 1;
+      pView[windowSize - 1].close  += 1;
+      pView[windowSize - 1].volume += 5;
+    }
+
+    freeRatesWindow(&window);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ratesWindow_follows_jumps_and_leaves_the_history_untouched)
+{
+  const int numCandles = 300;
+  const int windowSize = 40;
+  const int bars[]     = {39, 40, 41, 120, 119, 60, 61, 299, 39, 250, 251, 252, 280, 290, 20, 100};
+  std::vector<ASTRates> history = makeHistory(numCandles);
+  std::vector<ASTRates> original;
+  std::vector<CRates> copied(windowSize);
+  RatesWindow window;
+
+  history[100].time = -1;
+  original = history;
+
+  BOOST_REQUIRE(initRatesWindow(&window, &history[0], numCandles, windowSize));
+
+  for(size_t b = 0; b < sizeof(bars) / sizeof(bars[0]); b++)
+  {
+    int hasInvalidTime;
+    CRates* pView = moveRatesWindow(&window, bars[b], &hasInvalidTime);
+
+    if(bars[b] < windowSize - 1)
+    {
+      BOOST_CHECK(hasInvalidTime);
+      continue;
+    }
+
+    bool copyAborted = copyRatesWindow(&copied[0], &history[0], bars[b], windowSize);
+
+    BOOST_REQUIRE_EQUAL((bool)hasInvalidTime, copyAborted);
+    for(int j = 0; j < windowSize; j++)
+    {
+      BOOST_REQUIRE_MESSAGE(sameBar(pView[j], copied[j]), "bar " << bars[b] << ", index " << j);
+    }
+    pView[windowSize - 1].close += 1;
+  }
+
+  freeRatesWindow(&window);
+  BOOST_CHECK(std::memcmp(&history[0], &original[0], numCandles * sizeof(ASTRates)) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(ratesWindow_unused_timeframe)
+{
+  RatesWindow window;
+  int hasInvalidTime = true;
+
+  BOOST_REQUIRE(initRatesWindow(&window, NULL, 100, 0));
+  BOOST_CHECK(moveRatesWindow(&window, 50, &hasInvalidTime) == &window.emptyBar);
+  BOOST_CHECK(!hasInvalidTime);
+  freeRatesWindow(&window);
+}
+
+BOOST_AUTO_TEST_CASE(historics_binary_matches_csv)
+{
+  const char* csvPath = "CTesterHistoryTest.csv";
+  const char* binPath = "CTesterHistoryTest.bin";
+  std::ostringstream csv;
+  ASTRates* fromCsv = NULL;
+  ASTRates* fromBinary = NULL;
+  int numCsv, numBinary;
+  HistorySeries series;
+
+  std::remove(binPath);
+  for(int k = 0; k < 1000; k++)
+  {
+    csv << "01/02/13 " << (k / 12) % 24 / 10 << (k / 12) % 24 % 10 << ":" << (k % 12) * 5 / 10 << (k % 12) * 5 % 10
+        << "," << 1.31 + k * 0.0001 << "," << 1.3125 + k * 0.0001 << "," << 1.3075 + k * 0.0001 << "," << 1.311 + k * 0.0001 << "," << k % 7;
+    if(k % 10 != 0) csv << ",-0.37,0.12";
+    csv << (k % 2 ? "\r\n" : "\n");
+  }
+  writeTextFile(csvPath, csv.str());
+
+  BOOST_REQUIRE(loadHistoricRates((char*)csvPath, &fromCsv, &numCsv));
+  BOOST_REQUIRE_EQUAL(numCsv, 1000);
+  BOOST_CHECK_EQUAL(fromCsv[1].time, 1359677100);
+  BOOST_CHECK_EQUAL(fromCsv[1].swapLong, -0.37);
+  BOOST_CHECK_EQUAL(fromCsv[0].swapShort, 0);
+
+  BOOST_REQUIRE_EQUAL(convertHistoryFile((char*)csvPath, (char*)binPath, HISTORY_RATES), 1000);
+  BOOST_REQUIRE(loadHistoricRates((char*)binPath, &fromBinary, &numBinary));
+  BOOST_REQUIRE_EQUAL(numBinary, numCsv);
+  BOOST_CHECK(memcmp(fromCsv, fromBinary, numCsv * sizeof(ASTRates)) == 0);
+
+  /* The binary sibling is preferred once it exists */
+  BOOST_REQUIRE(openHistorySeries(csvPath, HISTORY_RATES, &series));
+  BOOST_CHECK(series.mapping != NULL);
+  BOOST_CHECK(mapHistoryFile(binPath, HISTORY_QUOTES, &series) == false);
+  closeHistorySeries(&series);
+
+  freeHistoricRates(fromCsv);
+  freeHistoricRates(fromBinary);
+  std::remove(csvPath);
+  std::remove(binPath);
+}
+
+BOOST_AUTO_TEST_CASE(historics_tick_and_quote_series)
+{
+  const char* tickPath  = "CTesterHistoryTest_TICK.csv";
+  const char* quotePath = "CTesterHistoryTest_QUOTES.csv";
+  HistorySeries series;
+  int row;
+
+  writeTextFile(tickPath, "01-02-2013-00-05-30,1.3101,1.3103\n01-02-2013-00-05-31,1.3102,1.3104\n");
+  writeTextFile(quotePath, "01/02/13 00:05,101.25\n01/02/13 00:10,101.5\n01/02/13 00:15,101.75\n");
+
+  BOOST_REQUIRE(openHistorySeries(tickPath, HISTORY_TICKS, &series));
+  BOOST_REQUIRE_EQUAL(series.numBars, 2);
+  row = nextHistoryRow(&series);
+  BOOST_CHECK_EQUAL(series.time[row], 1359677130);
+  BOOST_CHECK_EQUAL(series.column[0][row], 1.3101);
+  BOOST_CHECK_EQUAL(series.column[1][row], 1.3103);
+  BOOST_CHECK_EQUAL(nextHistoryRow(&series), 1);
+  BOOST_CHECK_EQUAL(nextHistoryRow(&series), -1);
+  closeHistorySeries(&series);
+
+  BOOST_REQUIRE(openHistorySeries(quotePath, HISTORY_QUOTES, &series));
+  BOOST_REQUIRE_EQUAL(series.numBars, 3);
+  BOOST_CHECK_EQUAL(series.time[2], 1359677700);
+  BOOST_CHECK_EQUAL(series.column[0][2], 101.75);
+  closeHistorySeries(&series);
+
+  std::remove(tickPath);
+  std::remove(quotePath);
+}
+
+BOOST_AUTO_TEST_CASE(historics_conversion_rates_aligned_to_bars)
+{
+  const char* quotePath = "CTesterHistoryTest_QUOTES.csv";
+  std::vector<ASTRates> bars = makeHistory(6);
+  std::vector<double> aligned(6, 0);
+  HistorySeries series;
+
+  /* Quotes are offset from the bars, skip one bar, have an extra row and end before the last bar */
+  writeTextFile(quotePath, "01/01/70 00:00,0.5\n12/01/70 13:46,1.0\n12/01/70 13:51,1.1\n12/01/70 14:01,1.3\n"
+                           "12/01/70 14:03,1.35\n12/01/70 14:06,1.4\n12/01/70 14:11,1.5\n");
+  BOOST_REQUIRE(openHistorySeries(quotePath, HISTORY_QUOTES, &series));
+  BOOST_REQUIRE_EQUAL(series.time[1], 1000000 - 40);
+
+  BOOST_REQUIRE(alignHistorySeries(&series, 0, &bars[0], 6, &aligned[0]));
+  BOOST_CHECK_EQUAL(aligned[0], 1.1);
+  BOOST_CHECK_EQUAL(aligned[1], 1.3);
+  BOOST_CHECK_EQUAL(aligned[2], 1.3);
+  BOOST_CHECK_EQUAL(aligned[3], 1.35);
+  BOOST_CHECK_EQUAL(aligned[4], 1.5);
+  BOOST_CHECK_EQUAL(aligned[5], 1.5);
+
+  BOOST_CHECK(alignHistorySeries(&series, 1, &bars[0], 6, &aligned[0]) == false);
+  closeHistorySeries(&series);
+  std::remove(quotePath);
+}
+
+BOOST_AUTO_TEST_CASE(tradeStatistics_match_full_recomputation)
+{
+  const int tradeCounts[] = {1, 2, 7, 250, 20000};
+
+  for(size_t t = 0; t < sizeof(tradeCounts) / sizeof(tradeCounts[0]); t++)
+  {
+    /* Intraday systems and systems with gaps of several weeks between trades */
+    compareTradeStatistics(tradeCounts[t], TRUE, 3600, 17 + t);
+    compareTradeStatistics(tradeCounts[t], FALSE, 3600, 29 + t);
+    compareTradeStatistics(tradeCounts[t], TRUE, 604800 * 5, 41 + t);
+    compareTradeStatistics(tradeCounts[t], FALSE, 604800 * 5, 53 + t);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(tradeStatistics_abort_limits_only_trip_past_the_final_result)
+{
+  const int day = 86400;
+  TradeStatistics statistics;
+  TestSettings settings;
+  TestResult result;
+
+  memset(&settings, 0, sizeof(settings));
+  BOOST_REQUIRE(initTradeStatistics(&statistics, 10000, FALSE, 4));
+
+  /* Up 10%, then down to 8800 over 30 days: a 20% drawdown */
+  addTradeStatistic(&statistics, 1000, 11000, 0);
+  addTradeStatistic(&statistics, -1200, 9800, 10 * day);
+  addTradeStatistic(&statistics, -1000, 8800, 30 * day);
+
+  /* Everything off */
+  BOOST_CHECK(!exceedsAbortLimits(&statistics, &settings, 8800));
+
+  settings.abortMaxDD = 25;
+  BOOST_CHECK(!exceedsAbortLimits(&statistics, &settings, 8800));
+  settings.abortMaxDD = 19;
+  BOOST_CHECK(exceedsAbortLimits(&statistics, &settings, 8800));
+  settings.abortMaxDD = 0;
+
+  settings.abortMaxDDLength = 31;
+  BOOST_CHECK(!exceedsAbortLimits(&statistics, &settings, 8800));
+  settings.abortMaxDDLength = 29;
+  BOOST_CHECK(exceedsAbortLimits(&statistics, &settings, 8800));
+  settings.abortMaxDDLength = 0;
+
+  settings.abortEquityFloor = 0.85;
+  BOOST_CHECK(!exceedsAbortLimits(&statistics, &settings, 8800));
+  settings.abortEquityFloor = 0.9;
+  BOOST_CHECK(exceedsAbortLimits(&statistics, &settings, 8800));
+  settings.abortEquityFloor = 0;
+
+  /* Recovering does not undo the drawdown the run already had */
+  settings.abortMaxDD = 19;
+  addTradeStatistic(&statistics, 4000, 12800, 40 * day);
+  BOOST_CHECK(exceedsAbortLimits(&statistics, &settings, 12800));
+
+  memset(&result, 0, sizeof(result));
+  finishTradeStatistics(&statistics, 4, 50 * day, &result);
+  BOOST_CHECK(result.maxDDDepth > settings.abortMaxDD);
+
+  freeTradeStatistics(&statistics);
+}
+
+BOOST_AUTO_TEST_CASE(orderBook_grows_past_old_limit_and_keeps_newest_closed_orders)
+{
+  const int historySize = 5;
+  const int numOrders = 450;
+  OrderBook book;
+  COrderInfo* pOrder;
+
+  BOOST_REQUIRE(initOrderBook(&book, historySize));
+
+  for(int k = 0; k < numOrders; k++)
+  {
+    pOrder = addOrder(&book, k % 3 == 0 ? SELL : (k % 3 == 1 ? BUY : BUYLIMIT));
+    BOOST_REQUIRE(pOrder != NULL);
+    pOrder->ticket = k + 1;
+    pOrder->isOpen = true;
+  }
+
+  BOOST_CHECK_EQUAL(book.numOpen, numOrders);
+  BOOST_CHECK_EQUAL(book.openOrdersCount[SELL], numOrders / 3);
+  BOOST_CHECK_EQUAL(book.openOrdersCount[BUY], numOrders - numOrders / 3);
+  BOOST_CHECK(book.capacity > numOrders);
+
+  /* Close every other order, the open ones stay in opening order */
+  for(int k = 0; k < numOrders / 2; k++)
+  {
+    book.orders[k].isOpen = false;
+    retireOrder(&book, k);
+  }
+
+  BOOST_CHECK_EQUAL(book.numOpen, numOrders / 2);
+  BOOST_CHECK_EQUAL(book.numClosed, historySize);
+  BOOST_CHECK_EQUAL(book.openOrdersCount[BUY] + book.openOrdersCount[SELL], book.numOpen);
+
+  for(int k = 0; k < book.numOpen; k++)
+  {
+    BOOST_CHECK_EQUAL(book.orders[k].ticket, 2 * k + 2);
+    BOOST_CHECK_EQUAL(book.orders[k].isOpen, true);
+  }
+
+  /* Newest closed order first, then nothing */
+  for(int k = 0; k < historySize; k++)
+  {
+    BOOST_CHECK_EQUAL(book.orders[book.numOpen + k].ticket, numOrders - 1 - 2 * k);
+    BOOST_CHECK_EQUAL(book.orders[book.numOpen + k].isOpen, false);
+  }
+  BOOST_CHECK_EQUAL(book.orders[book.numOpen + historySize].ticket, 0);
+
+  /* A new order goes between the open and the closed ones */
+  pOrder = addOrder(&book, SELLSTOP);
+  BOOST_REQUIRE(pOrder != NULL);
+  BOOST_CHECK_EQUAL(pOrder, &book.orders[book.numOpen - 1]);
+  BOOST_CHECK_EQUAL(pOrder->type, SELLSTOP);
+  BOOST_CHECK_EQUAL(book.orders[book.numOpen].ticket, numOrders - 1);
+
+  freeOrderBook(&book);
+  BOOST_CHECK(book.orders == NULL);
+}
+
+BOOST_AUTO_TEST_CASE(workerInstances_ids_are_private_to_each_worker)
+{
+  /* IDs the repo's set files use, some of them differ only above the fifth digit */
+  const int configIds[] = {1, 7, 51, 123456, 223456, 23456, 842001, 12345699};
+  std::set<int> ids;
+
+  for(int worker = 0; worker < 64; worker++)
+  {
+    for(size_t c = 0; c < sizeof(configIds) / sizeof(configIds[0]); c++)
+    {
+      int instanceId = getWorkerInstanceId(configIds[c], worker);
+
+      BOOST_CHECK(instanceId >= WORKER_INSTANCE_ID_BASE);
+      BOOST_CHECK_EQUAL(getConfigInstanceId(instanceId), configIds[c]);
+      BOOST_CHECK(ids.insert(instanceId).second);
+    }
+  }
+
+  /* Backtest and live instance IDs are their own config ID */
+  BOOST_CHECK_EQUAL(getConfigInstanceId(7), 7);
+  BOOST_CHECK_EQUAL(getConfigInstanceId(223456), 223456);
+  BOOST_CHECK_EQUAL(getConfigInstanceId(12345699), 12345699);
+}
+
+BOOST_AUTO_TEST_CASE(workerInstances_release_clears_the_instance_state)
+{
+  int instanceId = getWorkerInstanceId(223456, 3);
+
+  BOOST_REQUIRE(getInstanceState(instanceId) != NULL);
+  getInstanceState(instanceId)->lastRunTime = 1262304000;
+  getInstanceState(instanceId)->lastOrderUpdateTime = 1262304000;
+
+  releaseWorkerInstance(instanceId);
+
+  /* The next combination on this worker starts from a fresh state */
+  BOOST_CHECK(!hasInstanceRunOnCurrentBar(instanceId, 1262304000, TRUE));
+  BOOST_CHECK(getLastOrderUpdateTime(instanceId) != 1262304000);
+}
+
+BOOST_AUTO_TEST_CASE(workerInstances_single_and_multi_threaded_runs_match)
+{
+  /* More combos than framework instances: every run has to release its slot */
+  const int numCombos = 2 * MAX_INSTANCES;
+  const int numWorkers = 4;
+  std::vector<double> single(numCombos), multi(numCombos);
+  std::vector<std::thread> workers;
+
+  /* As initFramework() does */
+  initCriticalSection();
+  resetAllRatesBuffers();
+
+  for(int c = 0; c < numCombos; c++)
+  {
+    single[c] = runWorkerCombo(c, c);
+  }
+
+  for(int w = 0; w < numWorkers; w++)
+  {
+    workers.push_back(std::thread([&multi, w, numCombos, numWorkers]()
+    {
+      for(int c = w; c < numCombos; c += numWorkers)
+      {
+        multi[c] = runWorkerCombo(c, w);
+      }
+    }));
+  }
+  for(int w = 0; w < numWorkers; w++)
+  {
+    workers[w].join();
+  }
+
+  for(int c = 0; c < numCombos; c++)
+  {
+    BOOST_CHECK(single[c] > 0);
+    BOOST_CHECK_EQUAL(single[c], multi[c]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(fitnessCache_returns_stored_fitness_per_set_and_goal)
+{
+  const int numParams = 3;
+  const int numSets = 1000;
+  FitnessCache cache;
+  double params[numParams], fitness;
+
+  /* Small initial capacity so the table has to grow several times */
+  BOOST_REQUIRE(initFitnessCache(&cache, numParams, 4));
+
+  for(int k = 0; k < numSets; k++)
+  {
+    params[0] = 10 + k % 10;
+    params[1] = 0.5 * (k / 10);
+    params[2] = -2.0;
+    BOOST_CHECK(!lookupFitness(&cache, params, 0, &fitness));
+    BOOST_REQUIRE(storeFitness(&cache, params, 0, 3.5 * k));
+  }
+  BOOST_CHECK_EQUAL(cache.count, numSets);
+  BOOST_CHECK(cache.capacity >= 2 * numSets);
+
+  for(int k = numSets - 1; k >= 0; k--)
+  {
+    params[0] = 10 + k % 10;
+    params[1] = 0.5 * (k / 10);
+    params[2] = -2.0;
+    BOOST_REQUIRE(lookupFitness(&cache, params, 0, &fitness));
+    BOOST_CHECK_EQUAL(fitness, 3.5 * k);
+
+    /* The same set under another goal is another test */
+    BOOST_CHECK(!lookupFitness(&cache, params, 1, &fitness));
+  }
+
+  BOOST_CHECK_EQUAL(cache.hits, numSets);
+  BOOST_CHECK_EQUAL(cache.misses, 2 * numSets);
+
+  /* -0.0 and 0.0 decode to the same parameter value */
+  params[0] = 0.0;
+  params[1] = 1.0;
+  params[2] = 2.0;
+  BOOST_REQUIRE(storeFitness(&cache, params, 2, 7.0));
+  params[0] = -0.0;
+  BOOST_REQUIRE(lookupFitness(&cache, params, 2, &fitness));
+  BOOST_CHECK_EQUAL(fitness, 7.0);
+
+  freeFitnessCache(&cache);
+  BOOST_CHECK(cache.keys == NULL);
+}
+
+BOOST_AUTO_TEST_CASE(optimizer_decodes_combinations_in_the_materialized_order)
+{
+  const int numParams = 3;
+  OptimizationParam params[numParams] = {{4, 10, 2, 14}, {7, 0.1, 0.1, 0.5}, {2, -3, 1.5, 3}};
+  std::vector<double> sets;
+  std::vector<double> combination(numParams);
+  int finishCtr = 0, n = 0;
+
+  /* The parameter space as the brute force optimizer used to build it up front */
+  while(finishCtr < numParams)
+  {
+    finishCtr = 0;
+    int j = n;
+    for(int i = 0; i < numParams; i++)
+    {
+      int maxSteps = (int)((params[i].stop - params[i].start) / params[i].step) + 1;
+      int steps = j % maxSteps;
+      j = j / maxSteps;
+      if(j > 0 && steps == 0) finishCtr++;
+      combination[i] = params[i].start + steps * params[i].step;
+    }
+    if(finishCtr < numParams)
+    {
+      sets.insert(sets.end(), combination.begin(), combination.end());
+    }
+    n++;
+  }
+
+  BOOST_REQUIRE_EQUAL(sets.size(), (size_t)(3 * 5 * 5 * numParams));
+
+  for(size_t c = 0; c < sets.size() / numParams; c++)
+  {
+    for(int p = 0; p < numParams; p++)
+    {
+      BOOST_CHECK_EQUAL(getParameterSetValue((int)c, p, params), sets[c * numParams + p]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(walkForward_windows_tile_the_test_period)
+{
+  const int day = SECONDS_PER_DAY;
+  const int fromDate = 1262304000;
+  WalkForwardSettings settings = {30, 10, 0};
+  WalkForwardWindow windows[16];
+
+  /* Out-of-sample periods follow each other up to the end of the period */
+  int numWindows = getWalkForwardWindows(settings, fromDate, fromDate + 100 * day, windows, 16);
+  BOOST_REQUIRE_EQUAL(numWindows, 7);
+  BOOST_CHECK_EQUAL(getWalkForwardWindows(settings, fromDate, fromDate + 100 * day, NULL, 0), 7);
+  for(int w = 0; w < numWindows; w++)
+  {
+    BOOST_CHECK_EQUAL(windows[w].index, w);
+    BOOST_CHECK_EQUAL(windows[w].inSampleFrom, fromDate + w * 10 * day);
+    BOOST_CHECK_EQUAL(windows[w].inSampleTo - windows[w].inSampleFrom, 30 * day);
+    BOOST_CHECK_EQUAL(windows[w].outOfSampleFrom, windows[w].inSampleTo);
+    BOOST_CHECK_EQUAL(windows[w].outOfSampleTo - windows[w].outOfSampleFrom, 10 * day);
+    if(w > 0) BOOST_CHECK_EQUAL(windows[w].outOfSampleFrom, windows[w - 1].outOfSampleTo);
+  }
+  BOOST_CHECK_EQUAL(windows[numWindows - 1].outOfSampleTo, fromDate + 100 * day);
+
+  /* The last out-of-sample period is cut at the end of the period */
+  BOOST_REQUIRE_EQUAL(getWalkForwardWindows(settings, fromDate, fromDate + 95 * day, windows, 16), 7);
+  BOOST_CHECK_EQUAL(windows[6].outOfSampleTo, fromDate + 95 * day);
+
+  /* Steps under the out-of-sample length cut every period at the next one */
+  settings.stepDays = 5;
+  numWindows = getWalkForwardWindows(settings, fromDate, fromDate + 100 * day, windows, 16);
+  BOOST_REQUIRE_EQUAL(numWindows, 14);
+  BOOST_CHECK_EQUAL(windows[0].outOfSampleTo, windows[1].outOfSampleFrom);
+
+  /* Longer steps leave gaps */
+  settings.stepDays = 20;
+  numWindows = getWalkForwardWindows(settings, fromDate, fromDate + 100 * day, windows, 16);
+  BOOST_REQUIRE_EQUAL(numWindows, 4);
+  BOOST_CHECK_EQUAL(windows[0].outOfSampleTo - windows[0].outOfSampleFrom, 10 * day);
+  BOOST_CHECK_EQUAL(windows[1].outOfSampleFrom - windows[0].outOfSampleTo, 10 * day);
+
+  /* Only maxWindows are filled */
+  BOOST_CHECK_EQUAL(getWalkForwardWindows(settings, fromDate, fromDate + 100 * day, windows, 2), 2);
+
+  /* Periods too short for a window and invalid lengths */
+  settings.stepDays = 0;
+  BOOST_CHECK_EQUAL(getWalkForwardWindows(settings, fromDate, fromDate + 30 * day, windows, 16), 0);
+  settings.outOfSampleDays = 0;
+  BOOST_CHECK_EQUAL(getWalkForwardWindows(settings, fromDate, fromDate + 100 * day, windows, 16), 0);
+}
+
+BOOST_AUTO_TEST_CASE(walkForward_stitches_the_best_set_of_every_window)
+{
+  BOOST_REQUIRE(runStubWalkForward(-1));
+  BOOST_REQUIRE_EQUAL(stubWalkForward.windows.size(), 2u);
+
+  /* Set 2 ran on one symbol only, set 1 has the best fitness over both */
+  BOOST_CHECK(stubWalkForward.windows[0].hasSet);
+  BOOST_CHECK_EQUAL(stubWalkForward.windowValues[0], 1);
+  BOOST_CHECK_EQUAL(stubWalkForward.windows[0].inSampleFitness, 200);
+  BOOST_CHECK_EQUAL(stubWalkForward.windowValues[1], 3);
+  BOOST_CHECK_EQUAL(stubWalkForward.windows[1].inSampleFitness, 600);
+
+  /* Each out-of-sample test ran the chosen set from the balance the previous one ended with */
+  BOOST_REQUIRE_EQUAL(stubWalkForward.testedValues.size(), 2u);
+  BOOST_CHECK_EQUAL(stubWalkForward.testedValues[0], 1);
+  BOOST_CHECK_EQUAL(stubWalkForward.testedValues[1], 3);
+  BOOST_CHECK_EQUAL(stubWalkForward.testedBalances[0], 10000);
+  BOOST_CHECK_EQUAL(stubWalkForward.windows[0].startBalance, 10000);
+  BOOST_CHECK_EQUAL(stubWalkForward.windows[0].endBalance, 11000);
+  BOOST_CHECK_EQUAL(stubWalkForward.testedBalances[1], 11000);
+  BOOST_CHECK_EQUAL(stubWalkForward.windows[1].startBalance, 11000);
+  BOOST_CHECK_EQUAL(stubWalkForward.windows[1].endBalance, 14000);
+}
+
+BOOST_AUTO_TEST_CASE(walkForward_keeps_a_stop_arriving_as_an_optimization_starts)
+{
+  /* The stop survives the start of the second optimization, whose window does not trade */
+  BOOST_REQUIRE(runStubWalkForward(1));
+  BOOST_CHECK_EQUAL(stubWalkForward.numOptimizations, 2);
+  BOOST_REQUIRE_EQUAL(stubWalkForward.windows.size(), 1u);
+  BOOST_CHECK_EQUAL(stubWalkForward.windows[0].endBalance, 11000);
+  BOOST_CHECK_EQUAL(stubWalkForward.testedValues.size(), 1u);
+
+  /* Outside a walk-forward an optimization clears an earlier stop again */
+  stopOptimization();
+  startOptimizationStop();
+  BOOST_CHECK(!isOptimizationStopped());
+}
+
+#if defined __linux__ || defined __APPLE__
+BOOST_AUTO_TEST_CASE(forkPool_streams_every_worker_result_to_the_parent)
+{
+  const int numWorkers = 3;
+  const int numCombinations = 40;
+  ForkPool pool;
+  int worker = startForkWorkers(&pool, numWorkers);
+
+  BOOST_REQUIRE(worker != FORK_POOL_FAILED);
+
+  if(worker >= 0)
+  {
+    /* Worker: every numWorkers-th combination, as the optimizer strides them */
+    for(int c = worker; c < numCombinations; c += numWorkers)
+    {
+      TestResult testResult;
+      double settings[2] = {51.0, (double)c};
+
+      memset(&testResult, 0, sizeof(testResult));
+      testResult.testId = c;
+      testResult.finalBalance = 1000.0 + c;
+      forkWorkerUpdate(testResult, settings, 1);
+    }
+    finishForkWorker(0);
+  }
+
+  forkedResults.clear();
+  forkedSettings.clear();
+  BOOST_CHECK_EQUAL(collectForkResults(&pool, 1, collectForkedResult, NULL), 0);
+  BOOST_REQUIRE_EQUAL(forkedResults.size(), (size_t)numCombinations);
+
+  std::vector<int> seen(numCombinations, 0);
+  for(size_t k = 0; k < forkedResults.size(); k++)
+  {
+    int c = forkedResults[k].testId;
+    BOOST_REQUIRE(c >= 0 && c < numCombinations);
+    seen[c]++;
+    BOOST_CHECK_EQUAL(forkedResults[k].finalBalance, 1000.0 + c);
+    BOOST_CHECK_EQUAL(forkedSettings[2 * k], 51.0);
+    BOOST_CHECK_EQUAL(forkedSettings[2 * k + 1], (double)c);
+  }
+  for(int c = 0; c < numCombinations; c++)
+  {
+    BOOST_CHECK_EQUAL(seen[c], 1);
+  }
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -89,7 +89,7 @@ void loadInstanceState(int instanceId);
 *   The ID of the instance state to be retrieved.
 *
 * @return InstanceState*
-*   A pointer to the instance state.
+*   A pointer to the instance state. It stays valid for the life of the process.
 */
 InstanceState* getInstanceState(int instanceId);
 
@@ -160,6 +160,15 @@ time_t getLastOrderUpdateTime(int instanceId);
  */
 void resetInstanceState(int instanceId);
 
+/**
+ * Resets the internal state variables of an instance without writing the state file.
+ * Used for instances that only live for one test run.
+ *
+ * @param int instanceId
+ *   The ID of the instance to be cleared.
+ */
+void clearInstanceState(int instanceId);
+
 /**
 * Gets the parameter space buffer for the specified instance
 *
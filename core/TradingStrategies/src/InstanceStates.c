@@ -37,60 +37,178 @@
 
 #include "Precompiled.h"
 #include "InstanceStates.h"
-#include "CriticalSection.h"
 #include <stdio.h>
 #include "EasyTradeCWrapper.hpp"
 #include "AsirikuyLogger.h"
 
+#if defined _WIN32 || defined _WIN64
+  #include <windows.h>
+#else
+  #include <pthread.h>
+#endif
+
 #define INSTANCE_STATES_FILENAME_EXTENSION ".state"
 
-static char          gInstanceStatesFolder[MAX_FILE_PATH_CHARS];
-static InstanceState gInstanceStates[MAX_INSTANCES];
+/* Open addressing table of instance states keyed by instance ID. Must be a power of 2. */
+#define INSTANCE_STATE_SLOTS 4096
 
-static void initializeInstanceState(int instanceIndex)
+/* 
+ * An entry is allocated and published with a single compare and swap the first time an instance ID is seen.
+ * It is never moved or freed, so lookups need no lock and each instance only ever waits on its own entry.
+ */
+typedef struct instanceStateEntry_t
 {
-  gInstanceStates[instanceIndex].instanceId             = -1;
-  gInstanceStates[instanceIndex].lastRunTime            = -1;
-  gInstanceStates[instanceIndex].lastOrderUpdateTime    = -1;
-  gInstanceStates[instanceIndex].totalParameters        = 0;
-  gInstanceStates[instanceIndex].isParameterSpaceLoaded = FALSE;
-  //gInstanceStates[instanceIndex].predictDailyATR = 0.0;
+  int           instanceId; /* The key. Unlike state.instanceId it never changes after the entry is published. */
+#if defined _WIN32 || defined _WIN64
+  CRITICAL_SECTION lock;
+#else
+  pthread_mutex_t  lock;
+#endif
+  InstanceState state;
+} InstanceStateEntry;
+
+#if defined _WIN32 || defined _WIN64
+  #define loadEntry(ppSlot)                 ((InstanceStateEntry*)InterlockedCompareExchangePointer((PVOID volatile*)(ppSlot), NULL, NULL))
+  #define publishEntry(ppSlot, pEntry)      (InterlockedCompareExchangePointer((PVOID volatile*)(ppSlot), (pEntry), NULL) == NULL)
+  #define initEntryLock(pEntry)             InitializeCriticalSection(&(pEntry)->lock)
+  #define deinitEntryLock(pEntry)           DeleteCriticalSection(&(pEntry)->lock)
+  #define lockEntry(pEntry)                 EnterCriticalSection(&(pEntry)->lock)
+  #define unlockEntry(pEntry)               LeaveCriticalSection(&(pEntry)->lock)
+#else
+  #define loadEntry(ppSlot)                 __atomic_load_n((ppSlot), __ATOMIC_ACQUIRE)
+  #define publishEntry(ppSlot, pEntry)      compareAndPublishEntry((ppSlot), (pEntry))
+  #define initEntryLock(pEntry)             pthread_mutex_init(&(pEntry)->lock, NULL)
+  #define deinitEntryLock(pEntry)           pthread_mutex_destroy(&(pEntry)->lock)
+  #define lockEntry(pEntry)                 pthread_mutex_lock(&(pEntry)->lock)
+  #define unlockEntry(pEntry)               pthread_mutex_unlock(&(pEntry)->lock)
+
+static BOOL compareAndPublishEntry(InstanceStateEntry** ppSlot, InstanceStateEntry* pEntry)
+{
+  InstanceStateEntry* pExpected = NULL;
+  return __atomic_compare_exchange_n(ppSlot, &pExpected, pEntry, FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+#endif
+
+static char                gInstanceStatesFolder[MAX_FILE_PATH_CHARS];
+static InstanceStateEntry* gInstanceStateEntries[INSTANCE_STATE_SLOTS];
+
+static void initializeInstanceState(InstanceState* pState)
+{
+  pState->instanceId             = -1;
+  pState->lastRunTime            = -1;
+  pState->lastOrderUpdateTime    = -1;
+  pState->totalParameters        = 0;
+  pState->isParameterSpaceLoaded = FALSE;
+  //pState->predictDailyATR = 0.0;
+}
+
+static unsigned int firstInstanceSlot(int instanceId)
+{
+  /* Fibonacci hashing spreads consecutive instance IDs over the table */
+  return ((unsigned int)instanceId * 2654435761u) & (INSTANCE_STATE_SLOTS - 1);
+}
+
+/* Returns the entry of an instance, adding it if it does not exist yet and isAdding is TRUE. */
+static InstanceStateEntry* findInstanceEntry(int instanceId, BOOL isAdding)
+{
+  InstanceStateEntry* pNewEntry = NULL;
+  unsigned int        slot      = firstInstanceSlot(instanceId);
+  int                 probes;
+
+  for(probes = 0; probes < INSTANCE_STATE_SLOTS; probes++, slot = (slot + 1) & (INSTANCE_STATE_SLOTS - 1))
+  {
+    InstanceStateEntry* pEntry = loadEntry(&gInstanceStateEntries[slot]);
+
+    if(pEntry == NULL)
+    {
+      if(!isAdding)
+      {
+        return NULL;
+      }
+
+      if(pNewEntry == NULL)
+      {
+        pNewEntry = (InstanceStateEntry*)malloc(sizeof(InstanceStateEntry));
+        if(pNewEntry == NULL)
+        {
+          logCritical("findInstanceEntry() failed. Unable to allocate the state of instance ID: %d\n", instanceId);
+          return NULL;
+        }
+        pNewEntry->instanceId = instanceId;
+        initEntryLock(pNewEntry);
+        initializeInstanceState(&pNewEntry->state);
+      }
+
+      if(publishEntry(&gInstanceStateEntries[slot], pNewEntry))
+      {
+        return pNewEntry;
+      }
+
+      /* Another thread took the slot first, it may have added this same instance */
+      pEntry = loadEntry(&gInstanceStateEntries[slot]);
+    }
+
+    if(pEntry->instanceId == instanceId)
+    {
+      if(pNewEntry != NULL)
+      {
+        deinitEntryLock(pNewEntry);
+        free(pNewEntry);
+      }
+      return pEntry;
+    }
+  }
+
+  if(pNewEntry != NULL)
+  {
+    deinitEntryLock(pNewEntry);
+    free(pNewEntry);
+  }
+
+  if(isAdding)
+  {
+    logCritical("findInstanceEntry() failed. More than %d instances have state.\n", INSTANCE_STATE_SLOTS);
+  }
+  return NULL;
 }
 
 void initializeInstanceStates(const char* folderPath)
 {
   int i;
-  for(i = 0; i < MAX_INSTANCES; i++)
+  for(i = 0; i < INSTANCE_STATE_SLOTS; i++)
   {
-    initializeInstanceState(i);
+    InstanceStateEntry* pEntry = loadEntry(&gInstanceStateEntries[i]);
+
+    if(pEntry != NULL)
+    {
+      lockEntry(pEntry);
+      initializeInstanceState(&pEntry->state);
+      unlockEntry(pEntry);
+    }
   }
 
   strcpy(gInstanceStatesFolder, folderPath);
 }
 
-static int safe_getInstanceIndex(int instanceId)
+/* Returns the entry of an instance, claiming its state if nothing is stored in it yet. */
+static InstanceStateEntry* safe_getInstanceEntry(int instanceId)
 {
-  int i;
+  InstanceStateEntry* pEntry = findInstanceEntry(instanceId, TRUE);
 
-  enterCriticalSection();
-  for(i = 0; i < MAX_INSTANCES; i++)
+  if(pEntry == NULL)
   {
-    if(gInstanceStates[i].instanceId == -1)
-    {
-      initializeInstanceState(i);
-      gInstanceStates[i].instanceId = instanceId;
-      leaveCriticalSection();
-      return i;
-    }
-    if(gInstanceStates[i].instanceId == instanceId)
-    {
-      leaveCriticalSection();
-      return i;
-    }
+    return NULL;
+  }
+
+  lockEntry(pEntry);
+  if(pEntry->state.instanceId == -1)
+  {
+    initializeInstanceState(&pEntry->state);
+    pEntry->state.instanceId = instanceId;
   }
-  
-  leaveCriticalSection();
-  return -1;
+  unlockEntry(pEntry);
+
+  return pEntry;
 }
 
 void loadInstanceState(int instanceId)
@@ -98,11 +216,11 @@ void loadInstanceState(int instanceId)
   FILE *file;
   char instanceIdString[MAX_FILE_PATH_CHARS] = "";
   char path[MAX_FILE_PATH_CHARS] = "";
-  int  instanceIndex = safe_getInstanceIndex(instanceId);
+  InstanceStateEntry* pEntry = safe_getInstanceEntry(instanceId);
 
-  if(instanceIndex < 0)
+  if(pEntry == NULL)
   {
-    logError("loadInstanceState() Failed. InstanceIndex < 0\n\n\n\n\n\n");
+    logError("loadInstanceState() Failed. No state for instance ID %d\n\n\n\n\n\n", instanceId);
     return;
   }
 
@@ -116,55 +234,53 @@ void loadInstanceState(int instanceId)
   if(!file)
   {
     logNotice("loadInstanceState() %s does not exist yet. There is no state to load.\n", path);
-    initializeInstanceState(instanceIndex);
+    lockEntry(pEntry);
+    initializeInstanceState(&pEntry->state);
+    unlockEntry(pEntry);
     return;
   }
 
   logNotice("loadInstanceState() Loading instance state from %s\n", path);
-  fread(&gInstanceStates[instanceIndex], sizeof(InstanceState), 1, file);
+  lockEntry(pEntry);
+  fread(&pEntry->state, sizeof(InstanceState), 1, file);
+  unlockEntry(pEntry);
   fclose(file);
 
-  logDebug("loadInstanceState() InstanceId = %d, States Index = %d, instance ID = %d, Is parameter space loaded = %d, Last order update time = %d, Last Run time = %d\n", instanceId, instanceIndex, gInstanceStates[instanceIndex].instanceId, gInstanceStates[instanceIndex].isParameterSpaceLoaded, gInstanceStates[instanceIndex].lastOrderUpdateTime, gInstanceStates[instanceIndex].lastRunTime);
+  logDebug("loadInstanceState() InstanceId = %d, instance ID = %d, Is parameter space loaded = %d, Last order update time = %d, Last Run time = %d\n", instanceId, pEntry->state.instanceId, pEntry->state.isParameterSpaceLoaded, pEntry->state.lastOrderUpdateTime, pEntry->state.lastRunTime);
 }
 
 InstanceState* getInstanceState(int instanceId)
 {
-  int instanceIndex = safe_getInstanceIndex(instanceId);
+  InstanceStateEntry* pEntry = safe_getInstanceEntry(instanceId);
 
-  if(instanceIndex < 0)
+  if(pEntry == NULL)
   {
     logCritical("getInstanceState() failed. Unable to find state variables for instance ID: %d\n", instanceId);
     return NULL;
   }
 
-  return &gInstanceStates[instanceIndex];
+  return &pEntry->state;
 }
 
-static void backupInstanceState(int instanceId)
+/* The caller holds the entry lock. */
+static void backupInstanceState(InstanceStateEntry* pEntry)
 {
   FILE *file;
   char instanceIdString[MAX_FILE_PATH_CHARS] = "";
   char path[MAX_FILE_PATH_CHARS] = "";
-  int  instanceIndex = safe_getInstanceIndex(instanceId);
 
-  if(instanceIndex < 0)
-  {
-    logError("backupInstanceState() Failed. InstanceIndex < 0\n\n\n\n\n");
-    return;
-  }
-
-  logDebug("backupInstanceState() InstanceId = %d, States Index = %d, instance ID = %d, Is parameter space loaded = %d, Last order update time = %d, Last Run time = %d, ", instanceId, instanceIndex, gInstanceStates[instanceIndex].instanceId, gInstanceStates[instanceIndex].isParameterSpaceLoaded, gInstanceStates[instanceIndex].lastOrderUpdateTime, gInstanceStates[instanceIndex].lastRunTime);
+  logDebug("backupInstanceState() InstanceId = %d, instance ID = %d, Is parameter space loaded = %d, Last order update time = %d, Last Run time = %d, ", pEntry->instanceId, pEntry->state.instanceId, pEntry->state.isParameterSpaceLoaded, pEntry->state.lastOrderUpdateTime, pEntry->state.lastRunTime);
 
   strcpy(path, gInstanceStatesFolder);
   strcat(path, "/");
-  sprintf(instanceIdString, "%d", instanceId);
+  sprintf(instanceIdString, "%d", pEntry->instanceId);
   strcat(path, instanceIdString);
   strcat(path, INSTANCE_STATES_FILENAME_EXTENSION);
 
   file = fopen(path, "wb");
   if(file)
   {
-    fwrite(&gInstanceStates[instanceIndex], sizeof(InstanceState), 1, file);
+    fwrite(&pEntry->state, sizeof(InstanceState), 1, file);
     fclose(file);
   }
   else
@@ -175,56 +291,52 @@ static void backupInstanceState(int instanceId)
 
 BOOL hasInstanceRunOnCurrentBar(int instanceId, time_t barTime, BOOL isBackTesting)
 {
+  InstanceStateEntry* pEntry;
+  BOOL                hasRun;
+
 #if defined _WIN32 || defined _WIN64
   assert(barTime <= _I32_MAX); /* 32 bits is sufficient for the time until the year 2038. */
 #else
   assert(barTime <= INT_MAX);
 #endif
 
-  enterCriticalSection();
+  pEntry = findInstanceEntry(instanceId, TRUE);
+  if(pEntry == NULL)
   {
-    int i;
+    return TRUE;
+  }
 
-    for(i = 0; i < MAX_INSTANCES; i++)
+  lockEntry(pEntry);
+  if(pEntry->state.instanceId == -1)
+  {
+    logDebug("hasInstanceRunOnCurrentBar() Instance has no run time stored yet. InstanceId = %d, Bar time = %d", instanceId, barTime);
+    pEntry->state.instanceId = instanceId;
+    pEntry->state.lastRunTime = (__time32_t)barTime;
+    if(!isBackTesting)
     {
-      if(gInstanceStates[i].instanceId == -1)
-      {
-        logDebug("hasInstanceRunOnCurrentBar() Instance has no run time stored yet. InstanceId = %d, States Index = %d, Bar time = %d", instanceId, i, barTime);
-        gInstanceStates[i].instanceId = instanceId;
-        gInstanceStates[i].lastRunTime = (__time32_t)barTime;
-        if(!isBackTesting)
-        {
-          backupInstanceState(instanceId);
-        }
-        leaveCriticalSection();
-        /* Prevent instances from running on the very first bar. See Redmine Bug #89. */
-        return TRUE;
-      }
-      if(gInstanceStates[i].instanceId == instanceId)
-      {
-        if(gInstanceStates[i].lastRunTime == barTime)
-        {
-          logDebug("hasInstanceRunOnCurrentBar() Instance has already run on this bar. InstanceId = %d, States Index = %d, Last run time = %d, Bar time = %d", instanceId, i, gInstanceStates[i].lastRunTime, barTime);
-          leaveCriticalSection();
-          return TRUE;
-        }
-        else
-        {
-          logDebug("hasInstanceRunOnCurrentBar() Instance has not yet run on this bar. InstanceId = %d, States Index = %d, Last run time = %d, Bar time = %d", instanceId, i, gInstanceStates[i].lastRunTime, barTime);
-          gInstanceStates[i].lastRunTime = (__time32_t)barTime;
-          if(!isBackTesting)
-          {
-            backupInstanceState(instanceId);
-          }
-          leaveCriticalSection();
-          return FALSE;
-        }
-      }
+      backupInstanceState(pEntry);
+    }
+    /* Prevent instances from running on the very first bar. See Redmine Bug #89. */
+    hasRun = TRUE;
+  }
+  else if(pEntry->state.lastRunTime == barTime)
+  {
+    logDebug("hasInstanceRunOnCurrentBar() Instance has already run on this bar. InstanceId = %d, Last run time = %d, Bar time = %d", instanceId, pEntry->state.lastRunTime, barTime);
+    hasRun = TRUE;
+  }
+  else
+  {
+    logDebug("hasInstanceRunOnCurrentBar() Instance has not yet run on this bar. InstanceId = %d, Last run time = %d, Bar time = %d", instanceId, pEntry->state.lastRunTime, barTime);
+    pEntry->state.lastRunTime = (__time32_t)barTime;
+    if(!isBackTesting)
+    {
+      backupInstanceState(pEntry);
     }
+    hasRun = FALSE;
   }
-  leaveCriticalSection();
+  unlockEntry(pEntry);
 
-  return TRUE;
+  return hasRun;
 }
 
 BOOL hasOrderOpenedOnCurrentBar(StrategyParams* pParams)
@@ -253,93 +365,102 @@ BOOL hasOrderOpenedOnCurrentBar(StrategyParams* pParams)
 
 time_t setLastOrderUpdateTime(int instanceId, time_t updateTime, BOOL isBackTesting)
 {
+  InstanceStateEntry* pEntry;
+  time_t              oldUpdateTime;
+
 #if defined _WIN32 || defined _WIN64
   assert(updateTime <= _I32_MAX); /* 32 bits is sufficient for the time until the year 2038. */
 #else
   assert(updateTime <= INT_MAX);
 #endif
 
-  enterCriticalSection();
+  pEntry = findInstanceEntry(instanceId, TRUE);
+  if(pEntry == NULL)
   {
-    int i;
+    return TRUE;
+  }
 
-    for(i = 0; i < MAX_INSTANCES; i++)
+  lockEntry(pEntry);
+  if(pEntry->state.instanceId == -1)
+  {
+    pEntry->state.instanceId = instanceId;
+    pEntry->state.lastOrderUpdateTime = (__time32_t)updateTime;
+    if(!isBackTesting)
     {
-      if(gInstanceStates[i].instanceId == -1)
-      {
-        gInstanceStates[i].instanceId = instanceId;
-        gInstanceStates[i].lastOrderUpdateTime = (__time32_t)updateTime;
-        if(!isBackTesting)
-        {
-          backupInstanceState(instanceId);
-        }
-        leaveCriticalSection();
-        return 0;
-      }
-      if(gInstanceStates[i].instanceId == instanceId)
+      backupInstanceState(pEntry);
+    }
+    oldUpdateTime = 0;
+  }
+  else
+  {
+    oldUpdateTime = pEntry->state.lastOrderUpdateTime;
+    if(pEntry->state.lastOrderUpdateTime != (__time32_t)updateTime)
+    {
+      pEntry->state.lastOrderUpdateTime = (__time32_t)updateTime;
+      if(!isBackTesting)
       {
-        time_t oldUpdateTime = gInstanceStates[i].lastOrderUpdateTime;
-        if(gInstanceStates[i].lastOrderUpdateTime != (__time32_t)updateTime)
-        {
-          gInstanceStates[i].lastOrderUpdateTime = (__time32_t)updateTime;
-          if(!isBackTesting)
-          {
-            backupInstanceState(instanceId);
-          }
-        }
-        leaveCriticalSection();
-        return oldUpdateTime;
+        backupInstanceState(pEntry);
       }
     }
   }
-  leaveCriticalSection();
+  unlockEntry(pEntry);
 
-  return TRUE;
+  return oldUpdateTime;
 }
 
 time_t getLastOrderUpdateTime(int instanceId)
 {
-  enterCriticalSection();
+  InstanceStateEntry* pEntry = findInstanceEntry(instanceId, FALSE);
+  time_t              updateTime = 0;
+
+  if(pEntry == NULL)
   {
-    int i;
+    return 0;
+  }
 
-    for(i = 0; i < MAX_INSTANCES; i++)
-    {
-      if(gInstanceStates[i].instanceId == -1)
-      {
-        leaveCriticalSection();
-        return 0;
-      }
-      if(gInstanceStates[i].instanceId == instanceId)
-      {
-        leaveCriticalSection();
-        return gInstanceStates[i].lastOrderUpdateTime;
-      }
-    }
+  lockEntry(pEntry);
+  if(pEntry->state.instanceId != -1)
+  {
+    updateTime = pEntry->state.lastOrderUpdateTime;
   }
-  leaveCriticalSection();
+  unlockEntry(pEntry);
 
-  return 0;
+  return updateTime;
 }
 
 void resetInstanceState(int instanceId)
 {
-  int instanceIndex = safe_getInstanceIndex(instanceId);
-  if(instanceIndex >= 0)
+  InstanceStateEntry* pEntry = findInstanceEntry(instanceId, TRUE);
+  if(pEntry != NULL)
+  {
+    lockEntry(pEntry);
+    initializeInstanceState(&pEntry->state);
+    pEntry->state.instanceId = instanceId;
+    backupInstanceState(pEntry);
+    unlockEntry(pEntry);
+  }
+}
+
+void clearInstanceState(int instanceId)
+{
+  InstanceStateEntry* pEntry = findInstanceEntry(instanceId, FALSE);
+  if(pEntry != NULL)
   {
-    initializeInstanceState(instanceIndex);
-    backupInstanceState(instanceId);
+    lockEntry(pEntry);
+    initializeInstanceState(&pEntry->state);
+    pEntry->state.instanceId = instanceId;
+    unlockEntry(pEntry);
   }
 }
 
 ParameterInfo* getParameterSpaceBuffer(int instanceId, int** ppTotalParameters)
 {
-  int instanceIndex = safe_getInstanceIndex(instanceId);
+  InstanceStateEntry* pEntry = safe_getInstanceEntry(instanceId);
 
-  if(instanceIndex >= 0)
+  if(pEntry != NULL)
   {
-    *ppTotalParameters = &gInstanceStates[instanceIndex].totalParameters;
-    return gInstanceStates[instanceIndex].parameterSpace;
+    *ppTotalParameters = &pEntry->state.totalParameters;
+    return pEntry->state.parameterSpace;
   }
   else
   {
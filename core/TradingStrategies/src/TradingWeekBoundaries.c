@@ -40,15 +40,6 @@
 #include <stdio.h>
 #include <string.h>
 
-static int gCropMondayHours = 4;
-static int gCropFridayHours = 4;
-
-void setTradingWeekBoundaries(int cropMondayHours, int cropFridayHours)
-{
-  gCropMondayHours = cropMondayHours;
-  gCropFridayHours = cropFridayHours;
-}
-
 BOOL isWeekend(time_t time)
 {
    //TODO: need to overcome when moving DST, the monday 0:00 will become Sunday 23:00, but it is a valid time bar.
@@ -85,34 +76,7 @@ BOOL isOutsideTradingBoundaries(StrategyParams* pParams,time_t time)
 }
 
 
-BOOL isOutsideTradingWeekBoundaries(time_t time)
-{
-	struct tm * timeStructure;
-	char       timeString[MAX_TIME_STRING_SIZE] = "";
-
-	#if defined _MSC_VER
-		timeStructure = gmtime(&time);
-	#else
-		struct tm temp;
-		timeStructure = gmtime_r(&time, &temp);
-	#endif
-
-	safe_timeString(timeString, time);
-
-	logDebug("isOutsideTradingWeekBoundaries() PassedDate = %s Day of week: %d, Hour: %d", timeString, timeStructure->tm_wday, timeStructure->tm_hour);
-
-	if((timeStructure->tm_wday == MONDAY) && (timeStructure->tm_hour < gCropMondayHours))
-  {
-		return TRUE;
-  }
- 
-	if((timeStructure->tm_wday == FRIDAY) && (timeStructure->tm_hour > (23 - gCropFridayHours)))
-  {
-		return TRUE;
-  }
-
-	return FALSE;
-}
+/* isOutsideTradingWeekBoundaries() is defined by the AsirikuyFrameworkAPI library, which reads the crop hours from the framework context */
 
 BOOL isForexBrokerHoliday(time_t time)
 {
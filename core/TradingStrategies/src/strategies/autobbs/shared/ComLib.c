@@ -201,14 +201,12 @@ BOOL isNextdayMACDPostiveBar2(StrategyParams* pParams, int orderIndex,int startS
 	int    shift0Index = pParams->ratesBuffers->rates[B_PRIMARY_RATES].info.arraySize - 1;
 	time_t currentTime, orderOpenTime;
 	struct tm timeInfo1, timeInfo2;
-	char   timeString[MAX_TIME_STRING_SIZE] = "";	
 	BOOL result = TRUE;
 	double preDayOpen, preDayOpen1, preDayClose, preDayClose1, preDayRange, preDayRange1;
 	double diffHours;
 
 	currentTime = pParams->ratesBuffers->rates[B_PRIMARY_RATES].time[shift0Index];
 	safe_gmtime(&timeInfo1, currentTime);
-	safe_timeString(timeString, currentTime);
 
 	orderOpenTime = pParams->orderInfo[orderIndex].openTime;
 	safe_gmtime(&timeInfo2, orderOpenTime);
@@ -376,14 +374,12 @@ AsirikuyReturnCode getHighestHourlyClosePrice(StrategyParams* pParams, Indicator
 	int count;
 	time_t currentTime;
 	struct tm timeInfo1; 
-	char   timeString[MAX_TIME_STRING_SIZE] = "";
 	
 	*highPrice = -999999.0;
 	*lowPrice = 999999.0;
 
 	currentTime = pParams->ratesBuffers->rates[B_PRIMARY_RATES].time[shift0Index];
 	safe_gmtime(&timeInfo1, currentTime);
-	safe_timeString(timeString, currentTime);
 
 	if (orderIndex >=0 && pParams->orderInfo[orderIndex].isOpen == TRUE)
 	{
@@ -406,14 +402,12 @@ AsirikuyReturnCode getHighLowPrice(StrategyParams* pParams, Indicators* pIndicat
 	int count;
 	time_t currentTime;
 	struct tm timeInfo1;
-	char   timeString[MAX_TIME_STRING_SIZE] = "";
 
 	*highPrice = -999999.0;
 	*lowPrice = 999999.0;
 
 	currentTime = pParams->ratesBuffers->rates[B_PRIMARY_RATES].time[shift0Index];
 	safe_gmtime(&timeInfo1, currentTime);
-	safe_timeString(timeString, currentTime);
 
 	if (orderIndex >= 0 && pParams->orderInfo[orderIndex].isOpen == TRUE
 		&& (pParams->orderInfo[orderIndex].type == BUY || pParams->orderInfo[orderIndex].type == SELL))
@@ -440,7 +434,6 @@ AsirikuyReturnCode addMoreOrdersOnLongTermTrend(StrategyParams* pParams, Indicat
 	int    shift1Index_Daily = pParams->ratesBuffers->rates[B_DAILY_RATES].info.arraySize - 2;
 	time_t currentTime;
 	struct tm timeInfo1;
-	char       timeString[MAX_TIME_STRING_SIZE] = "";
 
 	double preHigh = iHigh(B_PRIMARY_RATES, 1);
 	double preLow = iLow(B_PRIMARY_RATES, 1);
@@ -448,7 +441,6 @@ AsirikuyReturnCode addMoreOrdersOnLongTermTrend(StrategyParams* pParams, Indicat
 
 	currentTime = pParams->ratesBuffers->rates[B_PRIMARY_RATES].time[shift0Index_primary];
 	safe_gmtime(&timeInfo1, currentTime);
-	safe_timeString(timeString, currentTime);
 
 	if (pParams->orderInfo[oldestOpenOrderIndex].type == BUY){
 
@@ -489,12 +481,10 @@ BOOL XAUUSD_not_full_trading_day(StrategyParams* pParams, Indicators* pIndicator
 	int    shift0Index = pParams->ratesBuffers->rates[B_PRIMARY_RATES].info.arraySize - 1;
 	time_t currentTime;
 	struct tm timeInfo1;
-	char       timeString[MAX_TIME_STRING_SIZE] = "";
 	BOOL isFilter = FALSE;
 
 	currentTime = pParams->ratesBuffers->rates[B_PRIMARY_RATES].time[shift0Index];
 	safe_gmtime(&timeInfo1, currentTime);
-	safe_timeString(timeString, currentTime);
 
 	// Martin Luther King Jr. Day - 3rd Monday in January
 	if (timeInfo1.tm_mon == 0 && timeInfo1.tm_wday == 1
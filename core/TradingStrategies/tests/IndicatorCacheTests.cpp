@@ -0,0 +1,184 @@
+/**
+ * @file
+ * @brief     Unit tests for the indicator cache and indicator states of the EasyTrade library
+ *
+ * @author    Morgan Doel (Initial implementation)
+ * @version   F4.x.x
+ * @date      2025
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <cstring>
+#include "EasyTradeCWrapper.hpp"
+
+namespace
+{
+  // Kept clear of the instance IDs used by the other test suites
+  const int FIRST_TEST_INSTANCE_ID = 910000;
+  const int TEST_BARS              = 100;
+
+  struct IndicatorCacheFixture
+  {
+    StrategyParams params;
+    RatesBuffers   ratesBuffers;
+    double settings[ORDERINFO_ARRAY_SIZE + 1];
+    time_t time[TEST_BARS];
+    double open[TEST_BARS];
+    double high[TEST_BARS];
+    double low[TEST_BARS];
+    double close[TEST_BARS];
+    double volume[TEST_BARS];
+
+    IndicatorCacheFixture()
+    {
+      Rates* pRates = &ratesBuffers.rates[0];
+
+      std::memset(&params, 0, sizeof(params));
+      std::memset(&ratesBuffers, 0, sizeof(ratesBuffers));
+      std::memset(settings, 0, sizeof(settings));
+      params.ratesBuffers = &ratesBuffers;
+      params.settings     = settings;
+
+      for(int i = 0; i < TEST_BARS; i++)
+      {
+        time[i]   = 1262304000 + 900 * i;
+        open[i]   = 1.3000 + 0.0010 * (i % 7);
+        high[i]   = open[i] + 0.0020;
+        low[i]    = open[i] - 0.0015;
+        close[i]  = open[i] + 0.0005;
+        volume[i] = 100;
+      }
+
+      pRates->info.arraySize = TEST_BARS - 1;
+      pRates->info.timeframe = 15;
+      pRates->time   = time;
+      pRates->open   = open;
+      pRates->high   = high;
+      pRates->low    = low;
+      pRates->close  = close;
+      pRates->volume = volume;
+
+      // Start every test from empty caches on this thread
+      releaseIndicatorCachesEasy();
+      runInstance(FIRST_TEST_INSTANCE_ID);
+    }
+
+    ~IndicatorCacheFixture()
+    {
+      releaseIndicatorCachesEasy();
+      releaseThreadIndicatorStatesEasy();
+    }
+
+    void runInstance(int instanceId)
+    {
+      params.settings[STRATEGY_INSTANCE_ID] = instanceId;
+      initEasyTradeLibrary(&params);
+    }
+
+    void checkCounters(long long expectedHits, long long expectedMisses)
+    {
+      long long hits, misses;
+
+      getIndicatorCacheCountersEasy(&hits, &misses);
+      BOOST_CHECK_EQUAL(hits, expectedHits);
+      BOOST_CHECK_EQUAL(misses, expectedMisses);
+    }
+  };
+}
+
+BOOST_FIXTURE_TEST_SUITE(IndicatorCache_Tests, IndicatorCacheFixture)
+
+BOOST_AUTO_TEST_CASE(repeated_call_on_the_same_bar_is_a_hit)
+{
+  double atr = iAtr(0, 14, 1);
+
+  BOOST_CHECK_EQUAL(iAtr(0, 14, 1), atr);
+  BOOST_CHECK_EQUAL(iAtr(0, 14, 1), atr);
+  checkCounters(2, 1);
+}
+
+BOOST_AUTO_TEST_CASE(other_parameters_are_a_miss)
+{
+  iAtr(0, 14, 1);
+  iAtr(0, 20, 1);
+  iAtr(0, 14, 2);
+  checkCounters(0, 3);
+}
+
+BOOST_AUTO_TEST_CASE(new_bar_is_a_miss)
+{
+  iAtr(0, 14, 1);
+  ratesBuffers.rates[0].info.arraySize = TEST_BARS;
+  iAtr(0, 14, 1);
+  iAtr(0, 14, 1);
+  checkCounters(1, 2);
+}
+
+BOOST_AUTO_TEST_CASE(new_tick_on_the_open_bar_is_a_miss)
+{
+  iAtr(0, 14, 1);
+  close[TEST_BARS - 2] += 0.0001;
+  iAtr(0, 14, 1);
+  checkCounters(0, 2);
+}
+
+BOOST_AUTO_TEST_CASE(instances_keep_separate_counters)
+{
+  iAtr(0, 14, 1);
+  iAtr(0, 14, 1);
+
+  runInstance(FIRST_TEST_INSTANCE_ID + 1);
+  checkCounters(0, 0);
+  iAtr(0, 14, 1);
+  checkCounters(0, 1);
+
+  runInstance(FIRST_TEST_INSTANCE_ID);
+  checkCounters(1, 1);
+}
+
+BOOST_AUTO_TEST_CASE(release_clears_the_caches_of_the_thread)
+{
+  iAtr(0, 14, 1);
+  iAtr(0, 14, 1);
+
+  releaseIndicatorCachesEasy();
+  checkCounters(0, 0);
+  iAtr(0, 14, 1);
+  checkCounters(0, 1);
+}
+
+BOOST_AUTO_TEST_CASE(bband_stop_states_are_freed_with_their_instance)
+{
+  int signal, index;
+  double stopPrice;
+
+  iBBandStop(0, 20, 2.0, &signal, &stopPrice, &index);
+  iBBandStop(0, 30, 2.5, &signal, &stopPrice, &index);
+  iBBandStop(0, 30, 2.5, &signal, &stopPrice, &index);
+  runInstance(FIRST_TEST_INSTANCE_ID + 1);
+  iBBandStop(0, 20, 2.0, &signal, &stopPrice, &index);
+
+  BOOST_CHECK_EQUAL(countBBandStopStatesEasy(FIRST_TEST_INSTANCE_ID), 2);
+  BOOST_CHECK_EQUAL(countBBandStopStatesEasy(FIRST_TEST_INSTANCE_ID + 1), 1);
+
+  releaseIndicatorStatesEasy(FIRST_TEST_INSTANCE_ID);
+  BOOST_CHECK_EQUAL(countBBandStopStatesEasy(FIRST_TEST_INSTANCE_ID), 0);
+  BOOST_CHECK_EQUAL(countBBandStopStatesEasy(FIRST_TEST_INSTANCE_ID + 1), 1);
+}
+
+BOOST_AUTO_TEST_CASE(release_frees_the_bband_stop_states_of_the_thread)
+{
+  int signal, index;
+  double stopPrice;
+
+  iBBandStop(0, 20, 2.0, &signal, &stopPrice, &index);
+  runInstance(FIRST_TEST_INSTANCE_ID + 1);
+  iBBandStop(0, 25, 1.5, &signal, &stopPrice, &index);
+
+  releaseThreadIndicatorStatesEasy();
+  BOOST_CHECK_EQUAL(countBBandStopStatesEasy(FIRST_TEST_INSTANCE_ID), 0);
+  BOOST_CHECK_EQUAL(countBBandStopStatesEasy(FIRST_TEST_INSTANCE_ID + 1), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
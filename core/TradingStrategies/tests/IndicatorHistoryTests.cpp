@@ -0,0 +1,225 @@
+/**
+ * @file
+ * @brief     Unit tests comparing the EMA and MACD of the EasyTrade library with TA-Lib
+ *
+ * iMA and iMACDAll read closed bars from a per instance IndicatorHistory. These tests
+ * check that the values they return are the ones TA_MA and TA_MACDEXT give over the
+ * same bars.
+ *
+ * @author    Morgan Doel (Initial implementation)
+ * @version   F4.x.x
+ * @date      2025
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <ta_libc.h>
+#include "EasyTradeCWrapper.hpp"
+
+namespace
+{
+  // Kept clear of the instance IDs used by the other test suites
+  const int FIRST_TEST_INSTANCE_ID = 920000;
+  const int TEST_BARS              = 1500;
+  const int MACD_UNSTABLE_PERIOD   = 35;  // The one iMACD and iMACDAll always used
+  const int SHIFTS[]               = {0, 1, 2, 7, 40, 150, 298, 400};
+  const int NUM_SHIFTS             = sizeof(SHIFTS) / sizeof(SHIFTS[0]);
+  const double NO_VALUE            = -12345;
+
+  struct DirectValues
+  {
+    bool   hasEma;
+    bool   hasMacd;
+    double ema;
+    double macd[3];
+  };
+
+  struct IndicatorHistoryFixture
+  {
+    StrategyParams params;
+    RatesBuffers   ratesBuffers;
+    double settings[ORDERINFO_ARRAY_SIZE + 1];
+    std::vector<time_t> time;
+    std::vector<double> open, high, low, close, volume;
+
+    IndicatorHistoryFixture() : time(TEST_BARS), open(TEST_BARS), high(TEST_BARS), low(TEST_BARS), close(TEST_BARS), volume(TEST_BARS)
+    {
+      double price = 1.3;
+
+      std::memset(&params, 0, sizeof(params));
+      std::memset(&ratesBuffers, 0, sizeof(ratesBuffers));
+      std::memset(settings, 0, sizeof(settings));
+      params.ratesBuffers = &ratesBuffers;
+      params.settings     = settings;
+
+      for(int i = 0; i < TEST_BARS; i++)
+      {
+        price    += 0.002 * std::sin(i * 0.05) + 0.0007 * ((i * 37) % 11 - 5) / 5.0;
+        time[i]   = 1262304000 + 900 * i;
+        open[i]   = price;
+        close[i]  = price + 0.0004 * ((i * 13) % 7 - 3);
+        high[i]   = std::max(open[i], close[i]) + 0.0010;
+        low[i]    = std::min(open[i], close[i]) - 0.0010;
+        volume[i] = 100 + i % 17;
+      }
+
+      ratesBuffers.rates[0].info.timeframe = 15;
+      releaseIndicatorCachesEasy();
+    }
+
+    ~IndicatorHistoryFixture()
+    {
+      releaseIndicatorCachesEasy();
+      releaseThreadIndicatorStatesEasy();
+    }
+
+    // Points rates array 0 at bars firstBar..firstBar+arraySize-1 and runs the instance on them
+    void showBars(int instanceId, int firstBar, int arraySize)
+    {
+      Rates* pRates = &ratesBuffers.rates[0];
+
+      pRates->info.arraySize = arraySize;
+      pRates->time   = &time[firstBar];
+      pRates->open   = &open[firstBar];
+      pRates->high   = &high[firstBar];
+      pRates->low    = &low[firstBar];
+      pRates->close  = &close[firstBar];
+      pRates->volume = &volume[firstBar];
+
+      settings[STRATEGY_INSTANCE_ID] = instanceId;
+      initEasyTradeLibrary(&params);
+    }
+
+    // TA_MA and TA_MACDEXT on one bar of the rates array, the way iMA and iMACDAll called them
+    DirectValues directValues(int index, int emaPeriod, const int* macdPeriods)
+    {
+      const Rates* pRates = &ratesBuffers.rates[0];
+      DirectValues direct = {false, false, NO_VALUE, {NO_VALUE, NO_VALUE, NO_VALUE}};
+      int outBegIdx, outNBElement;
+
+      TA_SetUnstablePeriod(TA_FUNC_UNST_EMA, 0);
+      BOOST_REQUIRE_EQUAL(TA_MA(index, index, pRates->close, emaPeriod, TA_MAType_EMA, &outBegIdx, &outNBElement, &direct.ema), TA_SUCCESS);
+      direct.hasEma = outNBElement > 0;
+
+      TA_SetUnstablePeriod(TA_FUNC_UNST_EMA, MACD_UNSTABLE_PERIOD);
+      BOOST_REQUIRE_EQUAL(TA_MACDEXT(index, index, pRates->close, macdPeriods[0], TA_MAType_EMA, macdPeriods[1], TA_MAType_EMA, macdPeriods[2], TA_MAType_EMA,
+        &outBegIdx, &outNBElement, &direct.macd[0], &direct.macd[1], &direct.macd[2]), TA_SUCCESS);
+      direct.hasMacd = outNBElement > 0;
+      TA_SetUnstablePeriod(TA_FUNC_UNST_EMA, 0);
+
+      return direct;
+    }
+
+    void checkBar(int shift, int emaPeriod, const int* macdPeriods, const DirectValues& expected)
+    {
+      double macd[3] = {NO_VALUE, NO_VALUE, NO_VALUE};
+
+      // The EMA of a bar without enough history was never defined
+      if(expected.hasEma)
+      {
+        BOOST_CHECK_CLOSE(iMA(3, 0, emaPeriod, shift), expected.ema, 1e-9);
+      }
+
+      BOOST_REQUIRE_EQUAL(iMACDAll(0, macdPeriods[0], macdPeriods[1], macdPeriods[2], shift, &macd[0], &macd[1], &macd[2]), 0);
+      for(int k = 0; k < 3; k++)
+      {
+        // Bars without enough history leave the outputs as they are
+        BOOST_CHECK_SMALL(macd[k] - (expected.hasMacd ? expected.macd[k] : NO_VALUE), 1e-12);
+      }
+    }
+  };
+
+  const int EMA_PERIODS[]     = {2, 30};
+  const int MACD_PERIODS[][3] = {{12, 26, 9}, {3, 10, 1}};
+}
+
+BOOST_FIXTURE_TEST_SUITE(IndicatorHistory_Tests, IndicatorHistoryFixture)
+
+BOOST_AUTO_TEST_CASE(ema_and_macd_match_ta_lib_on_a_growing_rates_array)
+{
+  for(int p = 0; p < 2; p++)
+  {
+    const int instanceId = FIRST_TEST_INSTANCE_ID + p;
+
+    for(int arraySize = 50; arraySize <= 700; arraySize++)
+    {
+      showBars(instanceId, 0, arraySize);
+      for(int s = 0; s < NUM_SHIFTS && SHIFTS[s] < arraySize; s++)
+      {
+        checkBar(SHIFTS[s], EMA_PERIODS[p], MACD_PERIODS[p], directValues(arraySize - 1 - SHIFTS[s], EMA_PERIODS[p], MACD_PERIODS[p]));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ema_and_macd_of_a_closed_bar_are_the_ones_it_had_as_the_newest_bar)
+{
+  const int windowSize = 300;
+
+  for(int p = 0; p < 2; p++)
+  {
+    const int instanceId = FIRST_TEST_INSTANCE_ID + 10 + p;
+    std::vector<DirectValues> expected(TEST_BARS);
+
+    // The first window fills the history from the bars it holds
+    showBars(instanceId, 0, windowSize);
+    for(int i = 0; i < windowSize - 1; i++)
+    {
+      expected[i] = directValues(i, EMA_PERIODS[p], MACD_PERIODS[p]);
+    }
+
+    for(int firstBar = 0; firstBar + windowSize <= TEST_BARS; firstBar++)
+    {
+      const int shift1Bar = firstBar + windowSize - 2;
+
+      showBars(instanceId, firstBar, windowSize);
+      if(firstBar > 0)
+      {
+        expected[shift1Bar] = directValues(windowSize - 2, EMA_PERIODS[p], MACD_PERIODS[p]);
+      }
+
+      checkBar(0, EMA_PERIODS[p], MACD_PERIODS[p], directValues(windowSize - 1, EMA_PERIODS[p], MACD_PERIODS[p]));
+      for(int s = 1; s < NUM_SHIFTS && SHIFTS[s] < windowSize; s++)
+      {
+        checkBar(SHIFTS[s], EMA_PERIODS[p], MACD_PERIODS[p], expected[shift1Bar + 1 - SHIFTS[s]]);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(histories_are_freed_with_their_instance)
+{
+  const int instanceId = FIRST_TEST_INSTANCE_ID + 20, otherInstanceId = FIRST_TEST_INSTANCE_ID + 21, arraySize = 300;
+  double macd[3];
+
+  showBars(instanceId, 0, arraySize);
+  iMA(3, 0, EMA_PERIODS[0], 1);
+  iMA(3, 0, EMA_PERIODS[1], 1);
+  iMACDAll(0, MACD_PERIODS[0][0], MACD_PERIODS[0][1], MACD_PERIODS[0][2], 1, &macd[0], &macd[1], &macd[2]);
+  showBars(otherInstanceId, 0, arraySize);
+  iMA(3, 0, EMA_PERIODS[0], 1);
+
+  BOOST_CHECK_EQUAL(countEmaHistoriesEasy(instanceId), 3);
+  BOOST_CHECK_EQUAL(countEmaHistoriesEasy(otherInstanceId), 1);
+
+  releaseIndicatorStatesEasy(instanceId);
+  BOOST_CHECK_EQUAL(countEmaHistoriesEasy(instanceId), 0);
+  BOOST_CHECK_EQUAL(countEmaHistoriesEasy(otherInstanceId), 1);
+
+  releaseThreadIndicatorStatesEasy();
+  BOOST_CHECK_EQUAL(countEmaHistoriesEasy(otherInstanceId), 0);
+
+  // A released instance starts a new history with the same values
+  releaseIndicatorCachesEasy();
+  showBars(instanceId, 0, arraySize);
+  for(int s = 1; s < NUM_SHIFTS && SHIFTS[s] < arraySize; s++)
+  {
+    checkBar(SHIFTS[s], EMA_PERIODS[1], MACD_PERIODS[0], directValues(arraySize - 1 - SHIFTS[s], EMA_PERIODS[1], MACD_PERIODS[0]));
+  }
+  BOOST_CHECK_EQUAL(countEmaHistoriesEasy(instanceId), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,104 @@
+/**
+ * @file
+ * @brief     Unit tests for the instance state registry
+ * 
+ * @author    Morgan Doel (Initial implementation)
+ * @version   F4.x.x
+ * @date      2025
+ *
+ * @copyright END-USER LICENSE AGREEMENT FOR ASIRIKUY SOFTWARE
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+#include "InstanceStates.h"
+
+namespace
+{
+  // Kept clear of the instance IDs used by the other test suites
+  const int FIRST_TEST_INSTANCE_ID = 900000;
+  const int TEST_BARS              = 1000;
+
+  void runInstanceOnBars(int instanceId, int* pBarsRun)
+  {
+    int bar;
+
+    *pBarsRun = 0;
+    for(bar = 0; bar < TEST_BARS; bar++)
+    {
+      time_t barTime = 1262304000 + 900 * bar;
+
+      if(!hasInstanceRunOnCurrentBar(instanceId, barTime, TRUE))
+      {
+        (*pBarsRun)++;
+      }
+      /* A second tick on the same bar must not run the instance again */
+      if(!hasInstanceRunOnCurrentBar(instanceId, barTime, TRUE))
+      {
+        (*pBarsRun)++;
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(InstanceStates_Tests)
+
+BOOST_AUTO_TEST_CASE(instance_skips_its_first_bar_and_runs_once_per_bar)
+{
+  const int instanceId = FIRST_TEST_INSTANCE_ID;
+
+  initializeInstanceStates(".");
+
+  BOOST_CHECK(hasInstanceRunOnCurrentBar(instanceId, 1000, TRUE));
+  BOOST_CHECK(hasInstanceRunOnCurrentBar(instanceId, 1000, TRUE));
+  BOOST_CHECK(!hasInstanceRunOnCurrentBar(instanceId, 2000, TRUE));
+  BOOST_CHECK(hasInstanceRunOnCurrentBar(instanceId, 2000, TRUE));
+}
+
+BOOST_AUTO_TEST_CASE(more_instances_than_max_instances_keep_separate_states)
+{
+  const int numInstances = 4 * MAX_INSTANCES;
+  int i;
+
+  initializeInstanceStates(".");
+
+  for(i = 0; i < numInstances; i++)
+  {
+    BOOST_CHECK_EQUAL(setLastOrderUpdateTime(FIRST_TEST_INSTANCE_ID + i, 5000 + i, TRUE), 0);
+  }
+
+  for(i = 0; i < numInstances; i++)
+  {
+    InstanceState* pState = getInstanceState(FIRST_TEST_INSTANCE_ID + i);
+
+    BOOST_REQUIRE(pState != NULL);
+    BOOST_CHECK_EQUAL(pState->instanceId, FIRST_TEST_INSTANCE_ID + i);
+    BOOST_CHECK_EQUAL(getLastOrderUpdateTime(FIRST_TEST_INSTANCE_ID + i), 5000 + i);
+    BOOST_CHECK(getInstanceState(FIRST_TEST_INSTANCE_ID + i) == pState);
+  }
+
+  BOOST_CHECK_EQUAL(getLastOrderUpdateTime(FIRST_TEST_INSTANCE_ID + numInstances), 0);
+}
+
+BOOST_AUTO_TEST_CASE(instances_on_different_threads_run_once_per_bar)
+{
+  const int numThreads = 8;
+  int barsRun[numThreads];
+  boost::thread_group threads;
+  int i;
+
+  initializeInstanceStates(".");
+
+  for(i = 0; i < numThreads; i++)
+  {
+    threads.add_thread(new boost::thread(runInstanceOnBars, FIRST_TEST_INSTANCE_ID + i, &barsRun[i]));
+  }
+  threads.join_all();
+
+  for(i = 0; i < numThreads; i++)
+  {
+    BOOST_CHECK_EQUAL(barsRun[i], TEST_BARS - 1);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -8,6 +8,9 @@
  * - StrategyContextTests.cpp
  * - StrategyFactoryTests.cpp
  * - BaseStrategyTests.cpp
+ * - InstanceStatesTests.cpp
+ * - IndicatorCacheTests.cpp
+ * - IndicatorHistoryTests.cpp
  * 
  * @author    Morgan Doel (Initial implementation)
  * @version   F4.x.x
@@ -10,6 +10,7 @@ project "UnitTests"
   includedirs{
     "../AsirikuyCommon/tests", 
     "../AsirikuyFrameworkAPI/tests", 
+    "../CTesterFrameworkAPI/tests", 
     "../AsirikuyTechnicalAnalysis/tests", 
     "../Log/tests", 
     "../NTPClient/tests", 
@@ -20,6 +21,7 @@ project "UnitTests"
   links{
     -- Do not change the order of these libraries,
     -- otherwise the GCC on Linux will complain
+    "CTesterFrameworkAPI",
     "AsirikuyFrameworkAPI",
 	"AsirikuyTechnicalAnalysis",
 	"AsirikuyEasyTrade",
@@ -43,6 +45,7 @@ project "UnitTests"
     }
     links{
       "boost_serialization",
+      "boost_thread",
       "boost_unit_test_framework"
     }
   os.chdir("../..")
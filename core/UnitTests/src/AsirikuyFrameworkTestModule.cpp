@@ -42,6 +42,7 @@
 
 #include "AsirikuyCommonTests.hpp"
 #include "AsirikuyFrameworkAPITests.hpp"
+#include "CTesterFrameworkAPITests.hpp"
 #include "AsirikuyTechnicalAnalysisTests.hpp"
 #include "LogTests.hpp"
 #include "NTPClientTests.hpp"
@@ -77,6 +77,7 @@ def main():
         print("No shared library loading support for OS %s" % (system))
         return False
     print("[DEBUG] Library loaded successfully")
+    setHistoryLibrary(astdll)
 
     print("[DEBUG] Importing graphics module...")
     from include.graphics import plotTestResult, plotMultipleTestResults, plotOptimizationResult, plotPortfolioTestResult
@@ -468,6 +469,11 @@ def main():
         testSettings[i] = TestSettings()
         testSettings[i].spread = spreads[i]
         testSettings[i].is_calculate_expectancy = is_calculate_expectancy
+        if optimize:
+            # Early abort criteria of the optimization runs (0 = off), without the inline comments
+            testSettings[i].abortMaxDD = float(config.get("optimization", "abortMaxDD", fallback="0").split(';')[0].strip())
+            testSettings[i].abortMaxDDLength = float(config.get("optimization", "abortMaxDDLength", fallback="0").split(';')[0].strip())
+            testSettings[i].abortEquityFloor = float(config.get("optimization", "abortEquityFloor", fallback="0").split(';')[0].strip())
 
     print(f"[DEBUG] After processing all systems:", flush=True)
     print(f"[DEBUG] optimize = {optimize}", flush=True)
@@ -667,7 +673,7 @@ def main():
     error_c = c_char_p();
 
     start = time()
-    global f
+    global f, walkForwardFile
     if optimize:
         print("[DEBUG] Optimization mode enabled", flush=True)
         print("[DEBUG] numOptimizationParams[0] =", numOptimizationParams[0], flush=True)
@@ -694,7 +700,7 @@ def main():
         
         if execUnderMPI == False or (execUnderMPI == True and rank == 1):
             f = open(outputOptimizationFile + ".csv", 'w')
-            header = "Iteration, Symbol, NumTrades, Profit, maxDD, maxDDLength, PF, R2, ulcerIndex, Sharpe, CAGR, CAGR to Max DD, numShorts, numLongs, Set Parameters\n"
+            header = "Iteration, Symbol, NumTrades, Profit, maxDD, maxDDLength, PF, R2, ulcerIndex, Sharpe, CAGR, CAGR to Max DD, numShorts, numLongs, Set Parameters, Aborted\n"
             f.write(header)
             f.flush()  # CRITICAL: Flush immediately to ensure header is written
             print("[DEBUG] Opened optimization output file:", outputOptimizationFile + ".csv")
@@ -728,6 +734,15 @@ def main():
         optimizationSettings.discardAssymetricSets = config.getint("optimization", "discardAssymetricSets")
         optimizationSettings.minTradesAYear = config.getint("optimization", "minTradesAYear")
         optimizationSettings.optimizationGoal = config.getint("optimization", "optimizationGoal")
+        optimizationSettings.numIslands = config.getint("optimization", "numIslands", fallback=1)
+        optimizationSettings.migrationInterval = config.getint("optimization", "migrationInterval", fallback=10)
+        # Walk-forward windows (0 in-sample days = one optimization over the whole period)
+        walkForwardSettings = WalkForwardSettings()
+        walkForwardSettings.inSampleDays = int(config.get("optimization", "walkForwardInSampleDays", fallback="0").split(';')[0].strip())
+        walkForwardSettings.outOfSampleDays = int(config.get("optimization", "walkForwardOutOfSampleDays", fallback="0").split(';')[0].strip())
+        walkForwardSettings.stepDays = int(config.get("optimization", "walkForwardStepDays", fallback="0").split(';')[0].strip())
+        # Brute force worker processes, read by the optimizer from the environment (0 = threads only)
+        os.environ["AST_OPTIMIZER_PROCESSES"] = str(config.getint("optimization", "numProcesses", fallback=0))
         
         print("[DEBUG] Optimization settings configured:")
         print(f"  [DEBUG] population={optimizationSettings.population}, maxGenerations={optimizationSettings.maxGenerations}")
@@ -792,28 +807,60 @@ def main():
             dbg.write("About to call runOptimizationMultipleSymbols\n")
             dbg.flush()
         try:
-            result = astdll.runOptimizationMultipleSymbols (
-                    ctypes.pointer(optimizationParams[0]),
-                    c_int(numOptimizationParams[0]),
-                    c_int(optimizationType),
-                    optimizationSettings,
-                    c_int(numCores),
-                    settings[0],
-                    ctypes.pointer(symbols),
-                    accountCurrency,
-                    brokerName,
-                    refBrokerName,
-                    accountInfo[0],
-                    ctypes.pointer(testSettings),
-                    ctypes.pointer(ratesInfoArray),
-                    c_int(numCandles),
-                    c_int(numPairs),
-                    ctypes.pointer(ratesArray),
-                    c_double(minLotSize),
-                    optimizationUpdate_c,
-                    optimizationFinished_c,
-                    byref(error_c)
-            )
+            if walkForwardSettings.inSampleDays > 0:
+                walkForwardFile = open(outputOptimizationFile + "_walkforward.csv", 'w')
+                walkForwardFile.write("Window, In Sample From, In Sample To, Out Of Sample From, Out Of Sample To, In Sample Fitness, Start Balance, End Balance, NumTrades, maxDD, PF, R2, Sharpe, CAGR, Set Parameters\n")
+                WALK_FORWARD_UPDATE = CFUNCTYPE(c_void_p, WalkForwardWindow, POINTER(c_double), c_int)
+                walkForwardUpdate_c = WALK_FORWARD_UPDATE(walkForwardUpdate)
+                astdll.runWalkForwardOptimization.restype = c_int
+                result = astdll.runWalkForwardOptimization (
+                        ctypes.pointer(optimizationParams[0]),
+                        c_int(numOptimizationParams[0]),
+                        c_int(optimizationType),
+                        optimizationSettings,
+                        c_int(numCores),
+                        settings[0],
+                        ctypes.pointer(symbols),
+                        accountCurrency,
+                        brokerName,
+                        refBrokerName,
+                        accountInfo[0],
+                        ctypes.pointer(testSettings),
+                        ctypes.pointer(ratesInfoArray),
+                        c_int(numCandles),
+                        c_int(numPairs),
+                        ctypes.pointer(ratesArray),
+                        c_double(minLotSize),
+                        walkForwardSettings,
+                        optimizationUpdate_c,
+                        walkForwardUpdate_c,
+                        optimizationFinished_c,
+                        byref(error_c)
+                )
+                walkForwardFile.close()
+            else:
+                result = astdll.runOptimizationMultipleSymbols (
+                        ctypes.pointer(optimizationParams[0]),
+                        c_int(numOptimizationParams[0]),
+                        c_int(optimizationType),
+                        optimizationSettings,
+                        c_int(numCores),
+                        settings[0],
+                        ctypes.pointer(symbols),
+                        accountCurrency,
+                        brokerName,
+                        refBrokerName,
+                        accountInfo[0],
+                        ctypes.pointer(testSettings),
+                        ctypes.pointer(ratesInfoArray),
+                        c_int(numCandles),
+                        c_int(numPairs),
+                        ctypes.pointer(ratesArray),
+                        c_double(minLotSize),
+                        optimizationUpdate_c,
+                        optimizationFinished_c,
+                        byref(error_c)
+                )
             print("[DEBUG] runOptimizationMultipleSymbols returned:", result, flush=True)
             print("[DEBUG] error_c.value:", error_c.value if error_c.value else "None", flush=True)
             sys.stdout.flush()
@@ -1018,12 +1065,12 @@ def optimizationUpdate(testResults, settings, numSettings):
         with optimizationUpdateLock:
             if execUnderMPI == False:
                 iterationNumber+=1
-                print("Iteration %d finished" % (iterationNumber), flush=True)
+                print("Iteration %d finished%s" % (iterationNumber, " (aborted early)" if testResults.aborted else ""), flush=True)
                 sys.stdout.flush()
                 
-                line = "%d,%s,%d,%lf,%lf,%d,%lf,%lf,%lf,%lf,%lf,%lf,%d,%d,%s\n" % (iterationNumber, testResults.symbol, testResults.totalTrades, testResults.finalBalance-initialBalance, testResults.maxDDDepth,
+                line = "%d,%s,%d,%lf,%lf,%d,%lf,%lf,%lf,%lf,%lf,%lf,%d,%d,%s,%d\n" % (iterationNumber, testResults.symbol, testResults.totalTrades, testResults.finalBalance-initialBalance, testResults.maxDDDepth,
                                                                                    int(testResults.maxDDLength/60/60/24), float(testResults.pf), testResults.r2, testResults.ulcerIndex, testResults.sharpe, testResults.cagr, ratio,
-                                                                                   testResults.numShorts, testResults.numLongs, " ".join(parameters))
+                                                                                   testResults.numShorts, testResults.numLongs, " ".join(parameters), testResults.aborted)
                 print("[DEBUG] optimizationUpdate: Writing line to CSV: %s" % line.strip(), flush=True)
                 sys.stdout.flush()
                 f.write(line)
@@ -1032,9 +1079,9 @@ def optimizationUpdate(testResults, settings, numSettings):
                 sys.stdout.flush()
             else:
                 # MPI mode - line construction (file write happens later in MPI code)
-                line = "%d,%s,%d,%lf,%lf,%d,%lf,%lf,%lf,%lf,%lf,%lf,%d,%d,%s\n" % (iterationNumber, testResults.symbol, testResults.totalTrades,testResults.finalBalance-initialBalance, testResults.maxDDDepth,
+                line = "%d,%s,%d,%lf,%lf,%d,%lf,%lf,%lf,%lf,%lf,%lf,%d,%d,%s,%d\n" % (iterationNumber, testResults.symbol, testResults.totalTrades,testResults.finalBalance-initialBalance, testResults.maxDDDepth,
                                                                                    int(testResults.maxDDLength/60/60/24), float(testResults.pf), testResults.r2, testResults.ulcerIndex, testResults.sharpe, testResults.cagr, ratio,
-                                                                                   testResults.numShorts, testResults.numLongs, " ".join(parameters))
+                                                                                   testResults.numShorts, testResults.numLongs, " ".join(parameters), testResults.aborted)
         
         # MPI-specific code (outside lock, but MPI handles its own synchronization)
         if execUnderMPI == True:
@@ -1060,6 +1107,20 @@ def optimizationUpdate(testResults, settings, numSettings):
         sys.stdout.flush()
         sys.stderr.flush()
 
+def walkForwardUpdate(window, settings, numSettings):
+    global walkForwardFile, paramNames
+    parameters = []
+    for i in range(numSettings):
+        parameters.append("%s=%lf" % (paramNames[int(settings[i*2])], settings[i*2+1]))
+    result = window.outOfSampleResult
+    print("Walk-forward window %d finished, balance %.2lf -> %.2lf" % (window.index, window.startBalance, window.endBalance), flush=True)
+    walkForwardFile.write("%d,%s,%s,%s,%s,%lf,%lf,%lf,%d,%lf,%lf,%lf,%lf,%lf,%s\n" % (window.index,
+        strftime("%d/%m/%Y", gmtime(window.inSampleFrom)), strftime("%d/%m/%Y", gmtime(window.inSampleTo)),
+        strftime("%d/%m/%Y", gmtime(window.outOfSampleFrom)), strftime("%d/%m/%Y", gmtime(window.outOfSampleTo)),
+        window.inSampleFitness, window.startBalance, window.endBalance, result.totalTrades, result.maxDDDepth,
+        result.pf, result.r2, result.sharpe, result.cagr, " ".join(parameters) if window.hasSet else "no qualifying set"))
+    walkForwardFile.flush()
+
 def optimizationFinished():
     if execUnderMPI == False:
         print("Optimization finished!!")
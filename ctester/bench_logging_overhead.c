@@ -0,0 +1,97 @@
+/**
+ * Micro-benchmark of the per-bar cost of debug logging in the tester when debug is not logged
+ * Compile: gcc -O2 -o bench_logging_overhead bench_logging_overhead.c -I../core/AsirikuyCommon/include -L../bin/gmake/x64/Release/lib -lAsirikuyCommon -lpthread
+ * Run:     ./bench_logging_overhead [bars]
+ *
+ * Each bar logs what a strategy typically does on a bar: the bar time and a handful of
+ * indicator values at debug level. The logger runs at LOG_INFO, so nothing is written.
+ *   eager        - the former macros: arguments evaluated, the call made, the level checked inside
+ *   lazy         - logDebug: one level check, arguments not evaluated
+ *   compiled out - logDebug built with ASIRIKUY_LOG_COMPILED_LEVEL=LOG_INFO
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../core/AsirikuyCommon/include/AsirikuyLogger.h"
+#include "../core/AsirikuyCommon/include/AsirikuyTime.h"
+
+#define DEFAULT_BARS 1000000
+
+static volatile double sink;
+
+static double elapsedNanoseconds(struct timespec start, struct timespec end)
+{
+    return (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+}
+
+static void eagerBar(time_t barTime, const double* values)
+{
+    char timeString[MAX_TIME_STRING_SIZE] = "";
+
+    asirikuyLogMessage(LOG_DEBUG, "bar time = %s", safe_timeString(timeString, barTime));
+    asirikuyLogMessage(LOG_DEBUG, "open = %lf, high = %lf, low = %lf, close = %lf", values[0], values[1], values[2], values[3]);
+    asirikuyLogMessage(LOG_DEBUG, "atr = %lf, ma = %lf, macd = %lf", values[4], values[5], values[6]);
+    asirikuyLogMessage(LOG_DEBUG, "stop = %lf, take = %lf, risk = %lf", values[7], values[8], values[9]);
+    sink = values[3];
+}
+
+static void lazyBar(time_t barTime, const double* values)
+{
+    char timeString[MAX_TIME_STRING_SIZE] = "";
+
+    logDebug("bar time = %s", safe_timeString(timeString, barTime));
+    logDebug("open = %lf, high = %lf, low = %lf, close = %lf", values[0], values[1], values[2], values[3]);
+    logDebug("atr = %lf, ma = %lf, macd = %lf", values[4], values[5], values[6]);
+    logDebug("stop = %lf, take = %lf, risk = %lf", values[7], values[8], values[9]);
+    sink = values[3];
+}
+
+/* What -DASIRIKUY_LOG_COMPILED_LEVEL=LOG_INFO does to the whole build */
+#undef ASIRIKUY_LOG_COMPILED_LEVEL
+#define ASIRIKUY_LOG_COMPILED_LEVEL LOG_INFO
+
+static void compiledOutBar(time_t barTime, const double* values)
+{
+    char timeString[MAX_TIME_STRING_SIZE] = "";
+
+    logDebug("bar time = %s", safe_timeString(timeString, barTime));
+    logDebug("open = %lf, high = %lf, low = %lf, close = %lf", values[0], values[1], values[2], values[3]);
+    logDebug("atr = %lf, ma = %lf, macd = %lf", values[4], values[5], values[6]);
+    logDebug("stop = %lf, take = %lf, risk = %lf", values[7], values[8], values[9]);
+    sink = values[3];
+}
+
+static double nanosecondsPerBar(void (*bar)(time_t, const double*), int numBars)
+{
+    struct timespec start, end;
+    double values[10];
+    int i, k;
+
+    for(k = 0; k < 10; k++) values[k] = 1.3 + k * 0.001;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(i = 0; i < numBars; i++)
+    {
+        values[3] += 0.00001;
+        bar(1262304000 + 900 * (time_t)i, values);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return elapsedNanoseconds(start, end) / numBars;
+}
+
+int main(int argc, char* argv[])
+{
+    int numBars = argc > 1 ? atoi(argv[1]) : DEFAULT_BARS;
+
+    if(numBars <= 0) numBars = DEFAULT_BARS;
+    asirikuyLoggerInit(NULL, LOG_INFO);
+
+    printf("Per-bar debug logging overhead at LOG_INFO, %d bars\n", numBars);
+    printf("  eager        %8.1f ns/bar\n", nanosecondsPerBar(eagerBar, numBars));
+    printf("  lazy         %8.1f ns/bar\n", nanosecondsPerBar(lazyBar, numBars));
+    printf("  compiled out %8.1f ns/bar\n", nanosecondsPerBar(compiledOutBar, numBars));
+
+    return 0;
+}
@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+"""Converts CSV history files to the tester's memory-mapped binary format.
+
+The tester maps NAME.bin instead of parsing NAME.csv whenever the binary file
+exists and is not older than the CSV file, so re-run this after the CSV changes.
+
+    python3 convert_history.py [--kind rates|quotes|ticks] FILE.csv [FILE.csv ...]
+
+Without --kind, files ending in _QUOTES.csv are converted as quotes and files
+ending in _TICK.csv as ticks.
+"""
+import argparse
+import os
+import platform
+from ctypes import c_char_p, c_int
+
+from include.asirikuy import loadLibrary
+
+KINDS = {'rates': 0, 'quotes': 1, 'ticks': 2}
+
+
+def guessKind(path):
+    if path.endswith('_QUOTES.csv'):
+        return KINDS['quotes']
+    if path.endswith('_TICK.csv'):
+        return KINDS['ticks']
+    return KINDS['rates']
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert CSV history to binary history')
+    parser.add_argument('-k', '--kind', choices=sorted(KINDS.keys()))
+    parser.add_argument('files', nargs='+')
+    args = parser.parse_args()
+
+    system = platform.system()
+    if system == "Windows":
+        astdll = loadLibrary('CTesterFrameworkAPI')
+    elif system == "Darwin":
+        astdll = loadLibrary('libCTesterFrameworkAPI.dylib')
+    else:
+        astdll = loadLibrary('libCTesterFrameworkAPI.so')
+
+    astdll.convertHistoryFile.argtypes = [c_char_p, c_char_p, c_int]
+    astdll.convertHistoryFile.restype = c_int
+
+    for csvPath in args.files:
+        kind = KINDS[args.kind] if args.kind else guessKind(csvPath)
+        binPath = os.path.splitext(csvPath)[0] + '.bin'
+        numRows = astdll.convertHistoryFile(csvPath.encode(), binPath.encode(), kind)
+        if numRows < 0:
+            print("Failed to convert %s" % csvPath)
+        else:
+            print("%s -> %s (%d rows)" % (csvPath, binPath, numRows))
+
+
+if __name__ == "__main__":
+    main()
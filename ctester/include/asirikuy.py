@@ -187,6 +187,38 @@ def makeRatesCoherent(historyFilePathsInput):
         rates_to_save = rates[rates.columns[(index*7):(index*7+7)]]
         rates_to_save.to_csv(historyFilePath1, date_format="%d/%m/%y %H:%M", header=False)
 
+historyLibrary = None
+
+def setHistoryLibrary(library):
+    """Loads rates and quotes through the tester's binary history loader from now on.
+
+    loadRates then reads NAME.bin when it is up to date and parses NAME.csv in C
+    otherwise, and converts the quote files it writes so every test run maps them.
+    """
+    global historyLibrary
+    library.loadHistoricRates.argtypes = [c_char_p, POINTER(POINTER(Rate)), POINTER(c_int)]
+    library.loadHistoricRates.restype = c_int
+    library.freeHistoricRates.argtypes = [POINTER(Rate)]
+    library.freeHistoricRates.restype = None
+    library.convertHistoryFile.argtypes = [c_char_p, c_char_p, c_int]
+    library.convertHistoryFile.restype = c_int
+    historyLibrary = library
+
+def loadHistoryRates(historyFilePath1, numCandles):
+    """Loads the first numCandles rates of a history file with loadHistoricRates, None if it fails."""
+    loaded = POINTER(Rate)()
+    numLoaded = c_int(0)
+    if not historyLibrary.loadHistoricRates(historyFilePath1.encode('utf-8'), byref(loaded), byref(numLoaded)):
+        return None
+
+    rates = (Rate * numCandles)()
+    numCopied = min(numCandles, numLoaded.value)
+    ctypes.memmove(rates, loaded, sizeof(Rate) * numCopied)
+    historyLibrary.freeHistoricRates(loaded)
+    if numCopied == 0:
+        return None
+    return rates, rates[numCopied - 1].time
+
 def loadRates(historyFilePath1, arbitraryNum, symbol, updateQuotes):
 
     # Python 3: symbol may be bytes, decode to string first
@@ -211,28 +243,32 @@ def loadRates(historyFilePath1, arbitraryNum, symbol, updateQuotes):
         if numberOfColumns < 8:
             addSwapToRates(historyFilePath1,  basePath + "/SWAP_" + baseName + ".csv" , basePath + "/SWAP_" + termName + ".csv")
 
-    with fastcsv.Reader(io.open(historyFilePath1)) as reader:
-
-        RatesType = Rate * numCandles
-        rates = RatesType()
-
-        for i,row in enumerate(reader):
-            if i < numCandles:
-                year = int(row[0][6:8])
-                if year > 50:
-                    year += 1900
-                else:
-                    year += 2000
+    loaded = loadHistoryRates(historyFilePath1, numCandles) if historyLibrary is not None else None
+    if loaded is not None:
+        rates, time = loaded
+    else:
+        with fastcsv.Reader(io.open(historyFilePath1)) as reader:
 
-                time = int((datetime.datetime(int(year), int(row[0][3:5]), int(row[0][0:2]), int(row[0][9:11]), int(row[0][12:14]), 0)-datetime.datetime(1970,1,1)).total_seconds())
-                rates[i].time = time
-                rates[i].open = float(row[1])
-                rates[i].high = float(row[2])
-                rates[i].low = float(row[3])
-                rates[i].close = float(row[4])
-                rates[i].volume = float(row[5])
-                rates[i].shortSwap = float(row[6])
-                rates[i].longSwap = float(row[7])
+            RatesType = Rate * numCandles
+            rates = RatesType()
+
+            for i,row in enumerate(reader):
+                if i < numCandles:
+                    year = int(row[0][6:8])
+                    if year > 50:
+                        year += 1900
+                    else:
+                        year += 2000
+
+                    time = int((datetime.datetime(int(year), int(row[0][3:5]), int(row[0][0:2]), int(row[0][9:11]), int(row[0][12:14]), 0)-datetime.datetime(1970,1,1)).total_seconds())
+                    rates[i].time = time
+                    rates[i].open = float(row[1])
+                    rates[i].high = float(row[2])
+                    rates[i].low = float(row[3])
+                    rates[i].close = float(row[4])
+                    rates[i].volume = float(row[5])
+                    rates[i].shortSwap = float(row[6])
+                    rates[i].longSwap = float(row[7])
 
     endingDate = time
 
@@ -242,6 +278,9 @@ def loadRates(historyFilePath1, arbitraryNum, symbol, updateQuotes):
             spamwriter  = csv.writer(f, delimiter=',', quotechar='|', quoting=csv.QUOTE_MINIMAL)
             for i in range(0, numCandles):
                 spamwriter.writerow([str(strftime("%d/%m/%y %H:%M", gmtime(rates[i].time))), str(rates[i].open)])
+        # Every test run reads the quotes, map them instead of parsing the CSV file each time
+        if historyLibrary is not None:
+            historyLibrary.convertHistoryFile((baseName+termName+'_QUOTES.csv').encode('utf-8'), (baseName+termName+'_QUOTES.bin').encode('utf-8'), 1)
         return
 
     return {'rates':rates, 'numCandles':numCandles, 'endingDate':endingDate}
@@ -435,7 +474,8 @@ class TestResult(Structure):
         ("numShorts", c_int),
         ("numLongs", c_int),
         ("yearsTraded", c_double),
-        ("symbol", c_char*5000)
+        ("symbol", c_char*5000),
+        ("aborted", c_int)
     ]
 
 
@@ -458,7 +498,10 @@ class TestSettings(Structure):
         ("spread", c_double),
         ("fromDate", c_int),
         ("toDate", c_int),
-        ("is_calculate_expectancy", c_int)
+        ("is_calculate_expectancy", c_int),
+        ("abortMaxDD", c_double),
+        ("abortMaxDDLength", c_double),
+        ("abortEquityFloor", c_double)
     ]
 
 class Rate(Structure):
@@ -849,7 +892,30 @@ class GeneticOptimizationSettings(Structure):
         ("stopIfConverged", c_int),
         ("discardAssymetricSets", c_int),
         ("minTradesAYear", c_int),
-        ("optimizationGoal", c_int)
+        ("optimizationGoal", c_int),
+        ("numIslands", c_int),
+        ("migrationInterval", c_int)
+    ]
+
+class WalkForwardSettings(Structure):
+    _fields_ = [
+        ("inSampleDays", c_int),
+        ("outOfSampleDays", c_int),
+        ("stepDays", c_int)
+    ]
+
+class WalkForwardWindow(Structure):
+    _fields_ = [
+        ("index", c_int),
+        ("inSampleFrom", c_int),
+        ("inSampleTo", c_int),
+        ("outOfSampleFrom", c_int),
+        ("outOfSampleTo", c_int),
+        ("hasSet", c_int),
+        ("inSampleFitness", c_double),
+        ("startBalance", c_double),
+        ("endBalance", c_double),
+        ("outOfSampleResult", TestResult)
     ]
 
 OPTI_BRUTE_FORCE = 0
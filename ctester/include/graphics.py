@@ -281,7 +281,8 @@ def plotOptimizationResult(resultsFile, optimizationGoal = 0, show = False, reso
         reader = csv.reader(f)
         i = 0
         for row in reader:
-            if i > 0:
+            # Aborted runs only hold the statistics of the bars they ran
+            if i > 0 and not (len(row) > 15 and row[15].strip() == "1"):
                 iterations.append(int(row[0]))
                 scores.append(float(row[optimizationGoal + 3]))
             i = i + 1
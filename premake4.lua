@@ -1,6 +1,16 @@
 -- Minimal premake4.lua for building TradingStrategies only
 -- This version excludes vendor libraries that are not needed
 
+newoption{
+  trigger     = "no-debug-log",
+  description = "Compile the logDebug calls out of Release builds"
+}
+
+newoption{
+  trigger     = "gaul-thread-safe",
+  description = "Gaul is built with its locking, evolve the optimizer islands in parallel"
+}
+
 -- Handle action
 if _ACTION == "clean" then
   os.rmdir("bin")
@@ -76,6 +86,9 @@ else
     configuration{"Release"}
 	  defines{"NDEBUG"}
 	  flags{"OptimizeSize", "NoFramePointer"}
+	  if _OPTIONS["no-debug-log"] then
+	    defines{"ASIRIKUY_LOG_COMPILED_LEVEL=LOG_INFO"}
+	  end
     -- OS specific settings
 	configuration{"macosx"}
       includedirs{"/opt/local/include"}